@@ -52,9 +52,15 @@ function(calamares_add_library)
     include_directories(${CMAKE_CURRENT_LIST_DIR})
     include_directories(${CMAKE_CURRENT_BINARY_DIR})
 
-    # add resources from current dir
+    # add resources from current dir; QML files in the resources
+    # are compiled ahead-of-time if the Qt Quick Compiler is available.
     if(LIBRARY_RESOURCES)
-        list(APPEND LIBRARY_SOURCES ${LIBRARY_RESOURCES})
+        if(Qt5QuickCompiler_FOUND)
+            qtquick_compiler_add_resources(_library_rcc_sources ${LIBRARY_RESOURCES})
+            list(APPEND LIBRARY_SOURCES ${_library_rcc_sources})
+        else()
+            list(APPEND LIBRARY_SOURCES ${LIBRARY_RESOURCES})
+        endif()
     endif()
 
     # add target
@@ -70,7 +76,7 @@ function(calamares_add_library)
     if(LIBRARY_UI)
         calamares_autouic(${target} ${LIBRARY_UI})
     endif()
-    if(LIBRARY_RESOURCES)
+    if(LIBRARY_RESOURCES AND NOT Qt5QuickCompiler_FOUND)
         calamares_autorcc(${target} ${LIBRARY_RESOURCES})
     endif()
 
@@ -32,6 +32,7 @@
 #   [NO_CONFIG]
 #   [SHARED_LIB]
 #   [EMERGENCY]
+#   [IDEMPOTENT]
 #   [WEIGHT w]
 # )
 #
@@ -55,6 +56,9 @@
 #  - EMERGENCY
 #       If this is set, the module is marked as an *emergency* module in the
 #       descriptor. See *Emergency Modules* in the module documentation.
+#  - IDEMPOTENT
+#       If this is set, the module is marked as *idempotent* in the
+#       descriptor. See *Resuming Installations* in the module documentation.
 #  - WEIGHT
 #       If this is set, writes an explicit weight into the module.desc;
 #       module weights are used in progress reporting.
@@ -75,7 +79,7 @@ include( CMakeColors )
 function( calamares_add_plugin )
     # parse arguments ( name needs to be saved before passing ARGN into the macro )
     set( NAME ${ARGV0} )
-    set( options NO_CONFIG NO_INSTALL SHARED_LIB EMERGENCY )
+    set( options NO_CONFIG NO_INSTALL SHARED_LIB EMERGENCY IDEMPOTENT )
     set( oneValueArgs NAME TYPE EXPORT_MACRO RESOURCES WEIGHT )
     set( multiValueArgs SOURCES UI LINK_LIBRARIES LINK_PRIVATE_LIBRARIES COMPILE_DEFINITIONS REQUIRES )
     cmake_parse_arguments( PLUGIN "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
@@ -196,6 +200,9 @@ function( calamares_add_plugin )
         if ( PLUGIN_EMERGENCY )
             file( APPEND ${_file} "emergency: true\n" )
         endif()
+        if ( PLUGIN_IDEMPOTENT )
+            file( APPEND ${_file} "idempotent: true\n" )
+        endif()
         if ( PLUGIN_NO_CONFIG )
             file( APPEND ${_file} "noconfig: true\n" )
         endif()
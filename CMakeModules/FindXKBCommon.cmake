@@ -0,0 +1,53 @@
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+###
+#
+# Locate libxkbcommon
+#   https://xkbcommon.org/
+#
+# This module defines
+#  XKBCommon_FOUND
+#  XKBCommon_LIBRARIES, where to find the library
+#  XKBCommon_INCLUDE_DIRS, where to find xkbcommon/xkbcommon.h
+#
+# (ECM has a module with the same name, which defines the same variables;
+# when ECM is found, that one is used instead).
+#
+find_package(PkgConfig)
+include(FindPackageHandleStandardArgs)
+
+if(PkgConfig_FOUND)
+    pkg_search_module(pc_xkbcommon QUIET xkbcommon)
+else()
+    # It's just possible that the find_path and find_library will
+    # find it **anyway**, so let's pretend it was there.
+    set(pc_xkbcommon_FOUND ON)
+endif()
+
+find_path(XKBCommon_INCLUDE_DIR
+    NAMES xkbcommon/xkbcommon.h
+    PATHS ${pc_xkbcommon_INCLUDE_DIRS}
+)
+find_library(XKBCommon_LIBRARY
+    NAMES xkbcommon
+    PATHS ${pc_xkbcommon_LIBRARY_DIRS}
+)
+if(pc_xkbcommon_FOUND)
+    set(XKBCommon_LIBRARIES ${XKBCommon_LIBRARY})
+    set(XKBCommon_INCLUDE_DIRS ${XKBCommon_INCLUDE_DIR} ${pc_xkbcommon_INCLUDE_DIRS})
+endif()
+
+find_package_handle_standard_args(XKBCommon DEFAULT_MSG
+    XKBCommon_INCLUDE_DIRS
+    XKBCommon_LIBRARIES
+)
+mark_as_advanced(XKBCommon_INCLUDE_DIRS XKBCommon_LIBRARIES)
+
+set_package_properties(
+    XKBCommon PROPERTIES
+    DESCRIPTION "Keyboard keymap handling library"
+    URL "https://xkbcommon.org/"
+)
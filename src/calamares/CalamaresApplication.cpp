@@ -18,7 +18,9 @@
 #include "JobQueue.h"
 #include "Settings.h"
 #include "ViewManager.h"
+#include "geoip/Resolver.h"
 #include "modulesystem/ModuleManager.h"
+#include "network/Manager.h"
 #include "utils/CalamaresUtilsGui.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Dirs.h"
@@ -27,6 +29,7 @@
 #include "utils/Qml.h"
 #endif
 #include "utils/Retranslator.h"
+#include "utils/Variant.h"
 #include "viewpages/ViewStep.h"
 
 #include <QDesktopWidget>
@@ -70,11 +73,16 @@ CalamaresApplication::init()
     cDebug() << Logger::SubEntry
              << "languages:" << QString( CALAMARES_TRANSLATION_LANGUAGES ).replace( ";", ", " );
 
+    // Keep network responses (e.g. netinstall package lists) across restarts of Calamares
+    CalamaresUtils::Network::Manager::instance().setCacheDirectory(
+        CalamaresUtils::appLogDir().absoluteFilePath( QStringLiteral( "network-cache" ) ), 64 * 1024 * 1024 );
+
     if ( !Calamares::Settings::instance() )
     {
         cError() << "Must create Calamares::Settings before the application.";
         ::exit( 1 );
     }
+    initGeoIP();
     initQmlPath();
     initBranding();
 
@@ -139,6 +147,31 @@ brandingFileCandidates( bool assumeBuilddir, const QString& brandingFilename )
 }
 
 
+void
+CalamaresApplication::initGeoIP()
+{
+    const QVariantMap config = Calamares::Settings::instance()->geoipConfiguration();
+    if ( config.isEmpty() )
+    {
+        return;
+    }
+
+    using namespace CalamaresUtils::GeoIP;
+    // Results are kept across runs, so a restarted Calamares doesn't have to look again
+    qint64 hours = CalamaresUtils::getInteger( config, "cache-hours", 24 );
+    if ( hours < 0 )
+    {
+        hours = 0;
+    }
+    const QString cacheFile = CalamaresUtils::appLogDir().absoluteFilePath( QStringLiteral( "geoip-cache.json" ) );
+    Resolver::instance().setCacheFile( cacheFile, std::chrono::hours( hours ) );
+    if ( !Resolver::instance().start( Resolver::handlers( config.value( "providers" ) ) ) )
+    {
+        cWarning() << "No valid GeoIP providers in settings.conf";
+    }
+}
+
+
 void
 CalamaresApplication::initQmlPath()
 {
@@ -297,4 +330,20 @@ CalamaresApplication::initJobQueue()
     Calamares::JobQueue* jobQueue = new Calamares::JobQueue( this );
     new CalamaresUtils::System( Calamares::Settings::instance()->doChroot(), this );
     Calamares::Branding::instance()->setGlobals( jobQueue->globalStorage() );
+
+    const QString checkpoint
+        = m_checkpointPath.isEmpty() ? CalamaresUtils::appLogDir().filePath( "checkpoint.json" ) : m_checkpointPath;
+    jobQueue->setCheckpoint( checkpoint, m_resume );
+    if ( m_resume )
+    {
+        cDebug() << "Resuming installation from checkpoint" << checkpoint;
+    }
+}
+
+
+void
+CalamaresApplication::setCheckpoint( const QString& path, bool resume )
+{
+    m_checkpointPath = path;
+    m_resume = resume;
 }
@@ -45,6 +45,14 @@ public:
      */
     CalamaresWindow* mainWindow();
 
+    /**
+     * @brief Where the job queue keeps its checkpoint, and whether to resume from it
+     *
+     * An empty @p path uses the default, `checkpoint.json` next to the
+     * session log. Call this before init().
+     */
+    void setCheckpoint( const QString& path, bool resume );
+
 private slots:
     void initView();
     void initViewSteps();
@@ -52,6 +60,7 @@ private slots:
 
 private:
     // Initialization steps happen in this order
+    void initGeoIP();
     void initQmlPath();
     void initBranding();
     void initModuleManager();
@@ -59,6 +68,8 @@ private:
 
     CalamaresWindow* m_mainwindow;
     Calamares::ModuleManager* m_moduleManager;
+    QString m_checkpointPath;
+    bool m_resume = false;
 };
 
 #endif  // CALAMARESAPPLICATION_H
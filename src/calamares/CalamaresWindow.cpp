@@ -32,6 +32,7 @@
 #include <QFileInfo>
 #include <QLabel>
 #ifdef WITH_QML
+#include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QQuickItem>
@@ -242,6 +243,36 @@ setDimension( QQuickWidget* w, Qt::Orientation o, int desiredWidth )
 }
 
 
+/** @brief A widget showing the QML file @p name
+ *
+ * The QML engine is shared with all the other QML in Calamares, so
+ * *debug* is set in a context of its own, which only this QML sees.
+ */
+static QQuickWidget*
+getQmlWidget( Calamares::DebugWindowManager* debug, const QString& name, QWidget* parent )
+{
+    QQuickWidget* w = new QQuickWidget( CalamaresUtils::qmlEngine(), parent );
+    QQmlContext* context = new QQmlContext( w->engine()->rootContext(), w );
+    if ( debug )
+    {
+        context->setContextProperty( "debug", debug );
+    }
+
+    const QUrl url( CalamaresUtils::searchQmlFile( CalamaresUtils::QmlSearch::Both, name ) );
+    QQmlComponent* component = new QQmlComponent( w->engine(), url, w );
+    QObject* o = component->create( context );
+    QQuickItem* item = qobject_cast< QQuickItem* >( o );
+    if ( !item )
+    {
+        cError() << "Could not create QML from" << url << component->errors();
+        delete o;
+        return w;
+    }
+    // See QmlViewStep::loadComplete() for setContent()
+    w->setContent( url, component, item );
+    return w;
+}
+
 static QWidget*
 getQmlSidebar( Calamares::DebugWindowManager* debug,
                Calamares::ViewManager*,
@@ -249,15 +280,7 @@ getQmlSidebar( Calamares::DebugWindowManager* debug,
                Qt::Orientation o,
                int desiredWidth )
 {
-    CalamaresUtils::registerQmlModels();
-    QQuickWidget* w = new QQuickWidget( parent );
-    if ( debug )
-    {
-        w->engine()->rootContext()->setContextProperty( "debug", debug );
-    }
-
-    w->setSource( QUrl(
-        CalamaresUtils::searchQmlFile( CalamaresUtils::QmlSearch::Both, QStringLiteral( "calamares-sidebar" ) ) ) );
+    QQuickWidget* w = getQmlWidget( debug, QStringLiteral( "calamares-sidebar" ), parent );
     setDimension( w, o, desiredWidth );
     return w;
 }
@@ -269,14 +292,7 @@ getQmlNavigation( Calamares::DebugWindowManager* debug,
                   Qt::Orientation o,
                   int desiredWidth )
 {
-    CalamaresUtils::registerQmlModels();
-    QQuickWidget* w = new QQuickWidget( parent );
-    if ( debug )
-    {
-        w->engine()->rootContext()->setContextProperty( "debug", debug );
-    }
-    w->setSource( QUrl(
-        CalamaresUtils::searchQmlFile( CalamaresUtils::QmlSearch::Both, QStringLiteral( "calamares-navigation" ) ) ) );
+    QQuickWidget* w = getQmlWidget( debug, QStringLiteral( "calamares-navigation" ), parent );
     setDimension( w, o, desiredWidth );
     return w;
 }
@@ -78,6 +78,10 @@ handle_args( CalamaresApplication& a )
     QCommandLineOption configOption(
         QStringList { "c", "config" }, "Configuration directory to use, for testing purposes.", "config" );
     QCommandLineOption xdgOption( QStringList { "X", "xdg-config" }, "Use XDG_{CONFIG,DATA}_DIRS as well." );
+    QCommandLineOption resumeOption( QStringLiteral( "resume" ),
+                                     "Resume an interrupted installation, skipping the jobs that completed." );
+    QCommandLineOption checkpointOption(
+        QStringLiteral( "checkpoint" ), "Checkpoint file for resuming installations.", "file" );
 
     QCommandLineParser parser;
     parser.setApplicationDescription( "Distribution-independent installer framework" );
@@ -89,6 +93,8 @@ handle_args( CalamaresApplication& a )
     parser.addOption( configOption );
     parser.addOption( xdgOption );
     parser.addOption( debugTxOption );
+    parser.addOption( resumeOption );
+    parser.addOption( checkpointOption );
 
     parser.process( a );
 
@@ -102,6 +108,7 @@ handle_args( CalamaresApplication& a )
         CalamaresUtils::setXdgDirs();
     }
     CalamaresUtils::setAllowLocalTranslation( parser.isSet( debugOption ) || parser.isSet( debugTxOption ) );
+    a.setCheckpoint( parser.value( checkpointOption ), parser.isSet( resumeOption ) );
 
     return parser.isSet( debugOption );
 }
@@ -11,9 +11,14 @@
  * This executable loads and runs a Calamares Python module
  * within a C++ application, in order to test the different
  * bindings.
+ *
+ * With --sequence, it runs all the *exec* steps from a settings.conf
+ * instead, headless, and can write statistics for each job
+ * for benchmarking purposes.
  */
 
 #include "Branding.h"
+#include "CalamaresVersion.h"
 #include "CppJob.h"
 #include "GlobalStorage.h"
 #include "Job.h"
@@ -23,6 +28,8 @@
 #include "modulesystem/Module.h"
 #include "modulesystem/ModuleManager.h"
 #include "modulesystem/ViewModule.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Dirs.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "utils/Yaml.h"
@@ -43,11 +50,22 @@
 #include <QCommandLineOption>
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLabel>
 #include <QMainWindow>
+#include <QProcess>
+#include <QSysInfo>
+#include <QTemporaryDir>
 #include <QThread>
 
+#include <sys/resource.h>
+
 #include <memory>
 
 struct ModuleConfig
@@ -64,6 +82,12 @@ struct ModuleConfig
     QString m_branding;
     bool m_ui;
     bool m_pythonInjection;
+
+    // Running a whole sequence
+    QString m_sequence;  ///< settings.conf to take the exec steps from
+    QString m_stats;  ///< Where to write statistics
+    QString m_target;  ///< Disk image to provision as target
+    int m_targetSize;  ///< in MiB
 };
 
 static ModuleConfig
@@ -86,6 +110,17 @@ handle_args( QCoreApplication& a )
     QCommandLineOption uiOption( { QStringLiteral( "U" ), QStringLiteral( "ui" ) }, QStringLiteral( "Enable UI" ) );
     QCommandLineOption slideshowOption( { QStringLiteral( "s" ), QStringLiteral( "slideshow" ) },
                                         QStringLiteral( "Run slideshow module" ) );
+    QCommandLineOption sequenceOption( { QStringLiteral( "S" ), QStringLiteral( "sequence" ) },
+                                       QStringLiteral( "Run the exec steps from settings instead of a single module" ),
+                                       "settings.conf" );
+    QCommandLineOption statsOption( QStringLiteral( "stats" ),
+                                    QStringLiteral( "Write statistics for each job (with --sequence) as JSON" ),
+                                    "stats.json" );
+    QCommandLineOption targetOption( QStringLiteral( "target" ),
+                                     QStringLiteral( "Create disk image, format and mount it as target (needs root)" ),
+                                     "image" );
+    QCommandLineOption targetSizeOption(
+        QStringLiteral( "target-size" ), QStringLiteral( "Size of the target disk image" ), "MiB", "8192" );
     QCommandLineParser parser;
     parser.setApplicationDescription( "Calamares module tester" );
     parser.addHelpOption();
@@ -98,19 +133,23 @@ handle_args( QCoreApplication& a )
     parser.addOption( brandOption );
     parser.addOption( uiOption );
     parser.addOption( slideshowOption );
+    parser.addOption( sequenceOption );
+    parser.addOption( statsOption );
+    parser.addOption( targetOption );
+    parser.addOption( targetSizeOption );
 #ifdef WITH_PYTHON
     QCommandLineOption pythonOption( { QStringLiteral( "P" ), QStringLiteral( "no-injected-python" ) },
                                      QStringLiteral( "Do not disable potentially-harmful Python commands" ) );
     parser.addOption( pythonOption );
 #endif
 
-    parser.addPositionalArgument( "module", "Path or name of module to run." );
+    parser.addPositionalArgument( "module", "Path or name of module to run (unless --sequence)." );
     parser.addPositionalArgument( "job.yaml", "Path of job settings document to use.", "[job.yaml]" );
 
     parser.process( a );
 
     const QStringList args = parser.positionalArguments();
-    if ( args.isEmpty() && !parser.isSet( slideshowOption ) )
+    if ( args.isEmpty() && !parser.isSet( slideshowOption ) && !parser.isSet( sequenceOption ) )
     {
         cError() << "Missing <module> path.\n";
         parser.showHelp();
@@ -135,13 +174,26 @@ handle_args( QCoreApplication& a )
             pythonInjection = false;
         }
 #endif
-        return ModuleConfig { parser.isSet( slideshowOption ) ? QStringLiteral( "-" ) : args.first(),
+        QString moduleName;
+        if ( parser.isSet( slideshowOption ) )
+        {
+            moduleName = QStringLiteral( "-" );
+        }
+        else if ( !args.isEmpty() )
+        {
+            moduleName = args.first();
+        }
+        return ModuleConfig { moduleName,
                               jobSettings,
                               parser.value( globalOption ),
                               parser.value( langOption ),
                               parser.value( brandOption ),
                               parser.isSet( slideshowOption ) || parser.isSet( uiOption ),
-                              pythonInjection };
+                              pythonInjection,
+                              parser.value( sequenceOption ),
+                              parser.value( statsOption ),
+                              parser.value( targetOption ),
+                              parser.value( targetSizeOption ).toInt() };
     }
 }
 
@@ -282,17 +334,16 @@ ExecViewModule::jobs() const
     return l;
 }
 
-static Calamares::Module*
-load_module( const ModuleConfig& moduleConfig )
+/** @brief Finds and loads the module.desc for @p moduleName
+ *
+ * The @p moduleName can be a path to a module.desc, a path to
+ * a module directory, or the name of a module (directory)
+ * in one of the usual places. On success, @p fi points to the
+ * descriptor file and the (non-empty) descriptor is returned.
+ */
+static QVariantMap
+load_descriptor( const QString& moduleName, QFileInfo& fi )
 {
-    QString moduleName = moduleConfig.moduleName();
-    if ( moduleName == "-" )
-    {
-        return new ExecViewModule;
-    }
-
-    QFileInfo fi;
-
     bool ok = false;
     QVariantMap descriptor;
 
@@ -340,6 +391,24 @@ load_module( const ModuleConfig& moduleConfig )
     if ( !ok )
     {
         cWarning() << "No suitable module descriptor found in" << Logger::DebugList( moduleDirectories );
+        return QVariantMap();
+    }
+    return descriptor;
+}
+
+static Calamares::Module*
+load_module( const ModuleConfig& moduleConfig )
+{
+    QString moduleName = moduleConfig.moduleName();
+    if ( moduleName == "-" )
+    {
+        return new ExecViewModule;
+    }
+
+    QFileInfo fi;
+    QVariantMap descriptor = load_descriptor( moduleName, fi );
+    if ( descriptor.isEmpty() )
+    {
         return nullptr;
     }
 
@@ -362,6 +431,277 @@ load_module( const ModuleConfig& moduleConfig )
     return module;
 }
 
+/** @brief Resource usage of this process and its (finished) child processes
+ *
+ * The I/O counters are those of the storage layer (bytes actually
+ * read from and written to disk, or at least the page cache for writing),
+ * from /proc/self/io.
+ */
+struct ResourceUsage
+{
+    qint64 userMs = 0;
+    qint64 systemMs = 0;
+    qint64 readBytes = 0;
+    qint64 writeBytes = 0;
+
+    static ResourceUsage current()
+    {
+        ResourceUsage u;
+        const auto ms = []( const struct timeval& tv ) { return qint64( tv.tv_sec ) * 1000 + tv.tv_usec / 1000; };
+        for ( int who : { RUSAGE_SELF, RUSAGE_CHILDREN } )
+        {
+            struct rusage r;
+            if ( getrusage( who, &r ) == 0 )
+            {
+                u.userMs += ms( r.ru_utime );
+                u.systemMs += ms( r.ru_stime );
+            }
+        }
+
+        QFile io( QStringLiteral( "/proc/self/io" ) );
+        if ( io.open( QIODevice::ReadOnly ) )
+        {
+            for ( const auto& line : io.readAll().split( '\n' ) )
+            {
+                if ( line.startsWith( "read_bytes:" ) )
+                {
+                    u.readBytes = line.mid( 11 ).trimmed().toLongLong();
+                }
+                else if ( line.startsWith( "write_bytes:" ) )
+                {
+                    u.writeBytes = line.mid( 12 ).trimmed().toLongLong();
+                }
+            }
+        }
+        return u;
+    }
+
+    ResourceUsage operator-( const ResourceUsage& other ) const
+    {
+        return ResourceUsage { userMs - other.userMs,
+                               systemMs - other.systemMs,
+                               readBytes - other.readBytes,
+                               writeBytes - other.writeBytes };
+    }
+};
+
+/** @brief Job that measures another job
+ *
+ * Wraps a job from a module when running a --sequence, and
+ * records wall-clock time and resource usage of that job.
+ * The job queue runs one job at a time, so the resource usage of
+ * the whole process during exec() is attributed to this job.
+ */
+class BenchmarkJob : public Calamares::Job
+{
+public:
+    BenchmarkJob( const Calamares::job_ptr& job, const QString& source )
+        : m_job( job )
+        , m_source( source )
+    {
+        setEmergency( job->isEmergency() );
+        connect( job.data(), &Calamares::Job::progress, this, &Calamares::Job::progress );
+    }
+    ~BenchmarkJob() override;
+
+    int getJobWeight() const override { return m_job->getJobWeight(); }
+    QString prettyName() const override { return m_job->prettyName(); }
+    QString prettyDescription() const override { return m_job->prettyDescription(); }
+    QString prettyStatusMessage() const override { return m_job->prettyStatusMessage(); }
+
+    Calamares::JobResult exec() override
+    {
+        const ResourceUsage before = ResourceUsage::current();
+        QElapsedTimer timer;
+        timer.start();
+        Calamares::JobResult r = m_job->exec();
+        m_wallMs = timer.elapsed();
+        m_usage = ResourceUsage::current() - before;
+        m_ran = true;
+        m_ok = bool( r );
+        return r;
+    }
+
+    QJsonObject statistics() const
+    {
+        QJsonObject o { { "module", m_source }, { "name", prettyName() }, { "ran", m_ran } };
+        if ( m_ran )
+        {
+            o.insert( "ok", m_ok );
+            o.insert( "wall_ms", m_wallMs );
+            o.insert( "user_ms", m_usage.userMs );
+            o.insert( "system_ms", m_usage.systemMs );
+            o.insert( "read_bytes", m_usage.readBytes );
+            o.insert( "write_bytes", m_usage.writeBytes );
+        }
+        return o;
+    }
+
+private:
+    Calamares::job_ptr m_job;
+    QString m_source;
+    bool m_ran = false;
+    bool m_ok = false;
+    qint64 m_wallMs = 0;
+    ResourceUsage m_usage;
+};
+
+BenchmarkJob::~BenchmarkJob() {}
+
+/// @brief Runs @p program with @p args, logs failures
+static bool
+run_tool( const QString& program, const QStringList& args )
+{
+    QProcess p;
+    p.setProcessChannelMode( QProcess::MergedChannels );
+    p.start( program, args );
+    if ( !p.waitForFinished( -1 ) || p.exitStatus() != QProcess::NormalExit || p.exitCode() != 0 )
+    {
+        cError() << "Command" << program << args << "failed" << p.errorString();
+        cDebug() << Logger::NoQuote << p.readAll();
+        return false;
+    }
+    return true;
+}
+
+/** @brief Creates a disk image at @p image and mounts it on @p mountPoint
+ *
+ * The image is a sparse file of @p sizeMiB, formatted as ext4
+ * and loop-mounted, so that the jobs write to a real filesystem
+ * of known size instead of wherever the temporary directory lives.
+ */
+static bool
+provision_target( const QString& image, int sizeMiB, const QString& mountPoint )
+{
+    QFile f( image );
+    if ( sizeMiB < 1 || !f.open( QIODevice::WriteOnly | QIODevice::Truncate )
+         || !f.resize( qint64( sizeMiB ) * 1024 * 1024 ) )
+    {
+        cError() << "Could not create target image" << image << sizeMiB << "MiB" << f.errorString();
+        return false;
+    }
+    f.close();
+    return run_tool( QStringLiteral( "mkfs.ext4" ), { "-q", "-F", image } )
+        && run_tool( QStringLiteral( "mount" ), { "-o", "loop", image, mountPoint } );
+}
+
+/** @brief Runs the exec steps of the sequence, headless
+ *
+ * All the modules in all the exec steps are loaded, and their jobs
+ * queued up in the JobQueue, as Calamares would. View modules are
+ * skipped since their jobs depend on what the user did in the UI.
+ * The queue is run to completion, and statistics are written
+ * to the --stats file, if one is given.
+ */
+static int
+run_sequence( const ModuleConfig& moduleConfig, Calamares::JobQueue* queue )
+{
+    auto* settings = Calamares::Settings::instance();
+    const auto instances = settings->moduleInstances();
+
+    QList< QSharedPointer< BenchmarkJob > > benchmarkJobs;
+    for ( const auto& step : settings->modulesSequence() )
+    {
+        if ( step.first != Calamares::ModuleSystem::Action::Exec )
+        {
+            continue;
+        }
+        for ( const auto& key : step.second )
+        {
+            auto instance = std::find_if( instances.cbegin(),
+                                          instances.cend(),
+                                          [&key]( const Calamares::InstanceDescription& d ) { return d.key() == key; } );
+            const Calamares::InstanceDescription description
+                = instance == instances.cend() ? Calamares::InstanceDescription( key ) : *instance;
+
+            QFileInfo fi;
+            QVariantMap descriptor = load_descriptor( key.module(), fi );
+            if ( descriptor.isEmpty() )
+            {
+                cError() << "Could not find module" << key.toString();
+                return 1;
+            }
+            const auto moduleDescriptor = Calamares::ModuleSystem::Descriptor::fromDescriptorData( descriptor );
+            if ( moduleDescriptor.type() == Calamares::ModuleSystem::Type::View )
+            {
+                cWarning() << "Skipping view module" << key.toString() << "(its jobs need the UI).";
+                continue;
+            }
+
+            Calamares::Module* m = Calamares::moduleFromDescriptor(
+                moduleDescriptor, key.id(), description.configFileName(), fi.absolutePath() );
+            if ( m && !m->isLoaded() )
+            {
+                m->loadSelf();
+            }
+            if ( !m || !m->isLoaded() )
+            {
+                cError() << "Module" << key.toString() << "could not be loaded.";
+                return 1;
+            }
+
+            Calamares::JobList jobs;
+            for ( const auto& j : m->jobs() )
+            {
+                auto b = QSharedPointer< BenchmarkJob >::create( j, key.toString() );
+                if ( m->isEmergency() )
+                {
+                    b->setEmergency( true );
+                }
+                benchmarkJobs.append( b );
+                jobs.append( b );
+            }
+            queue->enqueue( description.weight(), jobs, key.toString() );
+        }
+    }
+
+    QString failure;
+    QEventLoop loop;
+    QObject::connect( queue, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QObject::connect( queue, &Calamares::JobQueue::failed, [&failure]( const QString& message, const QString& ) {
+        failure = message;
+    } );
+    QElapsedTimer timer;
+    timer.start();
+    queue->start();
+    loop.exec();
+    const qint64 totalMs = timer.elapsed();
+
+    if ( failure.isEmpty() )
+    {
+        cDebug() << "Sequence completed in" << totalMs << "ms";
+    }
+    else
+    {
+        cError() << "Sequence failed after" << totalMs << "ms:" << failure;
+    }
+
+    if ( !moduleConfig.m_stats.isEmpty() )
+    {
+        QJsonArray jobStats;
+        for ( const auto& b : qAsConst( benchmarkJobs ) )
+        {
+            jobStats.append( b->statistics() );
+        }
+        QJsonObject stats { { "calamares", QStringLiteral( CALAMARES_VERSION ) },
+                            { "settings", QFileInfo( moduleConfig.m_sequence ).absoluteFilePath() },
+                            { "date", QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) },
+                            { "kernel", QSysInfo::kernelVersion() },
+                            { "cpus", QThread::idealThreadCount() },
+                            { "ok", failure.isEmpty() },
+                            { "wall_ms", totalMs },
+                            { "jobs", jobStats } };
+        QFile f( moduleConfig.m_stats );
+        if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate )
+             || f.write( QJsonDocument( stats ).toJson( QJsonDocument::Indented ) ) < 0 )
+        {
+            cError() << "Could not write statistics" << moduleConfig.m_stats << f.errorString();
+            return 1;
+        }
+    }
+    return failure.isEmpty() ? 0 : 1;
+}
+
 static bool
 is_ui_option( const char* s )
 {
@@ -446,12 +786,17 @@ main( int argc, char* argv[] )
     Logger::setupLogLevel( Logger::LOGVERBOSE );
 
     ModuleConfig module = handle_args( *aw );
-    if ( module.moduleName().isEmpty() )
+    if ( module.moduleName().isEmpty() && module.m_sequence.isEmpty() )
     {
         return 1;
     }
 
-    std::unique_ptr< Calamares::Settings > settings_p( Calamares::Settings::init( QString() ) );
+    if ( !module.m_sequence.isEmpty() )
+    {
+        // Module configurations are looked up next to settings.conf, like calamares -c does
+        CalamaresUtils::setAppDataDir( QFileInfo( module.m_sequence ).absoluteDir() );
+    }
+    std::unique_ptr< Calamares::Settings > settings_p( Calamares::Settings::init( module.m_sequence ) );
     std::unique_ptr< Calamares::JobQueue > jobqueue_p( new Calamares::JobQueue( nullptr ) );
     QMainWindow* mw = nullptr;
 
@@ -477,6 +822,30 @@ main( int argc, char* argv[] )
     CalamaresUtils::initQmlModulesDir();  // don't care if failed
 #endif
 
+    if ( !module.m_sequence.isEmpty() )
+    {
+        cDebug() << "Calamares sequence-runner" << module.m_sequence;
+        (void)new CalamaresUtils::System( settings_p->doChroot(), aw );
+
+        QTemporaryDir targetDir;
+        if ( !module.m_target.isEmpty() )
+        {
+            if ( !targetDir.isValid()
+                 || !provision_target( module.m_target, module.m_targetSize, targetDir.path() ) )
+            {
+                return 1;
+            }
+            gs->insert( "rootMountPoint", targetDir.path() );
+        }
+        int r = run_sequence( module, jobqueue_p.get() );
+        if ( !module.m_target.isEmpty() && !run_tool( QStringLiteral( "umount" ), { "-R", targetDir.path() } ) )
+        {
+            // Don't recursively remove whatever is still mounted there
+            targetDir.setAutoRemove( false );
+        }
+        return r;
+    }
+
     cDebug() << "Calamares module-loader testing" << module.moduleName();
     Calamares::Module* m = load_module( module );
     if ( !m )
@@ -131,11 +131,22 @@ public:
     bool isEmergency() const { return m_emergency; }
     void setEmergency( bool e ) { m_emergency = e; }
 
+    /** @brief Can this job be run again without harm?
+     *
+     * When an interrupted installation is resumed (see JobQueue::setCheckpoint()),
+     * jobs that completed before are skipped -- except idempotent ones,
+     * which typically set up state that does not survive a restart
+     * (e.g. mounts), and so are run again.
+     */
+    bool isIdempotent() const { return m_idempotent; }
+    void setIdempotent( bool i ) { m_idempotent = i; }
+
 signals:
     void progress( qreal percent );
 
 private:
     bool m_emergency = false;
+    bool m_idempotent = false;
 };
 
 using job_ptr = QSharedPointer< Job >;
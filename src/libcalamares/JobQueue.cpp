@@ -15,9 +15,17 @@
 #include "Job.h"
 #include "utils/Logger.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSaveFile>
 #include <QThread>
+#include <QVector>
 
 #include <memory>
 
@@ -42,9 +50,21 @@ struct WeightedJob
     qreal weight = 0.0;
 
     job_ptr job;
+    /// @brief Module (instance) the job comes from
+    QString source;
+
+    /// @brief Identifies the job in a checkpoint
+    QString identity() const
+    {
+        const QString className = QString::fromLatin1( job->metaObject()->className() );
+        return source.isEmpty() ? className : ( source + '/' + className );
+    }
 };
 using WeightedJobList = QList< WeightedJob >;
 
+/// @brief Format of the checkpoint file, for compatibility checks
+static constexpr int checkpointVersion = 1;
+
 class JobThread : public QThread
 {
     Q_OBJECT
@@ -81,7 +101,7 @@ public:
         }
     }
 
-    void enqueue( int moduleWeight, const JobList& jobs )
+    void enqueue( int moduleWeight, const JobList& jobs, const QString& source )
     {
         QMutexLocker qlock( &m_enqueMutex );
 
@@ -100,11 +120,18 @@ public:
         for ( const auto& j : jobs )
         {
             qreal jobContribution = ( j->getJobWeight() / totalJobWeight ) * moduleWeight;
-            m_queuedJobs->append( WeightedJob { cumulative, jobContribution, j } );
+            m_queuedJobs->append( WeightedJob { cumulative, jobContribution, j, source } );
             cumulative += jobContribution;
         }
     }
 
+    void setCheckpoint( const QString& path, bool resume )
+    {
+        QMutexLocker rlock( &m_runMutex );
+        m_checkpointPath = path;
+        m_resume = resume && !path.isEmpty();
+    }
+
     void run() override
     {
         QMutexLocker rlock( &m_runMutex );
@@ -112,6 +139,14 @@ public:
         QString message;  ///< Filled in with errors
         QString details;
 
+        QVector< bool > completed( m_runningJobs->count(), false );
+        if ( m_resume )
+        {
+            // Only the first exec-block resumes; later ones overwrite the checkpoint anyway
+            m_resume = false;
+            loadCheckpoint( completed );
+        }
+
         Logger::Once o;
         m_jobIndex = 0;
         for ( const auto& jobitem : *m_runningJobs )
@@ -120,11 +155,21 @@ public:
             {
                 cDebug() << o << "Skipping non-emergency job" << jobitem.job->prettyName();
             }
+            else if ( !failureEncountered && completed[ m_jobIndex ] && !jobitem.job->isIdempotent() )
+            {
+                cDebug() << o << "Skipping completed job" << jobitem.job->prettyName() << '(' << ( m_jobIndex + 1 )
+                         << '/' << m_runningJobs->count() << ')';
+                emitProgress( 1.0 );
+            }
             else
             {
                 cDebug() << o << "Starting" << ( failureEncountered ? "EMERGENCY JOB" : "job" ) << jobitem.job->prettyName()
                          << '(' << ( m_jobIndex + 1 ) << '/' << m_runningJobs->count() << ')';
                 o.refresh();  // So next time it shows the function header again
+                if ( !failureEncountered )
+                {
+                    saveCheckpoint( completed, m_jobIndex );
+                }
                 emitProgress( 0.0 );  // 0% for *this job*
                 connect( jobitem.job.data(), &Job::progress, this, &JobThread::emitProgress );
                 auto result = jobitem.job->exec();
@@ -135,6 +180,11 @@ public:
                     message = result.message();
                     details = result.details();
                 }
+                else if ( !failureEncountered )
+                {
+                    completed[ m_jobIndex ] = true;
+                    saveCheckpoint( completed, -1 );
+                }
                 QThread::msleep( 16 );  // Very brief rest before reporting the job as complete
                 emitProgress( 1.0 );  // 100% for *this job*
             }
@@ -147,6 +197,10 @@ public:
         }
         else
         {
+            if ( !m_checkpointPath.isEmpty() )
+            {
+                QFile::remove( m_checkpointPath );
+            }
             emitProgress( 1.0 );
         }
         m_runningJobs->clear();
@@ -168,6 +222,107 @@ public:
     }
 
 private:
+    /* These are called **only** from run(), while m_runMutex is
+     * already locked, so we can use the m_runningJobs member safely.
+     */
+    QJsonArray jobIdentities() const
+    {
+        QJsonArray ids;
+        for ( const auto& j : *m_runningJobs )
+        {
+            ids.append( j.identity() );
+        }
+        return ids;
+    }
+
+    /** @brief Writes the checkpoint file
+     *
+     * The @p completed jobs have completed successfully, while
+     * job @p current is about to start (-1 if no job is running).
+     */
+    void saveCheckpoint( const QVector< bool >& completed, int current ) const
+    {
+        if ( m_checkpointPath.isEmpty() )
+        {
+            return;
+        }
+
+        QJsonArray done;
+        for ( int i = 0; i < completed.count(); ++i )
+        {
+            if ( completed[ i ] )
+            {
+                done.append( i );
+            }
+        }
+        QJsonObject checkpoint { { "version", checkpointVersion },
+                                 { "jobs", jobIdentities() },
+                                 { "completed", done },
+                                 { "current", current },
+                                 { "globalStorage", QJsonObject::fromVariantMap( m_queue->globalStorage()->data() ) } };
+
+        // Global storage may hold passwords, so keep the file private
+        QDir().mkpath( QFileInfo( m_checkpointPath ).absolutePath() );
+        QSaveFile f( m_checkpointPath );
+        if ( !f.open( QIODevice::WriteOnly ) || !f.setPermissions( QFileDevice::ReadOwner | QFileDevice::WriteOwner )
+             || f.write( QJsonDocument( checkpoint ).toJson( QJsonDocument::Compact ) ) < 0 || !f.commit() )
+        {
+            cWarning() << "Could not write checkpoint" << m_checkpointPath << f.errorString();
+        }
+    }
+
+    /** @brief Reads the checkpoint file, if it matches the queue
+     *
+     * Returns @c true if the checkpoint was for the jobs in the queue;
+     * then global storage has been restored and @p completed is filled in.
+     */
+    bool loadCheckpoint( QVector< bool >& completed ) const
+    {
+        QFile f( m_checkpointPath );
+        if ( !f.open( QIODevice::ReadOnly ) )
+        {
+            cWarning() << "Can not resume, no checkpoint" << m_checkpointPath;
+            return false;
+        }
+        QJsonParseError e;
+        const QJsonObject checkpoint = QJsonDocument::fromJson( f.readAll(), &e ).object();
+        if ( e.error != QJsonParseError::NoError || checkpoint.value( "version" ).toInt() != checkpointVersion )
+        {
+            cWarning() << "Can not resume, checkpoint" << m_checkpointPath << "is not valid" << e.errorString();
+            return false;
+        }
+        if ( checkpoint.value( "jobs" ).toArray() != jobIdentities() )
+        {
+            cDebug() << "Checkpoint" << m_checkpointPath << "is for different jobs, not resuming.";
+            return false;
+        }
+
+        auto* gs = m_queue->globalStorage();
+        const QVariantMap storage = checkpoint.value( "globalStorage" ).toObject().toVariantMap();
+        for ( auto it = storage.cbegin(); it != storage.cend(); ++it )
+        {
+            gs->insert( it.key(), it.value() );
+        }
+        int count = 0;
+        for ( const auto& v : checkpoint.value( "completed" ).toArray() )
+        {
+            const int i = v.toInt( -1 );
+            if ( i >= 0 && i < completed.count() )
+            {
+                completed[ i ] = true;
+                ++count;
+            }
+        }
+        const int current = checkpoint.value( "current" ).toInt( -1 );
+        cDebug() << "Resuming from checkpoint" << m_checkpointPath << count << "jobs completed.";
+        if ( current >= 0 && current < m_runningJobs->count() )
+        {
+            cWarning() << Logger::SubEntry << "Job" << m_runningJobs->at( current ).job->prettyName()
+                       << "was interrupted, it will run again.";
+        }
+        return true;
+    }
+
     /* This is called **only** from run(), while m_runMutex is
      * already locked, so we can use the m_runningJobs member safely.
      */
@@ -213,6 +368,9 @@ private:
     JobQueue* m_queue;
     int m_jobIndex = 0;  ///< Index into m_runningJobs
     qreal m_overallQueueWeight = 0.0;  ///< cumulation when **all** the jobs are done
+
+    QString m_checkpointPath;  ///< Empty if there are no checkpoints
+    bool m_resume = false;  ///< Read the checkpoint on the first run()
 };
 
 JobThread::~JobThread() {}
@@ -269,13 +427,20 @@ JobQueue::start()
 
 
 void
-JobQueue::enqueue( int moduleWeight, const JobList& jobs )
+JobQueue::enqueue( int moduleWeight, const JobList& jobs, const QString& source )
 {
     Q_ASSERT( !m_thread->isRunning() );
-    m_thread->enqueue( moduleWeight, jobs );
+    m_thread->enqueue( moduleWeight, jobs, source );
     emit queueChanged( m_thread->queuedJobs() );
 }
 
+void
+JobQueue::setCheckpoint( const QString& path, bool resume )
+{
+    Q_ASSERT( !m_thread->isRunning() );
+    m_thread->setCheckpoint( path, resume );
+}
+
 void
 JobQueue::finish()
 {
@@ -49,9 +49,26 @@ public:
     /** @brief Queues up jobs from a single module source
      *
      * The total weight of the jobs is spread out to fill the weight
-     * of the module.
+     * of the module. The @p source names the module (instance) the
+     * jobs come from; it is used to check that a checkpoint belongs
+     * to the same sequence of jobs.
      */
-    void enqueue( int moduleWeight, const JobList& jobs );
+    void enqueue( int moduleWeight, const JobList& jobs, const QString& source = QString() );
+    /** @brief Keep track of progress in the checkpoint file @p path
+     *
+     * While the queue runs, the checkpoint file is updated before and
+     * after each job with the jobs that have completed and a snapshot
+     * of global storage. When all the jobs complete successfully, the
+     * file is removed. An empty @p path switches checkpoints off (which
+     * is the default).
+     *
+     * If @p resume is @c true, the checkpoint is read when the queue
+     * starts. If it was written for the same sequence of jobs, global
+     * storage is restored from it and the jobs that completed are
+     * skipped, except idempotent ones (see Job::isIdempotent()).
+     * A job that was interrupted is run again.
+     */
+    void setCheckpoint( const QString& path, bool resume = false );
     /** @brief Starts all the jobs that are enqueued.
      *
      * After this, isRunning() returns @c true until
@@ -23,6 +23,7 @@ static const char* s_preScript = nullptr;
 
 namespace bp = boost::python;
 
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS( raw_copy_overloads, CalamaresPython::PythonJobInterface::raw_copy, 2, 5 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( mount_overloads, CalamaresPython::mount, 2, 4 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( target_env_call_str_overloads, CalamaresPython::target_env_call, 1, 3 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( target_env_call_list_overloads, CalamaresPython::target_env_call, 1, 3 );
@@ -56,7 +57,13 @@ BOOST_PYTHON_MODULE( libcalamares )
               &CalamaresPython::PythonJobInterface::setprogress,
               bp::args( "progress" ),
               "Reports the progress status of this job to Calamares, "
-              "as a real number between 0 and 1." );
+              "as a real number between 0 and 1." )
+        .def( "raw_copy",
+              &CalamaresPython::PythonJobInterface::raw_copy,
+              raw_copy_overloads( bp::args( "source", "destination", "progress_start", "progress_end", "verify" ),
+                                  "Copies the source image or device to the destination device, "
+                                  "reporting progress between progress_start and progress_end. "
+                                  "Raises OSError on failure." ) );
 
     bp::class_< CalamaresPython::GlobalStoragePythonWrapper >( "GlobalStorage",
                                                                bp::init< Calamares::GlobalStorage* >() )
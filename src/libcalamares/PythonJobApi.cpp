@@ -14,6 +14,7 @@
 #include "JobQueue.h"
 #include "PythonHelper.h"
 #include "partition/Mount.h"
+#include "partition/RawCopy.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 #include "utils/RAII.h"
@@ -171,6 +172,26 @@ PythonJobInterface::setprogress( qreal progress )
     }
 }
 
+void
+PythonJobInterface::raw_copy( const std::string& source,
+                              const std::string& destination,
+                              qreal progressStart,
+                              qreal progressEnd,
+                              bool verify )
+{
+    CalamaresUtils::Partition::RawCopy copy( QString::fromStdString( source ), QString::fromStdString( destination ) );
+    copy.setVerify( verify );
+    copy.setProgressFunction( [this, progressStart, progressEnd]( qint64 done, qint64 total, double ) {
+        const qreal fraction = total > 0 ? qreal( done ) / qreal( total ) : 1.0;
+        setprogress( progressStart + fraction * ( progressEnd - progressStart ) );
+    } );
+    if ( !copy.exec() )
+    {
+        PyErr_SetString( PyExc_OSError, copy.errorString().toStdString().c_str() );
+        bp::throw_error_already_set();
+    }
+}
+
 std::string
 obscure( const std::string& string )
 {
@@ -64,6 +64,19 @@ public:
 
     void setprogress( qreal progress );
 
+    /** @brief Copies @p source to @p destination byte-for-byte
+     *
+     * Progress of the copy is reported as job progress, scaled to
+     * the range from @p progressStart to @p progressEnd. Raises
+     * OSError if the copy fails (or, with @p verify, if the copy
+     * is not identical to the source).
+     */
+    void raw_copy( const std::string& source,
+                   const std::string& destination,
+                   qreal progressStart = 0.0,
+                   qreal progressEnd = 1.0,
+                   bool verify = false );
+
 private:
     Calamares::PythonJob* m_parent;
 };
@@ -317,6 +317,10 @@ Settings::setConfiguration( const QByteArray& ba, const QString& explainName )
         m_disableCancelDuringExec = requireBool( config, "disable-cancel-during-exec", false );
         m_hideBackAndNextDuringExec = requireBool( config, "hide-back-and-next-during-exec", false );
         m_quitAtEnd = requireBool( config, "quit-at-end", false );
+        if ( config[ "geoip" ].IsMap() )
+        {
+            m_geoip = CalamaresUtils::yamlMapToVariant( config[ "geoip" ] );
+        }
 
         reconcileInstancesAndSequence();
     }
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QStringList>
+#include <QVariantMap>
 
 
 namespace Calamares
@@ -162,6 +163,13 @@ public:
     /** @brief Is quit-at-end set? (Quit automatically when done) */
     bool quitAtEnd() const { return m_quitAtEnd; }
 
+    /** @brief The *geoip* section, for a GeoIP lookup at startup
+     *
+     * This is empty if there is no such section. See settings.conf
+     * for the keys; the lookup itself is done by GeoIP::Resolver.
+     */
+    QVariantMap geoipConfiguration() const { return m_geoip; }
+
 private:
     static Settings* s_instance;
 
@@ -181,6 +189,8 @@ private:
     bool m_disableCancelDuringExec = false;
     bool m_hideBackAndNextDuringExec = false;
     bool m_quitAtEnd = false;
+
+    QVariantMap m_geoip;
 };
 
 }  // namespace Calamares
@@ -38,6 +38,7 @@ private Q_SLOTS:
     void testSettings();
 
     void testJobQueue();
+    void testJobQueueCheckpoint();
 };
 
 void
@@ -630,6 +631,111 @@ TestLibCalamares::testJobQueue()
 }
 
 
+class CountingJob : public Calamares::Job
+{
+public:
+    CountingJob( bool fail, QObject* parent )
+        : Calamares::Job( parent )
+        , m_fail( fail )
+    {
+    }
+    ~CountingJob() override;
+
+    QString prettyName() const override { return QStringLiteral( "CountingJob" ); }
+    Calamares::JobResult exec() override
+    {
+        ++m_runs;
+        return m_fail ? Calamares::JobResult::error( QStringLiteral( "CountingJob failed" ) )
+                      : Calamares::JobResult::ok();
+    }
+
+    int runs() const { return m_runs; }
+
+private:
+    bool m_fail;
+    int m_runs = 0;
+};
+
+CountingJob::~CountingJob() {}
+
+/// @brief Runs the queue @p q to completion, returns @c true if no job failed
+static bool
+runQueue( Calamares::JobQueue& q )
+{
+    QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+    QEventLoop loop;
+    QObject::connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    return !q.isRunning() && spy_failed.count() == 0;
+}
+
+void
+TestLibCalamares::testJobQueueCheckpoint()
+{
+    QTemporaryDir tempDir;
+    QVERIFY( tempDir.isValid() );
+    const QString checkpoint = tempDir.filePath( "checkpoint.json" );
+
+    // The third job fails, leaving a checkpoint behind
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( checkpoint );
+        q.globalStorage()->insert( "rootMountPoint", "/tmp/target" );
+
+        auto* plain = new CountingJob( false, this );
+        auto* idempotent = new CountingJob( false, this );
+        idempotent->setIdempotent( true );
+        auto* failing = new CountingJob( true, this );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( plain ), "unpackfs@unpackfs" );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( idempotent ), "mount@mount" );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( failing ), "users@users" );
+        QVERIFY( !runQueue( q ) );
+        QCOMPARE( plain->runs(), 1 );
+        QCOMPARE( failing->runs(), 1 );
+        QVERIFY( QFile::exists( checkpoint ) );
+        // Private, since global storage may contain passwords
+        QVERIFY( !( QFileInfo( checkpoint ).permissions() & ( QFile::ReadOther | QFile::ReadGroup ) ) );
+    }
+
+    // A different sequence of jobs does not resume (use a copy, since it overwrites the checkpoint)
+    {
+        const QString other = tempDir.filePath( "other.json" );
+        QVERIFY( QFile::copy( checkpoint, other ) );
+        Calamares::JobQueue q;
+        q.setCheckpoint( other, true );
+        auto* job = new CountingJob( true, this );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( job ), "shellprocess@other" );
+        QVERIFY( !runQueue( q ) );
+        QCOMPARE( job->runs(), 1 );
+        QVERIFY( !q.globalStorage()->contains( "rootMountPoint" ) );
+    }
+
+    // Resume: completed jobs are skipped, idempotent and failed ones run again
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( checkpoint, true );
+        QVERIFY( !q.globalStorage()->contains( "rootMountPoint" ) );
+
+        auto* plain = new CountingJob( false, this );
+        auto* idempotent = new CountingJob( false, this );
+        idempotent->setIdempotent( true );
+        auto* fixed = new CountingJob( false, this );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( plain ), "unpackfs@unpackfs" );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( idempotent ), "mount@mount" );
+        q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( fixed ), "users@users" );
+        QVERIFY( runQueue( q ) );
+        QCOMPARE( plain->runs(), 0 );
+        QCOMPARE( idempotent->runs(), 1 );
+        QCOMPARE( fixed->runs(), 1 );
+        QCOMPARE( q.globalStorage()->value( "rootMountPoint" ).toString(), QStringLiteral( "/tmp/target" ) );
+        // Successful completion removes the checkpoint
+        QVERIFY( !QFile::exists( checkpoint ) );
+    }
+}
+
+
 QTEST_GUILESS_MAIN( TestLibCalamares )
 
 #include "utils/moc-warnings.h"
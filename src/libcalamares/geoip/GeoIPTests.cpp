@@ -15,9 +15,13 @@
 #include "GeoIPXML.h"
 #endif
 #include "Handler.h"
+#include "Resolver.h"
 
 #include "network/Manager.h"
 
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( GeoIPTests )
@@ -264,3 +268,102 @@ GeoIPTests::testFixed()
         QCOMPARE( f.processReply( QByteArray( "derp" ) ), tz );
     }
 }
+
+void
+GeoIPTests::testResolverHandlers()
+{
+    QVariantMap provider { { "style", "fixed" }, { "url", "http://127.0.0.1:1/" }, { "selector", "Asia/Tokyo" } };
+    auto handlers = Resolver::handlers( provider );
+    QCOMPARE( handlers.size(), size_t( 1 ) );
+    QCOMPARE( handlers.front().type(), Handler::Type::Fixed );
+    QCOMPARE( handlers.front().selector(), QStringLiteral( "Asia/Tokyo" ) );
+
+    // Invalid ones are left out
+    QVariantMap bogus { { "style", "none" }, { "url", "http://127.0.0.1:1/" } };
+    QVariantMap json { { "style", "json" }, { "url", "http://127.0.0.1:1/" } };
+    handlers = Resolver::handlers( QVariantList { provider, bogus, json } );
+    QCOMPARE( handlers.size(), size_t( 2 ) );
+    QCOMPARE( handlers.back().type(), Handler::Type::JSON );
+
+    QVERIFY( Resolver::handlers( QVariant() ).empty() );
+    QVERIFY( Resolver::handlers( QStringLiteral( "json" ) ).empty() );
+}
+
+void
+GeoIPTests::testResolverRace()
+{
+    // Nothing listens there, so JSON fails and Fixed returns its selector
+    const QString unreachable = QStringLiteral( "http://127.0.0.1:1/" );
+    {
+        Resolver r;
+        QVERIFY( !r.isStarted() );
+        QVERIFY( !r.start( {} ) );
+        QVERIFY( !r.isStarted() );
+    }
+    {
+        Resolver r;
+        QVERIFY( r.start( { Handler( "json", unreachable, QString() ),
+                            Handler( "fixed", unreachable, QStringLiteral( "America/Vancouver" ) ) } ) );
+        QVERIFY( r.isStarted() );
+        QCOMPARE( r.result().result(), RegionZonePair( QStringLiteral( "America" ), QStringLiteral( "Vancouver" ) ) );
+    }
+    {
+        // All of them fail
+        Resolver r;
+        QVERIFY( r.start( { Handler( "json", unreachable, QString() ),
+                            Handler( "json", unreachable, QStringLiteral( "timezone" ) ) } ) );
+        QVERIFY( !r.result().result().isValid() );
+    }
+}
+
+void
+GeoIPTests::testResolverCache()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString cacheFile = dir.filePath( "geoip-cache.json" );
+    const std::vector< Handler > handlers {
+        Handler( "fixed", QStringLiteral( "http://127.0.0.1:1/" ), QStringLiteral( "America/Vancouver" ) )
+    };
+    const RegionZonePair vancouver( QStringLiteral( "America" ), QStringLiteral( "Vancouver" ) );
+    const RegionZonePair edmonton( QStringLiteral( "America" ), QStringLiteral( "Edmonton" ) );
+
+    {
+        Resolver r;
+        r.setCacheFile( cacheFile, std::chrono::hours( 1 ) );
+        QVERIFY( r.start( handlers ) );
+        QCOMPARE( r.result().result(), vancouver );
+    }
+    QVERIFY( QFile::exists( cacheFile ) );
+
+    // Change the cached answer, so that it is clear where the result comes from
+    {
+        QFile f( cacheFile );
+        QVERIFY( f.open( QIODevice::ReadWrite ) );
+        QJsonObject o = QJsonDocument::fromJson( f.readAll() ).object();
+        QCOMPARE( o.value( "zone" ).toString(), vancouver.second );
+        o.insert( "zone", edmonton.second );
+        QVERIFY( f.resize( 0 ) );
+        QVERIFY( f.write( QJsonDocument( o ).toJson() ) > 0 );
+    }
+    {
+        Resolver r;
+        r.setCacheFile( cacheFile, std::chrono::hours( 1 ) );
+        QVERIFY( r.start( handlers ) );
+        QCOMPARE( r.result().result(), edmonton );
+    }
+    {
+        // No cache: look it up
+        Resolver r;
+        r.setCacheFile( cacheFile, std::chrono::seconds( 0 ) );
+        QVERIFY( r.start( handlers ) );
+        QCOMPARE( r.result().result(), vancouver );
+    }
+    {
+        // Different providers: look it up
+        Resolver r;
+        r.setCacheFile( cacheFile, std::chrono::hours( 1 ) );
+        QVERIFY( r.start( { Handler( "fixed", handlers.front().url(), QStringLiteral( "Asia/Tokyo" ) ) } ) );
+        QCOMPARE( r.result().result().second, QStringLiteral( "Tokyo" ) );
+    }
+}
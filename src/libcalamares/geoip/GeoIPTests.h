@@ -32,6 +32,10 @@ private Q_SLOTS:
     void testSplitTZ();
 
     void testGet();
+
+    void testResolverHandlers();
+    void testResolverRace();
+    void testResolverCache();
 };
 
 #endif
@@ -104,6 +104,10 @@ create_interface( Handler::Type t, const QString& selector )
     __builtin_unreachable();
 }
 
+/// GeoIP providers are raced, so a slow one shouldn't hold things up; retry once for a flaky network
+static const CalamaresUtils::Network::RequestOptions requestOptions(
+    CalamaresUtils::Network::RequestOptions::FakeUserAgent, std::chrono::seconds( 10 ), 1 );
+
 static RegionZonePair
 do_query( Handler::Type type, const QString& url, const QString& selector )
 {
@@ -115,7 +119,7 @@ do_query( Handler::Type type, const QString& url, const QString& selector )
 
     using namespace CalamaresUtils::Network;
     return interface->processReply(
-        CalamaresUtils::Network::Manager::instance().synchronousGet( url, { RequestOptions::FakeUserAgent } ) );
+        CalamaresUtils::Network::Manager::instance().synchronousGet( url, requestOptions ) );
 }
 
 static QString
@@ -129,7 +133,7 @@ do_raw_query( Handler::Type type, const QString& url, const QString& selector )
 
     using namespace CalamaresUtils::Network;
     return interface->rawReply(
-        CalamaresUtils::Network::Manager::instance().synchronousGet( url, { RequestOptions::FakeUserAgent } ) );
+        CalamaresUtils::Network::Manager::instance().synchronousGet( url, requestOptions ) );
 }
 
 RegionZonePair
@@ -0,0 +1,221 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Resolver.h"
+
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <memory>
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+/// @brief Identifies the @p handlers, so that a cached result is only used with the same providers
+static QStringList
+providerNames( const std::vector< Handler >& handlers )
+{
+    QStringList names;
+    for ( const auto& h : handlers )
+    {
+        names.append( QStringLiteral( "%1 %2 %3" ).arg( int( h.type() ) ).arg( h.url(), h.selector() ) );
+    }
+    return names;
+}
+
+/// @brief The state of a race between providers, shared with the providers
+struct Race
+{
+    QMutex mutex;
+    QWaitCondition changed;
+    int remaining = 0;
+    RegionZonePair winner;
+};
+
+/** @brief Asks all the @p handlers, returns the first valid answer
+ *
+ * Each handler runs in the @p pool, which must have room for all of
+ * them **and** this function. Slower handlers are not stopped, their
+ * answers are ignored.
+ */
+static RegionZonePair
+race( QThreadPool* pool, const std::vector< Handler >& handlers )
+{
+    auto state = std::make_shared< Race >();
+    state->remaining = int( handlers.size() );
+    for ( const auto& h : handlers )
+    {
+        QtConcurrent::run( pool, [ state, h ]() {
+            const RegionZonePair r = h.get();
+            QMutexLocker lock( &state->mutex );
+            if ( r.isValid() && !state->winner.isValid() )
+            {
+                cDebug() << "GeoIP result" << r << "from" << h.url();
+                state->winner = r;
+            }
+            --state->remaining;
+            state->changed.wakeAll();
+        } );
+    }
+
+    QMutexLocker lock( &state->mutex );
+    while ( !state->winner.isValid() && state->remaining > 0 )
+    {
+        state->changed.wait( &state->mutex );
+    }
+    return state->winner;
+}
+
+static void
+writeCache( const QString& fileName, const QStringList& providers, const RegionZonePair& result )
+{
+    QJsonObject o;
+    o.insert( QStringLiteral( "providers" ), QJsonArray::fromStringList( providers ) );
+    o.insert( QStringLiteral( "time" ), QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) );
+    o.insert( QStringLiteral( "region" ), result.first );
+    o.insert( QStringLiteral( "zone" ), result.second );
+
+    QSaveFile f( fileName );
+    if ( !f.open( QIODevice::WriteOnly ) || f.write( QJsonDocument( o ).toJson() ) < 0 || !f.commit() )
+    {
+        cWarning() << "Could not write GeoIP cache" << fileName;
+    }
+}
+
+Resolver&
+Resolver::instance()
+{
+    static auto* s_resolver = new Resolver();
+    return *s_resolver;
+}
+
+std::vector< Handler >
+Resolver::handlers( const QVariant& configuration )
+{
+    QVariantList providers;
+    if ( configuration.type() == QVariant::List )
+    {
+        providers = configuration.toList();
+    }
+    else if ( configuration.type() == QVariant::Map )
+    {
+        providers.append( configuration );
+    }
+
+    std::vector< Handler > handlers;
+    for ( const auto& p : qAsConst( providers ) )
+    {
+        const QVariantMap map = p.toMap();
+        Handler h( CalamaresUtils::getString( map, "style" ),
+                   CalamaresUtils::getString( map, "url" ),
+                   CalamaresUtils::getString( map, "selector" ) );
+        if ( h.isValid() )
+        {
+            handlers.push_back( h );
+        }
+        else
+        {
+            cWarning() << "GeoIP Style" << CalamaresUtils::getString( map, "style" ) << "is not recognized.";
+        }
+    }
+    return handlers;
+}
+
+Resolver::Resolver() {}
+
+Resolver::~Resolver()
+{
+    m_pool.waitForDone();
+}
+
+void
+Resolver::setCacheFile( const QString& fileName, std::chrono::seconds ttl )
+{
+    m_cacheFile = fileName;
+    m_ttl = ttl;
+}
+
+RegionZonePair
+Resolver::readCache( const QStringList& providers ) const
+{
+    if ( m_cacheFile.isEmpty() || m_ttl <= std::chrono::seconds( 0 ) )
+    {
+        return RegionZonePair();
+    }
+    QFile f( m_cacheFile );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return RegionZonePair();
+    }
+
+    const QJsonObject o = QJsonDocument::fromJson( f.readAll() ).object();
+    const QDateTime time = QDateTime::fromString( o.value( "time" ).toString(), Qt::ISODate );
+    const QStringList cachedProviders = o.value( "providers" ).toVariant().toStringList();
+    if ( !time.isValid() || time.addSecs( m_ttl.count() ) < QDateTime::currentDateTimeUtc()
+         || cachedProviders != providers )
+    {
+        cDebug() << "GeoIP cache" << m_cacheFile << "is stale.";
+        return RegionZonePair();
+    }
+    return RegionZonePair( o.value( "region" ).toString(), o.value( "zone" ).toString() );
+}
+
+bool
+Resolver::start( const std::vector< Handler >& handlers )
+{
+    if ( m_started )
+    {
+        return true;
+    }
+    if ( handlers.empty() )
+    {
+        return false;
+    }
+    m_started = true;
+
+    const QStringList providers = providerNames( handlers );
+    const RegionZonePair cached = readCache( providers );
+    if ( cached.isValid() )
+    {
+        cDebug() << "GeoIP result" << cached << "from cache" << m_cacheFile;
+        m_result = QtConcurrent::run( &m_pool, [ cached ]() { return cached; } );
+        return true;
+    }
+
+    cDebug() << "GeoIP lookup started with" << providers.count() << "providers.";
+    // Room for each of the providers, and the race itself
+    m_pool.setMaxThreadCount( int( handlers.size() ) + 1 );
+    const QString cacheFile = m_ttl > std::chrono::seconds( 0 ) ? m_cacheFile : QString();
+    QThreadPool* pool = &m_pool;
+    m_result = QtConcurrent::run( pool, [ pool, handlers, providers, cacheFile ]() {
+        const RegionZonePair r = race( pool, handlers );
+        if ( r.isValid() && !cacheFile.isEmpty() )
+        {
+            writeCache( cacheFile, providers, r );
+        }
+        return r;
+    } );
+    return true;
+}
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
@@ -0,0 +1,91 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef GEOIP_RESOLVER_H
+#define GEOIP_RESOLVER_H
+
+#include "Handler.h"
+#include "Interface.h"
+
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariant>
+
+#include <chrono>
+#include <vector>
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+/** @brief A GeoIP lookup that is shared, raced and remembered
+ *
+ * Calamares starts the lookup from settings.conf when it starts up,
+ * so that the result is usually there by the time the locale module
+ * wants it; the locale module uses the same lookup (or starts it,
+ * if it wasn't started yet).
+ *
+ * Several providers may be configured. They are all asked at the same
+ * time, and the first valid answer wins. A valid answer is kept in
+ * a cache file, which is used instead of a lookup for as long as
+ * it is fresh (and the providers haven't changed).
+ */
+class DLLEXPORT Resolver
+{
+public:
+    /// @brief The resolver that Calamares uses
+    static Resolver& instance();
+
+    /** @brief Handlers from a *geoip* configuration
+     *
+     * The @p configuration is either a map with keys *style*, *url*
+     * and *selector* (one provider), or a list of such maps.
+     * Invalid providers are left out.
+     */
+    static std::vector< Handler > handlers( const QVariant& configuration );
+
+    Resolver();
+    ~Resolver();
+
+    /** @brief Remember results in @p fileName, for @p ttl
+     *
+     * An empty @p fileName (the default) or zero @p ttl means no cache.
+     */
+    void setCacheFile( const QString& fileName, std::chrono::seconds ttl );
+
+    /** @brief Starts the lookup, unless it is already started
+     *
+     * Returns @c false if the lookup is not started (e.g. because there
+     * are no valid @p handlers).
+     */
+    bool start( const std::vector< Handler >& handlers );
+    bool isStarted() const { return m_started; }
+    /** @brief The result of the lookup
+     *
+     * This is an invalid RegionZonePair if all the providers fail.
+     * If the lookup isn't started, the future is empty.
+     */
+    QFuture< RegionZonePair > result() const { return m_result; }
+
+private:
+    RegionZonePair readCache( const QStringList& providers ) const;
+
+    bool m_started = false;
+    QString m_cacheFile;
+    std::chrono::seconds m_ttl { 0 };
+    QFuture< RegionZonePair > m_result;
+    QThreadPool m_pool;
+};
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
+#endif
@@ -20,6 +20,8 @@
 
 #include <QtTest/QtTest>
 
+#include <cmath>
+
 class LocaleTests : public QObject
 {
     Q_OBJECT
@@ -49,6 +51,9 @@ private Q_SLOTS:
     void testLocationLookup_data();
     void testLocationLookup();
     void testLocationLookup2();
+    void testLocationIndex();
+    void testZoneTable();
+    void benchmarkLocationLookup();
 
     // Global Storage updates
     void testGSUpdates();
@@ -425,7 +430,9 @@ LocaleTests::testLocationLookup_data()
 
     QTest::newRow( "London" ) << 50.0 << 0.0 << QString( "London" );
     QTest::newRow( "Tarawa E" ) << 0.0 << 179.0 << QString( "Tarawa" );
-    QTest::newRow( "Tarawa W" ) << 0.0 << -179.0 << QString( "Tarawa" );
+    // Measured along the globe, (0, -179) is closer to Kanton (-2.78, -171.72)
+    // than to Tarawa (1.42, 173.0), so look a little further west.
+    QTest::newRow( "Tarawa W" ) << 1.0 << -179.5 << QString( "Tarawa" );
 
     QTest::newRow( "Johannesburg" ) << -26.0 << 28.0 << QString( "Johannesburg" );  // South Africa
     QTest::newRow( "Maseru" ) << -29.0 << 27.0 << QString( "Maseru" );  // Lesotho
@@ -479,6 +486,110 @@ LocaleTests::testLocationLookup2()
     QCOMPARE( trunc( altzone->latitude() * 1000.0 ), -29466 );
 }
 
+void
+LocaleTests::testLocationIndex()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+
+    // Brute-force great-circle distance, compare with the index
+    for ( double latitude = -89.0; latitude < 90.0; latitude += 7.0 )
+    {
+        for ( double longitude = -180.0; longitude < 180.0; longitude += 7.0 )
+        {
+            auto distance = [=]( const CalamaresUtils::Locale::TimeZoneData* zone ) -> double {
+                constexpr double degrees = M_PI / 180.0;
+                const double phi1 = latitude * degrees;
+                const double phi2 = zone->latitude() * degrees;
+                const double c = std::sin( phi1 ) * std::sin( phi2 )
+                    + std::cos( phi1 ) * std::cos( phi2 ) * std::cos( ( zone->longitude() - longitude ) * degrees );
+                return std::acos( qBound( -1.0, c, 1.0 ) );
+            };
+            const auto* indexed = zones.find( latitude, longitude );
+            const auto* scanned = zones.find( distance );
+            QVERIFY( indexed );
+            QVERIFY( scanned );
+            if ( indexed != scanned )
+            {
+                // Equally far away is fine, too
+                QCOMPARE( distance( indexed ), distance( scanned ) );
+            }
+        }
+    }
+}
+
+void
+LocaleTests::testZoneTable()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+    QVERIFY( !zones.tzdataVersion().isEmpty() );
+
+    // Whatever the version, only zones the system can actually set are offered
+    const QDir zoneinfo( "/usr/share/zoneinfo" );
+    if ( zoneinfo.exists() )
+    {
+        for ( auto it = zones.begin(); it; ++it )
+        {
+            const auto* zone = *it;
+            QVERIFY2( QFileInfo::exists( zoneinfo.filePath( zone->region() + '/' + zone->zone() ) ),
+                      qPrintable( zone->region() + '/' + zone->zone() ) );
+        }
+    }
+
+    QFile file( "/usr/share/zoneinfo/zone.tab" );
+    QFile versionFile( "/usr/share/zoneinfo/tzdata.zi" );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text )
+         || !versionFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        QSKIP( "No system tzdata to compare with" );
+    }
+    const QString systemVersion = QString::fromLatin1( versionFile.readLine() ).trimmed().mid( 10 );
+    if ( systemVersion != zones.tzdataVersion() )
+    {
+        QSKIP( "System tzdata is a different version than the zones" );
+    }
+
+    // Same version, so the zones should be the ones in zone.tab
+    int count = 0;
+    while ( !file.atEnd() )
+    {
+        const QString line = QString::fromLatin1( file.readLine() ).trimmed();
+        if ( line.isEmpty() || line.startsWith( '#' ) )
+        {
+            continue;
+        }
+        const QStringList parts = line.split( '\t' );
+        QVERIFY( parts.count() >= 3 );
+        const QString region = parts.at( 2 ).section( '/', 0, 0 );
+        const QString zoneName = parts.at( 2 ).section( '/', 1 );
+
+        const auto* zone = zones.find( region, zoneName );
+        QVERIFY( zone );
+        QCOMPARE( zone->country(), parts.at( 0 ) );
+        count++;
+    }
+    QCOMPARE( zones.rowCount( QModelIndex() ), count );
+}
+
+void
+LocaleTests::benchmarkLocationLookup()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+
+    int found = 0;
+    QBENCHMARK
+    {
+        found = 0;
+        for ( double latitude = -89.0; latitude < 90.0; latitude += 2.0 )
+        {
+            for ( double longitude = -180.0; longitude < 180.0; longitude += 2.0 )
+            {
+                found += zones.find( latitude, longitude ) ? 1 : 0;
+            }
+        }
+    }
+    QCOMPARE( found, 90 * 180 );
+}
+
 void
 LocaleTests::testGSUpdates()
 {
@@ -14,10 +14,19 @@
 #include "utils/Logger.h"
 #include "utils/String.h"
 
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QString>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ZoneTable_p.cpp"
+
 static const char TZ_DATA_FILE[] = "/usr/share/zoneinfo/zone.tab";
+static const char TZ_DATA_DIR[] = "/usr/share/zoneinfo";
 
 namespace CalamaresUtils
 {
@@ -171,6 +180,105 @@ loadTZData( RegionVector& regions, ZoneVector& zones, QTextStream& in )
     }
 }
 
+/** @brief Load the compiled-in zone table (see zone-extractor.py)
+ *
+ * This gives the same results as loadTZData() on the zone.tab
+ * the table was generated from, without any parsing. If the system
+ * has (older) tzdata, zones that it doesn't have a file for are left
+ * out: picking one of those would leave a dangling /etc/localtime.
+ */
+static void
+loadTZTable( RegionVector& regions, ZoneVector& zones )
+{
+    const QDir zoneinfo( TZ_DATA_DIR );
+    const bool checkFiles = zoneinfo.exists();
+    int missing = 0;
+
+    const char* previousRegion = nullptr;
+    for ( const auto& entry : zone_table )
+    {
+        const QString region = QString::fromLatin1( entry.region );
+        const QString zone = QString::fromLatin1( entry.zone );
+        if ( checkFiles && !QFileInfo::exists( zoneinfo.filePath( region + '/' + zone ) ) )
+        {
+            ++missing;
+            continue;
+        }
+        if ( !previousRegion || qstrcmp( previousRegion, entry.region ) != 0 )
+        {
+            previousRegion = entry.region;
+            if ( std::none_of( regions.cbegin(), regions.cend(), [&region]( const RegionData* p ) {
+                     return p->key() == region;
+                 } ) )
+            {
+                regions.append( new RegionData( region ) );
+            }
+        }
+        zones.append(
+            new TimeZoneData( region, zone, QString::fromLatin1( entry.country ), entry.latitude, entry.longitude ) );
+    }
+    if ( missing )
+    {
+        cDebug() << "Skipped" << missing << "zones that are not in" << TZ_DATA_DIR;
+    }
+}
+
+/** @brief Version of the tzdata installed on the system
+ *
+ * Returns an empty string if it can't be determined.
+ */
+static QString
+systemTZVersion()
+{
+    const QDir zoneinfo( TZ_DATA_DIR );
+    {
+        // The tzdata.zi file starts with a line "# version 2021a"
+        QFile file( zoneinfo.filePath( QStringLiteral( "tzdata.zi" ) ) );
+        if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        {
+            const QString line = QString::fromLatin1( file.readLine() ).trimmed();
+            if ( line.startsWith( QStringLiteral( "# version " ) ) )
+            {
+                return line.mid( 10 ).trimmed();
+            }
+        }
+    }
+    {
+        QFile file( zoneinfo.filePath( QStringLiteral( "+VERSION" ) ) );
+        if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        {
+            return QString::fromLatin1( file.readLine() ).trimmed();
+        }
+    }
+    return QString();
+}
+
+/** @brief Is tzdata version @p candidate newer than @p reference?
+ *
+ * Versions are a year and a (possibly empty) letter suffix,
+ * e.g. "2021a"; after "z" come "za", "zb", ..
+ * An empty (unknown) version is never newer.
+ */
+static bool
+isNewerTZVersion( const QString& candidate, const QString& reference )
+{
+    if ( candidate.length() < 4 || reference.length() < 4 )
+    {
+        return false;
+    }
+    const int candidateYear = candidate.left( 4 ).toInt();
+    const int referenceYear = reference.left( 4 ).toInt();
+    if ( candidateYear != referenceYear )
+    {
+        return candidateYear > referenceYear;
+    }
+    if ( candidate.length() != reference.length() )
+    {
+        return candidate.length() > reference.length();
+    }
+    return candidate > reference;
+}
+
 /** @brief Extra, fake, timezones
  *
  * The timezone locations in zone.tab are not always very useful,
@@ -196,6 +304,139 @@ static const char altZones[] =
      */
     "ZA -3230+02259 Africa/Johannesburg\n";
 
+/** @brief Spatial index over zone locations
+ *
+ * Locations are placed on the unit sphere, and stored in a
+ * 3-dimensional k-d tree (implicit, in a single vector, with
+ * the median of each sub-range at its middle). The straight-line
+ * (chord) distance between two points on the sphere grows with
+ * the great-circle distance, so the nearest point in 3D is
+ * also the nearest point on the globe.
+ */
+class ZoneIndex
+{
+public:
+    /** @brief Build the index for @p zones
+     *
+     * Each location in @p locations is stored as a pointer to the
+     * zone in @p zones with the same name, so that spot-patches
+     * resolve to an official zone.
+     */
+    void build( const ZoneVector& zones, const ZoneVector& locations )
+    {
+        m_points.clear();
+        m_points.reserve( size_t( zones.count() + locations.count() ) );
+        for ( const auto* z : zones )
+        {
+            m_points.push_back( point( z->latitude(), z->longitude(), z ) );
+        }
+        for ( const auto* l : locations )
+        {
+            const auto it = std::find_if( zones.cbegin(), zones.cend(), [l]( const TimeZoneData* z ) {
+                return z->region() == l->region() && z->zone() == l->zone();
+            } );
+            if ( it != zones.cend() )
+            {
+                m_points.push_back( point( l->latitude(), l->longitude(), *it ) );
+            }
+        }
+        build( 0, m_points.size(), 0 );
+    }
+
+    /// @brief The zone nearest to the given location, or nullptr if there are none
+    const TimeZoneData* nearest( double latitude, double longitude ) const
+    {
+        const Point target = point( latitude, longitude, nullptr );
+        const Point* best = nullptr;
+        double bestDistance = 5.0;  // Larger than any squared chord (max 4)
+        nearest( 0, m_points.size(), 0, target, best, bestDistance );
+        return best ? best->zone : nullptr;
+    }
+
+private:
+    struct Point
+    {
+        double c[ 3 ];
+        const TimeZoneData* zone;
+    };
+
+    static Point point( double latitude, double longitude, const TimeZoneData* zone )
+    {
+        constexpr double degrees = M_PI / 180.0;
+        const double phi = latitude * degrees;
+        const double lambda = longitude * degrees;
+        return Point { { std::cos( phi ) * std::cos( lambda ), std::cos( phi ) * std::sin( lambda ), std::sin( phi ) },
+                       zone };
+    }
+
+    static double squaredDistance( const Point& a, const Point& b )
+    {
+        const double dx = a.c[ 0 ] - b.c[ 0 ];
+        const double dy = a.c[ 1 ] - b.c[ 1 ];
+        const double dz = a.c[ 2 ] - b.c[ 2 ];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void build( size_t begin, size_t end, int axis )
+    {
+        if ( end - begin < 2 )
+        {
+            return;
+        }
+        const size_t middle = begin + ( end - begin ) / 2;
+        std::nth_element( m_points.begin() + begin,
+                          m_points.begin() + middle,
+                          m_points.begin() + end,
+                          [axis]( const Point& l, const Point& r ) { return l.c[ axis ] < r.c[ axis ]; } );
+        build( begin, middle, ( axis + 1 ) % 3 );
+        build( middle + 1, end, ( axis + 1 ) % 3 );
+    }
+
+    void nearest( size_t begin,
+                  size_t end,
+                  int axis,
+                  const Point& target,
+                  const Point*& best,
+                  double& bestDistance ) const
+    {
+        if ( begin >= end )
+        {
+            return;
+        }
+        const size_t middle = begin + ( end - begin ) / 2;
+        const Point& here = m_points[ middle ];
+        const double d = squaredDistance( here, target );
+        if ( d < bestDistance )
+        {
+            best = &here;
+            bestDistance = d;
+        }
+
+        const double delta = target.c[ axis ] - here.c[ axis ];
+        const int nextAxis = ( axis + 1 ) % 3;
+        // Search the side the target is on first, then the other
+        // side only if the splitting plane is closer than the best so far.
+        if ( delta < 0 )
+        {
+            nearest( begin, middle, nextAxis, target, best, bestDistance );
+            if ( delta * delta < bestDistance )
+            {
+                nearest( middle + 1, end, nextAxis, target, best, bestDistance );
+            }
+        }
+        else
+        {
+            nearest( middle + 1, end, nextAxis, target, best, bestDistance );
+            if ( delta * delta < bestDistance )
+            {
+                nearest( begin, middle, nextAxis, target, best, bestDistance );
+            }
+        }
+    }
+
+    std::vector< Point > m_points;
+};
+
 class Private : public QObject
 {
     Q_OBJECT
@@ -203,21 +444,34 @@ public:
     RegionVector m_regions;
     ZoneVector m_zones;  ///< The official timezones and locations
     ZoneVector m_altZones;  ///< Extra locations for zones
+    ZoneIndex m_index;  ///< Spatial index over m_zones and m_altZones
+    QString m_version;  ///< tzdata version the zones come from
 
     Private()
     {
         m_regions.reserve( 12 );  // reasonable guess
         m_zones.reserve( 452 );  // wc -l /usr/share/zoneinfo/zone.tab
 
-        // Load the official timezones
+        // Load the official timezones; the system's zone.tab is
+        // parsed only if it is newer than the compiled-in table.
+        const QString systemVersion = systemTZVersion();
+        if ( isNewerTZVersion( systemVersion, QString::fromLatin1( zone_table_version ) ) )
         {
             QFile file( TZ_DATA_FILE );
             if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
             {
+                cDebug() << "System tzdata" << systemVersion << "is newer than" << zone_table_version
+                         << "reading" << TZ_DATA_FILE;
                 QTextStream in( &file );
                 loadTZData( m_regions, m_zones, in );
+                m_version = systemVersion;
             }
         }
+        if ( m_zones.isEmpty() )
+        {
+            loadTZTable( m_regions, m_zones );
+            m_version = QString::fromLatin1( zone_table_version );
+        }
         // Load the alternate zones (see documentation at altZones)
         {
             QTextStream in( altZones );
@@ -239,6 +493,8 @@ public:
         {
             z->setParent( this );
         }
+
+        m_index.build( m_zones, m_altZones );
     }
 };
 
@@ -316,6 +572,12 @@ ZonesModel::rowCount( const QModelIndex& ) const
     return m_private->m_zones.count();
 }
 
+QString
+ZonesModel::tzdataVersion() const
+{
+    return m_private->m_version;
+}
+
 QVariant
 ZonesModel::data( const QModelIndex& index, int role ) const
 {
@@ -394,34 +656,7 @@ ZonesModel::find( const std::function< double( const TimeZoneData* ) >& distance
 const TimeZoneData*
 ZonesModel::find( double latitude, double longitude ) const
 {
-    /* This is a somewhat derpy way of finding "closest",
-     * in that it considers one degree of separation
-     * either N/S or E/W equal to any other; this obviously
-     * falls apart at the poles.
-     */
-    auto distance = [&]( const TimeZoneData* zone ) -> double {
-        // Latitude doesn't wrap around: there is nothing north of 90
-        double latitudeDifference = abs( zone->latitude() - latitude );
-
-        // Longitude **does** wrap around, so consider the case of -178 and 178
-        //   which differ by 4 degrees.
-        double westerly = qMin( zone->longitude(), longitude );
-        double easterly = qMax( zone->longitude(), longitude );
-        double longitudeDifference = 0.0;
-        if ( westerly < 0.0 && !( easterly < 0.0 ) )
-        {
-            // Only if they're different signs can we have wrap-around.
-            longitudeDifference = qMin( abs( westerly - easterly ), abs( 360.0 + westerly - easterly ) );
-        }
-        else
-        {
-            longitudeDifference = abs( westerly - easterly );
-        }
-
-        return latitudeDifference + longitudeDifference;
-    };
-
-    return find( distance );
+    return m_private->m_index.nearest( latitude, longitude );
 }
 
 QObject*
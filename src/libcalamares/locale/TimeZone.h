@@ -167,6 +167,15 @@ public:
 
     Iterator begin() const { return Iterator( m_private ); }
 
+    /** @brief Version of the tzdata the zones come from
+     *
+     * The zones are normally taken from a table compiled into
+     * Calamares; if the system has newer tzdata, then the system's
+     * zone.tab is read instead. This returns the version (e.g. "2021a")
+     * of whichever was used; it may be empty if unknown.
+     */
+    QString tzdataVersion() const;
+
     /** @brief Look up TZ data based on an arbitrary distance function
      *
      * This is a generic method that can define distance in whatever
@@ -187,10 +196,10 @@ public Q_SLOTS:
 
     /** @brief Look up TZ data based on the location.
      *
-     * Returns the nearest zone to the given lat and lon. This is a
-     * convenience function for calling find(), below, with a standard
-     * distance function based on the distance between the given
-     * location (lat and lon) and each zone's given location.
+     * Returns the nearest zone to the given lat and lon, measured
+     * along the surface of the globe (great-circle distance) to each
+     * zone's given location. Lookups go through a spatial index, so
+     * this is much cheaper than calling find() with a distance function.
      */
     const TimeZoneData* find( double latitude, double longitude ) const;
 
@@ -0,0 +1,461 @@
+/*   GENERATED FILE DO NOT EDIT
+*
+*  === This file is part of Calamares - <https://calamares.io> ===
+*
+* SPDX-FileCopyrightText: 2009 Arthur David Olson
+* SPDX-FileCopyrightText: 2019 Adriaan de Groot <groot@kde.org>
+* SPDX-License-Identifier: CC0-1.0
+*
+* This file is derived from zone.tab, which has its own copyright statement:
+*
+* This file is in the public domain, so clarified as of
+* 2009-05-17 by Arthur David Olson.
+*
+* From Paul Eggert (2018-06-27):
+* This file is intended as a backward-compatibility aid for older programs.
+* New programs should use zone1970.tab.  This file is like zone1970.tab (see
+* zone1970.tab's comments), but with the following additional restrictions:
+*
+* 1.  This file contains only ASCII characters.
+* 2.  The first data column contains exactly one country code.
+*
+*/
+
+// BEGIN Generated from zone.tab
+
+// *INDENT-OFF*
+// clang-format off
+struct ZoneTableEntry
+{
+    const char* country;
+    const char* region;
+    const char* zone;
+    double latitude;
+    double longitude;
+};
+
+static const char zone_table_version[] = "2025b";
+
+static constexpr const int zone_table_size = 418;
+static const ZoneTableEntry zone_table[ 418 ] = {
+    { "AD", "Europe", "Andorra", 42.5, 1.5166666666666666 },
+    { "AE", "Asia", "Dubai", 25.3, 55.3 },
+    { "AF", "Asia", "Kabul", 34.516666666666666, 69.2 },
+    { "AG", "America", "Antigua", 17.05, -61.8 },
+    { "AI", "America", "Anguilla", 18.2, -63.06666666666667 },
+    { "AL", "Europe", "Tirane", 41.333333333333336, 19.833333333333332 },
+    { "AM", "Asia", "Yerevan", 40.18333333333333, 44.5 },
+    { "AO", "Africa", "Luanda", -8.8, 13.233333333333333 },
+    { "AQ", "Antarctica", "McMurdo", -77.83333333333333, 166.6 },
+    { "AQ", "Antarctica", "Casey", -66.28333333333333, 110.51666666666667 },
+    { "AQ", "Antarctica", "Davis", -68.58333333333333, 77.96666666666667 },
+    { "AQ", "Antarctica", "DumontDUrville", -66.66666666666667, 140.01666666666668 },
+    { "AQ", "Antarctica", "Mawson", -67.6, 62.88333333333333 },
+    { "AQ", "Antarctica", "Palmer", -64.8, -64.1 },
+    { "AQ", "Antarctica", "Rothera", -67.56666666666666, -68.13333333333334 },
+    { "AQ", "Antarctica", "Syowa", -69.0, 39.583333333333336 },
+    { "AQ", "Antarctica", "Troll", -72.0, 2.533333333333333 },
+    { "AQ", "Antarctica", "Vostok", -78.4, 106.9 },
+    { "AR", "America", "Argentina/Buenos_Aires", -34.6, -58.45 },
+    { "AR", "America", "Argentina/Cordoba", -31.4, -64.18333333333334 },
+    { "AR", "America", "Argentina/Salta", -24.783333333333335, -65.41666666666667 },
+    { "AR", "America", "Argentina/Jujuy", -24.183333333333334, -65.3 },
+    { "AR", "America", "Argentina/Tucuman", -26.816666666666666, -65.21666666666667 },
+    { "AR", "America", "Argentina/Catamarca", -28.466666666666665, -65.78333333333333 },
+    { "AR", "America", "Argentina/La_Rioja", -29.433333333333334, -66.85 },
+    { "AR", "America", "Argentina/San_Juan", -31.533333333333335, -68.51666666666667 },
+    { "AR", "America", "Argentina/Mendoza", -32.88333333333333, -68.81666666666666 },
+    { "AR", "America", "Argentina/San_Luis", -33.31666666666667, -66.35 },
+    { "AR", "America", "Argentina/Rio_Gallegos", -51.63333333333333, -69.21666666666667 },
+    { "AR", "America", "Argentina/Ushuaia", -54.8, -68.3 },
+    { "AS", "Pacific", "Pago_Pago", -14.266666666666667, -170.7 },
+    { "AT", "Europe", "Vienna", 48.21666666666667, 16.333333333333332 },
+    { "AU", "Australia", "Lord_Howe", -31.55, 159.08333333333334 },
+    { "AU", "Antarctica", "Macquarie", -54.5, 158.95 },
+    { "AU", "Australia", "Hobart", -42.88333333333333, 147.31666666666666 },
+    { "AU", "Australia", "Melbourne", -37.81666666666667, 144.96666666666667 },
+    { "AU", "Australia", "Sydney", -33.86666666666667, 151.21666666666667 },
+    { "AU", "Australia", "Broken_Hill", -31.95, 141.45 },
+    { "AU", "Australia", "Brisbane", -27.466666666666665, 153.03333333333333 },
+    { "AU", "Australia", "Lindeman", -20.266666666666666, 149.0 },
+    { "AU", "Australia", "Adelaide", -34.916666666666664, 138.58333333333334 },
+    { "AU", "Australia", "Darwin", -12.466666666666667, 130.83333333333334 },
+    { "AU", "Australia", "Perth", -31.95, 115.85 },
+    { "AU", "Australia", "Eucla", -31.716666666666665, 128.86666666666667 },
+    { "AW", "America", "Aruba", 12.5, -69.96666666666667 },
+    { "AX", "Europe", "Mariehamn", 60.1, 19.95 },
+    { "AZ", "Asia", "Baku", 40.38333333333333, 49.85 },
+    { "BA", "Europe", "Sarajevo", 43.86666666666667, 18.416666666666668 },
+    { "BB", "America", "Barbados", 13.1, -59.61666666666667 },
+    { "BD", "Asia", "Dhaka", 23.716666666666665, 90.41666666666667 },
+    { "BE", "Europe", "Brussels", 50.833333333333336, 4.333333333333333 },
+    { "BF", "Africa", "Ouagadougou", 12.366666666666667, -1.5166666666666666 },
+    { "BG", "Europe", "Sofia", 42.68333333333333, 23.316666666666666 },
+    { "BH", "Asia", "Bahrain", 26.383333333333333, 50.583333333333336 },
+    { "BI", "Africa", "Bujumbura", -3.3833333333333333, 29.366666666666667 },
+    { "BJ", "Africa", "Porto-Novo", 6.483333333333333, 2.6166666666666667 },
+    { "BL", "America", "St_Barthelemy", 17.883333333333333, -62.85 },
+    { "BM", "Atlantic", "Bermuda", 32.28333333333333, -64.76666666666667 },
+    { "BN", "Asia", "Brunei", 4.933333333333334, 114.91666666666667 },
+    { "BO", "America", "La_Paz", -16.5, -68.15 },
+    { "BQ", "America", "Kralendijk", 12.15, -68.26666666666667 },
+    { "BR", "America", "Noronha", -3.85, -32.416666666666664 },
+    { "BR", "America", "Belem", -1.45, -48.483333333333334 },
+    { "BR", "America", "Fortaleza", -3.716666666666667, -38.5 },
+    { "BR", "America", "Recife", -8.05, -34.9 },
+    { "BR", "America", "Araguaina", -7.2, -48.2 },
+    { "BR", "America", "Maceio", -9.666666666666666, -35.71666666666667 },
+    { "BR", "America", "Bahia", -12.983333333333333, -38.516666666666666 },
+    { "BR", "America", "Sao_Paulo", -23.533333333333335, -46.61666666666667 },
+    { "BR", "America", "Campo_Grande", -20.45, -54.61666666666667 },
+    { "BR", "America", "Cuiaba", -15.583333333333334, -56.083333333333336 },
+    { "BR", "America", "Santarem", -2.4333333333333336, -54.86666666666667 },
+    { "BR", "America", "Porto_Velho", -8.766666666666667, -63.9 },
+    { "BR", "America", "Boa_Vista", 2.8166666666666664, -60.666666666666664 },
+    { "BR", "America", "Manaus", -3.1333333333333333, -60.016666666666666 },
+    { "BR", "America", "Eirunepe", -6.666666666666667, -69.86666666666666 },
+    { "BR", "America", "Rio_Branco", -9.966666666666667, -67.8 },
+    { "BS", "America", "Nassau", 25.083333333333332, -77.35 },
+    { "BT", "Asia", "Thimphu", 27.466666666666665, 89.65 },
+    { "BW", "Africa", "Gaborone", -24.65, 25.916666666666668 },
+    { "BY", "Europe", "Minsk", 53.9, 27.566666666666666 },
+    { "BZ", "America", "Belize", 17.5, -88.2 },
+    { "CA", "America", "St_Johns", 47.56666666666667, -52.71666666666667 },
+    { "CA", "America", "Halifax", 44.65, -63.6 },
+    { "CA", "America", "Glace_Bay", 46.2, -59.95 },
+    { "CA", "America", "Moncton", 46.1, -64.78333333333333 },
+    { "CA", "America", "Goose_Bay", 53.333333333333336, -60.416666666666664 },
+    { "CA", "America", "Blanc-Sablon", 51.416666666666664, -57.11666666666667 },
+    { "CA", "America", "Toronto", 43.65, -79.38333333333334 },
+    { "CA", "America", "Iqaluit", 63.733333333333334, -68.46666666666667 },
+    { "CA", "America", "Atikokan", 48.75, -91.61666666666666 },
+    { "CA", "America", "Winnipeg", 49.88333333333333, -97.15 },
+    { "CA", "America", "Resolute", 74.68333333333334, -94.81666666666666 },
+    { "CA", "America", "Rankin_Inlet", 62.81666666666667, -92.06666666666666 },
+    { "CA", "America", "Regina", 50.4, -104.65 },
+    { "CA", "America", "Swift_Current", 50.28333333333333, -107.83333333333333 },
+    { "CA", "America", "Edmonton", 53.55, -113.46666666666667 },
+    { "CA", "America", "Cambridge_Bay", 69.1, -105.05 },
+    { "CA", "America", "Inuvik", 68.33333333333333, -133.71666666666667 },
+    { "CA", "America", "Creston", 49.1, -116.51666666666667 },
+    { "CA", "America", "Dawson_Creek", 55.766666666666666, -120.23333333333333 },
+    { "CA", "America", "Fort_Nelson", 58.8, -122.7 },
+    { "CA", "America", "Whitehorse", 60.71666666666667, -135.05 },
+    { "CA", "America", "Dawson", 64.06666666666666, -139.41666666666666 },
+    { "CA", "America", "Vancouver", 49.266666666666666, -123.11666666666666 },
+    { "CC", "Indian", "Cocos", -12.166666666666666, 96.91666666666667 },
+    { "CD", "Africa", "Kinshasa", -4.3, 15.3 },
+    { "CD", "Africa", "Lubumbashi", -11.666666666666666, 27.466666666666665 },
+    { "CF", "Africa", "Bangui", 4.366666666666666, 18.583333333333332 },
+    { "CG", "Africa", "Brazzaville", -4.266666666666667, 15.283333333333333 },
+    { "CH", "Europe", "Zurich", 47.38333333333333, 8.533333333333333 },
+    { "CI", "Africa", "Abidjan", 5.316666666666666, -4.033333333333333 },
+    { "CK", "Pacific", "Rarotonga", -21.233333333333334, -159.76666666666668 },
+    { "CL", "America", "Santiago", -33.45, -70.66666666666667 },
+    { "CL", "America", "Coyhaique", -45.56666666666667, -72.06666666666666 },
+    { "CL", "America", "Punta_Arenas", -53.15, -70.91666666666667 },
+    { "CL", "Pacific", "Easter", -27.15, -109.43333333333334 },
+    { "CM", "Africa", "Douala", 4.05, 9.7 },
+    { "CN", "Asia", "Shanghai", 31.233333333333334, 121.46666666666667 },
+    { "CN", "Asia", "Urumqi", 43.8, 87.58333333333333 },
+    { "CO", "America", "Bogota", 4.6, -74.08333333333333 },
+    { "CR", "America", "Costa_Rica", 9.933333333333334, -84.08333333333333 },
+    { "CU", "America", "Havana", 23.133333333333333, -82.36666666666666 },
+    { "CV", "Atlantic", "Cape_Verde", 14.916666666666666, -23.516666666666666 },
+    { "CW", "America", "Curacao", 12.183333333333334, -69.0 },
+    { "CX", "Indian", "Christmas", -10.416666666666666, 105.71666666666667 },
+    { "CY", "Asia", "Nicosia", 35.166666666666664, 33.36666666666667 },
+    { "CY", "Asia", "Famagusta", 35.11666666666667, 33.95 },
+    { "CZ", "Europe", "Prague", 50.083333333333336, 14.433333333333334 },
+    { "DE", "Europe", "Berlin", 52.5, 13.366666666666667 },
+    { "DE", "Europe", "Busingen", 47.7, 8.683333333333334 },
+    { "DJ", "Africa", "Djibouti", 11.6, 43.15 },
+    { "DK", "Europe", "Copenhagen", 55.666666666666664, 12.583333333333334 },
+    { "DM", "America", "Dominica", 15.3, -61.4 },
+    { "DO", "America", "Santo_Domingo", 18.466666666666665, -69.9 },
+    { "DZ", "Africa", "Algiers", 36.78333333333333, 3.05 },
+    { "EC", "America", "Guayaquil", -2.1666666666666665, -79.83333333333333 },
+    { "EC", "Pacific", "Galapagos", -0.9, -89.6 },
+    { "EE", "Europe", "Tallinn", 59.416666666666664, 24.75 },
+    { "EG", "Africa", "Cairo", 30.05, 31.25 },
+    { "EH", "Africa", "El_Aaiun", 27.15, -13.2 },
+    { "ER", "Africa", "Asmara", 15.333333333333334, 38.88333333333333 },
+    { "ES", "Europe", "Madrid", 40.4, -3.6833333333333336 },
+    { "ES", "Africa", "Ceuta", 35.88333333333333, -5.316666666666666 },
+    { "ES", "Atlantic", "Canary", 28.1, -15.4 },
+    { "ET", "Africa", "Addis_Ababa", 9.033333333333333, 38.7 },
+    { "FI", "Europe", "Helsinki", 60.166666666666664, 24.966666666666665 },
+    { "FJ", "Pacific", "Fiji", -18.133333333333333, 178.41666666666666 },
+    { "FK", "Atlantic", "Stanley", -51.7, -57.85 },
+    { "FM", "Pacific", "Chuuk", 7.416666666666667, 151.78333333333333 },
+    { "FM", "Pacific", "Pohnpei", 6.966666666666667, 158.21666666666667 },
+    { "FM", "Pacific", "Kosrae", 5.316666666666666, 162.98333333333332 },
+    { "FO", "Atlantic", "Faroe", 62.016666666666666, -6.766666666666667 },
+    { "FR", "Europe", "Paris", 48.86666666666667, 2.3333333333333335 },
+    { "GA", "Africa", "Libreville", 0.38333333333333336, 9.45 },
+    { "GB", "Europe", "London", 51.5, -0.11666666666666667 },
+    { "GD", "America", "Grenada", 12.05, -61.75 },
+    { "GE", "Asia", "Tbilisi", 41.71666666666667, 44.81666666666667 },
+    { "GF", "America", "Cayenne", 4.933333333333334, -52.333333333333336 },
+    { "GG", "Europe", "Guernsey", 49.45, -2.533333333333333 },
+    { "GH", "Africa", "Accra", 5.55, -0.21666666666666667 },
+    { "GI", "Europe", "Gibraltar", 36.13333333333333, -5.35 },
+    { "GL", "America", "Nuuk", 64.18333333333334, -51.733333333333334 },
+    { "GL", "America", "Danmarkshavn", 76.76666666666667, -18.666666666666668 },
+    { "GL", "America", "Scoresbysund", 70.48333333333333, -21.966666666666665 },
+    { "GL", "America", "Thule", 76.56666666666666, -68.78333333333333 },
+    { "GM", "Africa", "Banjul", 13.466666666666667, -16.65 },
+    { "GN", "Africa", "Conakry", 9.516666666666667, -13.716666666666667 },
+    { "GP", "America", "Guadeloupe", 16.233333333333334, -61.53333333333333 },
+    { "GQ", "Africa", "Malabo", 3.75, 8.783333333333333 },
+    { "GR", "Europe", "Athens", 37.96666666666667, 23.716666666666665 },
+    { "GS", "Atlantic", "South_Georgia", -54.266666666666666, -36.53333333333333 },
+    { "GT", "America", "Guatemala", 14.633333333333333, -90.51666666666667 },
+    { "GU", "Pacific", "Guam", 13.466666666666667, 144.75 },
+    { "GW", "Africa", "Bissau", 11.85, -15.583333333333334 },
+    { "GY", "America", "Guyana", 6.8, -58.166666666666664 },
+    { "HK", "Asia", "Hong_Kong", 22.283333333333335, 114.15 },
+    { "HN", "America", "Tegucigalpa", 14.1, -87.21666666666667 },
+    { "HR", "Europe", "Zagreb", 45.8, 15.966666666666667 },
+    { "HT", "America", "Port-au-Prince", 18.533333333333335, -72.33333333333333 },
+    { "HU", "Europe", "Budapest", 47.5, 19.083333333333332 },
+    { "ID", "Asia", "Jakarta", -6.166666666666667, 106.8 },
+    { "ID", "Asia", "Pontianak", -0.03333333333333333, 109.33333333333333 },
+    { "ID", "Asia", "Makassar", -5.116666666666666, 119.4 },
+    { "ID", "Asia", "Jayapura", -2.533333333333333, 140.7 },
+    { "IE", "Europe", "Dublin", 53.333333333333336, -6.25 },
+    { "IL", "Asia", "Jerusalem", 31.766666666666666, 35.21666666666667 },
+    { "IM", "Europe", "Isle_of_Man", 54.15, -4.466666666666667 },
+    { "IN", "Asia", "Kolkata", 22.533333333333335, 88.36666666666666 },
+    { "IO", "Indian", "Chagos", -7.333333333333333, 72.41666666666667 },
+    { "IQ", "Asia", "Baghdad", 33.35, 44.416666666666664 },
+    { "IR", "Asia", "Tehran", 35.666666666666664, 51.43333333333333 },
+    { "IS", "Atlantic", "Reykjavik", 64.15, -21.85 },
+    { "IT", "Europe", "Rome", 41.9, 12.483333333333333 },
+    { "JE", "Europe", "Jersey", 49.18333333333333, -2.1 },
+    { "JM", "America", "Jamaica", 17.966666666666665, -76.78333333333333 },
+    { "JO", "Asia", "Amman", 31.95, 35.93333333333333 },
+    { "JP", "Asia", "Tokyo", 35.65, 139.73333333333332 },
+    { "KE", "Africa", "Nairobi", -1.2833333333333332, 36.81666666666667 },
+    { "KG", "Asia", "Bishkek", 42.9, 74.6 },
+    { "KH", "Asia", "Phnom_Penh", 11.55, 104.91666666666667 },
+    { "KI", "Pacific", "Tarawa", 1.4166666666666667, 173.0 },
+    { "KI", "Pacific", "Kanton", -2.783333333333333, -171.71666666666667 },
+    { "KI", "Pacific", "Kiritimati", 1.8666666666666667, -157.33333333333334 },
+    { "KM", "Indian", "Comoro", -11.683333333333334, 43.266666666666666 },
+    { "KN", "America", "St_Kitts", 17.3, -62.71666666666667 },
+    { "KP", "Asia", "Pyongyang", 39.016666666666666, 125.75 },
+    { "KR", "Asia", "Seoul", 37.55, 126.96666666666667 },
+    { "KW", "Asia", "Kuwait", 29.333333333333332, 47.983333333333334 },
+    { "KY", "America", "Cayman", 19.3, -81.38333333333334 },
+    { "KZ", "Asia", "Almaty", 43.25, 76.95 },
+    { "KZ", "Asia", "Qyzylorda", 44.8, 65.46666666666667 },
+    { "KZ", "Asia", "Qostanay", 53.2, 63.61666666666667 },
+    { "KZ", "Asia", "Aqtobe", 50.28333333333333, 57.166666666666664 },
+    { "KZ", "Asia", "Aqtau", 44.516666666666666, 50.266666666666666 },
+    { "KZ", "Asia", "Atyrau", 47.11666666666667, 51.93333333333333 },
+    { "KZ", "Asia", "Oral", 51.21666666666667, 51.35 },
+    { "LA", "Asia", "Vientiane", 17.966666666666665, 102.6 },
+    { "LB", "Asia", "Beirut", 33.88333333333333, 35.5 },
+    { "LC", "America", "St_Lucia", 14.016666666666667, -61.0 },
+    { "LI", "Europe", "Vaduz", 47.15, 9.516666666666667 },
+    { "LK", "Asia", "Colombo", 6.933333333333334, 79.85 },
+    { "LR", "Africa", "Monrovia", 6.3, -10.783333333333333 },
+    { "LS", "Africa", "Maseru", -29.466666666666665, 27.5 },
+    { "LT", "Europe", "Vilnius", 54.68333333333333, 25.316666666666666 },
+    { "LU", "Europe", "Luxembourg", 49.6, 6.15 },
+    { "LV", "Europe", "Riga", 56.95, 24.1 },
+    { "LY", "Africa", "Tripoli", 32.9, 13.183333333333334 },
+    { "MA", "Africa", "Casablanca", 33.65, -7.583333333333333 },
+    { "MC", "Europe", "Monaco", 43.7, 7.383333333333334 },
+    { "MD", "Europe", "Chisinau", 47.0, 28.833333333333332 },
+    { "ME", "Europe", "Podgorica", 42.43333333333333, 19.266666666666666 },
+    { "MF", "America", "Marigot", 18.066666666666666, -63.083333333333336 },
+    { "MG", "Indian", "Antananarivo", -18.916666666666668, 47.516666666666666 },
+    { "MH", "Pacific", "Majuro", 7.15, 171.2 },
+    { "MH", "Pacific", "Kwajalein", 9.083333333333334, 167.33333333333334 },
+    { "MK", "Europe", "Skopje", 41.983333333333334, 21.433333333333334 },
+    { "ML", "Africa", "Bamako", 12.65, -8.0 },
+    { "MM", "Asia", "Yangon", 16.783333333333335, 96.16666666666667 },
+    { "MN", "Asia", "Ulaanbaatar", 47.916666666666664, 106.88333333333334 },
+    { "MN", "Asia", "Hovd", 48.016666666666666, 91.65 },
+    { "MO", "Asia", "Macau", 22.183333333333334, 113.53333333333333 },
+    { "MP", "Pacific", "Saipan", 15.2, 145.75 },
+    { "MQ", "America", "Martinique", 14.6, -61.083333333333336 },
+    { "MR", "Africa", "Nouakchott", 18.1, -15.95 },
+    { "MS", "America", "Montserrat", 16.716666666666665, -62.21666666666667 },
+    { "MT", "Europe", "Malta", 35.9, 14.516666666666667 },
+    { "MU", "Indian", "Mauritius", -20.166666666666668, 57.5 },
+    { "MV", "Indian", "Maldives", 4.166666666666667, 73.5 },
+    { "MW", "Africa", "Blantyre", -15.783333333333333, 35.0 },
+    { "MX", "America", "Mexico_City", 19.4, -99.15 },
+    { "MX", "America", "Cancun", 21.083333333333332, -86.76666666666667 },
+    { "MX", "America", "Merida", 20.966666666666665, -89.61666666666666 },
+    { "MX", "America", "Monterrey", 25.666666666666668, -100.31666666666666 },
+    { "MX", "America", "Matamoros", 25.833333333333332, -97.5 },
+    { "MX", "America", "Chihuahua", 28.633333333333333, -106.08333333333333 },
+    { "MX", "America", "Ciudad_Juarez", 31.733333333333334, -106.48333333333333 },
+    { "MX", "America", "Ojinaga", 29.566666666666666, -104.41666666666667 },
+    { "MX", "America", "Mazatlan", 23.216666666666665, -106.41666666666667 },
+    { "MX", "America", "Bahia_Banderas", 20.8, -105.25 },
+    { "MX", "America", "Hermosillo", 29.066666666666666, -110.96666666666667 },
+    { "MX", "America", "Tijuana", 32.53333333333333, -117.01666666666667 },
+    { "MY", "Asia", "Kuala_Lumpur", 3.1666666666666665, 101.7 },
+    { "MY", "Asia", "Kuching", 1.55, 110.33333333333333 },
+    { "MZ", "Africa", "Maputo", -25.966666666666665, 32.583333333333336 },
+    { "NA", "Africa", "Windhoek", -22.566666666666666, 17.1 },
+    { "NC", "Pacific", "Noumea", -22.266666666666666, 166.45 },
+    { "NE", "Africa", "Niamey", 13.516666666666667, 2.1166666666666667 },
+    { "NF", "Pacific", "Norfolk", -29.05, 167.96666666666667 },
+    { "NG", "Africa", "Lagos", 6.45, 3.4 },
+    { "NI", "America", "Managua", 12.15, -86.28333333333333 },
+    { "NL", "Europe", "Amsterdam", 52.36666666666667, 4.9 },
+    { "NO", "Europe", "Oslo", 59.916666666666664, 10.75 },
+    { "NP", "Asia", "Kathmandu", 27.716666666666665, 85.31666666666666 },
+    { "NR", "Pacific", "Nauru", -0.5166666666666667, 166.91666666666666 },
+    { "NU", "Pacific", "Niue", -19.016666666666666, -169.91666666666666 },
+    { "NZ", "Pacific", "Auckland", -36.86666666666667, 174.76666666666668 },
+    { "NZ", "Pacific", "Chatham", -43.95, -176.55 },
+    { "OM", "Asia", "Muscat", 23.6, 58.583333333333336 },
+    { "PA", "America", "Panama", 8.966666666666667, -79.53333333333333 },
+    { "PE", "America", "Lima", -12.05, -77.05 },
+    { "PF", "Pacific", "Tahiti", -17.533333333333335, -149.56666666666666 },
+    { "PF", "Pacific", "Marquesas", -9.0, -139.5 },
+    { "PF", "Pacific", "Gambier", -23.133333333333333, -134.95 },
+    { "PG", "Pacific", "Port_Moresby", -9.5, 147.16666666666666 },
+    { "PG", "Pacific", "Bougainville", -6.216666666666667, 155.56666666666666 },
+    { "PH", "Asia", "Manila", 14.583333333333334, 120.96666666666667 },
+    { "PK", "Asia", "Karachi", 24.866666666666667, 67.05 },
+    { "PL", "Europe", "Warsaw", 52.25, 21.0 },
+    { "PM", "America", "Miquelon", 47.05, -56.333333333333336 },
+    { "PN", "Pacific", "Pitcairn", -25.066666666666666, -130.08333333333334 },
+    { "PR", "America", "Puerto_Rico", 18.466666666666665, -66.1 },
+    { "PS", "Asia", "Gaza", 31.5, 34.46666666666667 },
+    { "PS", "Asia", "Hebron", 31.533333333333335, 35.083333333333336 },
+    { "PT", "Europe", "Lisbon", 38.71666666666667, -9.133333333333333 },
+    { "PT", "Atlantic", "Madeira", 32.63333333333333, -16.9 },
+    { "PT", "Atlantic", "Azores", 37.733333333333334, -25.666666666666668 },
+    { "PW", "Pacific", "Palau", 7.333333333333333, 134.48333333333332 },
+    { "PY", "America", "Asuncion", -25.266666666666666, -57.666666666666664 },
+    { "QA", "Asia", "Qatar", 25.283333333333335, 51.53333333333333 },
+    { "RE", "Indian", "Reunion", -20.866666666666667, 55.46666666666667 },
+    { "RO", "Europe", "Bucharest", 44.43333333333333, 26.1 },
+    { "RS", "Europe", "Belgrade", 44.833333333333336, 20.5 },
+    { "RU", "Europe", "Kaliningrad", 54.71666666666667, 20.5 },
+    { "RU", "Europe", "Moscow", 55.75, 37.61666666666667 },
+    { "UA", "Europe", "Simferopol", 44.95, 34.1 },
+    { "RU", "Europe", "Kirov", 58.6, 49.65 },
+    { "RU", "Europe", "Volgograd", 48.733333333333334, 44.416666666666664 },
+    { "RU", "Europe", "Astrakhan", 46.35, 48.05 },
+    { "RU", "Europe", "Saratov", 51.56666666666667, 46.03333333333333 },
+    { "RU", "Europe", "Ulyanovsk", 54.333333333333336, 48.4 },
+    { "RU", "Europe", "Samara", 53.2, 50.15 },
+    { "RU", "Asia", "Yekaterinburg", 56.85, 60.6 },
+    { "RU", "Asia", "Omsk", 55.0, 73.4 },
+    { "RU", "Asia", "Novosibirsk", 55.03333333333333, 82.91666666666667 },
+    { "RU", "Asia", "Barnaul", 53.36666666666667, 83.75 },
+    { "RU", "Asia", "Tomsk", 56.5, 84.96666666666667 },
+    { "RU", "Asia", "Novokuznetsk", 53.75, 87.11666666666666 },
+    { "RU", "Asia", "Krasnoyarsk", 56.016666666666666, 92.83333333333333 },
+    { "RU", "Asia", "Irkutsk", 52.266666666666666, 104.33333333333333 },
+    { "RU", "Asia", "Chita", 52.05, 113.46666666666667 },
+    { "RU", "Asia", "Yakutsk", 62.0, 129.66666666666666 },
+    { "RU", "Asia", "Khandyga", 62.65, 135.55 },
+    { "RU", "Asia", "Vladivostok", 43.166666666666664, 131.93333333333334 },
+    { "RU", "Asia", "Ust-Nera", 64.55, 143.21666666666667 },
+    { "RU", "Asia", "Magadan", 59.56666666666667, 150.8 },
+    { "RU", "Asia", "Sakhalin", 46.96666666666667, 142.7 },
+    { "RU", "Asia", "Srednekolymsk", 67.46666666666667, 153.71666666666667 },
+    { "RU", "Asia", "Kamchatka", 53.016666666666666, 158.65 },
+    { "RU", "Asia", "Anadyr", 64.75, 177.48333333333332 },
+    { "RW", "Africa", "Kigali", -1.95, 30.066666666666666 },
+    { "SA", "Asia", "Riyadh", 24.633333333333333, 46.71666666666667 },
+    { "SB", "Pacific", "Guadalcanal", -9.533333333333333, 160.2 },
+    { "SC", "Indian", "Mahe", -4.666666666666667, 55.46666666666667 },
+    { "SD", "Africa", "Khartoum", 15.6, 32.53333333333333 },
+    { "SE", "Europe", "Stockholm", 59.333333333333336, 18.05 },
+    { "SG", "Asia", "Singapore", 1.2833333333333332, 103.85 },
+    { "SH", "Atlantic", "St_Helena", -15.916666666666666, -5.7 },
+    { "SI", "Europe", "Ljubljana", 46.05, 14.516666666666667 },
+    { "SJ", "Arctic", "Longyearbyen", 78.0, 16.0 },
+    { "SK", "Europe", "Bratislava", 48.15, 17.116666666666667 },
+    { "SL", "Africa", "Freetown", 8.5, -13.25 },
+    { "SM", "Europe", "San_Marino", 43.916666666666664, 12.466666666666667 },
+    { "SN", "Africa", "Dakar", 14.666666666666666, -17.433333333333334 },
+    { "SO", "Africa", "Mogadishu", 2.066666666666667, 45.36666666666667 },
+    { "SR", "America", "Paramaribo", 5.833333333333333, -55.166666666666664 },
+    { "SS", "Africa", "Juba", 4.85, 31.616666666666667 },
+    { "ST", "Africa", "Sao_Tome", 0.3333333333333333, 6.733333333333333 },
+    { "SV", "America", "El_Salvador", 13.7, -89.2 },
+    { "SX", "America", "Lower_Princes", 18.05, -63.03333333333333 },
+    { "SY", "Asia", "Damascus", 33.5, 36.3 },
+    { "SZ", "Africa", "Mbabane", -26.3, 31.1 },
+    { "TC", "America", "Grand_Turk", 21.466666666666665, -71.13333333333334 },
+    { "TD", "Africa", "Ndjamena", 12.116666666666667, 15.05 },
+    { "TF", "Indian", "Kerguelen", -49.35, 70.21666666666667 },
+    { "TG", "Africa", "Lome", 6.133333333333334, 1.2166666666666668 },
+    { "TH", "Asia", "Bangkok", 13.75, 100.51666666666667 },
+    { "TJ", "Asia", "Dushanbe", 38.583333333333336, 68.8 },
+    { "TK", "Pacific", "Fakaofo", -9.366666666666667, -171.23333333333332 },
+    { "TL", "Asia", "Dili", -8.55, 125.58333333333333 },
+    { "TM", "Asia", "Ashgabat", 37.95, 58.38333333333333 },
+    { "TN", "Africa", "Tunis", 36.8, 10.183333333333334 },
+    { "TO", "Pacific", "Tongatapu", -21.133333333333333, -175.2 },
+    { "TR", "Europe", "Istanbul", 41.016666666666666, 28.966666666666665 },
+    { "TT", "America", "Port_of_Spain", 10.65, -61.516666666666666 },
+    { "TV", "Pacific", "Funafuti", -8.516666666666667, 179.21666666666667 },
+    { "TW", "Asia", "Taipei", 25.05, 121.5 },
+    { "TZ", "Africa", "Dar_es_Salaam", -6.8, 39.28333333333333 },
+    { "UA", "Europe", "Kyiv", 50.43333333333333, 30.516666666666666 },
+    { "UG", "Africa", "Kampala", 0.31666666666666665, 32.416666666666664 },
+    { "UM", "Pacific", "Midway", 28.216666666666665, -177.36666666666667 },
+    { "UM", "Pacific", "Wake", 19.283333333333335, 166.61666666666667 },
+    { "US", "America", "New_York", 40.7, -74.0 },
+    { "US", "America", "Detroit", 42.31666666666667, -83.03333333333333 },
+    { "US", "America", "Kentucky/Louisville", 38.25, -85.75 },
+    { "US", "America", "Kentucky/Monticello", 36.81666666666667, -84.83333333333333 },
+    { "US", "America", "Indiana/Indianapolis", 39.766666666666666, -86.15 },
+    { "US", "America", "Indiana/Vincennes", 38.666666666666664, -87.51666666666667 },
+    { "US", "America", "Indiana/Winamac", 41.05, -86.6 },
+    { "US", "America", "Indiana/Marengo", 38.36666666666667, -86.33333333333333 },
+    { "US", "America", "Indiana/Petersburg", 38.483333333333334, -87.26666666666667 },
+    { "US", "America", "Indiana/Vevay", 38.733333333333334, -85.06666666666666 },
+    { "US", "America", "Chicago", 41.85, -87.65 },
+    { "US", "America", "Indiana/Tell_City", 37.95, -86.75 },
+    { "US", "America", "Indiana/Knox", 41.28333333333333, -86.61666666666666 },
+    { "US", "America", "Menominee", 45.1, -87.6 },
+    { "US", "America", "North_Dakota/Center", 47.1, -101.28333333333333 },
+    { "US", "America", "North_Dakota/New_Salem", 46.833333333333336, -101.4 },
+    { "US", "America", "North_Dakota/Beulah", 47.25, -101.76666666666667 },
+    { "US", "America", "Denver", 39.733333333333334, -104.98333333333333 },
+    { "US", "America", "Boise", 43.6, -116.2 },
+    { "US", "America", "Phoenix", 33.43333333333333, -112.06666666666666 },
+    { "US", "America", "Los_Angeles", 34.05, -118.23333333333333 },
+    { "US", "America", "Anchorage", 61.21666666666667, -149.9 },
+    { "US", "America", "Juneau", 58.3, -134.41666666666666 },
+    { "US", "America", "Sitka", 57.166666666666664, -135.3 },
+    { "US", "America", "Metlakatla", 55.11666666666667, -131.56666666666666 },
+    { "US", "America", "Yakutat", 59.53333333333333, -139.71666666666667 },
+    { "US", "America", "Nome", 64.5, -165.4 },
+    { "US", "America", "Adak", 51.86666666666667, -176.65 },
+    { "US", "Pacific", "Honolulu", 21.3, -157.85 },
+    { "UY", "America", "Montevideo", -34.9, -56.2 },
+    { "UZ", "Asia", "Samarkand", 39.666666666666664, 66.8 },
+    { "UZ", "Asia", "Tashkent", 41.333333333333336, 69.3 },
+    { "VA", "Europe", "Vatican", 41.9, 12.45 },
+    { "VC", "America", "St_Vincent", 13.15, -61.233333333333334 },
+    { "VE", "America", "Caracas", 10.5, -66.93333333333334 },
+    { "VG", "America", "Tortola", 18.45, -64.61666666666666 },
+    { "VI", "America", "St_Thomas", 18.35, -64.93333333333334 },
+    { "VN", "Asia", "Ho_Chi_Minh", 10.75, 106.66666666666667 },
+    { "VU", "Pacific", "Efate", -17.666666666666668, 168.41666666666666 },
+    { "WF", "Pacific", "Wallis", -13.3, -176.16666666666666 },
+    { "WS", "Pacific", "Apia", -13.833333333333334, -171.73333333333332 },
+    { "YE", "Asia", "Aden", 12.75, 45.2 },
+    { "YT", "Indian", "Mayotte", -12.783333333333333, 45.233333333333334 },
+    { "ZA", "Africa", "Johannesburg", -26.25, 28.0 },
+    { "ZM", "Africa", "Lusaka", -15.416666666666666, 28.283333333333335 },
+    { "ZW", "Africa", "Harare", -17.833333333333332, 31.05 },
+};
+
+// END Generated from zone.tab
@@ -11,9 +11,14 @@ Python3 script to scrape some data out of zoneinfo/zone.tab.
 To use this script, you must have a zone.tab in a standard location,
 /usr/share/zoneinfo/zone.tab (this is usual on FreeBSD and Linux).
 
-Prints out a few tables of zone names for use in translations.
+Prints out a few tables of zone names for use in translations,
+and writes ZoneTable_p.cpp, which is the compiled-in table of
+zones used by TimeZone.cpp instead of parsing zone.tab at runtime.
+Re-run this when a newer tzdata is released.
 """
 
+import os
+
 def scrape_file(file, regionset, zoneset):
     for line in file.readlines():
         if line.startswith("#"):
@@ -34,6 +39,79 @@ def scrape_file(file, regionset, zoneset):
         assert(zone not in zoneset)
         zoneset.add(zone)
 
+def geo_location(s):
+    """
+    Turns a zone.tab latitude or longitude (e.g. "+4230") into a float.
+    This must give the same result as getRightGeoLocation() in TimeZone.cpp.
+    """
+    sign = -1.0 if s.startswith("-") else 1.0
+    s = s.lstrip("+-")
+    if len(s) in (4, 6):
+        return sign * (float(s[0:2]) + float(s[2:4]) / 60.0)
+    if len(s) in (5, 7):
+        return sign * (float(s[0:3]) + float(s[3:5]) / 60.0)
+    return 0.0
+
+def scrape_table(file):
+    """
+    Returns a list of (country, region, zone, latitude, longitude)
+    tuples, in the order of the file.
+    """
+    table = []
+    for line in file.readlines():
+        line = line.split("#", 1)[0].strip()
+        parts = line.split()
+        if len(parts) < 3:
+            continue
+        country, position, zoneid = parts[0:3]
+        if len(country) != 2 or not "/" in zoneid:
+            continue
+        region, zone = zoneid.split("/", 1)
+        # Latitude and longitude are glued together, split at the second sign
+        signs = [i for i in range(1, len(position)) if position[i] in "+-"]
+        if not signs:
+            continue
+        split = signs[0]
+        table.append((country, region, zone, geo_location(position[:split]), geo_location(position[split:])))
+    return table
+
+def tzdata_version(zoneinfo):
+    """
+    Returns the version of the tzdata in @p zoneinfo, or an empty string.
+    Must match systemTZVersion() in TimeZone.cpp.
+    """
+    try:
+        with open(os.path.join(zoneinfo, "tzdata.zi"), "r") as f:
+            line = f.readline()
+            if line.startswith("# version "):
+                return line[10:].strip()
+    except OSError:
+        pass
+    try:
+        with open(os.path.join(zoneinfo, "+VERSION"), "r") as f:
+            return f.readline().strip()
+    except OSError:
+        pass
+    return ""
+
+def write_table(file, version, table):
+    file.write("""struct ZoneTableEntry
+{
+    const char* country;
+    const char* region;
+    const char* zone;
+    double latitude;
+    double longitude;
+};
+
+""")
+    file.write("static const char zone_table_version[] = \"{!s}\";\n\n".format(version))
+    file.write("static constexpr const int zone_table_size = {!s};\n".format(len(table)))
+    file.write("static const ZoneTableEntry zone_table[ {!s} ] = {{\n".format(len(table)))
+    for country, region, zone, latitude, longitude in table:
+        file.write("""    {{ "{!s}", "{!s}", "{!s}", {!r}, {!r} }},\n""".format(country, region, zone, latitude, longitude))
+    file.write("};\n\n// END Generated from zone.tab\n")
+
 def write_set(file, label, set):
     file.write("/* This returns a reference to local, which is a terrible idea.\n * Good thing it's not meant to be compiled.\n */\n")
     # Note {{ is an escaped { for Python string formatting
@@ -71,6 +149,10 @@ cpp_header_comment = """/*   GENERATED FILE DO NOT EDIT
 // clang-format off
 """
 
+table_header_comment = cpp_header_comment.replace(
+    "/** THIS FILE EXISTS ONLY FOR TRANSLATIONS PURPOSES **/\n",
+    "// BEGIN Generated from zone.tab\n")
+
 if __name__ == "__main__":
     regions=set()
     zones=set()
@@ -81,3 +163,9 @@ if __name__ == "__main__":
         write_set(f, "tz_regions", regions)
         write_set(f, "tz_names", zones)
 
+    with open("/usr/share/zoneinfo/zone.tab", "r") as f:
+        table = scrape_table(f)
+    with open("ZoneTable_p.cpp", "w") as f:
+        f.write(table_header_comment)
+        write_table(f, tzdata_version("/usr/share/zoneinfo"), table)
+
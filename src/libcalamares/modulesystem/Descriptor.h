@@ -69,6 +69,7 @@ public:
     Interface interface() const { return m_interface; }
 
     bool isEmergency() const { return m_isEmergeny; }
+    bool isIdempotent() const { return m_isIdempotent; }
     bool hasConfig() const { return m_hasConfig; }
     int weight() const { return m_weight < 1 ? 1 : m_weight; }
     bool explicitWeight() const { return m_weight > 0; }
@@ -123,6 +124,7 @@ private:
     Interface m_interface;
     bool m_isValid = false;
     bool m_isEmergeny = false;
+    bool m_isIdempotent = false;
     bool m_hasConfig = true;
 
     /** @brief The name of the thing to load
@@ -44,6 +44,7 @@ Module::initFrom( const Calamares::ModuleSystem::Descriptor& moduleDescriptor, c
     {
         m_maybe_emergency = true;
     }
+    m_idempotent = moduleDescriptor.isIdempotent();
 }
 
 static QStringList
@@ -11,14 +11,25 @@
 
 #include "utils/Logger.h"
 
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QEventLoop>
+#include <QFile>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QSaveFile>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <algorithm>
 
@@ -49,6 +60,185 @@ RequestOptions::applyToRequest( QNetworkRequest* request ) const
     }
 }
 
+namespace
+{
+/// @brief A response in the cache, with what is needed to revalidate it
+struct CacheEntry
+{
+    QByteArray data;
+    QByteArray etag;
+    QByteArray lastModified;
+    /// After this (UTC) time, the entry must be revalidated before use
+    QDateTime expires;
+
+    bool isFresh() const { return expires.isValid() && QDateTime::currentDateTimeUtc() < expires; }
+    bool canRevalidate() const { return !etag.isEmpty() || !lastModified.isEmpty(); }
+};
+
+/// @brief Identifies cache files (and their format)
+static constexpr quint32 cacheFileMagic = 0xca1a0001;
+
+/** @brief Responses in memory, optionally backed by a directory
+ *
+ * Both are bounded; the least-recently used entries are dropped
+ * from memory, the oldest files from the directory.
+ *
+ * This is not thread-safe, the Manager protects it with a mutex.
+ */
+class ResponseCache
+{
+public:
+    ResponseCache() { setMemoryLimit( 8 * 1024 * 1024 ); }
+
+    bool find( const QString& key, CacheEntry& entry );
+    void insert( const QString& key, const CacheEntry& entry );
+    void setMemoryLimit( qint64 bytes ) { m_memory.setMaxCost( int( std::max( qint64( 0 ), bytes / 1024 ) ) ); }
+    void setDirectory( const QString& directory, qint64 bytes );
+    void clear();
+
+private:
+    static int cost( const CacheEntry& entry ) { return entry.data.size() / 1024 + 1; }
+    QString fileName( const QString& key ) const;
+    void trimDirectory();
+
+    /// Cost is counted in KiB
+    QCache< QString, CacheEntry > m_memory;
+    QString m_directory;
+    qint64 m_directoryLimit = 0;
+};
+
+QString
+ResponseCache::fileName( const QString& key ) const
+{
+    return m_directory + '/'
+        + QString::fromLatin1( QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Sha1 ).toHex() )
+        + QStringLiteral( ".cache" );
+}
+
+bool
+ResponseCache::find( const QString& key, CacheEntry& entry )
+{
+    if ( const CacheEntry* e = m_memory.object( key ) )
+    {
+        entry = *e;
+        return true;
+    }
+    if ( m_directory.isEmpty() )
+    {
+        return false;
+    }
+
+    QFile f( fileName( key ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    QDataStream in( &f );
+    in.setVersion( QDataStream::Qt_5_9 );
+    quint32 magic = 0;
+    QString storedKey;
+    CacheEntry e;
+    in >> magic >> storedKey >> e.etag >> e.lastModified >> e.expires >> e.data;
+    if ( in.status() != QDataStream::Ok || magic != cacheFileMagic || storedKey != key )
+    {
+        cWarning() << "Ignoring bad network cache file" << f.fileName();
+        return false;
+    }
+    m_memory.insert( key, new CacheEntry( e ), cost( e ) );
+    entry = e;
+    return true;
+}
+
+void
+ResponseCache::insert( const QString& key, const CacheEntry& entry )
+{
+    m_memory.insert( key, new CacheEntry( entry ), cost( entry ) );
+    if ( m_directory.isEmpty() )
+    {
+        return;
+    }
+
+    QSaveFile f( fileName( key ) );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        cWarning() << "Could not write network cache file" << f.fileName();
+        return;
+    }
+    QDataStream out( &f );
+    out.setVersion( QDataStream::Qt_5_9 );
+    out << cacheFileMagic << key << entry.etag << entry.lastModified << entry.expires << entry.data;
+    if ( !f.commit() )
+    {
+        cWarning() << "Could not write network cache file" << f.fileName();
+        return;
+    }
+    trimDirectory();
+}
+
+void
+ResponseCache::setDirectory( const QString& directory, qint64 bytes )
+{
+    m_directory = directory;
+    m_directoryLimit = bytes;
+    if ( !m_directory.isEmpty() && !QDir().mkpath( m_directory ) )
+    {
+        cWarning() << "Could not create network cache directory" << m_directory;
+        m_directory.clear();
+    }
+    if ( !m_directory.isEmpty() )
+    {
+        trimDirectory();
+    }
+}
+
+void
+ResponseCache::trimDirectory()
+{
+    // Newest files first, keep as many as fit
+    const QFileInfoList files
+        = QDir( m_directory ).entryInfoList( { QStringLiteral( "*.cache" ) }, QDir::Files, QDir::Time );
+    qint64 total = 0;
+    for ( const auto& fi : files )
+    {
+        total += fi.size();
+        if ( total > m_directoryLimit )
+        {
+            QFile::remove( fi.absoluteFilePath() );
+        }
+    }
+}
+
+void
+ResponseCache::clear()
+{
+    m_memory.clear();
+    if ( !m_directory.isEmpty() )
+    {
+        for ( const auto& fi : QDir( m_directory ).entryInfoList( { QStringLiteral( "*.cache" ) }, QDir::Files ) )
+        {
+            QFile::remove( fi.absoluteFilePath() );
+        }
+    }
+}
+
+/// @brief A request that is being done, for others to wait on
+struct InFlight
+{
+    QThread* owner = nullptr;
+    bool done = false;
+    Response response;
+};
+
+/// @brief One try of a request
+struct Attempt
+{
+    Response response;
+    QNetworkReply::NetworkError error = QNetworkReply::NoError;
+    /// Should the (updated) entry go into the cache?
+    bool store = false;
+};
+}  // namespace
+
 class Manager::Private : public QObject
 {
     Q_OBJECT
@@ -58,17 +248,36 @@ private:
     using ThreadNam = QPair< QThread*, QNetworkAccessManager* >;
     QVector< ThreadNam > m_perThreadNams;
 
-public slots:
-    void cleanupNam();
+    void cleanupNam( QThread* thread );
 
 public:
     QVector< QUrl > m_hasInternetUrls;
     bool m_hasInternet = false;
     int m_lastCheckedUrlIndex = -1;
 
+    /** @brief Shared between threads, protected by m_requestMutex
+     *
+     * The wait condition is signalled whenever a request in flight
+     * is done or a connection to a host is released.
+     */
+    QMutex m_requestMutex;
+    QWaitCondition m_requestsChanged;
+    ResponseCache m_cache;
+    QHash< QString, std::shared_ptr< InFlight > > m_inFlight;
+    QHash< QString, QList< QThread* > > m_hostConnections;
+    int m_maxConnectionsPerHost = 4;
+
+    /// Worker threads for asynchronousRequest()
+    QThreadPool m_pool;
+
     Private();
 
     QNetworkAccessManager* nam();
+
+    bool hasConnection( QThread* thread ) const;
+    void acquireHost( const QString& host );
+    void releaseHost( const QString& host );
+    Attempt run( const QUrl& url, const RequestOptions& options, CacheEntry& entry, bool conditional );
 };
 
 Manager::Private::Private()
@@ -77,6 +286,7 @@ Manager::Private::Private()
 {
     m_perThreadNams.reserve( 20 );
     m_perThreadNams.append( qMakePair( QThread::currentThread(), m_nam.get() ) );
+    m_pool.setMaxThreadCount( 4 );
 }
 
 static QMutex*
@@ -105,17 +315,18 @@ Manager::Private::nam()
     // Need a new NAM for this thread
     QNetworkAccessManager* nam = new QNetworkAccessManager();
     m_perThreadNams.append( qMakePair( thread, nam ) );
-    QObject::connect( thread, &QThread::finished, this, &Manager::Private::cleanupNam );
+    // Clean up in the thread itself, which is also the thread the NAM belongs to
+    QObject::connect(
+        thread, &QThread::finished, this, [ this, thread ]() { cleanupNam( thread ); }, Qt::DirectConnection );
 
     return nam;
 }
 
 void
-Manager::Private::cleanupNam()
+Manager::Private::cleanupNam( QThread* thread )
 {
     QMutexLocker lock( namMutex() );
 
-    auto* thread = QThread::currentThread();
     bool cleanupFound = false;
     int cleanupIndex = 0;
     for ( const auto& n : m_perThreadNams )
@@ -258,9 +469,8 @@ Manager::getCheckInternetUrls() const
  * On failure, returns nullptr (e.g. bad URL, timeout).
  */
 static QNetworkReply*
-asynchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOptions& options )
+asynchronousRun( QNetworkAccessManager* nam, QNetworkRequest request, const RequestOptions& options )
 {
-    QNetworkRequest request = QNetworkRequest( url );
     options.applyToRequest( &request );
 
     QNetworkReply* reply = nam->get( request );
@@ -290,13 +500,15 @@ asynchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOptio
  * The extra options for the request are taken from @p options,
  * including the timeout setting.
  *
- * On failure, returns nullptr (e.g. bad URL, timeout). The request
- * is marked for later automatic deletion, so don't store the pointer.
+ * On failure, returns nullptr (e.g. bad URL, timeout). For HTTP errors,
+ * the reply is returned as well, so that the status can be examined.
+ * The request is marked for later automatic deletion, so don't store the pointer.
  */
 static QPair< RequestStatus, QNetworkReply* >
-synchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOptions& options )
+synchronousRun( QNetworkAccessManager* nam, const QNetworkRequest& request, const RequestOptions& options )
 {
-    auto* reply = asynchronousRun( nam, url, options );
+    const QUrl url = request.url();
+    auto* reply = asynchronousRun( nam, request, options );
     if ( !reply )
     {
         cDebug() << "Could not create request for" << url;
@@ -307,7 +519,8 @@ synchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOption
     QObject::connect( reply, &QNetworkReply::finished, &loop, &QEventLoop::quit );
     loop.exec();
     reply->deleteLater();
-    if ( reply->isRunning() )
+    // The timeout aborts the request, which is the only reason for a cancel
+    if ( reply->isRunning() || reply->error() == QNetworkReply::OperationCanceledError )
     {
         cDebug() << "Timeout on request for" << url;
         return qMakePair( RequestStatus( RequestStatus::Timeout ), nullptr );
@@ -315,7 +528,7 @@ synchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOption
     else if ( reply->error() != QNetworkReply::NoError )
     {
         cDebug() << "HTTP error" << reply->error() << "on request for" << url;
-        return qMakePair( RequestStatus( RequestStatus::HttpError ), nullptr );
+        return qMakePair( RequestStatus( RequestStatus::HttpError ), reply );
     }
     else
     {
@@ -323,6 +536,191 @@ synchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOption
     }
 }
 
+/** @brief Updates @p entry from the caching headers of the @p reply
+ *
+ * Returns @c false if the response must not be stored.
+ */
+static bool
+applyCacheHeaders( CacheEntry& entry, const QNetworkReply* reply )
+{
+    qint64 maxAge = 0;
+    bool noCache = false;
+    for ( const QByteArray& d : reply->rawHeader( "Cache-Control" ).split( ',' ) )
+    {
+        const QByteArray directive = d.trimmed().toLower();
+        if ( directive == "no-store" )
+        {
+            return false;
+        }
+        if ( directive == "no-cache" )
+        {
+            noCache = true;
+        }
+        else if ( directive.startsWith( "max-age=" ) )
+        {
+            maxAge = std::max( qint64( 0 ), directive.mid( 8 ).toLongLong() );
+        }
+    }
+    if ( reply->hasRawHeader( "ETag" ) )
+    {
+        entry.etag = reply->rawHeader( "ETag" );
+    }
+    if ( reply->hasRawHeader( "Last-Modified" ) )
+    {
+        entry.lastModified = reply->rawHeader( "Last-Modified" );
+    }
+    entry.expires = QDateTime::currentDateTimeUtc().addSecs( noCache ? 0 : maxAge );
+    // Without a lifetime, a response is only useful if it can be revalidated
+    return ( !noCache && maxAge > 0 ) || entry.canRevalidate();
+}
+
+/** @brief Does one GET request for @p url
+ *
+ * If @p conditional, this is a request to revalidate the cached @p entry.
+ * On success, @p entry holds the (new or revalidated) response.
+ */
+static Attempt
+attemptRequest( QNetworkAccessManager* nam,
+                const QUrl& url,
+                const RequestOptions& options,
+                CacheEntry& entry,
+                bool conditional )
+{
+    QNetworkRequest request( url );
+    if ( conditional && !entry.etag.isEmpty() )
+    {
+        request.setRawHeader( "If-None-Match", entry.etag );
+    }
+    if ( conditional && !entry.lastModified.isEmpty() )
+    {
+        request.setRawHeader( "If-Modified-Since", entry.lastModified );
+    }
+
+    const auto result = synchronousRun( nam, request, options );
+    const QNetworkReply* reply = result.second;
+    Attempt a;
+    a.response.status = result.first;
+    if ( !reply )
+    {
+        return a;
+    }
+    a.error = reply->error();
+    a.response.httpStatus = reply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+    if ( !a.response.status )
+    {
+        return a;
+    }
+
+    if ( conditional && a.response.httpStatus == 304 )
+    {
+        a.store = applyCacheHeaders( entry, reply );
+        a.response.data = entry.data;
+        a.response.fromCache = true;
+        return a;
+    }
+    CacheEntry fresh;
+    fresh.data = result.second->readAll();
+    a.store = applyCacheHeaders( fresh, reply );
+    a.response.data = fresh.data;
+    entry = fresh;
+    return a;
+}
+
+/// @brief Is it worth trying again after this failure?
+static bool
+isTransient( const Attempt& a )
+{
+    if ( a.response.status.status == RequestStatus::Timeout )
+    {
+        return true;
+    }
+    if ( a.response.httpStatus >= 500 || a.response.httpStatus == 429 )
+    {
+        return true;
+    }
+    if ( a.response.httpStatus >= 400 )
+    {
+        return false;
+    }
+    // Connection-level problems have codes below 100; a bad certificate won't get better
+    return a.response.status.status == RequestStatus::HttpError && a.error != QNetworkReply::NoError && a.error < 100
+        && a.error != QNetworkReply::SslHandshakeFailedError;
+}
+
+/// @brief How long to wait before retry number @p retry (counting from 0)
+static std::chrono::milliseconds
+retryDelay( int retry )
+{
+    using std::chrono::milliseconds;
+    return std::min( milliseconds( 8000 ), milliseconds( 250 ) * ( 1 << std::min( retry, 5 ) ) );
+}
+
+/// @brief Does @p thread hold a connection to any host? (call with the mutex locked)
+bool
+Manager::Private::hasConnection( QThread* thread ) const
+{
+    return std::any_of( m_hostConnections.cbegin(),
+                        m_hostConnections.cend(),
+                        [ thread ]( const QList< QThread* >& threads ) { return threads.contains( thread ); } );
+}
+
+void
+Manager::Private::acquireHost( const QString& host )
+{
+    QMutexLocker lock( &m_requestMutex );
+    auto* thread = QThread::currentThread();
+    // A thread that already has a connection (in a nested event loop) would wait for itself
+    while ( !m_hostConnections.value( host ).contains( thread )
+            && m_hostConnections.value( host ).count() >= m_maxConnectionsPerHost )
+    {
+        m_requestsChanged.wait( &m_requestMutex );
+    }
+    m_hostConnections[ host ].append( thread );
+}
+
+void
+Manager::Private::releaseHost( const QString& host )
+{
+    QMutexLocker lock( &m_requestMutex );
+    auto it = m_hostConnections.find( host );
+    if ( it != m_hostConnections.end() )
+    {
+        it.value().removeOne( QThread::currentThread() );
+        if ( it.value().isEmpty() )
+        {
+            m_hostConnections.erase( it );
+        }
+    }
+    m_requestsChanged.wakeAll();
+}
+
+/** @brief Does the request, with retries, within the per-host limits
+ *
+ * See attemptRequest() for the meaning of @p entry and @p conditional.
+ */
+Attempt
+Manager::Private::run( const QUrl& url, const RequestOptions& options, CacheEntry& entry, bool conditional )
+{
+    const QString host = url.host().toLower();
+    for ( int retry = 0;; ++retry )
+    {
+        acquireHost( host );
+        const Attempt a = attemptRequest( nam(), url, options, entry, conditional );
+        releaseHost( host );
+
+        if ( a.response.status || retry >= options.retries() || !isTransient( a ) )
+        {
+            return a;
+        }
+        const auto delay = retryDelay( retry );
+        cDebug() << "Request for" << url << "failed" << a.response.status << a.response.httpStatus << "retry in"
+                 << delay.count() << "ms";
+        QEventLoop loop;
+        QTimer::singleShot( delay, &loop, &QEventLoop::quit );
+        loop.exec();
+    }
+}
+
 RequestStatus
 Manager::synchronousPing( const QUrl& url, const RequestOptions& options )
 {
@@ -331,33 +729,140 @@ Manager::synchronousPing( const QUrl& url, const RequestOptions& options )
         return RequestStatus::Failed;
     }
 
-    auto reply = synchronousRun( d->nam(), url, options );
-    if ( reply.first )
+    CacheEntry entry;
+    const Attempt a = d->run( url, options, entry, false );
+    if ( a.response.status )
     {
-        return reply.second->bytesAvailable() ? RequestStatus::Ok : RequestStatus::Empty;
+        return a.response.data.isEmpty() ? RequestStatus::Empty : RequestStatus::Ok;
     }
     else
     {
-        return reply.first;
+        return a.response.status;
     }
 }
 
 QByteArray
 Manager::synchronousGet( const QUrl& url, const RequestOptions& options )
+{
+    const Response r = synchronousRequest( url, options );
+    return r.status ? r.data : QByteArray();
+}
+
+Response
+Manager::synchronousRequest( const QUrl& url, const RequestOptions& options )
 {
     if ( !url.isValid() )
     {
-        return QByteArray();
+        Response r;
+        r.status = RequestStatus::Failed;
+        return r;
     }
 
-    auto reply = synchronousRun( d->nam(), url, options );
-    return reply.first ? reply.second->readAll() : QByteArray();
+    const bool useCache = !( options.flags() & RequestOptions::NoCache );
+    // The flags (e.g. the user agent) may change the response
+    const QString key = QString::number( int( options.flags() ) ) + ' ' + url.toString( QUrl::FullyEncoded );
+    CacheEntry entry;
+    bool haveEntry = false;
+    std::shared_ptr< InFlight > flight;
+    if ( useCache )
+    {
+        QMutexLocker lock( &d->m_requestMutex );
+        haveEntry = d->m_cache.find( key, entry );
+        if ( haveEntry && entry.isFresh() )
+        {
+            Response r;
+            r.data = entry.data;
+            r.fromCache = true;
+            return r;
+        }
+
+        // Wait for the same request from another thread, unless that might
+        // wait for this thread (which is then in a nested event loop)
+        auto* thread = QThread::currentThread();
+        auto it = d->m_inFlight.constFind( key );
+        if ( it != d->m_inFlight.constEnd() && it.value()->owner != thread && !d->hasConnection( thread ) )
+        {
+            const auto other = it.value();
+            while ( !other->done )
+            {
+                d->m_requestsChanged.wait( &d->m_requestMutex );
+            }
+            return other->response;
+        }
+        if ( it == d->m_inFlight.constEnd() )
+        {
+            flight = std::make_shared< InFlight >();
+            flight->owner = thread;
+            d->m_inFlight.insert( key, flight );
+        }
+    }
+
+    const Attempt a = d->run( url, options, entry, haveEntry && entry.canRevalidate() );
+
+    if ( useCache )
+    {
+        QMutexLocker lock( &d->m_requestMutex );
+        if ( a.response.status && a.store )
+        {
+            d->m_cache.insert( key, entry );
+        }
+        if ( flight )
+        {
+            flight->response = a.response;
+            flight->done = true;
+            d->m_inFlight.remove( key );
+            d->m_requestsChanged.wakeAll();
+        }
+    }
+    return a.response;
+}
+
+QFuture< Response >
+Manager::asynchronousRequest( const QUrl& url, const RequestOptions& options )
+{
+    return QtConcurrent::run( &d->m_pool, [ this, url, options ]() { return synchronousRequest( url, options ); } );
+}
+
+void
+Manager::setMemoryCacheLimit( qint64 bytes )
+{
+    QMutexLocker lock( &d->m_requestMutex );
+    d->m_cache.setMemoryLimit( bytes );
+}
+
+void
+Manager::setCacheDirectory( const QString& directory, qint64 bytes )
+{
+    QMutexLocker lock( &d->m_requestMutex );
+    d->m_cache.setDirectory( directory, bytes );
+}
+
+void
+Manager::clearCache()
+{
+    QMutexLocker lock( &d->m_requestMutex );
+    d->m_cache.clear();
+}
+
+void
+Manager::setMaximumConnectionsPerHost( int n )
+{
+    QMutexLocker lock( &d->m_requestMutex );
+    d->m_maxConnectionsPerHost = std::max( 1, n );
+    d->m_requestsChanged.wakeAll();
+}
+
+int
+Manager::maximumConnectionsPerHost() const
+{
+    QMutexLocker lock( &d->m_requestMutex );
+    return d->m_maxConnectionsPerHost;
 }
 
 QNetworkReply*
 Manager::asynchronousGet( const QUrl& url, const CalamaresUtils::Network::RequestOptions& options )
 {
-    return asynchronousRun( d->nam(), url, options );
+    return asynchronousRun( d->nam(), QNetworkRequest( url ), options );
 }
 
 QDebug&
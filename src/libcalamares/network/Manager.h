@@ -14,6 +14,7 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QFuture>
 #include <QObject>
 #include <QUrl>
 #include <QVector>
@@ -36,6 +37,7 @@ public:
     enum Flag
     {
         FollowRedirect = 0x1,
+        NoCache = 0x2,  ///< Do not use the response cache, nor share the request
         FakeUserAgent = 0x100
     };
     Q_DECLARE_FLAGS( Flags, Flag )
@@ -43,23 +45,35 @@ public:
     RequestOptions()
         : m_flags( Flags() )
         , m_timeout( -1 )
+        , m_retries( 0 )
     {
     }
 
-    RequestOptions( Flags f, milliseconds timeout = milliseconds( -1 ) )
+    /** @brief Options for a request
+     *
+     * The @p timeout applies to each attempt. Failed requests are
+     * tried again (at most @p retries times) if the failure looks
+     * like it is temporary: timeouts, connection problems and
+     * server errors (HTTP 5xx and 429), with exponential backoff.
+     */
+    RequestOptions( Flags f, milliseconds timeout = milliseconds( -1 ), int retries = 0 )
         : m_flags( f )
         , m_timeout( timeout )
+        , m_retries( retries )
     {
     }
 
     void applyToRequest( QNetworkRequest* ) const;
 
+    Flags flags() const { return m_flags; }
     bool hasTimeout() const { return m_timeout > milliseconds( 0 ); }
     auto timeout() const { return m_timeout; }
+    int retries() const { return m_retries; }
 
 private:
     Flags m_flags;
     milliseconds m_timeout;
+    int m_retries;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( RequestOptions::Flags );
@@ -86,6 +100,20 @@ struct RequestStatus
 
 QDebug& operator<<( QDebug& s, const RequestStatus& e );
 
+/** @brief The result of Manager::synchronousRequest() and asynchronousRequest()
+ *
+ * The @p data is only meaningful if the status is Ok.
+ */
+struct Response
+{
+    RequestStatus status;
+    QByteArray data;
+    /// The HTTP status code of the (last) reply, 0 if there was none
+    int httpStatus = 0;
+    /// Was the data served from the cache (possibly after revalidation)?
+    bool fromCache = false;
+};
+
 class DLLEXPORT Manager : public QObject
 {
     Q_OBJECT
@@ -121,6 +149,47 @@ public:
      */
     QByteArray synchronousGet( const QUrl& url, const RequestOptions& options = RequestOptions() );
 
+    /** @brief Downloads the data from a given @p url, through the cache
+     *
+     * This is the central request layer, which synchronousGet() also
+     * uses. It is safe to call from any thread.
+     *  - A fresh response in the (memory or disk) cache is returned without
+     *    a request. Stale responses with an ETag or Last-Modified are
+     *    revalidated with a conditional request. What is stored, and for
+     *    how long, follows the Cache-Control header of the response.
+     *  - Identical requests from different threads that are in flight
+     *    at the same time are done once, and all get the response.
+     *  - At most maximumConnectionsPerHost() requests run at a time for
+     *    a given host, the others wait.
+     *  - Failures are retried as described in RequestOptions.
+     *
+     * The NoCache option skips the cache and the sharing of requests.
+     */
+    Response synchronousRequest( const QUrl& url, const RequestOptions& options = RequestOptions() );
+
+    /** @brief Downloads the data from a given @p url, in the background
+     *
+     * This is synchronousRequest() run in a worker thread of the
+     * Manager, so it has the same caching, sharing and retries. Use
+     * a QFutureWatcher to be told when the response is there.
+     */
+    QFuture< Response > asynchronousRequest( const QUrl& url, const RequestOptions& options = RequestOptions() );
+
+    /// @brief Sets the memory budget of the response cache, in bytes
+    void setMemoryCacheLimit( qint64 bytes );
+    /** @brief Also keep responses in @p directory, up to @p bytes in total
+     *
+     * An empty @p directory switches off the on-disk cache, which
+     * is the default.
+     */
+    void setCacheDirectory( const QString& directory, qint64 bytes );
+    /// @brief Drops all responses from the cache (memory and disk)
+    void clearCache();
+
+    /// @brief Sets the number of concurrent requests to one host (at least 1)
+    void setMaximumConnectionsPerHost( int n );
+    int maximumConnectionsPerHost() const;
+
     /// @brief Set the URL which is used for the general "is there internet" check.
     void setCheckHasInternetUrl( const QUrl& url );
 
@@ -138,6 +207,7 @@ public:
      * Returns a pointer to the reply-from-the-request.
      * This may be a nullptr if an error occurs immediately.
      * The caller is responsible for cleaning up the reply (eventually).
+     * This does not use the cache, nor retries: see asynchronousRequest().
      */
     QNetworkReply* asynchronousGet( const QUrl& url, const RequestOptions& options = RequestOptions() );
 
@@ -12,8 +12,148 @@
 #include "Manager.h"
 #include "utils/Logger.h"
 
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtTest/QtTest>
 
+/** @brief A local stand-in for a web server
+ *
+ * Answers GET requests for a handful of paths:
+ *  - /fresh* : cacheable for a minute
+ *  - /etag*  : must be revalidated, has an ETag
+ *  - /nostore* : must not be cached
+ *  - /flaky* : fails with 503 the first @c failures times
+ *  - /slow/* : answers after a delay, not cacheable
+ * Everything else is 404.
+ */
+class HttpServer : public QObject
+{
+public:
+    HttpServer()
+    {
+        m_server.listen( QHostAddress::LocalHost );
+        connect( &m_server, &QTcpServer::newConnection, this, [ this ]() {
+            while ( QTcpSocket* socket = m_server.nextPendingConnection() )
+            {
+                connect( socket, &QTcpSocket::readyRead, this, [ this, socket ]() { read( socket ); } );
+            }
+        } );
+    }
+
+    QUrl url( const QString& path ) const
+    {
+        return QUrl( QStringLiteral( "http://127.0.0.1:%1%2" ).arg( m_server.serverPort() ).arg( path ) );
+    }
+
+    /// Requests per path
+    QHash< QString, int > requests;
+    /// Request headers of the last request per path
+    QHash< QString, QByteArray > headers;
+    int failures = 2;
+    int active = 0;
+    int maxActive = 0;
+
+private:
+    void read( QTcpSocket* socket )
+    {
+        QByteArray& request = m_pending[ socket ];
+        request.append( socket->readAll() );
+        const int headerEnd = request.indexOf( "\r\n\r\n" );
+        if ( headerEnd < 0 )
+        {
+            return;
+        }
+        const QString path = QString::fromLatin1( request.split( ' ' ).value( 1 ) );
+        const QByteArray requestHeaders = request.left( headerEnd );
+        m_pending.remove( socket );
+
+        const int count = ++requests[ path ];
+        headers[ path ] = requestHeaders;
+        maxActive = std::max( maxActive, ++active );
+
+        if ( path.startsWith( "/fresh" ) )
+        {
+            respond( socket, "200 OK", "Cache-Control: max-age=60\r\n", "fresh" );
+        }
+        else if ( path.startsWith( "/etag" ) )
+        {
+            if ( requestHeaders.contains( "If-None-Match: \"v1\"" ) )
+            {
+                respond( socket, "304 Not Modified", "ETag: \"v1\"\r\n", QByteArray() );
+            }
+            else
+            {
+                respond( socket, "200 OK", "ETag: \"v1\"\r\nCache-Control: no-cache\r\n", "etag" );
+            }
+        }
+        else if ( path.startsWith( "/nostore" ) )
+        {
+            respond( socket, "200 OK", "Cache-Control: no-store\r\n", "nostore-" + QByteArray::number( count ) );
+        }
+        else if ( path.startsWith( "/flaky" ) )
+        {
+            if ( count <= failures )
+            {
+                respond( socket, "503 Service Unavailable", QByteArray(), QByteArray() );
+            }
+            else
+            {
+                respond( socket, "200 OK", QByteArray(), "flaky" );
+            }
+        }
+        else if ( path.startsWith( "/slow/" ) )
+        {
+            QTimer::singleShot( 300, socket, [ this, socket, path ]() {
+                respond( socket, "200 OK", "Cache-Control: no-store\r\n", path.mid( 6 ).toLatin1() );
+            } );
+        }
+        else
+        {
+            respond( socket, "404 Not Found", QByteArray(), QByteArray() );
+        }
+    }
+
+    void respond( QTcpSocket* socket, const QByteArray& status, const QByteArray& extraHeaders, const QByteArray& body )
+    {
+        --active;
+        socket->write( "HTTP/1.1 " + status + "\r\nContent-Length: " + QByteArray::number( body.size() )
+                       + "\r\nConnection: close\r\n" + extraHeaders + "\r\n" + body );
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+    QHash< QTcpSocket*, QByteArray > m_pending;
+};
+
+void
+NetworkTests::testAsynchronousRequest()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    nam.clearCache();
+    HttpServer server;
+    const RequestOptions once( RequestOptions::Flags(), RequestOptions::milliseconds( -1 ), 1 );
+
+    auto fresh = nam.asynchronousRequest( server.url( "/fresh-async" ) );
+    QTRY_VERIFY( fresh.isFinished() );
+    QCOMPARE( fresh.result().data, QByteArray( "fresh" ) );
+    QVERIFY( !fresh.result().fromCache );
+
+    // Same cache as the synchronous requests
+    QVERIFY( nam.synchronousRequest( server.url( "/fresh-async" ) ).fromCache );
+    QCOMPARE( server.requests.value( "/fresh-async" ), 1 );
+
+    // .. and the same retries
+    auto flaky = nam.asynchronousRequest( server.url( "/flaky-async" ), once );
+    QTRY_VERIFY( flaky.isFinished() );
+    QVERIFY( !flaky.result().status );
+    QCOMPARE( server.requests.value( "/flaky-async" ), 2 );
+}
+
 QTEST_GUILESS_MAIN( NetworkTests )
 
 NetworkTests::NetworkTests() {}
@@ -145,3 +285,180 @@ NetworkTests::testCheckMultiUrl()
         QCOMPARE( nam.getCheckInternetUrls().count(), 1 );
     }
 }
+
+void
+NetworkTests::testCacheHeaders()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    nam.clearCache();
+    HttpServer server;
+
+    {
+        const auto first = nam.synchronousRequest( server.url( "/fresh" ) );
+        QVERIFY( first.status );
+        QCOMPARE( first.data, QByteArray( "fresh" ) );
+        QCOMPARE( first.httpStatus, 200 );
+        QVERIFY( !first.fromCache );
+        const auto second = nam.synchronousRequest( server.url( "/fresh" ) );
+        QCOMPARE( second.data, QByteArray( "fresh" ) );
+        QVERIFY( second.fromCache );
+        QCOMPARE( server.requests.value( "/fresh" ), 1 );
+        // Not shared with requests that skip the cache
+        QCOMPARE( nam.synchronousGet( server.url( "/fresh" ), RequestOptions( RequestOptions::NoCache ) ),
+                  QByteArray( "fresh" ) );
+        QCOMPARE( server.requests.value( "/fresh" ), 2 );
+    }
+    {
+        QCOMPARE( nam.synchronousGet( server.url( "/etag" ) ), QByteArray( "etag" ) );
+        QVERIFY( !server.headers.value( "/etag" ).contains( "If-None-Match" ) );
+        const auto revalidated = nam.synchronousRequest( server.url( "/etag" ) );
+        QCOMPARE( revalidated.data, QByteArray( "etag" ) );
+        QCOMPARE( revalidated.httpStatus, 304 );
+        QVERIFY( revalidated.fromCache );
+        QCOMPARE( server.requests.value( "/etag" ), 2 );
+        QVERIFY( server.headers.value( "/etag" ).contains( "If-None-Match: \"v1\"" ) );
+    }
+    {
+        QCOMPARE( nam.synchronousGet( server.url( "/nostore" ) ), QByteArray( "nostore-1" ) );
+        QCOMPARE( nam.synchronousGet( server.url( "/nostore" ) ), QByteArray( "nostore-2" ) );
+    }
+    {
+        const auto missing = nam.synchronousRequest( server.url( "/missing" ) );
+        QVERIFY( !missing.status );
+        QCOMPARE( missing.httpStatus, 404 );
+        QVERIFY( nam.synchronousGet( server.url( "/missing" ) ).isEmpty() );
+        QCOMPARE( server.requests.value( "/missing" ), 2 );
+    }
+
+    nam.clearCache();
+    QVERIFY( !nam.synchronousRequest( server.url( "/fresh" ) ).fromCache );
+    QCOMPARE( server.requests.value( "/fresh" ), 3 );
+}
+
+void
+NetworkTests::testDiskCache()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    nam.clearCache();
+    HttpServer server;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    nam.setCacheDirectory( dir.path(), 1024 * 1024 );
+    // Nothing is kept in memory, so it must come from disk
+    nam.setMemoryCacheLimit( 0 );
+
+    QCOMPARE( nam.synchronousGet( server.url( "/fresh-disk" ) ), QByteArray( "fresh" ) );
+    QCOMPARE( QDir( dir.path() ).entryList( { "*.cache" }, QDir::Files ).count(), 1 );
+    const auto cached = nam.synchronousRequest( server.url( "/fresh-disk" ) );
+    QVERIFY( cached.fromCache );
+    QCOMPARE( cached.data, QByteArray( "fresh" ) );
+    QCOMPARE( server.requests.value( "/fresh-disk" ), 1 );
+
+    // No room on disk, so the file is dropped
+    nam.setCacheDirectory( dir.path(), 0 );
+    QCOMPARE( QDir( dir.path() ).entryList( { "*.cache" }, QDir::Files ).count(), 0 );
+    QVERIFY( !nam.synchronousRequest( server.url( "/fresh-disk" ) ).fromCache );
+    QCOMPARE( server.requests.value( "/fresh-disk" ), 2 );
+
+    nam.setCacheDirectory( QString(), 0 );
+    nam.setMemoryCacheLimit( 8 * 1024 * 1024 );
+}
+
+void
+NetworkTests::testRetries()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    HttpServer server;
+    const RequestOptions once( RequestOptions::Flags(), RequestOptions::milliseconds( -1 ), 1 );
+    const RequestOptions thrice( RequestOptions::Flags(), RequestOptions::milliseconds( -1 ), 3 );
+
+    // Not enough retries
+    const auto failed = nam.synchronousRequest( server.url( "/flaky1" ), once );
+    QVERIFY( !failed.status );
+    QCOMPARE( failed.status.status, RequestStatus::HttpError );
+    QCOMPARE( failed.httpStatus, 503 );
+    QCOMPARE( server.requests.value( "/flaky1" ), 2 );
+
+    QElapsedTimer timer;
+    timer.start();
+    const auto ok = nam.synchronousRequest( server.url( "/flaky2" ), thrice );
+    QVERIFY( ok.status );
+    QCOMPARE( ok.data, QByteArray( "flaky" ) );
+    QCOMPARE( server.requests.value( "/flaky2" ), 3 );
+    // Backoff of 250ms, then 500ms
+    QVERIFY( timer.elapsed() >= 700 );
+
+    // Client errors are not retried
+    QVERIFY( !nam.synchronousRequest( server.url( "/missing" ), thrice ).status );
+    QCOMPARE( server.requests.value( "/missing" ), 1 );
+
+    // Neither is a ping, unless asked
+    QVERIFY( !nam.synchronousPing( server.url( "/flaky3" ) ) );
+    QCOMPARE( server.requests.value( "/flaky3" ), 1 );
+    QVERIFY( nam.synchronousPing( server.url( "/flaky3" ), once ) );
+    QCOMPARE( server.requests.value( "/flaky3" ), 3 );
+}
+
+void
+NetworkTests::testInFlight()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    HttpServer server;
+    QThreadPool pool;
+    pool.setMaxThreadCount( 4 );
+
+    auto get = [ & ]( const QString& path ) { return nam.synchronousGet( server.url( path ) ); };
+    auto first = QtConcurrent::run( &pool, get, QStringLiteral( "/slow/shared" ) );
+    auto second = QtConcurrent::run( &pool, get, QStringLiteral( "/slow/shared" ) );
+    QTRY_VERIFY( first.isFinished() && second.isFinished() );
+    QCOMPARE( first.result(), QByteArray( "shared" ) );
+    QCOMPARE( second.result(), QByteArray( "shared" ) );
+    QCOMPARE( server.requests.value( "/slow/shared" ), 1 );
+
+    // The response is not cacheable, so later requests go to the server
+    QCOMPARE( get( "/slow/shared" ), QByteArray( "shared" ) );
+    QCOMPARE( server.requests.value( "/slow/shared" ), 2 );
+    pool.waitForDone();
+}
+
+void
+NetworkTests::testHostLimit()
+{
+    using namespace CalamaresUtils::Network;
+    auto& nam = Manager::instance();
+    HttpServer server;
+    QThreadPool pool;
+    pool.setMaxThreadCount( 4 );
+    auto get = [ & ]( const QString& path ) { return nam.synchronousGet( server.url( path ) ); };
+    auto isFinished = []( const QFuture< QByteArray >& f ) { return f.isFinished(); };
+
+    QCOMPARE( nam.maximumConnectionsPerHost(), 4 );
+    nam.setMaximumConnectionsPerHost( 1 );
+    {
+        QList< QFuture< QByteArray > > futures;
+        for ( const auto& path : { "/slow/a", "/slow/b", "/slow/c" } )
+        {
+            futures.append( QtConcurrent::run( &pool, get, QString( path ) ) );
+        }
+        QTRY_VERIFY( std::all_of( futures.cbegin(), futures.cend(), isFinished ) );
+        QCOMPARE( futures.at( 2 ).result(), QByteArray( "c" ) );
+        QCOMPARE( server.maxActive, 1 );
+    }
+
+    nam.setMaximumConnectionsPerHost( 4 );
+    {
+        QList< QFuture< QByteArray > > futures;
+        for ( const auto& path : { "/slow/d", "/slow/e", "/slow/f" } )
+        {
+            futures.append( QtConcurrent::run( &pool, get, QString( path ) ) );
+        }
+        QTRY_VERIFY( std::all_of( futures.cbegin(), futures.cend(), isFinished ) );
+        QVERIFY( server.maxActive > 1 );
+    }
+    pool.waitForDone();
+}
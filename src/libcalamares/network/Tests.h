@@ -27,6 +27,13 @@ private Q_SLOTS:
 
     void testCheckUrl();
     void testCheckMultiUrl();
+
+    void testCacheHeaders();
+    void testDiskCache();
+    void testRetries();
+    void testInFlight();
+    void testHostLimit();
+    void testAsynchronousRequest();
 };
 
 #endif
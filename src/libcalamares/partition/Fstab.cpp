@@ -0,0 +1,419 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2014 Aurélien Gâteau <agateau@kde.org>
+ *   SPDX-FileCopyrightText: 2016 Teo Mrnjavac <teo@kde.org>
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Fstab.h"
+
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QUuid>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include <algorithm>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+static const char FSTAB_HEADER[]
+    = "# /etc/fstab: static file system information.\n"
+      "#\n"
+      "# Use 'blkid' to print the universally unique identifier for a device; this may\n"
+      "# be used with UUID= as a more robust way to name devices that works even if\n"
+      "# disks are added and removed. See fstab(5).\n"
+      "#\n"
+      "# <file system>             <mount point>  <type>  <options>  <dump>  <pass>\n";
+
+static const char CRYPTTAB_HEADER[]
+    = "# /etc/crypttab: mappings for encrypted partitions.\n"
+      "#\n"
+      "# Each mapped device will be created in /dev/mapper, so your /etc/fstab\n"
+      "# should use the /dev/mapper/<name> paths for encrypted devices.\n"
+      "#\n"
+      "# See crypttab(5) for the supported syntax.\n"
+      "#\n"
+      "# NOTE: Do not list your root (/) partition here, it must be set up\n"
+      "#       beforehand by the initramfs (/etc/mkinitcpio.conf). The same applies\n"
+      "#       to encrypted swap, which should be set up with mkinitcpio-openswap\n"
+      "#       for resume support.\n"
+      "#\n"
+      "# <name>               <device>                         <password> <options>\n";
+
+/// @brief Turn Parted filesystem names into fstab names
+static QString
+fstabFilesystem( const QString& fs )
+{
+    const QString name = fs.toLower();
+    if ( name == QStringLiteral( "fat16" ) || name == QStringLiteral( "fat32" ) )
+    {
+        return QStringLiteral( "vfat" );
+    }
+    if ( name == QStringLiteral( "linuxswap" ) )
+    {
+        return QStringLiteral( "swap" );
+    }
+    return name;
+}
+
+QString
+FstabEntry::toString() const
+{
+    return QStringLiteral( "%1 %2 %3 %4 0 %5" )
+        .arg( device, -41 )
+        .arg( mountPoint, -14 )
+        .arg( fs, -7 )
+        .arg( options, -10 )
+        .arg( check );
+}
+
+QString
+CrypttabEntry::toString() const
+{
+    return QStringLiteral( "%1 %2 %3 %4" ).arg( name, -21 ).arg( device, -45 ).arg( password, options );
+}
+
+FstabGenerator::FstabGenerator( const QVariantMap& mountOptions,
+                                const QVariantMap& ssdExtraMountOptions,
+                                const QString& crypttabOptions )
+    : m_mountOptions( mountOptions )
+    , m_ssdExtraMountOptions( ssdExtraMountOptions )
+    , m_crypttabOptions( crypttabOptions )
+{
+}
+
+void
+FstabGenerator::setEfiMountOptions( const QString& mountPoint, const QString& options )
+{
+    m_efiMountPoint = mountPoint;
+    m_efiMountOptions = options;
+}
+
+QString
+FstabGenerator::diskName( const QString& devicePath ) const
+{
+    const QString name = QFileInfo( devicePath ).fileName();
+
+    // In sysfs, a partition is a subdirectory of its disk
+    const QFileInfo device( m_sysfsRoot + QStringLiteral( "/class/block/" ) + name );
+    if ( device.exists() && QFileInfo::exists( device.filePath() + QStringLiteral( "/partition" ) ) )
+    {
+        return QFileInfo( QFileInfo( device.canonicalFilePath() ).path() ).fileName();
+    }
+    if ( device.exists() )
+    {
+        return name;
+    }
+
+    // Not in sysfs (e.g. a swap file), so guess from the name
+    static const QRegularExpression numberedDisk( QStringLiteral( "^(mmcblk|nvme|loop)" ) );
+    static const QRegularExpression pPartition( QStringLiteral( "(?<=[0-9])p[0-9]+$" ) );
+    static const QRegularExpression partition( QStringLiteral( "[0-9]+$" ) );
+    QString disk( name );
+    return disk.remove( numberedDisk.match( name ).hasMatch() ? pPartition : partition );
+}
+
+bool
+FstabGenerator::isSsd( const QString& devicePath )
+{
+    const QString disk = diskName( devicePath );
+    auto it = m_ssdDisks.constFind( disk );
+    if ( it != m_ssdDisks.constEnd() )
+    {
+        return it.value();
+    }
+
+    QFile rotational( m_sysfsRoot + QStringLiteral( "/block/" ) + disk + QStringLiteral( "/queue/rotational" ) );
+    // Should not fail unless sysfs changes, but better safe than sorry
+    const bool ssd = rotational.open( QIODevice::ReadOnly ) && rotational.readAll().trimmed() == "0";
+    m_ssdDisks.insert( disk, ssd );
+    return ssd;
+}
+
+QString
+FstabGenerator::mountOptions( const QString& fs, const QString& mountPoint ) const
+{
+    if ( !m_efiMountPoint.isEmpty() && mountPoint == m_efiMountPoint )
+    {
+        return m_efiMountOptions;
+    }
+    return m_mountOptions.value( fs, m_mountOptions.value( QStringLiteral( "default" ) ) ).toString();
+}
+
+/** @brief The fstab line for @p partition mounted at @p mountPoint
+ *
+ * Returns an entry with an empty mount point if the partition
+ * does not belong in fstab.
+ */
+FstabEntry
+FstabGenerator::entry( const QVariantMap& partition, const QString& mountPoint, const QString& subvolume )
+{
+    FstabEntry e;
+    e.fs = fstabFilesystem( getString( partition, "fs" ) );
+    const QString device = getString( partition, "device" );
+
+    // Swap partitions are called "linuxswap" by parted, which is mapped
+    // to "swap" (the spelling needed in /etc/fstab) above.
+    if ( mountPoint.isEmpty() && e.fs != QStringLiteral( "swap" ) )
+    {
+        return FstabEntry();
+    }
+    if ( e.fs == QStringLiteral( "swap" ) && !getBool( partition, "claimed", false ) )
+    {
+        cDebug() << "Ignoring foreign swap" << device << getString( partition, "uuid" );
+        return FstabEntry();
+    }
+    e.mountPoint = mountPoint.isEmpty() ? QStringLiteral( "swap" ) : mountPoint;
+
+    const bool ssd = isSsd( device );
+    e.options = mountOptions( e.fs, e.mountPoint );
+    const QString extra = m_ssdExtraMountOptions.value( e.fs ).toString();
+    if ( ssd && !extra.isEmpty() )
+    {
+        e.options += ',' + extra;
+    }
+    if ( e.fs == QStringLiteral( "btrfs" ) && !subvolume.isEmpty() )
+    {
+        e.options = QStringLiteral( "subvol=%1," ).arg( subvolume ) + e.options;
+    }
+
+    if ( e.fs == QStringLiteral( "btrfs" ) || e.fs == QStringLiteral( "swap" ) )
+    {
+        e.check = 0;
+    }
+    else
+    {
+        e.check = e.mountPoint == QStringLiteral( "/" ) ? 1 : 2;
+    }
+    if ( e.mountPoint == QStringLiteral( "/" ) )
+    {
+        m_rootIsSsd = ssd;
+    }
+
+    if ( partition.contains( "luksMapperName" ) )
+    {
+        e.device = QStringLiteral( "/dev/mapper/" ) + getString( partition, "luksMapperName" );
+    }
+    else if ( !getString( partition, "uuid" ).isEmpty() )
+    {
+        e.device = QStringLiteral( "UUID=" ) + getString( partition, "uuid" );
+    }
+    else
+    {
+        e.device = device;
+    }
+    return e;
+}
+
+QList< FstabEntry >
+FstabGenerator::fstabEntries( const QVariantList& partitions, const QVariantList& btrfsSubvolumes )
+{
+    QList< FstabEntry > entries;
+    m_rootIsSsd = false;
+
+    auto append = [ &entries ]( const FstabEntry& e ) {
+        if ( !e.mountPoint.isEmpty() )
+        {
+            entries.append( e );
+        }
+    };
+    for ( const auto& v : partitions )
+    {
+        const QVariantMap partition = v.toMap();
+        const QString mountPoint = getString( partition, "mountPoint" );
+        if ( fstabFilesystem( getString( partition, "fs" ) ) == QStringLiteral( "btrfs" )
+             && mountPoint == QStringLiteral( "/" ) )
+        {
+            // The subvolumes have been curated by the mount module,
+            // so they all belong in fstab.
+            for ( const auto& s : btrfsSubvolumes )
+            {
+                const QVariantMap subvolume = s.toMap();
+                append( entry( partition, getString( subvolume, "mountPoint" ), getString( subvolume, "subvolume" ) ) );
+            }
+        }
+        else
+        {
+            append( entry( partition, mountPoint, QString() ) );
+        }
+    }
+
+    if ( m_rootIsSsd )
+    {
+        FstabEntry tmp;
+        tmp.device = tmp.fs = QStringLiteral( "tmpfs" );
+        tmp.mountPoint = QStringLiteral( "/tmp" );
+        tmp.options = QStringLiteral( "defaults,noatime,mode=1777" );
+        entries.append( tmp );
+    }
+    return entries;
+}
+
+QList< CrypttabEntry >
+FstabGenerator::crypttabEntries( const QVariantList& partitions ) const
+{
+    QList< CrypttabEntry > entries;
+    for ( const auto& v : partitions )
+    {
+        const QVariantMap partition = v.toMap();
+        const QString mapperName = getString( partition, "luksMapperName" );
+        const QString luksUuid = getString( partition, "luksUuid" );
+        if ( mapperName.isEmpty() || luksUuid.isEmpty() )
+        {
+            continue;
+        }
+        entries.append( CrypttabEntry { mapperName,
+                                        QStringLiteral( "UUID=" ) + luksUuid,
+                                        QStringLiteral( "/crypto_keyfile.bin" ),
+                                        m_crypttabOptions } );
+    }
+    return entries;
+}
+
+QString
+fstabContents( const QList< FstabEntry >& entries )
+{
+    QString s = QString::fromLatin1( FSTAB_HEADER );
+    for ( const auto& e : entries )
+    {
+        s += e.toString() + '\n';
+    }
+    return s;
+}
+
+QString
+crypttabContents( const QList< CrypttabEntry >& entries )
+{
+    QString s = QString::fromLatin1( CRYPTTAB_HEADER );
+    for ( const auto& e : entries )
+    {
+        s += e.toString() + '\n';
+    }
+    return s;
+}
+
+/// @brief Allocate @p size bytes, in case fallocate() isn't supported
+static bool
+writeZeroes( int fd, qint64 size )
+{
+    static constexpr qint64 bufferSize = 1024 * 1024;
+    const QByteArray zeroes( int( std::min( bufferSize, size ) ), '\0' );
+    for ( qint64 offset = 0; offset < size; )
+    {
+        const ssize_t w
+            = pwrite( fd, zeroes.constData(), size_t( std::min( qint64( zeroes.size() ), size - offset ) ), offset );
+        if ( w < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( w <= 0 )
+        {
+            return false;
+        }
+        offset += w;
+    }
+    return true;
+}
+
+/** @brief Writes a version-1 swap header, like mkswap(8)
+ *
+ * The header occupies the first page: the fields start after
+ * 1024 bytes of boot-loader space, and the signature is in
+ * the last ten bytes of the page.
+ */
+static bool
+writeSwapHeader( int fd, qint64 size )
+{
+    const long pageSize = sysconf( _SC_PAGESIZE );
+    const qint64 pages = size / pageSize;
+    if ( pages < 10 )
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    QByteArray page( int( pageSize ), '\0' );
+    const quint32 info[ 3 ] = { 1, quint32( pages - 1 ), 0 };  // version, last_page, nr_badpages
+    memcpy( page.data() + 1024, info, sizeof( info ) );
+    const QByteArray uuid = QUuid::createUuid().toRfc4122();
+    memcpy( page.data() + 1024 + sizeof( info ), uuid.constData(), size_t( uuid.size() ) );
+    memcpy( page.data() + pageSize - 10, "SWAPSPACE2", 10 );
+
+    return pwrite( fd, page.constData(), size_t( page.size() ), 0 ) == page.size() && fsync( fd ) == 0;
+}
+
+QString
+createSwapFile( const QString& path, qint64 size, bool noCopyOnWrite )
+{
+    const int fd = open( QFile::encodeName( path ).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+    if ( fd < 0 )
+    {
+        return QStringLiteral( "Could not create %1: %2" ).arg( path, QString::fromLocal8Bit( strerror( errno ) ) );
+    }
+    auto fail = [ fd, &path ]( const char* what ) {
+        const QString message = QStringLiteral( "Could not %1 %2: %3" )
+                                    .arg( QLatin1String( what ), path, QString::fromLocal8Bit( strerror( errno ) ) );
+        close( fd );
+        return message;
+    };
+
+    if ( noCopyOnWrite )
+    {
+        // The file must still be empty for this to take effect
+#if defined( FS_IOC_SETFLAGS ) && defined( FS_NOCOW_FL )
+        int flags = 0;
+        if ( ioctl( fd, FS_IOC_GETFLAGS, &flags ) != 0 )
+        {
+            flags = 0;
+        }
+        flags |= FS_NOCOW_FL;
+        if ( ioctl( fd, FS_IOC_SETFLAGS, &flags ) != 0 )
+        {
+            cWarning() << "Could not disable copy-on-write for" << path << strerror( errno );
+        }
+#else
+        cWarning() << "Copy-on-write can not be disabled for" << path;
+#endif
+    }
+    // The umask may have gotten in the way when creating the file
+    if ( fchmod( fd, 0600 ) != 0 )
+    {
+        return fail( "set permissions of" );
+    }
+
+    if ( posix_fallocate( fd, 0, size ) != 0 && !writeZeroes( fd, size ) )
+    {
+        return fail( "allocate" );
+    }
+    if ( !writeSwapHeader( fd, size ) )
+    {
+        return fail( "write swap header to" );
+    }
+    close( fd );
+    return QString();
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
@@ -0,0 +1,136 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/*
+ * Generating /etc/fstab and /etc/crypttab from the *partitions*
+ * global storage entry, and creating swap files.
+ */
+
+#ifndef PARTITION_FSTAB_H
+#define PARTITION_FSTAB_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/// @brief One line of /etc/fstab
+struct DLLEXPORT FstabEntry
+{
+    QString device;
+    QString mountPoint;
+    QString fs;
+    QString options;
+    int check = 0;
+
+    QString toString() const;
+};
+
+/// @brief One line of /etc/crypttab
+struct DLLEXPORT CrypttabEntry
+{
+    QString name;
+    QString device;
+    QString password;
+    QString options;
+
+    QString toString() const;
+};
+
+/** @brief Generates fstab and crypttab entries from partition information
+ *
+ * The partitions are those of global storage *partitions*, as
+ * filled in by the partition module: maps with keys *device*,
+ * *fs*, *mountPoint*, *uuid*, *claimed*, and for encrypted
+ * partitions *luksMapperName* and *luksUuid*.
+ *
+ * Whether a disk is an SSD is read from sysfs, once per disk.
+ */
+class DLLEXPORT FstabGenerator
+{
+public:
+    /** @brief Configure the generator
+     *
+     * The @p mountOptions map filesystem names to mount options,
+     * with key *default* for filesystems that are not listed. The
+     * @p ssdExtraMountOptions are added to those for filesystems on
+     * an SSD (there is no default).
+     */
+    FstabGenerator( const QVariantMap& mountOptions,
+                    const QVariantMap& ssdExtraMountOptions,
+                    const QString& crypttabOptions );
+
+    /// @brief Use @p options for the filesystem mounted at @p mountPoint (the ESP)
+    void setEfiMountOptions( const QString& mountPoint, const QString& options );
+    /// @brief Where sysfs lives, for testing against a synthetic device tree
+    void setSysfsRoot( const QString& path ) { m_sysfsRoot = path; }
+
+    /** @brief The fstab entries for @p partitions
+     *
+     * A btrfs root filesystem gets one entry for each of the
+     * @p btrfsSubvolumes (maps with keys *mountPoint* and *subvolume*)
+     * instead. If the root filesystem is on an SSD, /tmp goes on tmpfs.
+     */
+    QList< FstabEntry > fstabEntries( const QVariantList& partitions, const QVariantList& btrfsSubvolumes );
+    QList< CrypttabEntry > crypttabEntries( const QVariantList& partitions ) const;
+
+    /** @brief Name of the disk that partition @p devicePath is on
+     *
+     * E.g. "nvme0n1" for /dev/nvme0n1p2. This looks at the
+     * partition in sysfs, and falls back to stripping the
+     * partition number from the name.
+     */
+    QString diskName( const QString& devicePath ) const;
+    /// @brief Is the disk that @p devicePath is on non-rotational?
+    bool isSsd( const QString& devicePath );
+
+private:
+    FstabEntry entry( const QVariantMap& partition, const QString& mountPoint, const QString& subvolume );
+    QString mountOptions( const QString& fs, const QString& mountPoint ) const;
+
+    QVariantMap m_mountOptions;
+    QVariantMap m_ssdExtraMountOptions;
+    QString m_crypttabOptions;
+    QString m_efiMountPoint;
+    QString m_efiMountOptions;
+    QString m_sysfsRoot = QStringLiteral( "/sys" );
+    QHash< QString, bool > m_ssdDisks;  ///< Cache, per disk name
+    bool m_rootIsSsd = false;
+};
+
+/// @brief The complete /etc/fstab contents, with header
+DLLEXPORT QString fstabContents( const QList< FstabEntry >& entries );
+/// @brief The complete /etc/crypttab contents, with header
+DLLEXPORT QString crypttabContents( const QList< CrypttabEntry >& entries );
+
+/** @brief Creates a swap file of @p size bytes at @p path
+ *
+ * The space is allocated with fallocate(), the file is made
+ * private, and the swap signature is written directly (like
+ * mkswap does). With @p noCopyOnWrite, the file is marked
+ * NOCOW first, which btrfs requires for swap files (this
+ * also switches off compression for the file).
+ *
+ * Returns an empty string on success, or an explanation of
+ * what went wrong.
+ */
+DLLEXPORT QString createSwapFile( const QString& path, qint64 size, bool noCopyOnWrite );
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -14,17 +14,42 @@
 #include "partition/Sync.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/Variant.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
 #include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/btrfs.h>
+#endif
+
+#include <algorithm>
+#include <functional>
 
 namespace CalamaresUtils
 {
 namespace Partition
 {
 
-int
-mount( const QString& devicePath, const QString& mountPoint, const QString& filesystemName, const QString& options )
+/// @brief Runs mount(8), without waiting for the disks to settle
+static int
+mountNoSync( const QString& devicePath,
+             const QString& mountPoint,
+             const QString& filesystemName,
+             const QString& options )
 {
     if ( devicePath.isEmpty() || mountPoint.isEmpty() )
     {
@@ -70,9 +95,15 @@ mount( const QString& devicePath, const QString& mountPoint, const QString& file
     }
     args << devicePath << mountPoint;
 
-    auto r = CalamaresUtils::System::runCommand( args, std::chrono::seconds( 10 ) );
+    return CalamaresUtils::System::runCommand( args, std::chrono::seconds( 10 ) ).getExitCode();
+}
+
+int
+mount( const QString& devicePath, const QString& mountPoint, const QString& filesystemName, const QString& options )
+{
+    const int r = mountNoSync( devicePath, mountPoint, filesystemName, options );
     sync();
-    return r.getExitCode();
+    return r;
 }
 
 int
@@ -123,5 +154,240 @@ TemporaryMount::path() const
     return m_d ? m_d->m_mountDir.path() : QString();
 }
 
+QString
+createBtrfsSubvolume( const QString& path )
+{
+#ifdef __linux__
+    const QFileInfo fi( path );
+    const QByteArray name = QFile::encodeName( fi.fileName() );
+    if ( name.isEmpty() || name.length() > BTRFS_PATH_NAME_MAX )
+    {
+        return QStringLiteral( "Invalid subvolume name %1" ).arg( path );
+    }
+    if ( !QDir().mkpath( fi.path() ) )
+    {
+        return QStringLiteral( "Could not create directory %1" ).arg( fi.path() );
+    }
+
+    const int fd = open( QFile::encodeName( fi.path() ).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return QStringLiteral( "Could not open %1: %2" ).arg( fi.path(), QString::fromLocal8Bit( strerror( errno ) ) );
+    }
+    struct btrfs_ioctl_vol_args args;
+    memset( &args, 0, sizeof( args ) );
+    memcpy( args.name, name.constData(), size_t( name.length() ) );
+    const int r = ioctl( fd, BTRFS_IOC_SUBVOL_CREATE, &args );
+    const int error = errno;
+    close( fd );
+    if ( r != 0 && error != EEXIST )
+    {
+        return QStringLiteral( "Could not create subvolume %1: %2" )
+            .arg( path, QString::fromLocal8Bit( strerror( error ) ) );
+    }
+    return QString();
+#else
+    return QStringLiteral( "Could not create subvolume %1: btrfs is not supported." ).arg( path );
+#endif
+}
+
+/// @brief Is @p mountPoint @p parent, or inside it?
+static bool
+isInside( const QString& mountPoint, const QString& parent )
+{
+    return parent == QStringLiteral( "/" ) || mountPoint == parent || mountPoint.startsWith( parent + '/' );
+}
+
+MountPlan::MountPlan( const QVariantList& partitions, const QVariantList& btrfsSubvolumes )
+{
+    for ( const auto& v : partitions )
+    {
+        const QVariantMap partition = v.toMap();
+        MountEntry e;
+        e.mountPoint = getString( partition, "mountPoint" );
+        if ( e.mountPoint.isEmpty() )
+        {
+            continue;
+        }
+        e.fs = getString( partition, "fs" ).toLower();
+        if ( e.fs == QStringLiteral( "fat16" ) || e.fs == QStringLiteral( "fat32" ) )
+        {
+            e.fs = QStringLiteral( "vfat" );
+        }
+        e.device = partition.contains( "luksMapperName" )
+            ? QStringLiteral( "/dev/mapper/" ) + getString( partition, "luksMapperName" )
+            : getString( partition, "device" );
+        e.options = getString( partition, "options" );
+
+        if ( e.mountPoint == QStringLiteral( "/" ) && e.fs == QStringLiteral( "btrfs" ) && !btrfsSubvolumes.isEmpty() )
+        {
+            m_btrfsDevice = e.device;
+            m_btrfsOptions = e.options;
+            for ( const auto& s : btrfsSubvolumes )
+            {
+                const QVariantMap subvolume = s.toMap();
+                MountEntry sub( e );
+                sub.mountPoint = getString( subvolume, "mountPoint" );
+                m_subvolumes.append( getString( subvolume, "subvolume" ) );
+                sub.options = QStringLiteral( "subvol=" ) + m_subvolumes.last()
+                    + ( e.options.isEmpty() ? QString() : ',' + e.options );
+                m_entries.append( sub );
+            }
+        }
+        else
+        {
+            m_entries.append( e );
+        }
+    }
+
+    // Sorting means that a filesystem comes after the ones it is mounted on;
+    // the nearest of those is the parent.
+    std::stable_sort( m_entries.begin(), m_entries.end(), []( const MountEntry& a, const MountEntry& b ) {
+        return a.mountPoint < b.mountPoint;
+    } );
+    for ( int i = 0; i < m_entries.count(); ++i )
+    {
+        for ( int j = i - 1; j >= 0; --j )
+        {
+            if ( isInside( m_entries[ i ].mountPoint, m_entries[ j ].mountPoint ) )
+            {
+                m_entries[ i ].parent = j;
+                m_entries[ i ].depth = m_entries[ j ].depth + 1;
+                break;
+            }
+        }
+    }
+}
+
+/// @brief Mounts one filesystem @p e in @p rootMountPoint
+static bool
+mountEntry( const QString& rootMountPoint, const MountEntry& e )
+{
+    const QString mountPoint = rootMountPoint + e.mountPoint;
+    if ( !QDir().mkpath( mountPoint ) )
+    {
+        cWarning() << "Could not create mountpoint" << mountPoint;
+        return false;
+    }
+
+    // Ensure that the created directory has the correct SELinux context
+    // on SELinux-enabled systems.
+    static const QString chcon = QStandardPaths::findExecutable( QStringLiteral( "chcon" ) );
+    if ( !chcon.isEmpty() && QFileInfo::exists( e.mountPoint ) )
+    {
+        CalamaresUtils::System::runCommand( { chcon, QStringLiteral( "--reference=" ) + e.mountPoint, mountPoint },
+                                            std::chrono::seconds( 10 ) );
+    }
+
+    if ( e.fs == QStringLiteral( "unformatted" ) )
+    {
+        return true;
+    }
+    return mountNoSync( e.device, mountPoint, e.fs, e.options ) == 0;
+}
+
+QString
+MountPlan::execute( const QString& rootMountPoint, QStringList* failed ) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    cDebug() << "Mount plan in" << rootMountPoint;
+    for ( const auto& e : m_entries )
+    {
+        cDebug() << Logger::SubEntry << Logger::NoQuote
+                 << QStringLiteral( "%1%2 %3 %4 %5" )
+                        .arg( QString( 2 * e.depth, ' ' ), e.mountPoint, e.device, e.fs, e.options );
+    }
+
+    if ( !m_btrfsDevice.isEmpty() )
+    {
+        // The top level, mounted with the same options as the subvolumes will be
+        const QString options = QStringLiteral( "subvolid=5" )
+            + ( m_btrfsOptions.isEmpty() ? QString() : ',' + m_btrfsOptions );
+        TemporaryMount topLevel( m_btrfsDevice, QStringLiteral( "btrfs" ), options );
+        if ( !topLevel.isValid() )
+        {
+            return QStringLiteral( "Could not mount btrfs filesystem %1" ).arg( m_btrfsDevice );
+        }
+        for ( const auto& s : m_subvolumes )
+        {
+            const QString error = createBtrfsSubvolume( topLevel.path() + s );
+            if ( !error.isEmpty() )
+            {
+                return error;
+            }
+        }
+        cDebug() << "Created" << m_subvolumes.count() << "btrfs subvolumes in" << timer.elapsed() << "ms";
+    }
+
+    // Each filesystem is mounted by a task that, once done, starts
+    // the tasks for the filesystems mounted on it.
+    QThreadPool pool;
+    QMutex failedMutex;
+    QStringList failedMounts;
+    std::function< void( int ) > mountTree = [ & ]( int index ) {
+        const MountEntry& e = m_entries[ index ];
+        QElapsedTimer mountTimer;
+        mountTimer.start();
+        const bool ok = mountEntry( rootMountPoint, e );
+        if ( ok )
+        {
+            cDebug() << "Mounted" << e.mountPoint << "in" << mountTimer.elapsed() << "ms";
+        }
+        else
+        {
+            cWarning() << "Cannot mount" << e.device << "on" << e.mountPoint;
+        }
+
+        for ( int child = index + 1; child < m_entries.count(); ++child )
+        {
+            int ancestor = m_entries[ child ].parent;
+            while ( ancestor > index )
+            {
+                ancestor = m_entries[ ancestor ].parent;
+            }
+            if ( ancestor != index )
+            {
+                continue;
+            }
+            if ( !ok )
+            {
+                // Descendants of a failed mount would end up on the wrong filesystem
+                QMutexLocker lock( &failedMutex );
+                failedMounts.append( m_entries[ child ].mountPoint );
+            }
+            else if ( m_entries[ child ].parent == index )
+            {
+                QtConcurrent::run( &pool, [ &mountTree, child ] { mountTree( child ); } );
+            }
+        }
+        if ( !ok )
+        {
+            QMutexLocker lock( &failedMutex );
+            failedMounts.append( e.mountPoint );
+        }
+    };
+    for ( int i = 0; i < m_entries.count(); ++i )
+    {
+        if ( m_entries[ i ].parent < 0 )
+        {
+            QtConcurrent::run( &pool, [ &mountTree, i ] { mountTree( i ); } );
+        }
+    }
+    // This includes the tasks that are started by other tasks
+    pool.waitForDone();
+    sync();
+
+    cDebug() << "Mounted" << ( m_entries.count() - failedMounts.count() ) << "of" << m_entries.count()
+             << "filesystems in" << timer.elapsed() << "ms";
+    if ( failed )
+    {
+        failedMounts.sort();
+        *failed = failedMounts;
+    }
+    return QString();
+}
+
 }  // namespace Partition
 }  // namespace CalamaresUtils
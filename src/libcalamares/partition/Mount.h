@@ -14,8 +14,10 @@
 
 #include "DllMacro.h"
 
+#include <QList>
 #include <QString>
 #include <QStringList>
+#include <QVariantList>
 
 #include <memory>
 
@@ -68,6 +70,79 @@ private:
     std::unique_ptr< Private > m_d;
 };
 
+/** @brief Creates btrfs subvolume @p path
+ *
+ * The parent directory of @p path must be on a mounted btrfs
+ * filesystem. This uses the btrfs ioctl directly, rather than
+ * running btrfs(8). A subvolume that already exists is not an error.
+ *
+ * Returns an empty string on success, or an explanation of
+ * what went wrong.
+ */
+DLLEXPORT QString createBtrfsSubvolume( const QString& path );
+
+/// @brief One mount in a MountPlan
+struct DLLEXPORT MountEntry
+{
+    QString device;  ///< Device path, or e.g. "proc"
+    QString mountPoint;  ///< Relative to the root of the target system
+    QString fs;  ///< Filesystem type, may be empty (e.g. for bind mounts)
+    QString options;  ///< Options for mount -o
+    int parent = -1;  ///< Index of the entry whose filesystem this is mounted on
+    int depth = 0;  ///< Number of mounts this is nested in
+};
+
+/** @brief Mounts the filesystems of the target system
+ *
+ * The plan is computed from the *partitions* list in global storage,
+ * together with any extra mounts (e.g. /proc and /dev). Each filesystem
+ * is mounted after the one its mount point lives on, which makes the
+ * mounts a tree: separate branches of the tree (e.g. /boot/efi and /home)
+ * are mounted concurrently.
+ *
+ * A btrfs root filesystem is mounted as its subvolumes: the subvolumes
+ * are created first, and then each is mounted on its own mount point.
+ */
+class DLLEXPORT MountPlan
+{
+public:
+    /** @brief Plan the mounts for @p partitions
+     *
+     * The partitions are maps with keys *device*, *mountPoint*,
+     * *fs*, *options* and optionally *luksMapperName*, as in
+     * global storage. Those without a mount point are skipped.
+     * The @p btrfsSubvolumes are maps with keys *mountPoint* and
+     * *subvolume*; they are used if the root filesystem is btrfs.
+     */
+    explicit MountPlan( const QVariantList& partitions, const QVariantList& btrfsSubvolumes = QVariantList() );
+
+    /// @brief The mounts, in order of mount point
+    const QList< MountEntry >& entries() const { return m_entries; }
+    /// @brief The btrfs device whose subvolumes are mounted (may be empty)
+    QString btrfsDevice() const { return m_btrfsDevice; }
+    /// @brief The subvolumes to create on the btrfsDevice()
+    QStringList btrfsSubvolumes() const { return m_subvolumes; }
+    /// @brief The mount options of the btrfsDevice(), also used to create the subvolumes
+    QString btrfsOptions() const { return m_btrfsOptions; }
+
+    /** @brief Create subvolumes and mount everything in @p rootMountPoint
+     *
+     * Failure to mount a filesystem is logged, and the filesystems
+     * that would be mounted on it are skipped. Those mount points
+     * are returned in @p failed.
+     *
+     * Returns an empty string on success (even if mounts failed),
+     * or an explanation if the btrfs subvolumes could not be created.
+     */
+    QString execute( const QString& rootMountPoint, QStringList* failed = nullptr ) const;
+
+private:
+    QList< MountEntry > m_entries;
+    QString m_btrfsDevice;
+    QString m_btrfsOptions;
+    QStringList m_subvolumes;
+};
+
 }  // namespace Partition
 }  // namespace CalamaresUtils
 
@@ -0,0 +1,554 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "RawCopy.h"
+
+#include "utils/FileCopy.h"
+#include "utils/Logger.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/// Bytes per read, write or copy; large enough to keep the disk busy
+static constexpr qint64 chunkSize = 8 * 1024 * 1024;
+/// Alignment of buffers (a page, and any sector size)
+static constexpr size_t bufferAlignment = 4096;
+/// Minimum time between progress reports, in ms
+static constexpr qint64 progressInterval = 250;
+
+/// @brief A page-aligned buffer of chunkSize bytes
+class AlignedBuffer
+{
+public:
+    AlignedBuffer()
+    {
+        if ( posix_memalign( &m_data, bufferAlignment, size_t( chunkSize ) ) )
+        {
+            m_data = nullptr;
+        }
+    }
+    ~AlignedBuffer() { free( m_data ); }
+    AlignedBuffer( const AlignedBuffer& ) = delete;
+    AlignedBuffer& operator=( const AlignedBuffer& ) = delete;
+
+    bool isValid() const { return m_data; }
+    char* data() const { return static_cast< char* >( m_data ); }
+
+private:
+    void* m_data = nullptr;
+};
+
+/// @brief Reads @p length bytes at @p offset, returns the number read
+static qint64
+readFully( int fd, char* buffer, qint64 length, qint64 offset )
+{
+    qint64 total = 0;
+    while ( total < length )
+    {
+        const ssize_t r = pread( fd, buffer + total, size_t( length - total ), off_t( offset + total ) );
+        if ( r < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( r <= 0 )
+        {
+            break;
+        }
+        total += r;
+    }
+    return total;
+}
+
+/// @brief Writes @p length bytes at @p offset, returns @c true on success
+static bool
+writeFully( int fd, const char* buffer, qint64 length, qint64 offset )
+{
+    qint64 total = 0;
+    while ( total < length )
+    {
+        const ssize_t w = pwrite( fd, buffer + total, size_t( length - total ), off_t( offset + total ) );
+        if ( w < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( w <= 0 )
+        {
+            return false;
+        }
+        total += w;
+    }
+    return true;
+}
+
+/// @brief The size of the file or block device @p fd, or -1
+static qint64
+fileSize( int fd, bool& isBlockDevice )
+{
+    struct stat st;
+    if ( fstat( fd, &st ) )
+    {
+        return -1;
+    }
+    isBlockDevice = S_ISBLK( st.st_mode );
+    if ( !isBlockDevice )
+    {
+        return st.st_size;
+    }
+#ifdef __linux__
+    uint64_t bytes = 0;
+    return ioctl( fd, BLKGETSIZE64, &bytes ) ? -1 : qint64( bytes );
+#else
+    return lseek( fd, 0, SEEK_END );
+#endif
+}
+
+/// @brief Hashes the first @p length bytes of @p fd (skipping the page cache, if possible)
+static QByteArray
+hashFile( int fd, qint64 length )
+{
+    AlignedBuffer buffer;
+    if ( !buffer.isValid() )
+    {
+        return QByteArray();
+    }
+#ifdef POSIX_FADV_DONTNEED
+    // Read what is on disk, not what we just wrote
+    posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+    posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+    QCryptographicHash hash( QCryptographicHash::Sha256 );
+    for ( qint64 offset = 0; offset < length; )
+    {
+        const qint64 want = std::min( chunkSize, length - offset );
+        if ( readFully( fd, buffer.data(), want, offset ) != want )
+        {
+            return QByteArray();
+        }
+        hash.addData( buffer.data(), int( want ) );
+        offset += want;
+    }
+    return hash.result();
+}
+
+struct RawCopy::Private
+{
+    QString source;
+    QString destination;
+    bool verify = false;
+    ProgressFunction progress;
+
+    QString error;
+    QString method;
+    qint64 size = -1;
+
+    int in = -1;
+    int out = -1;
+    bool destinationIsBlockDevice = false;
+
+    qint64 done = 0;
+    QElapsedTimer timer;
+    qint64 lastReport = 0;
+
+    ~Private()
+    {
+        if ( in >= 0 )
+        {
+            close( in );
+        }
+        if ( out >= 0 )
+        {
+            close( out );
+        }
+    }
+
+    /// @brief Sets the error from @p what and errno, returns @c false
+    bool fail( const QString& what )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( what, QString::fromLocal8Bit( strerror( errno ) ) );
+        return false;
+    }
+
+    void report( bool force = false )
+    {
+        const qint64 elapsed = timer.elapsed();
+        if ( progress && ( force || elapsed - lastReport >= progressInterval ) )
+        {
+            lastReport = elapsed;
+            progress( done, size, elapsed > 0 ? double( done ) * 1000.0 / double( elapsed ) : 0.0 );
+        }
+    }
+
+    bool open();
+    bool copyReadWrite( qint64 offset, qint64 length );
+    bool zero( qint64 offset, qint64 length );
+    bool verifyCopy();
+};
+
+bool
+RawCopy::Private::open()
+{
+    in = ::open( QFile::encodeName( source ).constData(), O_RDONLY | O_CLOEXEC );
+    if ( in < 0 )
+    {
+        return fail( source );
+    }
+    bool sourceIsBlockDevice = false;
+    size = fileSize( in, sourceIsBlockDevice );
+    if ( size < 0 )
+    {
+        return fail( source );
+    }
+
+    out = ::open( QFile::encodeName( destination ).constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644 );
+    if ( out < 0 )
+    {
+        return fail( destination );
+    }
+    const qint64 destinationSize = fileSize( out, destinationIsBlockDevice );
+    if ( destinationSize < 0 )
+    {
+        return fail( destination );
+    }
+    if ( destinationIsBlockDevice && destinationSize < size )
+    {
+        error = QStringLiteral( "%1 (%2 bytes) is too small for %3 (%4 bytes)" )
+                    .arg( destination )
+                    .arg( destinationSize )
+                    .arg( source )
+                    .arg( size );
+        return false;
+    }
+    // A file becomes a sparse copy of the source, so start afresh
+    if ( !destinationIsBlockDevice && ftruncate( out, 0 ) )
+    {
+        return fail( destination );
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise( in, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+    return true;
+}
+
+bool
+RawCopy::Private::copyReadWrite( qint64 offset, qint64 length )
+{
+    struct Chunk
+    {
+        AlignedBuffer buffer;
+        qint64 length = 0;
+        bool full = false;
+    };
+    std::array< Chunk, 2 > chunks;
+    if ( !chunks[ 0 ].buffer.isValid() || !chunks[ 1 ].buffer.isValid() )
+    {
+        errno = ENOMEM;
+        return fail( source );
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stop = false;
+    int readErrno = 0;
+
+    // Reads ahead into whichever chunk the writer isn't using
+    std::thread reader( [&]() {
+        const qint64 end = offset + length;
+        int i = 0;
+        for ( qint64 position = offset; position < end; i ^= 1 )
+        {
+            Chunk& c = chunks[ size_t( i ) ];
+            {
+                std::unique_lock< std::mutex > lock( mutex );
+                changed.wait( lock, [&]() { return !c.full || stop; } );
+                if ( stop )
+                {
+                    return;
+                }
+            }
+            const qint64 want = std::min( chunkSize, end - position );
+            const qint64 got = readFully( in, c.buffer.data(), want, position );
+            {
+                std::lock_guard< std::mutex > lock( mutex );
+                if ( got != want )
+                {
+                    readErrno = errno ? errno : EIO;
+                }
+                c.length = got;
+                c.full = true;
+            }
+            changed.notify_all();
+            if ( got != want )
+            {
+                return;
+            }
+            position += got;
+        }
+    } );
+
+    bool ok = true;
+    int i = 0;
+    for ( qint64 position = offset; ok && position < offset + length; i ^= 1 )
+    {
+        Chunk& c = chunks[ size_t( i ) ];
+        {
+            std::unique_lock< std::mutex > lock( mutex );
+            changed.wait( lock, [&]() { return c.full; } );
+            if ( readErrno )
+            {
+                errno = readErrno;
+                ok = fail( source );
+                break;
+            }
+        }
+        if ( !writeFully( out, c.buffer.data(), c.length, position ) )
+        {
+            ok = fail( destination );
+            break;
+        }
+#ifdef __linux__
+        // Start writeback now, so there is no huge flush at the end
+        sync_file_range( out, off_t( position ), off_t( c.length ), SYNC_FILE_RANGE_WRITE );
+#endif
+        position += c.length;
+        done += c.length;
+        report();
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            c.full = false;
+        }
+        changed.notify_all();
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        stop = true;
+    }
+    changed.notify_all();
+    reader.join();
+    return ok;
+}
+
+bool
+RawCopy::Private::zero( qint64 offset, qint64 length )
+{
+    if ( !destinationIsBlockDevice )
+    {
+        // It's a hole in the destination, too
+        done += length;
+        report();
+        return true;
+    }
+
+#ifdef __linux__
+    // Let the device zero it; this fails for unaligned ranges
+    uint64_t range[ 2 ] = { uint64_t( offset ), uint64_t( length ) };
+    if ( ioctl( out, BLKZEROOUT, range ) == 0 )
+    {
+        done += length;
+        report();
+        return true;
+    }
+#endif
+
+    AlignedBuffer zeroes;
+    if ( !zeroes.isValid() )
+    {
+        errno = ENOMEM;
+        return fail( destination );
+    }
+    memset( zeroes.data(), 0, size_t( chunkSize ) );
+    for ( qint64 position = offset; position < offset + length; )
+    {
+        const qint64 n = std::min( chunkSize, offset + length - position );
+        if ( !writeFully( out, zeroes.data(), n, position ) )
+        {
+            return fail( destination );
+        }
+        position += n;
+        done += n;
+        report();
+    }
+    return true;
+}
+
+bool
+RawCopy::Private::verifyCopy()
+{
+    // Separate read-only descriptors: the copy's destination is write-only
+    const int source_fd = ::open( QFile::encodeName( source ).constData(), O_RDONLY | O_CLOEXEC );
+    if ( source_fd < 0 )
+    {
+        return fail( source );
+    }
+    const int destination_fd = ::open( QFile::encodeName( destination ).constData(), O_RDONLY | O_CLOEXEC );
+    if ( destination_fd < 0 )
+    {
+        close( source_fd );
+        return fail( destination );
+    }
+
+    bool isBlockDevice = false;
+    size = fileSize( source_fd, isBlockDevice );
+    const qint64 destinationSize = fileSize( destination_fd, isBlockDevice );
+
+    // The destination may be larger, only the copied part matters
+    QByteArray expected;
+    QByteArray destinationHash;
+    if ( size >= 0 && destinationSize >= size )
+    {
+        auto sourceHash = std::async( std::launch::async, hashFile, source_fd, size );
+        destinationHash = hashFile( destination_fd, size );
+        expected = sourceHash.get();
+    }
+    const int savedErrno = errno;
+    close( source_fd );
+    close( destination_fd );
+
+    if ( size >= 0 && destinationSize >= 0 && destinationSize < size )
+    {
+        error = QStringLiteral( "Verification of %1 failed: it is smaller than %2" ).arg( destination, source );
+        return false;
+    }
+    if ( expected.isEmpty() || destinationHash.isEmpty() )
+    {
+        errno = savedErrno;
+        return fail( QStringLiteral( "Verify %1" ).arg( destination ) );
+    }
+    if ( expected != destinationHash )
+    {
+        error = QStringLiteral( "Verification of %1 failed: the copy differs from %2" ).arg( destination, source );
+        return false;
+    }
+    cDebug() << Logger::SubEntry << "Verified" << destination << "SHA256" << destinationHash.toHex();
+    return true;
+}
+
+RawCopy::RawCopy( const QString& source, const QString& destination )
+    : d( std::make_unique< Private >() )
+{
+    d->source = source;
+    d->destination = destination;
+}
+
+RawCopy::~RawCopy() {}
+
+void
+RawCopy::setVerify( bool verify )
+{
+    d->verify = verify;
+}
+
+bool
+RawCopy::verify()
+{
+    d->error.clear();
+    return d->verifyCopy();
+}
+
+void
+RawCopy::setProgressFunction( const ProgressFunction& f )
+{
+    d->progress = f;
+}
+
+QString
+RawCopy::errorString() const
+{
+    return d->error;
+}
+
+qint64
+RawCopy::size() const
+{
+    return d->size;
+}
+
+QString
+RawCopy::method() const
+{
+    return d->method;
+}
+
+bool
+RawCopy::exec()
+{
+    d->error.clear();
+    d->done = 0;
+    d->timer.start();
+    if ( !d->open() )
+    {
+        return false;
+    }
+    cDebug() << "Raw copy of" << d->size << "bytes from" << d->source << "to" << d->destination;
+
+    // Holes in the source are zeroed (or left as holes) in the destination;
+    // data is copied by the kernel, or double-buffered if that doesn't work.
+    ExtentCopyHooks hooks;
+    hooks.chunkSize = chunkSize;
+    hooks.hole = [ this ]( qint64 offset, qint64 length ) { return d->zero( offset, length ); };
+    hooks.readWrite = [ this ]( qint64 offset, qint64 length ) { return d->copyReadWrite( offset, length ); };
+    hooks.progress = [ this ]( qint64 bytes ) {
+        d->done += bytes;
+        d->report();
+    };
+    CopyMethod method = CopyMethod::CopyFileRange;
+    const bool copied = copyExtents( d->in, d->out, d->size, method, hooks );
+    d->method
+        = method == CopyMethod::CopyFileRange ? QStringLiteral( "copy_file_range" ) : QStringLiteral( "read/write" );
+    if ( !copied )
+    {
+        // The hooks explain their own failures
+        return d->error.isEmpty() ? d->fail( QStringLiteral( "Copy %1 to %2" ).arg( d->source, d->destination ) )
+                                  : false;
+    }
+
+    if ( !d->destinationIsBlockDevice && ftruncate( d->out, off_t( d->size ) ) )
+    {
+        return d->fail( d->destination );
+    }
+    if ( fsync( d->out ) )
+    {
+        return d->fail( d->destination );
+    }
+    d->report( true );
+
+    const qint64 elapsed = std::max( d->timer.elapsed(), qint64( 1 ) );
+    cDebug() << Logger::SubEntry << "Copied" << d->size << "bytes using" << d->method << "in" << elapsed << "ms,"
+             << ( d->size / 1024 * 1000 / elapsed / 1024 ) << "MiB/s";
+
+    return !d->verify || d->verifyCopy();
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
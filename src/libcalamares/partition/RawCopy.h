@@ -0,0 +1,91 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_RAWCOPY_H
+#define PARTITION_RAWCOPY_H
+
+#include "DllMacro.h"
+
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief Copies a filesystem image (or partition) byte-for-byte
+ *
+ * The source is typically a filesystem image file, the destination
+ * a partition (or, in tests, another file). Only the data in the
+ * source is copied: holes in a sparse source image are skipped,
+ * and the corresponding ranges of the destination are zeroed
+ * (efficiently, for block devices) or left as holes (for files).
+ *
+ * Where possible, the kernel copies the data (copy_file_range);
+ * otherwise the copy is double-buffered, reading the next chunk
+ * in a separate thread while the current one is written.
+ *
+ * Optionally, the copy is verified afterwards by hashing the source
+ * and the destination (in parallel) and comparing the results.
+ */
+class DLLEXPORT RawCopy
+{
+public:
+    /** @brief Reports progress of the copy
+     *
+     * Called with the number of bytes done (which includes skipped
+     * holes), the total number of bytes, and the throughput so far.
+     */
+    using ProgressFunction = std::function< void( qint64 done, qint64 total, double bytesPerSecond ) >;
+
+    RawCopy( const QString& source, const QString& destination );
+    RawCopy( const RawCopy& ) = delete;
+    RawCopy& operator=( const RawCopy& ) = delete;
+    ~RawCopy();
+
+    /// @brief Compare hashes of source and destination after copying?
+    void setVerify( bool verify );
+    /// @brief Called (at most a few times per second) during exec()
+    void setProgressFunction( const ProgressFunction& f );
+
+    /** @brief Do the copy
+     *
+     * A destination block device must be at least as large as the source;
+     * a destination file is truncated and then has the size of the source.
+     * Returns @c false on failure, with an explanation in errorString().
+     */
+    bool exec();
+
+    /** @brief Compare the source and the destination
+     *
+     * This is what exec() does after copying, if setVerify() is on.
+     * Only the first size() bytes of the destination are compared.
+     * Returns @c false if they differ (or can't be read), with an
+     * explanation in errorString().
+     */
+    bool verify();
+
+    QString errorString() const;
+    /// @brief The size of the source, in bytes (after exec())
+    qint64 size() const;
+    /// @brief How the data was copied (for logging and tests)
+    QString method() const;
+
+private:
+    struct Private;
+    std::unique_ptr< Private > d;
+};
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -8,15 +8,25 @@
  *
  */
 
+#include "Fstab.h"
 #include "Global.h"
+#include "Mount.h"
 #include "PartitionSize.h"
+#include "RawCopy.h"
 
 #include "GlobalStorage.h"
 #include "utils/Logger.h"
 
 #include <QObject>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tuple>
+
 using SizeUnit = CalamaresUtils::Partition::SizeUnit;
 using PartitionSize = CalamaresUtils::Partition::PartitionSize;
 
@@ -39,6 +49,19 @@ private Q_SLOTS:
     void testUnitNormalisation();
 
     void testFilesystemGS();
+
+    void testRawCopy();
+    void testRawCopyErrors();
+    void testRawCopyVerify();
+    void benchmarkRawCopy_data();
+    void benchmarkRawCopy();
+
+    void testFstabLines();
+    void testFstabEntries();
+    void testSwapFile();
+
+    void testMountPlan();
+    void testMountPlanBtrfs();
 };
 
 PartitionServiceTests::PartitionServiceTests() {}
@@ -218,6 +241,525 @@ PartitionServiceTests::testFilesystemGS()
     QVERIFY( !isFilesystemUsedGS( &gs, "ext4" ) );
 }
 
+/** @brief Creates a sparse image file @p path of @p size bytes
+ *
+ * Every other MiB (starting with the first one) contains data,
+ * the ones in between are holes. Returns @c false on failure.
+ */
+static bool
+makeSparseImage( const QString& path, qint64 size )
+{
+    QFile f( path );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || !f.resize( size ) )
+    {
+        return false;
+    }
+    constexpr qint64 mib = 1024 * 1024;
+    QByteArray data( int( mib ), '\0' );
+    for ( qint64 offset = 0; offset < size; offset += 2 * mib )
+    {
+        for ( int i = 0; i < data.size(); ++i )
+        {
+            data[ i ] = char( ( offset / mib + i ) % 251 );
+        }
+        if ( !f.seek( offset ) || f.write( data.constData(), std::min( mib, size - offset ) ) < 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static QByteArray
+fileContents( const QString& path )
+{
+    QFile f( path );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+/// @brief The number of bytes actually allocated for @p path
+static qint64
+allocatedSize( const QString& path )
+{
+    struct stat st;
+    return stat( QFile::encodeName( path ).constData(), &st ) ? -1 : qint64( st.st_blocks ) * 512;
+}
+
+void
+PartitionServiceTests::testRawCopy()
+{
+    using CalamaresUtils::Partition::RawCopy;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source.img" );
+    const QString destination = dir.filePath( "destination.img" );
+
+    // 8.5 MiB, with holes, and a size that is not a multiple of the block size
+    const qint64 size = 8 * 1024 * 1024 + 512 * 1024 + 17;
+    QVERIFY( makeSparseImage( source, size ) );
+    // Existing contents of the destination are replaced
+    {
+        QFile f( destination );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QVERIFY( f.write( QByteArray( 16 * 1024 * 1024, 'x' ) ) > 0 );
+    }
+
+    qint64 lastDone = -1;
+    qint64 lastTotal = -1;
+    RawCopy copy( source, destination );
+    copy.setVerify( true );
+    copy.setProgressFunction( [&lastDone, &lastTotal]( qint64 done, qint64 total, double ) {
+        QVERIFY( done >= lastDone );
+        lastDone = done;
+        lastTotal = total;
+    } );
+    QVERIFY( copy.exec() );
+    QVERIFY( copy.errorString().isEmpty() );
+    QCOMPARE( copy.size(), size );
+    QVERIFY( !copy.method().isEmpty() );
+    QCOMPARE( lastDone, size );
+    QCOMPARE( lastTotal, size );
+
+    QCOMPARE( QFileInfo( destination ).size(), size );
+    QCOMPARE( fileContents( destination ), fileContents( source ) );
+
+    // If the filesystem supports holes in the source, there are
+    // holes in the destination as well.
+    const qint64 sourceAllocated = allocatedSize( source );
+    if ( sourceAllocated > 0 && sourceAllocated < size )
+    {
+        QVERIFY( allocatedSize( destination ) < size );
+    }
+    cDebug() << "Copied" << size << "bytes with" << copy.method() << "allocated" << allocatedSize( destination );
+}
+
+void
+PartitionServiceTests::testRawCopyErrors()
+{
+    using CalamaresUtils::Partition::RawCopy;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    {
+        RawCopy copy( dir.filePath( "nonexistent.img" ), dir.filePath( "destination.img" ) );
+        QVERIFY( !copy.exec() );
+        QVERIFY( !copy.errorString().isEmpty() );
+        QVERIFY( !QFile::exists( dir.filePath( "destination.img" ) ) );
+    }
+    {
+        const QString source = dir.filePath( "source.img" );
+        QVERIFY( makeSparseImage( source, 1024 * 1024 ) );
+        RawCopy copy( source, dir.filePath( "no/such/directory/destination.img" ) );
+        QVERIFY( !copy.exec() );
+        QVERIFY( copy.errorString().contains( "destination.img" ) );
+    }
+}
+
+void
+PartitionServiceTests::testRawCopyVerify()
+{
+    using CalamaresUtils::Partition::RawCopy;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source.img" );
+    const QString destination = dir.filePath( "destination.img" );
+    const qint64 size = 2 * 1024 * 1024 + 3;
+    QVERIFY( makeSparseImage( source, size ) );
+
+    RawCopy copy( source, destination );
+    copy.setVerify( true );
+    QVERIFY( copy.exec() );
+    QVERIFY( copy.verify() );
+    QVERIFY( copy.errorString().isEmpty() );
+
+    // A destination that is larger is fine, the extra bytes are not compared
+    {
+        QFile f( destination );
+        QVERIFY( f.open( QIODevice::Append ) );
+        QVERIFY( f.write( "extra" ) == 5 );
+    }
+    QVERIFY( copy.verify() );
+
+    // Change one byte in the middle of the copy
+    {
+        QFile f( destination );
+        QVERIFY( f.open( QIODevice::ReadWrite ) );
+        QVERIFY( f.seek( size / 2 ) );
+        char c = 0;
+        QVERIFY( f.getChar( &c ) );
+        QVERIFY( f.seek( size / 2 ) );
+        QVERIFY( f.putChar( char( c ^ 0x55 ) ) );
+    }
+    QVERIFY( !copy.verify() );
+    QVERIFY( copy.errorString().contains( "differs" ) );
+
+    // A destination that is too short
+    QVERIFY( QFile::resize( destination, size - 1 ) );
+    QVERIFY( !copy.verify() );
+    QVERIFY( copy.errorString().contains( "smaller" ) );
+}
+
+void
+PartitionServiceTests::benchmarkRawCopy_data()
+{
+    QTest::addColumn< bool >( "engine" );
+    QTest::addColumn< bool >( "sparse" );
+
+    QTest::newRow( "blocks-full" ) << false << false;
+    QTest::newRow( "blocks-sparse" ) << false << true;
+    QTest::newRow( "engine-full" ) << true << false;
+    QTest::newRow( "engine-sparse" ) << true << true;
+}
+
+/** @brief Copies the way the rawfs module used to do
+ *
+ * That's a read-and-write loop with blocks of 100x the least common
+ * multiple of the block sizes; for images that is 100 bytes.
+ */
+static bool
+blockCopy( const QString& source, const QString& destination )
+{
+    QFile in( source );
+    QFile out( destination );
+    if ( !in.open( QIODevice::ReadOnly | QIODevice::Unbuffered )
+         || !out.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered ) )
+    {
+        return false;
+    }
+    char buffer[ 100 ];
+    qint64 n = 0;
+    while ( ( n = in.read( buffer, sizeof( buffer ) ) ) > 0 )
+    {
+        if ( out.write( buffer, n ) != n )
+        {
+            return false;
+        }
+    }
+    return n == 0 && fsync( out.handle() ) == 0;
+}
+
+void
+PartitionServiceTests::benchmarkRawCopy()
+{
+    QFETCH( bool, engine );
+    QFETCH( bool, sparse );
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source.img" );
+    const QString destination = dir.filePath( "destination.img" );
+
+    // The old loop is slow, so keep the image small-ish
+    const qint64 size = 32 * 1024 * 1024;
+    if ( sparse )
+    {
+        QVERIFY( makeSparseImage( source, size ) );
+    }
+    else
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QByteArray data( 1024 * 1024, 'c' );
+        for ( qint64 i = 0; i < size; i += data.size() )
+        {
+            QCOMPARE( f.write( data ), qint64( data.size() ) );
+        }
+    }
+
+    bool ok = false;
+    QBENCHMARK
+    {
+        if ( engine )
+        {
+            CalamaresUtils::Partition::RawCopy copy( source, destination );
+            ok = copy.exec();
+        }
+        else
+        {
+            ok = blockCopy( source, destination );
+        }
+    }
+    QVERIFY( ok );
+    QCOMPARE( QFileInfo( destination ).size(), size );
+}
+
+
+void
+PartitionServiceTests::testFstabLines()
+{
+    using namespace CalamaresUtils::Partition;
+
+    // Same layout as the old Python implementation
+    const FstabEntry tmp { "tmpfs", "/tmp", "tmpfs", "defaults,noatime,mode=1777", 0 };
+    QCOMPARE( tmp.toString(),
+              QStringLiteral( "tmpfs                                     /tmp           tmpfs   "
+                              "defaults,noatime,mode=1777 0 0" ) );
+    const FstabEntry swap { "UUID=1234", "swap", "swap", "sw", 0 };
+    QCOMPARE( swap.toString(),
+              QStringLiteral( "UUID=1234                                 swap           swap    sw         0 0" ) );
+    const CrypttabEntry luks { "luks-home", "UUID=5678", "/crypto_keyfile.bin", "luks" };
+    QCOMPARE( luks.toString(),
+              QStringLiteral(
+                  "luks-home             UUID=5678                                     /crypto_keyfile.bin luks" ) );
+
+    const QString fstab = fstabContents( { tmp, swap } );
+    QVERIFY( fstab.startsWith( "# /etc/fstab" ) );
+    QVERIFY( fstab.endsWith( swap.toString() + '\n' ) );
+    QCOMPARE( fstab.count( '\n' ), 9 );
+    QVERIFY( crypttabContents( {} ).startsWith( "# /etc/crypttab" ) );
+}
+
+/** @brief Creates a (tiny) sysfs tree in @p root
+ *
+ * There are partitions 1 and 2 on disk nvme0n1, which is an SSD,
+ * and partitions 1, 2 and 3 on sda, which is a spinning disk.
+ */
+static bool
+makeSysfs( const QString& root )
+{
+    QDir d( root );
+    for ( const auto& [ disk, partitions, rotational ] :
+          { std::make_tuple( "nvme0n1", QStringList { "nvme0n1p1", "nvme0n1p2" }, "0\n" ),
+            std::make_tuple( "sda", QStringList { "sda1", "sda2", "sda3" }, "1\n" ) } )
+    {
+        const QString diskPath = QStringLiteral( "devices/%1" ).arg( disk );
+        if ( !d.mkpath( diskPath ) || !d.mkpath( QStringLiteral( "block/%1/queue" ).arg( disk ) )
+             || !d.mkpath( "class/block" ) )
+        {
+            return false;
+        }
+        QFile r( d.filePath( QStringLiteral( "block/%1/queue/rotational" ).arg( disk ) ) );
+        if ( !r.open( QIODevice::WriteOnly ) || r.write( rotational ) < 0 )
+        {
+            return false;
+        }
+        if ( !QFile::link( d.filePath( diskPath ), d.filePath( QStringLiteral( "class/block/%1" ).arg( disk ) ) ) )
+        {
+            return false;
+        }
+        for ( const auto& p : partitions )
+        {
+            QFile number( d.filePath( diskPath + '/' + p + QStringLiteral( "/partition" ) ) );
+            if ( !d.mkpath( diskPath + '/' + p ) || !number.open( QIODevice::WriteOnly )
+                 || !QFile::link( d.filePath( diskPath + '/' + p ), d.filePath( "class/block/" + p ) ) )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void
+PartitionServiceTests::testFstabEntries()
+{
+    using namespace CalamaresUtils::Partition;
+
+    QTemporaryDir sysfs;
+    QVERIFY( sysfs.isValid() );
+    QVERIFY( makeSysfs( sysfs.path() ) );
+
+    FstabGenerator generator( { { "default", "defaults,noatime" }, { "btrfs", "defaults,compress=zstd" } },
+                              { { "ext4", "discard" }, { "btrfs", "ssd" } },
+                              QStringLiteral( "luks" ) );
+    generator.setSysfsRoot( sysfs.path() );
+    generator.setEfiMountOptions( "/boot/efi", "umask=0077" );
+
+    QCOMPARE( generator.diskName( "/dev/nvme0n1p2" ), QStringLiteral( "nvme0n1" ) );
+    QCOMPARE( generator.diskName( "/dev/sda3" ), QStringLiteral( "sda" ) );
+    QCOMPARE( generator.diskName( "/dev/sda" ), QStringLiteral( "sda" ) );
+    // Not in sysfs
+    QCOMPARE( generator.diskName( "/dev/mmcblk0p1" ), QStringLiteral( "mmcblk0" ) );
+    QCOMPARE( generator.diskName( "/dev/sdb12" ), QStringLiteral( "sdb" ) );
+    QCOMPARE( generator.diskName( "/swapfile" ), QStringLiteral( "swapfile" ) );
+    QVERIFY( generator.isSsd( "/dev/nvme0n1p1" ) );
+    QVERIFY( !generator.isSsd( "/dev/sda1" ) );
+    QVERIFY( !generator.isSsd( "/swapfile" ) );
+
+    const QVariantList partitions {
+        QVariantMap {
+            { "device", "/dev/nvme0n1p1" }, { "fs", "fat32" }, { "mountPoint", "/boot/efi" }, { "uuid", "AB-CD" } },
+        QVariantMap { { "device", "/dev/nvme0n1p2" }, { "fs", "ext4" }, { "mountPoint", "/" }, { "uuid", "1234" } },
+        QVariantMap { { "device", "/dev/sda1" }, { "fs", "linuxswap" }, { "claimed", true }, { "uuid", "5678" } },
+        QVariantMap { { "device", "/dev/sda2" }, { "fs", "linuxswap" }, { "claimed", false }, { "uuid", "9abc" } },
+        QVariantMap { { "device", "/dev/sda3" },
+                      { "fs", "ext4" },
+                      { "mountPoint", "/home" },
+                      { "uuid", "def0" },
+                      { "luksMapperName", "luks-home" },
+                      { "luksUuid", "0123" } },
+        QVariantMap { { "device", "/dev/sda4" }, { "fs", "ext4" }, { "uuid", "4567" } },
+    };
+
+    const auto entries = generator.fstabEntries( partitions, {} );
+    QCOMPARE( entries.count(), 5 );  // Not the foreign swap, nor the unmounted sda4; with /tmp
+    QCOMPARE( entries[ 0 ].device, QStringLiteral( "UUID=AB-CD" ) );
+    QCOMPARE( entries[ 0 ].fs, QStringLiteral( "vfat" ) );
+    QCOMPARE( entries[ 0 ].options, QStringLiteral( "umask=0077" ) );
+    QCOMPARE( entries[ 0 ].check, 2 );
+    QCOMPARE( entries[ 1 ].mountPoint, QStringLiteral( "/" ) );
+    QCOMPARE( entries[ 1 ].options, QStringLiteral( "defaults,noatime,discard" ) );
+    QCOMPARE( entries[ 1 ].check, 1 );
+    QCOMPARE( entries[ 2 ].device, QStringLiteral( "UUID=5678" ) );
+    QCOMPARE( entries[ 2 ].mountPoint, QStringLiteral( "swap" ) );
+    QCOMPARE( entries[ 2 ].fs, QStringLiteral( "swap" ) );
+    QCOMPARE( entries[ 2 ].check, 0 );
+    QCOMPARE( entries[ 3 ].device, QStringLiteral( "/dev/mapper/luks-home" ) );
+    QCOMPARE( entries[ 3 ].options, QStringLiteral( "defaults,noatime" ) );  // Not an SSD
+    QCOMPARE( entries[ 3 ].check, 2 );
+    QCOMPARE( entries[ 4 ].mountPoint, QStringLiteral( "/tmp" ) );
+
+    const auto crypttab = generator.crypttabEntries( partitions );
+    QCOMPARE( crypttab.count(), 1 );
+    QCOMPARE( crypttab[ 0 ].name, QStringLiteral( "luks-home" ) );
+    QCOMPARE( crypttab[ 0 ].device, QStringLiteral( "UUID=0123" ) );
+    QCOMPARE( crypttab[ 0 ].options, QStringLiteral( "luks" ) );
+
+    // A btrfs root gets its subvolumes; root on a spinning disk means no tmpfs
+    const QVariantList btrfs {
+        QVariantMap { { "device", "/dev/sda2" }, { "fs", "btrfs" }, { "mountPoint", "/" }, { "uuid", "9abc" } },
+    };
+    const QVariantList subvolumes { QVariantMap { { "mountPoint", "/" }, { "subvolume", "/@" } },
+                                    QVariantMap { { "mountPoint", "/home" }, { "subvolume", "/@home" } } };
+    const auto btrfsEntries = generator.fstabEntries( btrfs, subvolumes );
+    QCOMPARE( btrfsEntries.count(), 2 );
+    QCOMPARE( btrfsEntries[ 0 ].mountPoint, QStringLiteral( "/" ) );
+    QCOMPARE( btrfsEntries[ 0 ].options, QStringLiteral( "subvol=/@,defaults,compress=zstd" ) );
+    QCOMPARE( btrfsEntries[ 0 ].check, 0 );
+    QCOMPARE( btrfsEntries[ 1 ].mountPoint, QStringLiteral( "/home" ) );
+    QCOMPARE( btrfsEntries[ 1 ].options, QStringLiteral( "subvol=/@home,defaults,compress=zstd" ) );
+    QCOMPARE( btrfs[ 0 ].toMap().value( "mountPoint" ).toString(), QStringLiteral( "/" ) );
+}
+
+void
+PartitionServiceTests::testSwapFile()
+{
+    using CalamaresUtils::Partition::createSwapFile;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.filePath( "swapfile" );
+    constexpr qint64 size = 4 * 1024 * 1024;
+
+    QCOMPARE( createSwapFile( path, size, false ), QString() );
+    QCOMPARE( QFileInfo( path ).size(), size );
+    QVERIFY( !( QFileInfo( path ).permissions() & ( QFileDevice::ReadOther | QFileDevice::ReadGroup ) ) );
+
+    const long pageSize = sysconf( _SC_PAGESIZE );
+    const QByteArray header = fileContents( path ).left( int( pageSize ) );
+    QCOMPARE( header.mid( int( pageSize ) - 10 ), QByteArray( "SWAPSPACE2" ) );
+    quint32 info[ 2 ] = { 0, 0 };
+    memcpy( info, header.constData() + 1024, sizeof( info ) );
+    QCOMPARE( info[ 0 ], 1u );  // version
+    QCOMPARE( qint64( info[ 1 ] ), size / pageSize - 1 );  // last page
+
+    // Far too small for a swap file
+    QVERIFY( !createSwapFile( path, 1024, false ).isEmpty() );
+    // The directory does not exist
+    QVERIFY( !createSwapFile( dir.filePath( "nonexistent/swapfile" ), size, true ).isEmpty() );
+}
+
+
+void
+PartitionServiceTests::testMountPlan()
+{
+    using CalamaresUtils::Partition::MountPlan;
+
+    const QVariantList partitions {
+        QVariantMap { { "device", "/dev/sdb1" }, { "mountPoint", "/" }, { "fs", "ext4" } },
+        QVariantMap { { "device", "/dev/sdb2" }, { "mountPoint", "/home" }, { "fs", "ext4" } },
+        QVariantMap { { "device", "/dev/sdb3" }, { "mountPoint", "" }, { "fs", "linuxswap" } },
+        QVariantMap { { "device", "/dev/sdb4" }, { "mountPoint", "/boot/efi" }, { "fs", "FAT32" } },
+        QVariantMap { { "device", "/dev/sdb5" },
+                      { "mountPoint", "/home/shared" },
+                      { "fs", "ext4" },
+                      { "luksMapperName", "luks-shared" } },
+        QVariantMap { { "device", "/dev/sdb6" }, { "mountPoint", "/home-old" }, { "fs", "ext4" } },
+        QVariantMap { { "device", "proc" }, { "mountPoint", "/proc" }, { "fs", "proc" } },
+        QVariantMap { { "device", "/dev" }, { "mountPoint", "/dev" }, { "options", "bind" } },
+    };
+
+    MountPlan plan( partitions );
+    QVERIFY( plan.btrfsDevice().isEmpty() );
+    const auto& entries = plan.entries();
+    QCOMPARE( entries.count(), 7 );  // Not the swap
+
+    QStringList mountPoints;
+    for ( const auto& e : entries )
+    {
+        mountPoints << e.mountPoint;
+    }
+    QCOMPARE( mountPoints,
+              QStringList( { "/", "/boot/efi", "/dev", "/home", "/home-old", "/home/shared", "/proc" } ) );
+
+    QCOMPARE( entries[ 0 ].parent, -1 );
+    QCOMPARE( entries[ 0 ].depth, 0 );
+    for ( int i : { 1, 2, 3, 4, 6 } )
+    {
+        QCOMPARE( entries[ i ].parent, 0 );
+        QCOMPARE( entries[ i ].depth, 1 );
+    }
+    // Inside /home, not inside /home-old which sorts in-between
+    QCOMPARE( entries[ 5 ].parent, 3 );
+    QCOMPARE( entries[ 5 ].depth, 2 );
+    QCOMPARE( entries[ 5 ].device, QStringLiteral( "/dev/mapper/luks-shared" ) );
+    QCOMPARE( entries[ 1 ].fs, QStringLiteral( "vfat" ) );
+    QCOMPARE( entries[ 2 ].options, QStringLiteral( "bind" ) );
+}
+
+void
+PartitionServiceTests::testMountPlanBtrfs()
+{
+    using CalamaresUtils::Partition::MountPlan;
+
+    const QVariantList partitions {
+        QVariantMap { { "device", "/dev/sdb1" }, { "mountPoint", "/" }, { "fs", "btrfs" } },
+        QVariantMap { { "device", "/dev/sdb2" }, { "mountPoint", "/home" }, { "fs", "ext4" } },
+        QVariantMap { { "device", "sys" }, { "mountPoint", "/sys" }, { "fs", "sysfs" } },
+    };
+    const QVariantList subvolumes { QVariantMap { { "mountPoint", "/" }, { "subvolume", "/@" } },
+                                    QVariantMap { { "mountPoint", "/var/log" }, { "subvolume", "/@log" } } };
+
+    {
+        // Without subvolumes, it's just the filesystem
+        MountPlan plan( partitions );
+        QVERIFY( plan.btrfsDevice().isEmpty() );
+        QCOMPARE( plan.entries().count(), 3 );
+        QCOMPARE( plan.entries()[ 0 ].fs, QStringLiteral( "btrfs" ) );
+    }
+
+    MountPlan plan( partitions, subvolumes );
+    QCOMPARE( plan.btrfsDevice(), QStringLiteral( "/dev/sdb1" ) );
+    QCOMPARE( plan.btrfsSubvolumes(), QStringList( { "/@", "/@log" } ) );
+
+    const auto& entries = plan.entries();
+    QCOMPARE( entries.count(), 4 );
+    QCOMPARE( entries[ 0 ].mountPoint, QStringLiteral( "/" ) );
+    QCOMPARE( entries[ 0 ].options, QStringLiteral( "subvol=/@" ) );
+    QCOMPARE( entries[ 1 ].mountPoint, QStringLiteral( "/home" ) );
+    QCOMPARE( entries[ 1 ].fs, QStringLiteral( "ext4" ) );
+    QCOMPARE( entries[ 3 ].mountPoint, QStringLiteral( "/var/log" ) );
+    QCOMPARE( entries[ 3 ].device, QStringLiteral( "/dev/sdb1" ) );
+    QCOMPARE( entries[ 3 ].options, QStringLiteral( "subvol=/@log" ) );
+    QCOMPARE( entries[ 3 ].parent, 0 );
+    QVERIFY( plan.btrfsOptions().isEmpty() );
+
+    {
+        // The options of the partition go to each subvolume, and to the top level
+        QVariantList withOptions( partitions );
+        QVariantMap root = withOptions[ 0 ].toMap();
+        root.insert( "options", "compress=zstd,noatime" );
+        withOptions[ 0 ] = root;
+        MountPlan optionsPlan( withOptions, subvolumes );
+        QCOMPARE( optionsPlan.btrfsOptions(), QStringLiteral( "compress=zstd,noatime" ) );
+        QCOMPARE( optionsPlan.entries()[ 0 ].options, QStringLiteral( "subvol=/@,compress=zstd,noatime" ) );
+        QCOMPARE( optionsPlan.entries()[ 3 ].options, QStringLiteral( "subvol=/@log,compress=zstd,noatime" ) );
+    }
+}
+
 
 QTEST_GUILESS_MAIN( PartitionServiceTests )
 
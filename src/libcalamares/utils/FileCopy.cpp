@@ -0,0 +1,343 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "FileCopy.h"
+
+#include "Logger.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/xattr.h>
+#endif
+
+#include <algorithm>
+
+namespace CalamaresUtils
+{
+
+/// @brief Explanation of errno, for messages
+static QString
+errnoString()
+{
+    return QString::fromLocal8Bit( strerror( errno ) );
+}
+
+/// @brief Closes a file descriptor when it goes out of scope
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor( int fd )
+        : m_fd( fd )
+    {
+    }
+    ~FileDescriptor()
+    {
+        if ( m_fd >= 0 )
+        {
+            close( m_fd );
+        }
+    }
+    FileDescriptor( const FileDescriptor& ) = delete;
+    FileDescriptor& operator=( const FileDescriptor& ) = delete;
+
+    operator int() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+static bool
+readWrite( int in, int out, qint64 offset, qint64 length )
+{
+    static constexpr qint64 bufferSize = 1024 * 1024;
+    QByteArray buffer( int( std::min( bufferSize, length ) ), Qt::Uninitialized );
+    while ( length > 0 )
+    {
+        const ssize_t r = pread( in, buffer.data(), size_t( std::min( qint64( buffer.size() ), length ) ), offset );
+        if ( r < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( r <= 0 )
+        {
+            errno = r ? errno : EIO;  // Source shrank under us
+            return false;
+        }
+        for ( ssize_t written = 0; written < r; )
+        {
+            const ssize_t w = pwrite( out, buffer.constData() + written, size_t( r - written ), offset + written );
+            if ( w < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            if ( w <= 0 )
+            {
+                return false;
+            }
+            written += w;
+        }
+        offset += r;
+        length -= r;
+    }
+    return true;
+}
+
+/** @brief Copy @p length bytes at @p offset with copy_file_range()
+ *
+ * Returns @c false on failure. If copy_file_range() does not work
+ * for these files, @p method is changed to ReadWrite and @p copied
+ * says how much was done.
+ */
+static bool
+copyFileRange( int in,
+               int out,
+               qint64 offset,
+               qint64 length,
+               CopyMethod& method,
+               qint64& copied,
+               const ExtentCopyHooks& hooks )
+{
+    copied = 0;
+#if defined( __linux__ ) || defined( __FreeBSD__ )
+    while ( copied < length )
+    {
+        off_t inOffset = off_t( offset + copied );
+        off_t outOffset = inOffset;
+        const ssize_t n = copy_file_range(
+            in, &inOffset, out, &outOffset, size_t( std::min( hooks.chunkSize, length - copied ) ), 0 );
+        if ( n < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( n < 0
+             && ( errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF ) )
+        {
+            method = CopyMethod::ReadWrite;
+            return true;
+        }
+        if ( n <= 0 )
+        {
+            errno = n ? errno : EIO;  // Source shrank under us
+            return false;
+        }
+        copied += n;
+        if ( hooks.progress )
+        {
+            hooks.progress( n );
+        }
+    }
+    return true;
+#else
+    Q_UNUSED( in )
+    Q_UNUSED( out )
+    Q_UNUSED( offset )
+    Q_UNUSED( length )
+    Q_UNUSED( hooks )
+    method = CopyMethod::ReadWrite;
+    return true;
+#endif
+}
+
+/// @brief Copy one data extent, at @p offset, of @p length bytes
+static bool
+copyRange( int in, int out, qint64 offset, qint64 length, CopyMethod& method, const ExtentCopyHooks& hooks )
+{
+    if ( method == CopyMethod::CopyFileRange )
+    {
+        qint64 copied = 0;
+        if ( !copyFileRange( in, out, offset, length, method, copied, hooks ) )
+        {
+            return false;
+        }
+        offset += copied;
+        length -= copied;
+    }
+    if ( length <= 0 )
+    {
+        return true;
+    }
+    return hooks.readWrite ? hooks.readWrite( offset, length ) : readWrite( in, out, offset, length );
+}
+
+bool
+copyExtents( int in, int out, qint64 size, CopyMethod& method, const ExtentCopyHooks& hooks )
+{
+    if ( method != CopyMethod::CopyFileRange )
+    {
+        method = CopyMethod::ReadWrite;
+    }
+    for ( qint64 offset = 0; offset < size; )
+    {
+        // Where there is no support for SEEK_DATA, the whole source is data
+        qint64 dataStart = offset;
+        qint64 dataEnd = size;
+#ifdef SEEK_DATA
+        dataStart = lseek( in, off_t( offset ), SEEK_DATA );
+        if ( dataStart < 0 )
+        {
+            // ENXIO means there is no more data; otherwise assume it's all data
+            dataStart = errno == ENXIO ? size : offset;
+        }
+        else
+        {
+            dataEnd = lseek( in, off_t( dataStart ), SEEK_HOLE );
+            dataEnd = dataEnd < 0 ? size : std::min( dataEnd, size );
+        }
+#endif
+        if ( dataStart > offset && hooks.hole && !hooks.hole( offset, dataStart - offset ) )
+        {
+            return false;
+        }
+        if ( dataEnd > dataStart && !copyRange( in, out, dataStart, dataEnd - dataStart, method, hooks ) )
+        {
+            return false;
+        }
+        offset = std::max( dataStart, dataEnd );
+    }
+    return true;
+}
+
+static bool
+copyData( int in, int out, qint64 size, CopyMethod& method )
+{
+#ifdef FICLONE
+    if ( ioctl( out, FICLONE, in ) == 0 )
+    {
+        method = CopyMethod::Reflink;
+        return true;
+    }
+#endif
+
+    // Only the data extents are copied, holes stay holes
+    method = CopyMethod::CopyFileRange;
+    if ( !copyExtents( in, out, size, method ) )
+    {
+        return false;
+    }
+    // Trailing hole
+    return ftruncate( out, size ) == 0;
+}
+
+static void
+copyXattrs( int in, int out, const QString& destination )
+{
+#ifdef __linux__
+    ssize_t listSize = flistxattr( in, nullptr, 0 );
+    if ( listSize <= 0 )
+    {
+        return;
+    }
+    QByteArray names( int( listSize ), '\0' );
+    listSize = flistxattr( in, names.data(), size_t( names.size() ) );
+    QByteArray value;
+    for ( const char* name = names.constData(); listSize > 0 && name < names.constData() + listSize;
+          name += strlen( name ) + 1 )
+    {
+        const ssize_t valueSize = fgetxattr( in, name, nullptr, 0 );
+        if ( valueSize < 0 )
+        {
+            continue;
+        }
+        value.resize( int( valueSize ) );
+        if ( fgetxattr( in, name, value.data(), size_t( value.size() ) ) != valueSize
+             || fsetxattr( out, name, value.constData(), size_t( value.size() ), 0 ) != 0 )
+        {
+            if ( errno != ENOTSUP )
+            {
+                cWarning() << "Could not copy extended attribute" << name << "to" << destination << errnoString();
+            }
+        }
+    }
+#else
+    Q_UNUSED( in )
+    Q_UNUSED( out )
+    Q_UNUSED( destination )
+#endif
+}
+
+static void
+copyMetadata( int in, int out, const struct stat& st, const QString& destination, CopyFlags flags )
+{
+    // Ownership first, since chown() clears setuid and setgid
+    if ( ( flags & PreserveOwnership ) && fchown( out, st.st_uid, st.st_gid ) != 0 && geteuid() == 0 )
+    {
+        cWarning() << "Could not set ownership of" << destination << errnoString();
+    }
+    if ( ( flags & PreserveMode ) && fchmod( out, st.st_mode & 07777 ) != 0 )
+    {
+        cWarning() << "Could not set permissions of" << destination << errnoString();
+    }
+    if ( flags & PreserveXattrs )
+    {
+        copyXattrs( in, out, destination );
+    }
+    // Timestamps last, after all the other modifications
+    if ( flags & PreserveTimestamps )
+    {
+        const struct timespec times[ 2 ] = { st.st_atim, st.st_mtim };
+        if ( futimens( out, times ) != 0 )
+        {
+            cWarning() << "Could not set timestamps of" << destination << errnoString();
+        }
+    }
+}
+
+CopyResult
+copyFile( const QString& source, const QString& destination, CopyFlags flags )
+{
+    CopyResult result;
+
+    FileDescriptor in( open( QFile::encodeName( source ).constData(), O_RDONLY | O_CLOEXEC ) );
+    struct stat st;
+    if ( in < 0 || fstat( in, &st ) != 0 )
+    {
+        result.errorString = QStringLiteral( "Could not read %1: %2" ).arg( source, errnoString() );
+        return result;
+    }
+    if ( !S_ISREG( st.st_mode ) )
+    {
+        result.errorString = QStringLiteral( "Could not copy %1: not a regular file" ).arg( source );
+        return result;
+    }
+
+    const mode_t mode = ( flags & PreserveMode ) ? ( st.st_mode & 0777 ) : 0666;
+    FileDescriptor out(
+        open( QFile::encodeName( destination ).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode ) );
+    if ( out < 0 )
+    {
+        result.errorString = QStringLiteral( "Could not open %1 for writing: %2" ).arg( destination, errnoString() );
+        return result;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise( in, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+    CopyMethod method = CopyMethod::None;
+    if ( !copyData( in, out, st.st_size, method ) )
+    {
+        result.errorString = QStringLiteral( "Could not copy %1 to %2: %3" ).arg( source, destination, errnoString() );
+        return result;
+    }
+    copyMetadata( in, out, st, destination, flags );
+
+    result.method = method;
+    return result;
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,96 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_FILECOPY_H
+#define UTILS_FILECOPY_H
+
+#include "DllMacro.h"
+
+#include <QFlags>
+#include <QString>
+
+#include <functional>
+
+namespace CalamaresUtils
+{
+/// @brief How the data of a file was copied
+enum class CopyMethod
+{
+    None,  ///< Nothing was copied (the copy failed)
+    Reflink,  ///< The destination shares the data (FICLONE, e.g. btrfs or xfs)
+    CopyFileRange,  ///< The kernel copied the data (copy_file_range)
+    ReadWrite  ///< Read into a buffer, and written out again
+};
+
+enum CopyFlag
+{
+    PreserveNothing = 0x0,
+    PreserveMode = 0x1,  ///< Permission bits, including setuid, setgid and sticky
+    PreserveOwnership = 0x2,  ///< Owner and group (only possible as root)
+    PreserveTimestamps = 0x4,  ///< Access- and modification time
+    PreserveXattrs = 0x8,  ///< Extended attributes (which includes ACLs and security labels)
+    PreserveAll = 0xf
+};
+Q_DECLARE_FLAGS( CopyFlags, CopyFlag )
+Q_DECLARE_OPERATORS_FOR_FLAGS( CopyFlags )
+
+struct CopyResult
+{
+    CopyMethod method = CopyMethod::None;
+    QString errorString;  ///< Explanation, if the copy failed
+
+    bool ok() const { return method != CopyMethod::None; }
+    explicit operator bool() const { return ok(); }
+};
+
+/** @brief Copy regular file @p source to @p destination
+ *
+ * The destination is created, or truncated if it exists. The data is
+ * copied in the cheapest way available: a reflink on filesystems that
+ * support it, otherwise copy_file_range() for each data extent of the
+ * source (so that holes in sparse files stay holes), or as a last
+ * resort by reading and writing. The metadata indicated by @p flags
+ * is copied as well; failing to copy metadata (e.g. ownership when
+ * not running as root, or extended attributes on a filesystem that
+ * does not support them) is logged, but the copy still succeeds.
+ *
+ * Without PreserveMode, the destination is created with mode 0666
+ * (reduced by the umask), like QFile does.
+ */
+DLLEXPORT CopyResult copyFile( const QString& source, const QString& destination, CopyFlags flags = PreserveAll );
+
+/// @brief Hooks for copyExtents(), for copies that need more than skipping holes
+struct ExtentCopyHooks
+{
+    /// @brief Called for each hole (offset, length) in the source; unset means holes stay holes
+    std::function< bool( qint64, qint64 ) > hole;
+    /// @brief Copies data (offset, length) without copy_file_range(); unset means a plain read/write loop
+    std::function< bool( qint64, qint64 ) > readWrite;
+    /// @brief Called with the number of bytes after each chunk of data copied by the kernel
+    std::function< void( qint64 ) > progress;
+    /// @brief Largest single copy_file_range() call, so that progress is reported regularly
+    qint64 chunkSize = qint64( 1 ) << 30;
+};
+
+/** @brief Copies the first @p size bytes of file descriptor @p in to @p out
+ *
+ * This walks the data extents of the source (SEEK_DATA and SEEK_HOLE,
+ * where supported), and copies each one at the same offset in the
+ * destination. The data is copied with copy_file_range() if @p method
+ * is CopyFileRange; if that doesn't work for these files (e.g. across
+ * filesystems on older kernels), @p method is changed to ReadWrite and
+ * the rest is copied that way. The destination is not truncated.
+ *
+ * Returns @c false on failure, with errno set.
+ */
+DLLEXPORT bool copyExtents( int in, int out, qint64 size, CopyMethod& method, const ExtentCopyHooks& hooks = {} );
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,148 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Initramfs.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+
+static const char INITRAMFSDIRTY[] = "initramfsDirty";
+static const char INITRAMFSREBUILT[] = "initramfsRebuilt";
+
+namespace CalamaresUtils
+{
+namespace Initramfs
+{
+
+void
+setDirty( const QString& reason )
+{
+    auto* gs = Calamares::JobQueue::instanceGlobalStorage();
+    if ( gs )
+    {
+        cDebug() << "initramfs needs a rebuild:" << reason;
+        gs->insert( INITRAMFSDIRTY, true );
+        gs->remove( INITRAMFSREBUILT );
+    }
+}
+
+bool
+isDirty( const QStringList& command )
+{
+    auto* gs = Calamares::JobQueue::instanceGlobalStorage();
+    if ( !gs || !gs->contains( INITRAMFSDIRTY ) || gs->value( INITRAMFSDIRTY ).toBool() )
+    {
+        return true;
+    }
+    return !gs->value( INITRAMFSREBUILT ).toStringList().contains( command.join( ' ' ) );
+}
+
+void
+setClean( const QStringList& command )
+{
+    auto* gs = Calamares::JobQueue::instanceGlobalStorage();
+    if ( !gs )
+    {
+        return;
+    }
+    // If something changed (Python modules only set the flag), earlier rebuilds don't count
+    QStringList rebuilt;
+    if ( gs->contains( INITRAMFSDIRTY ) && !gs->value( INITRAMFSDIRTY ).toBool() )
+    {
+        rebuilt = gs->value( INITRAMFSREBUILT ).toStringList();
+    }
+    const QString key = command.join( ' ' );
+    if ( !rebuilt.contains( key ) )
+    {
+        rebuilt.append( key );
+    }
+    gs->insert( INITRAMFSREBUILT, rebuilt );
+    gs->insert( INITRAMFSDIRTY, false );
+}
+
+QStringList
+installedKernels()
+{
+    QStringList kernels;
+    for ( const auto* path : { "/lib/modules", "/usr/lib/modules" } )
+    {
+        // With merged /usr, these are the same directory
+        QDir d( System::instance()->targetPath( path ) );
+        for ( const auto& k : d.entryList( QDir::Dirs | QDir::NoDotAndDotDot ) )
+        {
+            if ( !kernels.contains( k ) )
+            {
+                kernels.append( k );
+            }
+        }
+    }
+    kernels.sort();
+    return kernels;
+}
+
+Calamares::JobResult
+rebuild( const QString& tool, const QList< QStringList >& commands, bool skipWhenClean )
+{
+    // ProcessResult has no default constructor, which QtConcurrent needs
+    using Result = QPair< int, QString >;
+    QList< QStringList > started;
+    QList< QFuture< Result > > running;
+    for ( const auto& command : commands )
+    {
+        if ( skipWhenClean && !isDirty( command ) )
+        {
+            cDebug() << "initramfs is up-to-date, skipping" << command;
+            continue;
+        }
+        cDebug() << "Rebuilding initramfs" << command;
+        started.append( command );
+        running.append(
+            QtConcurrent::run( [command]() -> Result { return System::instance()->targetEnvCommand( command ); } ) );
+    }
+
+    for ( int i = 0; i < running.count(); ++i )
+    {
+        running[ i ].waitForFinished();
+    }
+    int failed = -1;
+    for ( int i = 0; i < running.count(); ++i )
+    {
+        if ( running.at( i ).result().first == 0 )
+        {
+            setClean( started.at( i ) );
+        }
+        else if ( failed < 0 )
+        {
+            failed = i;
+        }
+    }
+    if ( failed >= 0 )
+    {
+        const Result r = running.at( failed ).result();
+        cError() << tool << "failed for" << started.at( failed ) << "exit code" << r.first;
+        auto result = ProcessResult( r.first, r.second )
+                          .explainProcess( started.at( failed ), std::chrono::seconds( 10 ) /* fake timeout */ );
+        // The details say which command failed, and how
+        result.setMessage(
+            QCoreApplication::translate( "CalamaresUtils::Initramfs", "Could not rebuild the initramfs with %1." )
+                .arg( tool ) );
+        return result;
+    }
+    return Calamares::JobResult::ok();
+}
+
+}  // namespace Initramfs
+}  // namespace CalamaresUtils
@@ -0,0 +1,76 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_INITRAMFS_H
+#define UTILS_INITRAMFS_H
+
+#include "DllMacro.h"
+#include "Job.h"
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+/** @brief Coordination of initramfs rebuilds
+ *
+ * Several modules change the inputs of the initramfs (e.g. *initcpiocfg*,
+ * *luksbootkeyfile*, *plymouthcfg*), and one or more modules rebuild it
+ * (*initcpio*, *initramfs*, *dracut*). Each of the latter used to rebuild
+ * unconditionally, so a sequence with more than one of them, or a distro
+ * where package installation already rebuilt the initramfs, does the
+ * expensive work several times.
+ *
+ * Global storage key *initramfsDirty* tracks whether anything changed:
+ *  - unset: unknown, so rebuild (this is the behavior of older sequences);
+ *  - true: something changed since the last rebuild;
+ *  - false: nothing changed since the rebuilds listed in *initramfsRebuilt*.
+ * The list *initramfsRebuilt* holds the rebuild commands (e.g.
+ * "mkinitcpio -p linux"), each joined with spaces, so that a rebuild
+ * for one kernel or preset doesn't count for another.
+ *
+ * Not every module that changes the initramfs inputs marks it dirty
+ * (e.g. *shellprocess* can do anything), so skipping a rebuild is
+ * something each instance of the rebuilding modules opts in to.
+ *
+ * Python modules set *initramfsDirty* directly in global storage.
+ */
+namespace Initramfs
+{
+/// @brief Mark the initramfs as needing a rebuild; @p reason is logged
+DLLEXPORT void setDirty( const QString& reason );
+/// @brief Does @p command need to run? (true unless it ran, and nothing changed since)
+DLLEXPORT bool isDirty( const QStringList& command );
+/// @brief Mark the initramfs as up-to-date for @p command
+DLLEXPORT void setClean( const QStringList& command );
+
+/** @brief Kernel versions installed in the target system
+ *
+ * These are the names of the directories in /lib/modules and
+ * /usr/lib/modules of the target, sorted.
+ */
+DLLEXPORT QStringList installedKernels();
+
+/** @brief Runs the rebuild @p commands in the target, in parallel
+ *
+ * Each command (usually one per kernel) runs in a thread of its own
+ * since each rebuild is mostly single-threaded (compression aside).
+ * With @p skipWhenClean, commands that are not dirty are left out.
+ * The commands that succeed are marked clean. If any of them fails,
+ * the result explains the first failure; its message names @p tool
+ * (e.g. "mkinitcpio") and the details give the command and its output.
+ */
+DLLEXPORT Calamares::JobResult
+rebuild( const QString& tool, const QList< QStringList >& commands, bool skipWhenClean = false );
+
+}  // namespace Initramfs
+}  // namespace CalamaresUtils
+
+#endif
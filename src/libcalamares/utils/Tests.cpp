@@ -11,6 +11,7 @@
 
 #include "CalamaresUtilsSystem.h"
 #include "Entropy.h"
+#include "FileCopy.h"
 #include "Logger.h"
 #include "RAII.h"
 #include "String.h"
@@ -22,6 +23,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 
 #include <QtTest/QtTest>
@@ -70,6 +72,11 @@ private Q_SLOTS:
     void testStringTruncationShorter();
     void testStringTruncationDegenerate();
 
+    /** @section Test file copying. */
+    void testCopyFile();
+    void benchmarkCopyFile_data();
+    void benchmarkCopyFile();
+
 private:
     void recursiveCompareMap( const QVariantMap& a, const QVariantMap& b, int depth );
 };
@@ -745,6 +752,138 @@ LibCalamaresTests::testStringTruncationDegenerate()
     }
 }
 
+void
+LibCalamaresTests::testCopyFile()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source" );
+    const QString destination = dir.filePath( "destination" );
+
+    // Sparse file: data, a hole, data, and a hole at the end
+    QByteArray data( 64 * 1024, 'x' );
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( data ), qint64( data.size() ) );
+        QVERIFY( f.seek( 4 * 1024 * 1024 ) );
+        QCOMPARE( f.write( data ), qint64( data.size() ) );
+        QVERIFY( f.resize( 8 * 1024 * 1024 ) );
+    }
+    QVERIFY( QFile::setPermissions( source, QFileDevice::ReadOwner | QFileDevice::WriteOwner ) );
+    const QDateTime modified = QDateTime::fromSecsSinceEpoch( 1000000000 );
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::ReadWrite ) );
+        QVERIFY( f.setFileTime( modified, QFileDevice::FileModificationTime ) );
+    }
+    // An existing destination is overwritten
+    {
+        QFile f( destination );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QVERIFY( f.write( QByteArray( 16 * 1024 * 1024, 'y' ) ) > 0 );
+    }
+
+    auto r = CalamaresUtils::copyFile( source, destination );
+    QVERIFY( r );
+    QVERIFY( r.errorString.isEmpty() );
+    cDebug() << "Copied with method" << int( r.method );
+
+    QFile copied( destination );
+    QVERIFY( copied.open( QIODevice::ReadOnly ) );
+    QFile original( source );
+    QVERIFY( original.open( QIODevice::ReadOnly ) );
+    QCOMPARE( copied.size(), original.size() );
+    QVERIFY( copied.readAll() == original.readAll() );
+    QVERIFY( !( copied.permissions() & ( QFileDevice::ReadGroup | QFileDevice::ReadOther ) ) );
+    QCOMPARE( QFileInfo( destination ).lastModified(), modified );
+
+    // Holes stay holes (unless it's a reflink, then it's shared anyway)
+    struct stat sourceStat;
+    struct stat destinationStat;
+    QCOMPARE( stat( source.toLocal8Bit(), &sourceStat ), 0 );
+    QCOMPARE( stat( destination.toLocal8Bit(), &destinationStat ), 0 );
+    if ( sourceStat.st_blocks * 512 < sourceStat.st_size )
+    {
+        QVERIFY( destinationStat.st_blocks * 512 < destinationStat.st_size );
+    }
+
+    // Without preserving things, the umask applies
+    const QString plain = dir.filePath( "plain" );
+    {
+        CalamaresUtils::UMask um( 022 );
+        QVERIFY( CalamaresUtils::copyFile( source, plain, CalamaresUtils::PreserveNothing ) );
+    }
+    QVERIFY( QFileInfo( plain ).permissions() & QFileDevice::ReadOther );
+    QVERIFY( QFileInfo( plain ).lastModified() != modified );
+
+    // Failures
+    auto missing = CalamaresUtils::copyFile( dir.filePath( "missing" ), destination );
+    QVERIFY( !missing );
+    QCOMPARE( missing.method, CalamaresUtils::CopyMethod::None );
+    QVERIFY( !missing.errorString.isEmpty() );
+    QVERIFY( !CalamaresUtils::copyFile( dir.path(), destination ) );  // Not a regular file
+    QVERIFY( !CalamaresUtils::copyFile( source, dir.filePath( "no/such/dir" ) ) );
+}
+
+void
+LibCalamaresTests::benchmarkCopyFile_data()
+{
+    QTest::addColumn< int >( "method" );
+
+    QTest::newRow( "QByteArray loop" ) << 0;
+    QTest::newRow( "QFile::copy" ) << 1;
+    QTest::newRow( "copyFile" ) << 2;
+}
+
+void
+LibCalamaresTests::benchmarkCopyFile()
+{
+    QFETCH( int, method );
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source" );
+    const QString destination = dir.filePath( "destination" );
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QByteArray chunk( 1024 * 1024, 'c' );
+        for ( int i = 0; i < 64; ++i )
+        {
+            QCOMPARE( f.write( chunk ), qint64( chunk.size() ) );
+        }
+    }
+
+    QBENCHMARK
+    {
+        QFile::remove( destination );
+        switch ( method )
+        {
+        case 0:
+        {
+            // This is how preservefiles used to copy
+            QFile in( source );
+            QFile out( destination );
+            QVERIFY( in.open( QIODevice::ReadOnly ) && out.open( QIODevice::WriteOnly ) );
+            QByteArray b;
+            do
+            {
+                b = in.read( 1024 * 1024 );
+                out.write( b );
+            } while ( b.count() > 0 );
+            break;
+        }
+        case 1:
+            QVERIFY( QFile::copy( source, destination ) );
+            break;
+        default:
+            QVERIFY( CalamaresUtils::copyFile( source, destination ) );
+        }
+    }
+    QCOMPARE( QFileInfo( destination ).size(), qint64( 64 * 1024 * 1024 ) );
+}
+
 
 QTEST_GUILESS_MAIN( LibCalamaresTests )
 
@@ -19,6 +19,7 @@
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
 #include "utils/Units.h"
+#include "utils/Variant.h"
 #include "utils/Yaml.h"
 
 #include <QDir>
@@ -151,7 +152,8 @@ uploadServerFromMap( const QVariantMap& map )
     // clang-format off
     static const NamedEnumTable< Type > names {
         { "none", Type::None },
-        { "fiche", Type::Fiche }
+        { "fiche", Type::Fiche },
+        { "http", Type::Http }
     };
     // clang-format on
     // *INDENT-ON*
@@ -162,14 +164,15 @@ uploadServerFromMap( const QVariantMap& map )
 
     if ( typestring.isEmpty() || urlstring.isEmpty() )
     {
-        return Branding::UploadServerInfo( Branding::UploadServerType::None, QUrl(), 0 );
+        return Branding::UploadServerInfo( Branding::UploadServerType::None, QUrl(), 0, false );
     }
 
     bool bogus = false;  // we don't care about type-name lookup success here
     return Branding::UploadServerInfo(
         names.find( typestring, bogus ),
         QUrl( urlstring, QUrl::ParsingMode::StrictMode ),
-        sizeLimitKiB >= 0 ? CalamaresUtils::KiBtoBytes( static_cast< unsigned long long >( sizeLimitKiB ) ) : -1 );
+        sizeLimitKiB >= 0 ? CalamaresUtils::KiBtoBytes( static_cast< unsigned long long >( sizeLimitKiB ) ) : -1,
+        CalamaresUtils::getBool( map, "compress", true ) );
 }
 
 /** @brief Load the @p map with strings from @p config
@@ -90,7 +90,8 @@ public:
     enum UploadServerType : short
     {
         None,
-        Fiche
+        Fiche,
+        Http
     };
     Q_ENUM( UploadServerType )
 
@@ -223,11 +224,12 @@ public:
 
     /** @brief Upload server configuration
      *
-     * This object has 3 items : the type (which may be none, in which case the URL
-     * is irrelevant and usually empty), the URL for the upload and the size limit of upload
-     * in bytes (for configuration value < 0, it serves -1, which stands for having no limit).
+     * This object has 4 items : the type (which may be none, in which case the URL
+     * is irrelevant and usually empty), the URL for the upload, the size limit of upload
+     * in bytes (for configuration value < 0, it serves -1, which stands for having no limit)
+     * and whether the upload should be gzip-compressed (only for Http).
      */
-    using UploadServerInfo = std::tuple< UploadServerType, QUrl, qint64 >;
+    using UploadServerInfo = std::tuple< UploadServerType, QUrl, qint64, bool >;
     UploadServerInfo uploadServer() const { return m_uploadServer; }
 
     /**
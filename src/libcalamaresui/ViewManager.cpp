@@ -32,6 +32,7 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QTimer>
 
 #define UPDATE_BUTTON_PROPERTY( name, value ) \
     do \
@@ -63,6 +64,7 @@ ViewManager::ViewManager( QObject* parent )
     : QAbstractListModel( parent )
     , m_currentStep( -1 )
     , m_widget( new QWidget() )
+    , m_prefetchTimer( new QTimer( this ) )
     , m_panelSides( Qt::Horizontal | Qt::Vertical )
 {
     Q_ASSERT( !s_instance );
@@ -82,6 +84,12 @@ ViewManager::ViewManager( QObject* parent )
     connect( JobQueue::instance(), &JobQueue::failed, this, &ViewManager::onInstallationFailed );
     connect( JobQueue::instance(), &JobQueue::finished, this, &ViewManager::next );
 
+    // Once the user has been on a step for a bit, warm up the next one
+    m_prefetchTimer->setSingleShot( true );
+    m_prefetchTimer->setInterval( std::chrono::milliseconds( 300 ) );
+    connect( m_prefetchTimer, &QTimer::timeout, this, &ViewManager::prefetchNextStep );
+    connect( this, &ViewManager::currentStepChanged, m_prefetchTimer, qOverload<>( &QTimer::start ) );
+
     CALAMARES_RETRANSLATE_SLOT( &ViewManager::updateButtonLabels );
 
 #ifdef PRESERVE_FOR_TRANSLATION_PURPOSES
@@ -390,6 +398,25 @@ ViewManager::next()
     updateButtonLabels();
 }
 
+void
+ViewManager::prefetchNextStep()
+{
+    const int nextStep = m_currentStep + 1;
+    if ( !currentStepValid() || nextStep >= m_steps.count() )
+    {
+        return;
+    }
+
+    ViewStep* step = m_steps.at( nextStep );
+    // The execution step starts doing things when activated; nothing to warm up
+    if ( qobject_cast< ExecutionViewStep* >( step ) )
+    {
+        return;
+    }
+    cDebug() << "Prefetching step" << nextStep << step->prettyName();
+    step->onPrefetch();
+}
+
 void
 ViewManager::updateButtonLabels()
 {
@@ -19,6 +19,8 @@
 #include <QPushButton>
 #include <QStackedWidget>
 
+class QTimer;
+
 namespace Calamares
 {
 /**
@@ -240,6 +242,8 @@ private:
     void updateButtonLabels();
     void updateCancelEnabled( bool enabled );
     void updateBackAndNextVisibility( bool visible );
+    /// @brief Give the step after the current one a chance to prepare (see ViewStep::onPrefetch())
+    void prefetchNextStep();
 
     inline bool currentStepValid() const { return ( 0 <= m_currentStep ) && ( m_currentStep < m_steps.length() ); }
 
@@ -250,6 +254,7 @@ private:
 
     QWidget* m_widget;
     QStackedWidget* m_stack;
+    QTimer* m_prefetchTimer;  ///< Delays prefetching until the current step has settled
 
     bool m_nextEnabled = false;
     QString m_nextLabel;
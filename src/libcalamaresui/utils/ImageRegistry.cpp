@@ -8,12 +8,165 @@
 
 #include "ImageRegistry.h"
 
+#include <QCache>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QIcon>
+#include <QImage>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 
-static QHash< QString, QHash< int, QHash< qint64, QPixmap > > > s_cache;
+#include <algorithm>
 
+namespace
+{
+/// @brief Identifies one image at one size in the cache
+struct ImageKey
+{
+    QString image;
+    int mode;
+    QSize size;
+
+    bool operator==( const ImageKey& other ) const
+    {
+        return mode == other.mode && size == other.size && image == other.image;
+    }
+};
+
+uint
+qHash( const ImageKey& key, uint seed = 0 )
+{
+    return ::qHash( key.image, seed ) ^ ::qHash( ( key.size.width() << 16 ) ^ key.size.height() ^ ( key.mode << 28 ) );
+}
+}  // namespace
+
+/// Cost is counted in KiB, so that large budgets fit in an int
+static constexpr qint64 costUnit = 1024;
+/// Default memory budget, enough for branding and a handful of screenshots
+static constexpr qint64 defaultCacheLimit = 32 * 1024 * 1024;
+
+/// @brief The size to scale an image of size @p natural to, for requested @p size
+static QSize
+targetSize( const QSize& natural, const QSize& size )
+{
+    if ( size.isNull() || natural.isEmpty() )
+    {
+        return natural;
+    }
+    if ( size.width() == 0 )
+    {
+        return QSize( std::max( 1, qRound( qreal( natural.width() ) * size.height() / natural.height() ) ),
+                      size.height() );
+    }
+    if ( size.height() == 0 )
+    {
+        return QSize( size.width(),
+                      std::max( 1, qRound( qreal( natural.height() ) * size.width() / natural.width() ) ) );
+    }
+    return size;
+}
+
+/** @brief Loads the @p image at the given @p size
+ *
+ * This only uses QImage, so it can run in a worker thread. SVG images
+ * are rendered at the target size, rather than scaled afterwards.
+ */
+static QImage
+loadImage( const QString& image, const QSize& size )
+{
+    const QString lowerName = image.toLower();
+    if ( lowerName.endsWith( ".svg" ) || lowerName.endsWith( ".svgz" ) )
+    {
+        QSvgRenderer svgRenderer( image );
+        const QSize target = targetSize( svgRenderer.defaultSize(), size );
+        if ( !svgRenderer.isValid() || target.isEmpty() )
+        {
+            return QImage();
+        }
+        QImage img( target, QImage::Format_ARGB32_Premultiplied );
+        img.fill( Qt::transparent );
+
+        QPainter pixPainter( &img );
+        svgRenderer.render( &pixPainter );
+        pixPainter.end();
+        return img;
+    }
+
+    QImage img( image );
+    const QSize target = targetSize( img.size(), size );
+    if ( !img.isNull() && img.size() != target )
+    {
+        img = img.scaled( target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    }
+    return img;
+}
+
+struct ImageRegistry::Private
+{
+    QCache< ImageKey, QPixmap > cache;
+    /// Images that are being loaded in the background
+    QHash< ImageKey, QFuture< QImage > > pending;
+    QThreadPool pool;
+    /// Parent of the watchers that finish background loads
+    QObject watchers;
+
+    QFuture< QImage > load( const ImageKey& key );
+    QPixmap insert( const ImageKey& key, const QImage& image );
+};
+
+QFuture< QImage >
+ImageRegistry::Private::load( const ImageKey& key )
+{
+    auto it = pending.constFind( key );
+    if ( it != pending.constEnd() )
+    {
+        return it.value();
+    }
+    const QString image = key.image;
+    const QSize size = key.size;
+    auto future = QtConcurrent::run( &pool, [ image, size ]() { return loadImage( image, size ); } );
+    pending.insert( key, future );
+
+    // Finish the load here, rather than in whoever asked for it: they
+    // may be gone by the time the image is ready.
+    auto* watcher = new QFutureWatcher< QImage >( &watchers );
+    QObject::connect( watcher, &QFutureWatcherBase::finished, watcher, [ this, key, watcher ]() {
+        if ( pending.value( key ) == watcher->future() )
+        {
+            pending.remove( key );
+        }
+        insert( key, watcher->result() );
+        watcher->deleteLater();
+    } );
+    watcher->setFuture( future );
+    return future;
+}
+
+/// @brief Turns a loaded @p image into a pixmap (in the GUI thread) and caches it
+QPixmap
+ImageRegistry::Private::insert( const ImageKey& key, const QImage& image )
+{
+    if ( const QPixmap* cached = cache.object( key ) )
+    {
+        // Another request for the same image got here first
+        return *cached;
+    }
+    if ( image.isNull() )
+    {
+        return QPixmap();
+    }
+
+    QPixmap pixmap = QPixmap::fromImage( image );
+    if ( key.mode == CalamaresUtils::RoundedCorners )
+    {
+        pixmap = CalamaresUtils::createRoundedImage( pixmap, pixmap.size() );
+    }
+    const qint64 bytes = qint64( pixmap.width() ) * pixmap.height() * std::max( 1, pixmap.depth() ) / 8;
+    cache.insert( key, new QPixmap( pixmap ), int( std::max( qint64( 1 ), bytes / costUnit ) ) );
+    return pixmap;
+}
 
 ImageRegistry*
 ImageRegistry::instance()
@@ -23,20 +176,22 @@ ImageRegistry::instance()
 }
 
 
-ImageRegistry::ImageRegistry() {}
-
+ImageRegistry::ImageRegistry()
+    : d( std::make_unique< Private >() )
+{
+    setCacheLimit( defaultCacheLimit );
+}
 
-QIcon
-ImageRegistry::icon( const QString& image, CalamaresUtils::ImageMode mode )
+ImageRegistry::~ImageRegistry()
 {
-    return pixmap( image, CalamaresUtils::defaultIconSize(), mode );
+    d->pool.waitForDone();
 }
 
 
-qint64
-ImageRegistry::cacheKey( const QSize& size )
+QIcon
+ImageRegistry::icon( const QString& image, CalamaresUtils::ImageMode mode )
 {
-    return size.width() * 100 + size.height() * 10;
+    return pixmap( image, CalamaresUtils::defaultIconSize(), mode );
 }
 
 
@@ -49,93 +204,79 @@ ImageRegistry::pixmap( const QString& image, const QSize& size, CalamaresUtils::
         return QPixmap();
     }
 
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
-
-    if ( s_cache.contains( image ) )
+    const ImageKey key { image, mode, size };
+    if ( const QPixmap* cached = d->cache.object( key ) )
     {
-        subcache = s_cache.value( image );
-
-        if ( subcache.contains( mode ) )
-        {
-            subsubcache = subcache.value( mode );
-
-            const qint64 ck = cacheKey( size );
-            if ( subsubcache.contains( ck ) )
-            {
-                return subsubcache.value( ck );
-            }
-        }
+        return *cached;
     }
 
-    // Image not found in cache. Let's load it.
-    QPixmap pixmap;
-    if ( image.toLower().endsWith( ".svg" ) )
-    {
-        QSvgRenderer svgRenderer( image );
-        QPixmap p( size.isNull() || size.height() == 0 || size.width() == 0 ? svgRenderer.defaultSize() : size );
-        p.fill( Qt::transparent );
-
-        QPainter pixPainter( &p );
-        svgRenderer.render( &pixPainter );
-        pixPainter.end();
+    // If it is already loading in the background, wait for that
+    auto it = d->pending.constFind( key );
+    return d->insert( key, it != d->pending.constEnd() ? it.value().result() : loadImage( image, size ) );
+}
 
-        pixmap = p;
-    }
-    else
+QPixmap
+ImageRegistry::pixmapAsync( const QString& image,
+                            const QSize& size,
+                            CalamaresUtils::ImageMode mode,
+                            QObject* context,
+                            const std::function< void( const QPixmap& ) >& callback )
+{
+    if ( size.width() < 0 || size.height() < 0 )
     {
-        pixmap = QPixmap( image );
+        return QPixmap();
     }
 
-    if ( !pixmap.isNull() )
+    const ImageKey key { image, mode, size };
+    if ( const QPixmap* cached = d->cache.object( key ) )
     {
-        if ( mode == CalamaresUtils::RoundedCorners )
-        {
-            pixmap = CalamaresUtils::createRoundedImage( pixmap, size );
-        }
+        return *cached;
+    }
 
-        if ( !size.isNull() && pixmap.size() != size )
-        {
-            if ( size.width() == 0 )
-            {
-                pixmap = pixmap.scaledToHeight( size.height(), Qt::SmoothTransformation );
-            }
-            else if ( size.height() == 0 )
-            {
-                pixmap = pixmap.scaledToWidth( size.width(), Qt::SmoothTransformation );
-            }
-            else
-            {
-                pixmap = pixmap.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-            }
-        }
+    // The watcher goes away with the context, and then the callback is not called;
+    // the load itself is still finished and cached by Private::load().
+    auto* watcher = new QFutureWatcher< QImage >( context );
+    QObject::connect( watcher, &QFutureWatcherBase::finished, watcher, [ this, key, watcher, callback ]() {
+        const QPixmap pixmap = d->insert( key, watcher->result() );
+        watcher->deleteLater();
+        callback( pixmap );
+    } );
+    watcher->setFuture( d->load( key ) );
 
-        putInCache( image, size, mode, pixmap );
+    QPixmap placeholder( size.isEmpty() ? QSize() : size );
+    if ( !placeholder.isNull() )
+    {
+        placeholder.fill( Qt::transparent );
     }
-
-    return pixmap;
+    return placeholder;
 }
 
+bool
+ImageRegistry::isCached( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode ) const
+{
+    return d->cache.contains( ImageKey { image, mode, size } );
+}
 
 void
-ImageRegistry::putInCache( const QString& image,
-                           const QSize& size,
-                           CalamaresUtils::ImageMode mode,
-                           const QPixmap& pixmap )
+ImageRegistry::setCacheLimit( qint64 bytes )
 {
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
+    d->cache.setMaxCost( int( std::max( qint64( 1 ), bytes / costUnit ) ) );
+}
 
-    if ( s_cache.contains( image ) )
-    {
-        subcache = s_cache.value( image );
-        if ( subcache.contains( mode ) )
-        {
-            subsubcache = subcache.value( mode );
-        }
-    }
+qint64
+ImageRegistry::cacheLimit() const
+{
+    return qint64( d->cache.maxCost() ) * costUnit;
+}
 
-    subsubcache.insert( cacheKey( size ), pixmap );
-    subcache.insert( mode, subsubcache );
-    s_cache.insert( image, subcache );
+qint64
+ImageRegistry::cacheSize() const
+{
+    return qint64( d->cache.totalCost() ) * costUnit;
+}
+
+void
+ImageRegistry::clear()
+{
+    d->cache.clear();
 }
@@ -14,20 +14,65 @@
 #include "DllMacro.h"
 #include "utils/CalamaresUtilsGui.h"
 
+#include <functional>
+#include <memory>
+
+class QObject;
+
+/** @brief Cache of images (e.g. branding images) at the sizes they are used
+ *
+ * Images are kept until the cache grows beyond its limit; then the
+ * least-recently used images are dropped. The registry is meant to
+ * be used from the GUI thread only; the decoding and rendering of
+ * images for pixmapAsync() happens in worker threads.
+ */
 class UIDLLEXPORT ImageRegistry
 {
 public:
     static ImageRegistry* instance();
 
     explicit ImageRegistry();
+    ~ImageRegistry();
 
     QIcon icon( const QString& image, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+    /** @brief The @p image at the given @p size
+     *
+     * A width or height of 0 means "keep the aspect ratio", a null size
+     * means the natural size of the image. If the image is not yet
+     * in the cache, this loads it (and blocks until that is done).
+     */
     QPixmap
     pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
 
+    /** @brief The @p image at the given @p size, without blocking
+     *
+     * If the image is in the cache, returns it. Otherwise, returns
+     * a (transparent) placeholder pixmap and loads the image in the
+     * background; once loaded, @p callback is called with the
+     * image in the GUI thread -- unless @p context was destroyed
+     * in the meantime.
+     */
+    QPixmap pixmapAsync( const QString& image,
+                         const QSize& size,
+                         CalamaresUtils::ImageMode mode,
+                         QObject* context,
+                         const std::function< void( const QPixmap& ) >& callback );
+
+    /// @brief Is the image in the cache?
+    bool isCached( const QString& image,
+                   const QSize& size,
+                   CalamaresUtils::ImageMode mode = CalamaresUtils::Original ) const;
+
+    /// @brief Sets the memory budget for the cache, in bytes
+    void setCacheLimit( qint64 bytes );
+    qint64 cacheLimit() const;
+    /// @brief Memory used by the cached images, in bytes (roughly)
+    qint64 cacheSize() const;
+    void clear();
+
 private:
-    qint64 cacheKey( const QSize& size );
-    void putInCache( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode, const QPixmap& pixmap );
+    struct Private;
+    std::unique_ptr< Private > d;
 };
 
 #endif  // IMAGE_REGISTRY_H
@@ -10,6 +10,7 @@
 #include "Paste.h"
 
 #include "Branding.h"
+#include "CalamaresVersion.h"
 #include "DllMacro.h"
 #include "utils/Logger.h"
 #include "utils/Units.h"
@@ -17,148 +18,493 @@
 
 #include <QApplication>
 #include <QClipboard>
+#include <QEventLoop>
 #include <QFile>
-#include <QFileInfo>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QTcpSocket>
 #include <QUrl>
 #include <QWidget>
 
+#ifndef QT_NO_SSL
+#include <QSslSocket>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
 using namespace CalamaresUtils::Units;
+using Calamares::Branding;
+
+/// Size of the pieces of log that are read (and compressed) at a time
+static constexpr qint64 chunkSize = 64 * 1024;
+/// More of the log is read only when less than this is waiting to be sent
+static constexpr qint64 writeBufferLimit = 4 * chunkSize;
+
+/// @brief The CRC-32 (as used by gzip) of @p data
+static quint32
+crc32( const QByteArray& data )
+{
+    static const auto table = []() {
+        std::array< quint32, 256 > t {};
+        for ( quint32 i = 0; i < 256; ++i )
+        {
+            quint32 c = i;
+            for ( int k = 0; k < 8; ++k )
+            {
+                c = ( c & 1 ) ? ( 0xedb88320u ^ ( c >> 1 ) ) : ( c >> 1 );
+            }
+            t[ i ] = c;
+        }
+        return t;
+    }();
 
-/** @brief Reads the logfile, returns its contents.
+    quint32 crc = 0xffffffffu;
+    for ( const char c : data )
+    {
+        crc = table[ ( crc ^ quint8( c ) ) & 0xff ] ^ ( crc >> 8 );
+    }
+    return crc ^ 0xffffffffu;
+}
+
+static void
+appendLittleEndian32( QByteArray& a, quint32 v )
+{
+    for ( int i = 0; i < 4; ++i )
+    {
+        a.append( char( ( v >> ( 8 * i ) ) & 0xff ) );
+    }
+}
+
+/** @brief Compresses @p data into a gzip member
+ *
+ * A gzip file may consist of several members, which are decompressed
+ * one after the other, so compressing each chunk of the log as it
+ * is read gives a valid gzip stream. qCompress() gives a 4-byte size
+ * and then a zlib stream: a 2-byte header, the deflate data and a 4-byte
+ * checksum. gzip wants the deflate data with a different header and trailer.
  *
- * Returns an empty QByteArray() on any kind of error.
+ * Returns an empty QByteArray() for empty @p data.
  */
 STATICTEST QByteArray
-logFileContents( const qint64 sizeLimitBytes )
+gzipMember( const QByteArray& data )
 {
-    if ( sizeLimitBytes > 0 )
+    const QByteArray z = qCompress( data );
+    if ( data.isEmpty() || z.size() < 10 )
     {
-        cDebug() << "Log upload size limit was limited to" << sizeLimitBytes << "bytes";
+        return QByteArray();
     }
-    if ( sizeLimitBytes == 0 )
+
+    // Magic, deflate, no flags, no time, no extra flags, Unix
+    static const char header[] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3 };
+    QByteArray member;
+    member.reserve( z.size() + 12 );
+    member.append( header, sizeof( header ) );
+    member.append( z.constData() + 6, z.size() - 10 );
+    appendLittleEndian32( member, crc32( data ) );
+    appendLittleEndian32( member, quint32( data.size() ) );
+    return member;
+}
+
+/** @brief The paste URL in a fiche @p response
+ *
+ * Fiche replies with a single line, the URL, which is on the same
+ * host as the @p serverUrl.
+ */
+static QString
+ficheUrl( const QByteArray& response, const QUrl& serverUrl )
+{
+    const QByteArray responseText = response.left( response.indexOf( '\n' ) ).left( 1024 );
+    QUrl pasteUrl = QUrl( QString( responseText ).trimmed(), QUrl::StrictMode );
+    if ( pasteUrl.isValid() && pasteUrl.host() == serverUrl.host() )
     {
-        cDebug() << "Log upload size is 0, upload disabled.";
-        return QByteArray();
+        return pasteUrl.toString();
+    }
+    cError() << "No data from paste server";
+    return QString();
+}
+
+/** @brief The paste URL in the HTTP @p response to a POST to @p serverUrl
+ *
+ * The URL is taken from the Location header if there is one (it may be
+ * relative to the @p serverUrl), otherwise it is the first line of
+ * the body of the response.
+ */
+STATICTEST QString
+httpPasteUrl( const QByteArray& response, const QUrl& serverUrl )
+{
+    const int headerEnd = response.indexOf( "\r\n\r\n" );
+    if ( headerEnd < 0 )
+    {
+        cError() << "No (complete) response from paste server";
+        return QString();
     }
 
-    const QString name = Logger::logFile();
-    QFile pasteSourceFile( name );
-    if ( !pasteSourceFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    const QList< QByteArray > headerLines = response.left( headerEnd ).split( '\n' );
+    // The status line looks like "HTTP/1.1 201 Created"
+    const QList< QByteArray > status = headerLines.first().trimmed().split( ' ' );
+    const int code = status.count() > 1 ? status.at( 1 ).toInt() : 0;
+    if ( code < 200 || code >= 300 )
     {
-        cWarning() << "Could not open log file" << name;
-        return QByteArray();
+        cError() << "Paste server refused the upload:" << headerLines.first().trimmed();
+        return QString();
     }
-    if ( sizeLimitBytes < 0 )
+
+    QByteArray location;
+    bool chunked = false;
+    for ( auto it = headerLines.cbegin() + 1; it != headerLines.cend(); ++it )
     {
-        return pasteSourceFile.readAll();
+        const int colon = it->indexOf( ':' );
+        if ( colon < 0 )
+        {
+            continue;
+        }
+        const QByteArray name = it->left( colon ).trimmed().toLower();
+        const QByteArray value = it->mid( colon + 1 ).trimmed();
+        if ( name == "location" )
+        {
+            location = value;
+        }
+        else if ( name == "transfer-encoding" )
+        {
+            chunked = value.toLower().contains( "chunked" );
+        }
     }
-    QFileInfo fi( pasteSourceFile );
-    if ( fi.size() > sizeLimitBytes )
+    if ( location.isEmpty() )
     {
-        cDebug() << "Only last" << sizeLimitBytes << "bytes of log file (sized" << fi.size() << "bytes) uploaded";
-        fi.refresh();  // Because we just wrote to the file with that cDebug() ^^
-        pasteSourceFile.seek( fi.size() - sizeLimitBytes );
+        QList< QByteArray > bodyLines = response.mid( headerEnd + 4 ).split( '\n' );
+        if ( chunked && !bodyLines.isEmpty() )
+        {
+            // Skip the size of the first chunk
+            bodyLines.removeFirst();
+        }
+        location = bodyLines.isEmpty() ? QByteArray() : bodyLines.first().trimmed();
+    }
+
+    const QUrl pasteUrl = serverUrl.resolved( QUrl( QString::fromUtf8( location ), QUrl::StrictMode ) );
+    if ( !location.isEmpty() && pasteUrl.isValid()
+         && ( pasteUrl.scheme() == QStringLiteral( "http" ) || pasteUrl.scheme() == QStringLiteral( "https" ) ) )
+    {
+        return pasteUrl.toString();
     }
-    return pasteSourceFile.read( sizeLimitBytes );
+    cError() << "No paste URL from paste server";
+    return QString();
 }
 
+namespace CalamaresUtils
+{
+namespace Paste
+{
 
-STATICTEST QString
-ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent )
+LogUploader::LogUploader( Branding::UploadServerType type,
+                          const QUrl& serverUrl,
+                          qint64 sizeLimitBytes,
+                          bool compress,
+                          QObject* parent )
+    : QObject( parent )
+    , m_type( type )
+    , m_serverUrl( serverUrl )
+    , m_sizeLimitBytes( sizeLimitBytes )
+    , m_compress( compress && type == Branding::UploadServerType::Http )
+    , m_logFileName( Logger::logFile() )
 {
-    QTcpSocket* socket = new QTcpSocket( parent );
-    socket->connectToHost( serverUrl.host(), serverUrl.port() );
+    m_timeout.setSingleShot( true );
+    m_timeout.setInterval( 30000 );
+    connect( &m_timeout, &QTimer::timeout, this, [ this ]() {
+        cError() << "Paste server did not respond in time";
+        finish( QString() );
+    } );
+}
 
-    if ( !socket->waitForConnected() )
+LogUploader::~LogUploader() {}
+
+void
+LogUploader::start()
+{
+    if ( m_socket || m_finished )
     {
-        cError() << "Could not connect to paste server";
-        socket->close();
-        return QString();
+        return;
+    }
+    if ( m_type == Branding::UploadServerType::None )
+    {
+        cWarning() << "No upload configured.";
+        finish( QString() );
+        return;
+    }
+    if ( m_sizeLimitBytes == 0 )
+    {
+        cDebug() << "Log upload size is 0, upload disabled.";
+        finish( QString() );
+        return;
     }
 
-    cDebug() << "Connected to paste server" << serverUrl.host();
+    m_logFile.setFileName( m_logFileName );
+    if ( !m_logFile.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not open log file" << m_logFileName;
+        finish( QString() );
+        return;
+    }
+    // Only what is in the log now is sent, even though logging goes on
+    const qint64 size = m_logFile.size();
+    m_bytesTotal = m_sizeLimitBytes > 0 ? std::min( size, m_sizeLimitBytes ) : size;
+    if ( m_bytesTotal == 0 )
+    {
+        cWarning() << "Log file" << m_logFileName << "is empty";
+        finish( QString() );
+        return;
+    }
+    if ( m_bytesTotal < size )
+    {
+        cDebug() << "Only last" << m_bytesTotal << "bytes of log file (sized" << size << "bytes) uploaded";
+        m_logFile.seek( size - m_bytesTotal );
+    }
 
-    socket->write( pasteData );
+    const bool http = m_type == Branding::UploadServerType::Http;
+    const bool https = http && m_serverUrl.scheme() == QStringLiteral( "https" );
+    auto onConnected = [ this, http ]() {
+        cDebug() << "Connected to paste server" << m_serverUrl.host();
+        if ( http )
+        {
+            const QByteArray path
+                = m_serverUrl.toEncoded( QUrl::RemoveScheme | QUrl::RemoveAuthority | QUrl::RemoveFragment );
+            QByteArray host = m_serverUrl.host( QUrl::FullyEncoded ).toUtf8();
+            if ( m_serverUrl.port() > 0 )
+            {
+                host += ':' + QByteArray::number( m_serverUrl.port() );
+            }
+            m_socket->write( "POST " + ( path.isEmpty() ? QByteArray( "/" ) : path ) + " HTTP/1.1\r\n"
+                             "Host: " + host + "\r\n"
+                             "User-Agent: Calamares/" CALAMARES_VERSION "\r\n"
+                             "Content-Type: text/plain; charset=utf-8\r\n"
+                             "Transfer-Encoding: chunked\r\n"
+                             "Connection: close\r\n"
+                             + ( m_compress ? QByteArray( "Content-Encoding: gzip\r\n" ) : QByteArray() ) + "\r\n" );
+        }
+        sendMore();
+    };
 
-    if ( !socket->waitForBytesWritten() )
+    if ( https )
     {
-        cError() << "Could not write to paste server";
-        socket->close();
-        return QString();
+#ifndef QT_NO_SSL
+        auto* socket = new QSslSocket( this );
+        m_socket = socket;
+        connect( socket, &QSslSocket::encrypted, this, onConnected );
+        socket->connectToHostEncrypted( m_serverUrl.host(), quint16( m_serverUrl.port( 443 ) ) );
+#else
+        cError() << "Cannot upload to" << m_serverUrl << "without SSL support";
+        finish( QString() );
+        return;
+#endif
+    }
+    else
+    {
+        m_socket = new QTcpSocket( this );
+        connect( m_socket, &QTcpSocket::connected, this, onConnected );
+        m_socket->connectToHost( m_serverUrl.host(), quint16( m_serverUrl.port( http ? 80 : 9999 ) ) );
     }
 
-    cDebug() << Logger::SubEntry << "Paste data written to paste server";
+    connect( m_socket, &QTcpSocket::bytesWritten, this, &LogUploader::sendMore );
+    connect( m_socket, &QTcpSocket::readyRead, this, &LogUploader::readResponse );
+    connect( m_socket, &QTcpSocket::disconnected, this, [ this, http ]() {
+        m_response.append( m_socket->readAll() );
+        finish( http ? httpPasteUrl( m_response, m_serverUrl ) : ficheUrl( m_response, m_serverUrl ) );
+    } );
+    auto onError = [ this ]( QAbstractSocket::SocketError e ) {
+        // A close after the response is normal, and handled when disconnected
+        if ( e != QAbstractSocket::RemoteHostClosedError )
+        {
+            cError() << "Could not upload to paste server" << m_serverUrl.host() << m_socket->errorString();
+            finish( QString() );
+        }
+    };
+#if ( QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 ) )
+    connect( m_socket, QOverload< QAbstractSocket::SocketError >::of( &QAbstractSocket::error ), this, onError );
+#else
+    connect( m_socket, &QAbstractSocket::errorOccurred, this, onError );
+#endif
+    m_timeout.start();
+}
 
-    if ( !socket->waitForReadyRead() )
+void
+LogUploader::sendMore()
+{
+    if ( m_finished || m_allWritten )
     {
-        cError() << "No data from paste server";
-        socket->close();
-        return QString();
+        return;
     }
+    m_timeout.start();
+
+    const bool http = m_type == Branding::UploadServerType::Http;
+    while ( m_socket->bytesToWrite() < writeBufferLimit && m_bytesRead < m_bytesTotal )
+    {
+        const QByteArray chunk = m_logFile.read( std::min( chunkSize, m_bytesTotal - m_bytesRead ) );
+        if ( chunk.isEmpty() )
+        {
+            cWarning() << "Could not read log file" << m_logFileName;
+            finish( QString() );
+            return;
+        }
+        m_bytesRead += chunk.size();
+        if ( http )
+        {
+            const QByteArray data = m_compress ? gzipMember( chunk ) : chunk;
+            m_socket->write( QByteArray::number( data.size(), 16 ) + "\r\n" + data + "\r\n" );
+        }
+        else
+        {
+            m_socket->write( chunk );
+        }
 
-    cDebug() << Logger::SubEntry << "Reading response from paste server";
-    QByteArray responseText = socket->readLine( 1024 );
-    socket->close();
+        emit progress( m_bytesRead, m_bytesTotal );
+        if ( m_finished )
+        {
+            // Cancelled
+            return;
+        }
+    }
 
-    QUrl pasteUrl = QUrl( QString( responseText ).trimmed(), QUrl::StrictMode );
-    if ( pasteUrl.isValid() && pasteUrl.host() == serverUrl.host() )
+    if ( m_bytesRead >= m_bytesTotal )
     {
-        cDebug() << Logger::SubEntry << "Paste server results:" << pasteUrl;
-        return pasteUrl.toString();
+        if ( http )
+        {
+            m_socket->write( "0\r\n\r\n" );
+        }
+        m_allWritten = true;
+        cDebug() << Logger::SubEntry << "Paste data written to paste server";
     }
-    else
+}
+
+void
+LogUploader::readResponse()
+{
+    m_timeout.start();
+    m_response.append( m_socket->readAll() );
+    // Fiche answers with one line; an HTTP server closes the connection when done
+    if ( m_type == Branding::UploadServerType::Fiche && m_response.contains( '\n' ) )
     {
-        cError() << "No data from paste server";
-        return QString();
+        finish( ficheUrl( m_response, m_serverUrl ) );
     }
 }
 
-QString
-CalamaresUtils::Paste::doLogUpload( QObject* parent )
+void
+LogUploader::cancel()
 {
-    auto [ type, serverUrl, sizeLimitBytes ] = Calamares::Branding::instance()->uploadServer();
+    if ( !m_finished )
+    {
+        cDebug() << "Log upload cancelled";
+        finish( QString() );
+    }
+}
+
+void
+LogUploader::finish( const QString& pasteUrl )
+{
+    if ( m_finished )
+    {
+        return;
+    }
+    m_finished = true;
+    m_timeout.stop();
+    if ( m_socket )
+    {
+        m_socket->disconnect( this );
+        m_socket->abort();
+    }
+    m_logFile.close();
+    if ( !pasteUrl.isEmpty() )
+    {
+        cDebug() << Logger::SubEntry << "Paste server results:" << pasteUrl;
+    }
+    emit finished( pasteUrl );
+}
+
+}  // namespace Paste
+}  // namespace CalamaresUtils
+
+/** @brief An uploader for the configured upload server
+ *
+ * Returns nullptr (and logs why) if there is nothing to upload to.
+ */
+static std::unique_ptr< CalamaresUtils::Paste::LogUploader >
+configuredUploader()
+{
+    auto [ type, serverUrl, sizeLimitBytes, compress ] = Branding::instance()->uploadServer();
     if ( !serverUrl.isValid() )
     {
         cWarning() << "Upload configured with invalid URL";
-        return QString();
+        return nullptr;
     }
-    if ( type == Calamares::Branding::UploadServerType::None )
+    if ( type == Branding::UploadServerType::None )
     {
-        // Early return to avoid reading the log file
-        return QString();
+        return nullptr;
     }
     if ( sizeLimitBytes == 0 )
     {
         // Suggests that it is un-set in the config file
         cWarning() << "Upload configured to send 0 bytes";
-        return QString();
+        return nullptr;
     }
-
-    QByteArray pasteData = logFileContents( sizeLimitBytes );
-    if ( pasteData.isEmpty() )
+    if ( sizeLimitBytes > 0 )
     {
-        // An error has already been logged
-        return QString();
+        cDebug() << "Log upload size limit was limited to" << sizeLimitBytes << "bytes";
     }
+    return std::make_unique< CalamaresUtils::Paste::LogUploader >( type, serverUrl, sizeLimitBytes, compress );
+}
 
-    switch ( type )
+/// @brief Runs the @p uploader to completion, handling events in the meantime
+static QString
+waitForUpload( CalamaresUtils::Paste::LogUploader& uploader )
+{
+    QString pasteUrl;
+    bool done = false;
+    QEventLoop loop;
+    QObject::connect( &uploader, &CalamaresUtils::Paste::LogUploader::finished, &loop, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        done = true;
+        loop.quit();
+    } );
+    uploader.start();
+    if ( !done )
     {
-    case Calamares::Branding::UploadServerType::None:
-        cWarning() << "No upload configured.";
-        return QString();
-    case Calamares::Branding::UploadServerType::Fiche:
-        return ficheLogUpload( pasteData, serverUrl, parent );
+        loop.exec();
     }
-    return QString();
+    return pasteUrl;
+}
+
+QString
+CalamaresUtils::Paste::doLogUpload( QObject* parent )
+{
+    Q_UNUSED( parent )
+    auto uploader = configuredUploader();
+    return uploader ? waitForUpload( *uploader ) : QString();
 }
 
 QString
 CalamaresUtils::Paste::doLogUploadUI( QWidget* parent )
 {
+    QString pasteUrl;
+    if ( auto uploader = configuredUploader() )
+    {
+        QProgressDialog progress(
+            QCoreApplication::translate( "Calamares::ViewManager", "Uploading the install log ..." ),
+            QCoreApplication::translate( "Calamares::ViewManager", "&Cancel" ),
+            0,
+            100,
+            parent );
+        progress.setWindowModality( Qt::WindowModal );
+        progress.setMinimumDuration( 500 );
+        auto onProgress = [ &progress ]( qint64 read, qint64 total ) {
+            // Stay below 100%, the server still has to answer
+            progress.setValue( int( std::min( qint64( 99 ), 100 * read / std::max( qint64( 1 ), total ) ) ) );
+        };
+        QObject::connect( uploader.get(), &LogUploader::progress, &progress, onProgress );
+        QObject::connect( &progress, &QProgressDialog::canceled, uploader.get(), &LogUploader::cancel );
+        pasteUrl = waitForUpload( *uploader );
+    }
+
     // These strings originated in the ViewManager class
-    QString pasteUrl = CalamaresUtils::Paste::doLogUpload( parent );
     QString pasteUrlMessage;
     if ( pasteUrl.isEmpty() )
     {
@@ -192,6 +538,6 @@ CalamaresUtils::Paste::doLogUploadUI( QWidget* parent )
 bool
 CalamaresUtils::Paste::isEnabled()
 {
-    auto [ type, serverUrl, sizeLimitBytes ] = Calamares::Branding::instance()->uploadServer();
+    auto [ type, serverUrl, sizeLimitBytes, compress ] = Calamares::Branding::instance()->uploadServer();
     return type != Calamares::Branding::UploadServerType::None && sizeLimitBytes != 0;
 }
@@ -10,24 +10,97 @@
 #ifndef UTILS_PASTE_H
 #define UTILS_PASTE_H
 
+#include "Branding.h"
+#include "DllMacro.h"
+
+#include <QFile>
+#include <QObject>
 #include <QString>
+#include <QTimer>
+#include <QUrl>
 
-class QObject;
+class QTcpSocket;
 class QWidget;
 
 namespace CalamaresUtils
 {
 namespace Paste
 {
+/** @brief Uploads (the tail of) the log file, without blocking
+ *
+ * The log is read in chunks, which are written to the server as
+ * the connection drains, so that only a few chunks are in memory
+ * at any time. For an Http server, the log is sent as a chunked
+ * POST request and each chunk can be gzip-compressed on the fly
+ * (as a gzip stream with one member per chunk); fiche gets
+ * the plain log.
+ *
+ * Call start() and wait for finished(), which is emitted exactly once.
+ */
+class UIDLLEXPORT LogUploader : public QObject
+{
+    Q_OBJECT
+public:
+    LogUploader( Calamares::Branding::UploadServerType type,
+                 const QUrl& serverUrl,
+                 qint64 sizeLimitBytes,
+                 bool compress,
+                 QObject* parent = nullptr );
+    ~LogUploader() override;
+
+    /// @brief Upload @p fileName rather than the Calamares log file
+    void setLogFile( const QString& fileName ) { m_logFileName = fileName; }
+    /// @brief Give up if nothing happens on the connection for @p ms milliseconds
+    void setTimeout( int ms ) { m_timeout.setInterval( ms ); }
+
+    /// @brief Starts the upload; if this fails immediately, finished() is emitted right away
+    void start();
+
+public Q_SLOTS:
+    /// @brief Stops the upload, finished() is emitted with an empty URL
+    void cancel();
+
+Q_SIGNALS:
+    /// @brief @p bytesRead of the @p bytesTotal bytes of log have been sent
+    void progress( qint64 bytesRead, qint64 bytesTotal );
+    /** @brief The upload is done
+     *
+     * The @p pasteUrl is the URL the server returned, or empty on failure.
+     */
+    void finished( const QString& pasteUrl );
+
+private:
+    void sendMore();
+    void readResponse();
+    void finish( const QString& pasteUrl );
+
+    Calamares::Branding::UploadServerType m_type;
+    QUrl m_serverUrl;
+    qint64 m_sizeLimitBytes;
+    bool m_compress;
+    QString m_logFileName;
+
+    QFile m_logFile;
+    QTcpSocket* m_socket = nullptr;
+    QTimer m_timeout;
+    QByteArray m_response;
+    qint64 m_bytesTotal = 0;
+    qint64 m_bytesRead = 0;
+    bool m_allWritten = false;
+    bool m_finished = false;
+};
+
 /** @brief Send the current log file to a pastebin
  *
- * Returns the (string) URL that the pastebin gives us.
+ * Returns the (string) URL that the pastebin gives us. This runs
+ * a LogUploader and waits (processing events) until it is done.
  */
 QString doLogUpload( QObject* parent );
 
 /** @brief Send the current log file to a pastebin
  *
- * As doLogUpload(), but also sets the clipboard and displays
+ * As doLogUpload(), but shows the progress of the upload (which
+ * can be cancelled), and then sets the clipboard and displays
  * a message saying it's been done.
  */
 QString doLogUploadUI( QWidget* parent );
@@ -17,9 +17,12 @@
 #include "network/Manager.h"
 #include "utils/Dirs.h"
 #include "utils/Logger.h"
+#include "utils/Retranslator.h"
 
 #include <QByteArray>
+#include <QCoreApplication>
 #include <QObject>
+#include <QQmlEngine>
 #include <QQuickItem>
 #include <QString>
 #include <QVariant>
@@ -241,4 +244,22 @@ registerQmlModels()
     }
 }
 
+QQmlEngine*
+qmlEngine()
+{
+    static QQmlEngine* engine = nullptr;
+    if ( !engine )
+    {
+        registerQmlModels();
+
+        engine = new QQmlEngine( QCoreApplication::instance() );
+        engine->addImportPath( qmlModulesDir().absolutePath() );
+        cDebug() << "QML import paths:" << Logger::DebugList( engine->importPathList() );
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 10, 0 )
+        CALAMARES_RETRANSLATE_FOR( engine, engine->retranslate(); );
+#endif
+    }
+    return engine;
+}
+
 }  // namespace CalamaresUtils
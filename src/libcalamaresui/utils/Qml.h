@@ -17,6 +17,7 @@
 
 #include <QDir>
 
+class QQmlEngine;
 class QQuickItem;
 
 namespace CalamaresUtils
@@ -48,6 +49,22 @@ UIDLLEXPORT bool initQmlModulesDir();
  */
 UIDLLEXPORT void registerQmlModels();
 
+/** @brief The QML engine shared by all of Calamares
+ *
+ * All the QML in Calamares -- QML view steps, the QML slideshow,
+ * QML sidebar and navigation -- runs in this one engine, so that
+ * import resolution, type registration and compiled components
+ * are shared. The engine is created on first use, after which
+ * the QML modules directory (see qmlModulesDir()) is on the import
+ * path and the global models are registered (see registerQmlModels()).
+ * It is retranslated when the language changes.
+ *
+ * Things that are specific to a QML view (e.g. the `config` context
+ * property of a view step) belong in a child context of the
+ * engine's root context.
+ */
+UIDLLEXPORT QQmlEngine* qmlEngine();
+
 /** @brief Calls the QML method @p method on @p qmlObject
  *
  * Pass in only the name of the method (e.g. onActivate). This function
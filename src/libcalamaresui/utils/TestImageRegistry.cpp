@@ -0,0 +1,190 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "ImageRegistry.h"
+
+#include "utils/Logger.h"
+
+#include <QImage>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+// A logo-like SVG, with some gradients to make rendering non-trivial
+static const char logoSvg[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<svg xmlns="http://www.w3.org/2000/svg" width="200" height="100" viewBox="0 0 200 100">
+  <defs>
+    <linearGradient id="g" x1="0" y1="0" x2="1" y2="1">
+      <stop offset="0" stop-color="#1d99f3"/>
+      <stop offset="1" stop-color="#f67400"/>
+    </linearGradient>
+  </defs>
+  <rect x="4" y="4" width="192" height="92" rx="16" fill="url(#g)"/>
+  <circle cx="50" cy="50" r="30" fill="#ffffff" fill-opacity="0.6"/>
+</svg>
+)";
+
+class TestImageRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestImageRegistry() {}
+    ~TestImageRegistry() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSizes();
+    void testEviction();
+    void testAsync();
+    void benchmarkLookup();
+    void benchmarkFirstRender();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_png;
+    QString m_svg;
+};
+
+void
+TestImageRegistry::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    QVERIFY( m_dir.isValid() );
+
+    // A screenshot-sized image
+    QImage screenshot( 800, 600, QImage::Format_RGB32 );
+    for ( int y = 0; y < screenshot.height(); ++y )
+    {
+        for ( int x = 0; x < screenshot.width(); ++x )
+        {
+            screenshot.setPixel( x, y, qRgb( x % 256, y % 256, ( x + y ) % 256 ) );
+        }
+    }
+    m_png = m_dir.filePath( "screenshot.png" );
+    QVERIFY( screenshot.save( m_png ) );
+
+    m_svg = m_dir.filePath( "logo.svg" );
+    QFile svg( m_svg );
+    QVERIFY( svg.open( QIODevice::WriteOnly ) );
+    QVERIFY( svg.write( logoSvg ) > 0 );
+}
+
+void
+TestImageRegistry::testSizes()
+{
+    ImageRegistry r;
+
+    QCOMPARE( r.pixmap( m_png, QSize() ).size(), QSize( 800, 600 ) );
+    QCOMPARE( r.pixmap( m_png, QSize( 400, 0 ) ).size(), QSize( 400, 300 ) );
+    QCOMPARE( r.pixmap( m_png, QSize( 0, 60 ) ).size(), QSize( 80, 60 ) );
+    QCOMPARE( r.pixmap( m_png, QSize( 100, 100 ) ).size(), QSize( 100, 100 ) );
+    QCOMPARE( r.pixmap( m_svg, QSize() ).size(), QSize( 200, 100 ) );
+    QCOMPARE( r.pixmap( m_svg, QSize( 0, 50 ) ).size(), QSize( 100, 50 ) );
+    QCOMPARE( r.pixmap( m_svg, QSize( 64, 64 ) ).size(), QSize( 64, 64 ) );
+    QVERIFY( r.pixmap( m_dir.filePath( "missing.png" ), QSize( 10, 10 ) ).isNull() );
+
+    // These are all different, and don't overwrite each other in the cache
+    QVERIFY( r.isCached( m_png, QSize( 400, 0 ) ) );
+    QVERIFY( r.isCached( m_png, QSize( 0, 60 ) ) );
+    QVERIFY( r.isCached( m_svg, QSize( 64, 64 ) ) );
+    QVERIFY( !r.isCached( m_svg, QSize( 64, 64 ), CalamaresUtils::RoundedCorners ) );
+    QVERIFY( !r.isCached( m_dir.filePath( "missing.png" ), QSize( 10, 10 ) ) );
+}
+
+void
+TestImageRegistry::testEviction()
+{
+    ImageRegistry r;
+    // Room for two 400x300 images (at 32 bits per pixel), not three
+    r.setCacheLimit( 1000 * 1024 );
+    QCOMPARE( r.cacheLimit(), qint64( 1000 * 1024 ) );
+
+    r.pixmap( m_png, QSize( 400, 300 ) );
+    r.pixmap( m_png, QSize( 300, 400 ) );
+    QVERIFY( r.isCached( m_png, QSize( 400, 300 ) ) );
+    // Using it makes it the most-recently used
+    r.pixmap( m_png, QSize( 400, 300 ) );
+    r.pixmap( m_png, QSize( 200, 600 ) );
+
+    QVERIFY( r.isCached( m_png, QSize( 400, 300 ) ) );
+    QVERIFY( !r.isCached( m_png, QSize( 300, 400 ) ) );
+    QVERIFY( r.isCached( m_png, QSize( 200, 600 ) ) );
+    QVERIFY( r.cacheSize() <= r.cacheLimit() );
+
+    r.clear();
+    QCOMPARE( r.cacheSize(), qint64( 0 ) );
+    QVERIFY( !r.isCached( m_png, QSize( 400, 300 ) ) );
+}
+
+void
+TestImageRegistry::testAsync()
+{
+    ImageRegistry r;
+    QPixmap loaded;
+    int calls = 0;
+    auto callback = [ & ]( const QPixmap& p ) {
+        loaded = p;
+        ++calls;
+    };
+
+    QObject context;
+    const QPixmap placeholder = r.pixmapAsync( m_svg, QSize( 120, 60 ), CalamaresUtils::Original, &context, callback );
+    QCOMPARE( placeholder.size(), QSize( 120, 60 ) );
+    QTRY_COMPARE( calls, 1 );
+    QCOMPARE( loaded.size(), QSize( 120, 60 ) );
+    QVERIFY( r.isCached( m_svg, QSize( 120, 60 ) ) );
+
+    // Now it's cached, so there's no callback
+    QCOMPARE( r.pixmapAsync( m_svg, QSize( 120, 60 ), CalamaresUtils::Original, &context, callback ).cacheKey(),
+              loaded.cacheKey() );
+    QTest::qWait( 50 );
+    QCOMPARE( calls, 1 );
+
+    // No callback when the context is gone
+    {
+        QObject shortLived;
+        r.pixmapAsync( m_png, QSize( 320, 240 ), CalamaresUtils::Original, &shortLived, callback );
+    }
+    // .. but the image is still loaded and cached
+    QTRY_VERIFY( r.isCached( m_png, QSize( 320, 240 ) ) );
+    QCOMPARE( calls, 1 );
+    QCOMPARE( r.pixmap( m_png, QSize( 320, 240 ) ).size(), QSize( 320, 240 ) );
+}
+
+void
+TestImageRegistry::benchmarkLookup()
+{
+    ImageRegistry r;
+    r.pixmap( m_svg, QSize( 64, 64 ) );
+    QBENCHMARK
+    {
+        QVERIFY( !r.pixmap( m_svg, QSize( 64, 64 ) ).isNull() );
+    }
+}
+
+void
+TestImageRegistry::benchmarkFirstRender()
+{
+    ImageRegistry r;
+    QBENCHMARK
+    {
+        r.clear();
+        QVERIFY( !r.pixmap( m_svg, QSize( 256, 128 ) ).isNull() );
+        QVERIFY( !r.pixmap( m_png, QSize( 400, 300 ) ).isNull() );
+    }
+}
+
+QTEST_MAIN( TestImageRegistry )
+
+#include "utils/moc-warnings.h"
+
+#include "TestImageRegistry.moc"
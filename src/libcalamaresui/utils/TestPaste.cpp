@@ -10,15 +10,151 @@
  */
 
 #include "Paste.h"
-#include "network/Manager.h"
 
 #include "utils/Logger.h"
 
 #include <QDateTime>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
-extern QByteArray logFileContents( qint64 sizeLimitBytes );
-extern QString ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent );
+extern QByteArray gzipMember( const QByteArray& data );
+extern QString httpPasteUrl( const QByteArray& response, const QUrl& serverUrl );
+
+using CalamaresUtils::Paste::LogUploader;
+using UploadServerType = Calamares::Branding::UploadServerType;
+
+/// @brief Decompress @p data with the gzip command; returns false if there is no gzip
+static bool
+gunzip( const QByteArray& data, QByteArray& out )
+{
+    const QString gzip = QStandardPaths::findExecutable( "gzip" );
+    if ( gzip.isEmpty() )
+    {
+        return false;
+    }
+    QProcess p;
+    p.start( gzip, { "-dc" } );
+    p.write( data );
+    p.closeWriteChannel();
+    p.waitForFinished();
+    out = p.readAllStandardOutput();
+    return p.exitCode() == 0;
+}
+
+/** @brief Decodes the chunked-transfer @p body
+ *
+ * Sets @p complete if the terminating chunk has been seen.
+ */
+static QByteArray
+dechunk( const QByteArray& body, bool& complete )
+{
+    QByteArray data;
+    complete = false;
+    int pos = 0;
+    while ( true )
+    {
+        const int eol = body.indexOf( "\r\n", pos );
+        if ( eol < 0 )
+        {
+            return data;
+        }
+        bool ok = false;
+        const int size = body.mid( pos, eol - pos ).toInt( &ok, 16 );
+        if ( !ok || body.size() < eol + 2 + size + 2 )
+        {
+            return data;
+        }
+        if ( size == 0 )
+        {
+            complete = true;
+            return data;
+        }
+        data.append( body.mid( eol + 2, size ) );
+        pos = eol + 2 + size + 2;
+    }
+}
+
+/** @brief A local stand-in for a paste server
+ *
+ * For Http, it answers once the whole (chunked) POST has been read,
+ * with the paste URL in a Location header or in the body. For Fiche,
+ * it answers once @p expectedSize bytes have been read.
+ */
+class PasteServer : public QObject
+{
+public:
+    PasteServer( UploadServerType type, bool location, qint64 expectedSize = 0 )
+        : m_type( type )
+        , m_location( location )
+        , m_expectedSize( expectedSize )
+    {
+        m_server.listen( QHostAddress::LocalHost );
+        connect( &m_server, &QTcpServer::newConnection, this, [ this ]() {
+            QTcpSocket* socket = m_server.nextPendingConnection();
+            connect( socket, &QTcpSocket::readyRead, this, [ this, socket ]() { read( socket ); } );
+        } );
+    }
+
+    QUrl url( const QString& path = QString() ) const
+    {
+        return QUrl( QStringLiteral( "http://127.0.0.1:%1%2" ).arg( m_server.serverPort() ).arg( path ) );
+    }
+
+    QByteArray request;
+    QByteArray headers;
+    QByteArray body;
+    bool answered = false;
+
+private:
+    void read( QTcpSocket* socket )
+    {
+        request.append( socket->readAll() );
+        const QByteArray pasteUrl = url( "/abc123" ).toString().toUtf8();
+        if ( m_type == UploadServerType::Fiche )
+        {
+            if ( request.size() >= m_expectedSize && !answered )
+            {
+                body = request;
+                answered = true;
+                socket->write( pasteUrl + "\n" );
+                socket->disconnectFromHost();
+            }
+            return;
+        }
+
+        const int headerEnd = request.indexOf( "\r\n\r\n" );
+        bool complete = false;
+        if ( headerEnd >= 0 && !answered )
+        {
+            headers = request.left( headerEnd );
+            body = dechunk( request.mid( headerEnd + 4 ), complete );
+        }
+        if ( complete )
+        {
+            answered = true;
+            if ( m_location )
+            {
+                socket->write( "HTTP/1.1 201 Created\r\nLocation: /abc123\r\nContent-Length: 0\r\n\r\n" );
+            }
+            else
+            {
+                socket->write( "HTTP/1.1 200 OK\r\nContent-Length: " + QByteArray::number( pasteUrl.size() + 1 )
+                               + "\r\n\r\n" + pasteUrl + "\n" );
+            }
+            socket->disconnectFromHost();
+        }
+    }
+
+    QTcpServer m_server;
+    UploadServerType m_type;
+    bool m_location;
+    qint64 m_expectedSize;
+};
 
 class TestPaste : public QObject
 {
@@ -32,25 +168,58 @@ private Q_SLOTS:
     void testGetLogFile();
     void testFichePaste();
     void testUploadSize();
+
+    void testGzip();
+    void testHttpResponse();
+    void testHttpUpload_data();
+    void testHttpUpload();
+    void testFicheUpload();
+    void testUploadTimeout();
+
+private:
+    /// @brief Writes a log-like file of @p size bytes
+    QString makeLog( int size );
+
+    QTemporaryDir m_dir;
 };
 
+/// @brief Runs the @p uploader, returns the paste URL (empty on failure)
+static QString
+upload( LogUploader& uploader )
+{
+    QSignalSpy finished( &uploader, &LogUploader::finished );
+    uploader.start();
+    if ( finished.isEmpty() && !finished.wait( 5000 ) )
+    {
+        return QString();
+    }
+    return finished.first().first().toString();
+}
+
 void
 TestPaste::testGetLogFile()
 {
     QFile::remove( Logger::logFile() );
     // This test assumes nothing **else** has set up logging yet
-    QByteArray logLimitedBefore = logFileContents( 16 );
-    QVERIFY( logLimitedBefore.isEmpty() );
-    QByteArray logUnlimitedBefore = logFileContents( -1 );
-    QVERIFY( logUnlimitedBefore.isEmpty() );
+    PasteServer before( UploadServerType::Http, true );
+    LogUploader limitedBefore( UploadServerType::Http, before.url(), 16, false );
+    QVERIFY( upload( limitedBefore ).isEmpty() );
+    LogUploader unlimitedBefore( UploadServerType::Http, before.url(), -1, false );
+    QVERIFY( upload( unlimitedBefore ).isEmpty() );
+    QVERIFY( !before.answered );
 
     Logger::setupLogLevel( Logger::LOGDEBUG );
     Logger::setupLogfile();
 
-    QByteArray logLimitedAfter = logFileContents( 16 );
-    QVERIFY( !logLimitedAfter.isEmpty() );
-    QByteArray logUnlimitedAfter = logFileContents( -1 );
-    QVERIFY( !logUnlimitedAfter.isEmpty() );
+    PasteServer limited( UploadServerType::Http, true );
+    LogUploader limitedAfter( UploadServerType::Http, limited.url(), 16, false );
+    QVERIFY( !upload( limitedAfter ).isEmpty() );
+    QCOMPARE( limited.body.size(), 16 );
+
+    PasteServer unlimited( UploadServerType::Http, true );
+    LogUploader unlimitedAfter( UploadServerType::Http, unlimited.url(), -1, false );
+    QVERIFY( !upload( unlimitedAfter ).isEmpty() );
+    QVERIFY( unlimited.body.size() > 16 );
 }
 
 void
@@ -58,27 +227,239 @@ TestPaste::testFichePaste()
 {
     QString blabla( "the quick brown fox tested Calamares and found it rubbery" );
     QDateTime now = QDateTime::currentDateTime();
+    const QByteArray d = ( blabla + now.toString() ).toUtf8();
 
-    QByteArray d = ( blabla + now.toString() ).toUtf8();
-    QString s = ficheLogUpload( d, QUrl( "http://termbin.com:9999" ), nullptr );
+    const QString logFile = m_dir.filePath( QStringLiteral( "fiche.txt" ) );
+    QFile f( logFile );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    QCOMPARE( f.write( d ), qint64( d.size() ) );
+    f.close();
+
+    PasteServer server( UploadServerType::Fiche, false, d.size() );
+    LogUploader uploader( UploadServerType::Fiche, server.url(), -1, false );
+    uploader.setLogFile( logFile );
+    const QString s = upload( uploader );
 
     cDebug() << "Paste data to" << s;
-    QVERIFY( !s.isEmpty() );
+    QCOMPARE( s, server.url( "/abc123" ).toString() );
+    QCOMPARE( server.body, d );
 }
 
 void
 TestPaste::testUploadSize()
 {
-    QByteArray logContent = logFileContents( 100 );
-    QString s = ficheLogUpload( logContent, QUrl( "http://termbin.com:9999" ), nullptr );
+    // The tail of the real log file, as set up in testGetLogFile()
+    QVERIFY( QFileInfo( Logger::logFile() ).size() > 100 );
+    PasteServer server( UploadServerType::Fiche, false, 100 );
+    LogUploader uploader( UploadServerType::Fiche, server.url(), 100, false );
+    QVERIFY( !upload( uploader ).isEmpty() );
+
+    QCOMPARE( server.body.size(), 100 );
+}
+
+QString
+TestPaste::makeLog( int size )
+{
+    QByteArray data;
+    for ( int i = 0; data.size() < size; ++i )
+    {
+        data.append( QStringLiteral( "%1 [6]: Line %2 of a log that is being uploaded\n" )
+                         .arg( QTime( 0, 0 ).addMSecs( i ).toString( "hh:mm:ss.zzz" ) )
+                         .arg( i )
+                         .toUtf8() );
+    }
+    data.truncate( size );
 
-    QVERIFY( !s.isEmpty() );
+    const QString name = m_dir.filePath( QStringLiteral( "log-%1.txt" ).arg( size ) );
+    QFile f( name );
+    if ( !f.open( QIODevice::WriteOnly ) || f.write( data ) != size )
+    {
+        return QString();
+    }
+    return name;
+}
+
+void
+TestPaste::testGzip()
+{
+    QVERIFY( gzipMember( QByteArray() ).isEmpty() );
 
-    QUrl url( s );
-    QByteArray returnedData = CalamaresUtils::Network::Manager::instance().synchronousGet( url );
+    const QByteArray part1( "The quick brown fox tested Calamares\n" );
+    const QByteArray part2 = QByteArray( "and found it rubbery\n" ).repeated( 1000 );
+    const QByteArray gz1 = gzipMember( part1 );
+    const QByteArray gz2 = gzipMember( part2 );
+    QVERIFY( gz1.startsWith( "\x1f\x8b" ) );
+    QVERIFY( gz2.size() < part2.size() / 10 );
 
-    QCOMPARE( returnedData.size(), 100 );
+    if ( QStandardPaths::findExecutable( "gzip" ).isEmpty() )
+    {
+        QSKIP( "No gzip to check the compressed data" );
+    }
+    // Concatenated members decompress to the concatenated data
+    QByteArray decompressed;
+    QVERIFY( gunzip( gz1 + gz2, decompressed ) );
+    QCOMPARE( decompressed, part1 + part2 );
 }
+
+void
+TestPaste::testHttpResponse()
+{
+    const QUrl server( "https://paste.example.com/upload" );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 201 Created\r\nLocation: /p/1234\r\n\r\n", server ),
+              QStringLiteral( "https://paste.example.com/p/1234" ) );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 200 OK\r\nContent-Length: 33\r\n\r\nhttps://paste.example.com/p/1234\n", server ),
+              QStringLiteral( "https://paste.example.com/p/1234" ) );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                            "20\r\nhttps://paste.example.com/p/1234\r\n0\r\n\r\n",
+                            server ),
+              QStringLiteral( "https://paste.example.com/p/1234" ) );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\n\r\n", server ), QString() );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n", server ), QString() );
+    QCOMPARE( httpPasteUrl( "HTTP/1.1 200 OK\r\nContent-Le", server ), QString() );
+    QCOMPARE( httpPasteUrl( QByteArray(), server ), QString() );
+}
+
+void
+TestPaste::testHttpUpload_data()
+{
+    QTest::addColumn< bool >( "compress" );
+    QTest::addColumn< bool >( "location" );
+    QTest::addColumn< int >( "logSize" );
+    QTest::addColumn< int >( "sizeLimit" );
+
+    QTest::newRow( "plain" ) << false << false << 1000 << -1;
+    QTest::newRow( "gzip" ) << true << true << 1000 << -1;
+    // Big enough for several chunks, and a backlog on the connection
+    QTest::newRow( "plain-big" ) << false << true << 3000000 << -1;
+    QTest::newRow( "gzip-big" ) << true << false << 3000000 << -1;
+    QTest::newRow( "gzip-tail" ) << true << true << 3000000 << 200000;
+}
+
+void
+TestPaste::testHttpUpload()
+{
+    QFETCH( bool, compress );
+    QFETCH( bool, location );
+    QFETCH( int, logSize );
+    QFETCH( int, sizeLimit );
+
+    const QString logFile = makeLog( logSize );
+    QVERIFY( !logFile.isEmpty() );
+    QFile f( logFile );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    const QByteArray log = f.readAll();
+    const QByteArray expected = sizeLimit < 0 ? log : log.right( sizeLimit );
+
+    PasteServer server( UploadServerType::Http, location );
+    LogUploader uploader( UploadServerType::Http, server.url( "/upload" ), sizeLimit, compress );
+    uploader.setLogFile( logFile );
+
+    QList< qint64 > progress;
+    QString pasteUrl;
+    int finished = 0;
+    connect( &uploader, &LogUploader::progress, [ & ]( qint64 read, qint64 total ) {
+        QCOMPARE( total, qint64( expected.size() ) );
+        progress.append( read );
+    } );
+    connect( &uploader, &LogUploader::finished, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        ++finished;
+    } );
+    uploader.start();
+    QTRY_COMPARE( finished, 1 );
+
+    QVERIFY( server.answered );
+    QCOMPARE( pasteUrl, server.url( "/abc123" ).toString() );
+    QVERIFY( server.headers.startsWith( "POST /upload HTTP/1.1\r\n" ) );
+    QCOMPARE( server.headers.contains( "Content-Encoding: gzip" ), compress );
+
+    QVERIFY( !progress.isEmpty() );
+    QCOMPARE( progress.last(), qint64( expected.size() ) );
+    QVERIFY( std::is_sorted( progress.cbegin(), progress.cend() ) );
+
+    if ( compress )
+    {
+        QVERIFY( server.body.size() < expected.size() / 4 );
+        QByteArray decompressed;
+        if ( !QStandardPaths::findExecutable( "gzip" ).isEmpty() )
+        {
+            QVERIFY( gunzip( server.body, decompressed ) );
+            QCOMPARE( decompressed.size(), expected.size() );
+            QVERIFY( decompressed == expected );
+        }
+    }
+    else
+    {
+        QCOMPARE( server.body.size(), expected.size() );
+        QVERIFY( server.body == expected );
+    }
+}
+
+void
+TestPaste::testFicheUpload()
+{
+    const QString logFile = makeLog( 500000 );
+    QVERIFY( !logFile.isEmpty() );
+
+    PasteServer server( UploadServerType::Fiche, false, 100000 );
+    // Compression is not used for fiche, which stores what it gets
+    LogUploader uploader( UploadServerType::Fiche, server.url(), 100000, true );
+    uploader.setLogFile( logFile );
+
+    QString pasteUrl;
+    int finished = 0;
+    connect( &uploader, &LogUploader::finished, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        ++finished;
+    } );
+    uploader.start();
+    QTRY_COMPARE( finished, 1 );
+
+    QCOMPARE( pasteUrl, server.url( "/abc123" ).toString() );
+    QCOMPARE( server.body.size(), 100000 );
+    QFile f( logFile );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    QVERIFY( server.body == f.readAll().right( 100000 ) );
+}
+
+void
+TestPaste::testUploadTimeout()
+{
+    const QString logFile = makeLog( 1000 );
+    QVERIFY( !logFile.isEmpty() );
+
+    // This server never answers (it expects more data than there is)
+    PasteServer server( UploadServerType::Fiche, false, 2000 );
+    LogUploader uploader( UploadServerType::Fiche, server.url(), -1, false );
+    uploader.setLogFile( logFile );
+    uploader.setTimeout( 200 );
+
+    QString pasteUrl( "unset" );
+    int finished = 0;
+    connect( &uploader, &LogUploader::finished, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        ++finished;
+    } );
+    uploader.start();
+    QTRY_COMPARE( finished, 1 );
+    QVERIFY( pasteUrl.isEmpty() );
+    QVERIFY( !server.answered );
+
+    // Cancelling afterwards does nothing
+    uploader.cancel();
+    QCOMPARE( finished, 1 );
+
+    // Nothing to upload
+    LogUploader none( UploadServerType::Http, server.url(), 0, false );
+    connect( &none, &LogUploader::finished, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        ++finished;
+    } );
+    none.start();
+    QCOMPARE( finished, 2 );
+    QVERIFY( pasteUrl.isEmpty() );
+}
+
 QTEST_GUILESS_MAIN( TestPaste )
 
 #include "utils/moc-warnings.h"
@@ -0,0 +1,127 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "Qml.h"
+
+#include "utils/Logger.h"
+
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QtTest/QtTest>
+
+#include <memory>
+
+// Something like a view-step QML: uses QtQuick and the per-step config
+static const char stepQml[] = R"(
+import QtQuick 2.0
+Item {
+    property string name: config ? config.objectName : ""
+    Rectangle { width: 100; height: 100; color: "red" }
+    Text { text: parent.name }
+}
+)";
+
+// Number of QML steps in a typical QML-heavy configuration
+static constexpr const int stepCount = 8;
+
+class TestQml : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestQml() {}
+    ~TestQml() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSharedEngine();
+    void benchmarkSeparateEngines();
+    void benchmarkSharedEngine();
+};
+
+void
+TestQml::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+TestQml::testSharedEngine()
+{
+    QQmlEngine* engine = CalamaresUtils::qmlEngine();
+    QVERIFY( engine );
+    QCOMPARE( CalamaresUtils::qmlEngine(), engine );
+    QVERIFY( engine->importPathList().contains( CalamaresUtils::qmlModulesDir().absolutePath() ) );
+
+    // Each step has its own context, so its own config
+    QObject config1;
+    config1.setObjectName( "one" );
+    QObject config2;
+    config2.setObjectName( "two" );
+    QQmlContext context1( engine->rootContext() );
+    context1.setContextProperty( "config", &config1 );
+    QQmlContext context2( engine->rootContext() );
+    context2.setContextProperty( "config", &config2 );
+
+    QQmlComponent component( engine );
+    component.setData( stepQml, QUrl() );
+    QVERIFY2( component.isReady(), qPrintable( component.errorString() ) );
+
+    std::unique_ptr< QObject > o1( component.create( &context1 ) );
+    std::unique_ptr< QObject > o2( component.create( &context2 ) );
+    QVERIFY( o1 );
+    QVERIFY( o2 );
+    QCOMPARE( o1->property( "name" ).toString(), QStringLiteral( "one" ) );
+    QCOMPARE( o2->property( "name" ).toString(), QStringLiteral( "two" ) );
+}
+
+void
+TestQml::benchmarkSeparateEngines()
+{
+    // The way it used to be: each step with its own engine
+    QBENCHMARK
+    {
+        for ( int i = 0; i < stepCount; ++i )
+        {
+            QQmlEngine engine;
+            engine.addImportPath( CalamaresUtils::qmlModulesDir().absolutePath() );
+            QQmlComponent component( &engine );
+            component.setData( stepQml, QUrl( QStringLiteral( "step%1.qml" ).arg( i ) ) );
+            std::unique_ptr< QObject > o( component.create() );
+            QVERIFY( o );
+        }
+    }
+}
+
+void
+TestQml::benchmarkSharedEngine()
+{
+    QQmlEngine* engine = CalamaresUtils::qmlEngine();
+    QBENCHMARK
+    {
+        for ( int i = 0; i < stepCount; ++i )
+        {
+            QQmlContext context( engine->rootContext() );
+            QQmlComponent component( engine );
+            component.setData( stepQml, QUrl( QStringLiteral( "step%1.qml" ).arg( i ) ) );
+            std::unique_ptr< QObject > o( component.create( &context ) );
+            QVERIFY( o );
+        }
+    }
+}
+
+QTEST_MAIN( TestQml )
+
+#include "utils/moc-warnings.h"
+
+#include "TestQml.moc"
@@ -168,7 +168,14 @@ ExecutionViewStep::onActivate()
                     j->setEmergency( true );
                 }
             }
-            queue->enqueue( weight, jl );
+            if ( module->isIdempotent() )
+            {
+                for ( auto& j : jl )
+                {
+                    j->setIdempotent( true );
+                }
+            }
+            queue->enqueue( weight, jl, instanceKey.toString() );
         }
     }
 
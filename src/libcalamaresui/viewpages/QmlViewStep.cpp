@@ -65,16 +65,14 @@ QmlViewStep::QmlViewStep( QObject* parent )
     : ViewStep( parent )
     , m_widget( new QWidget )
     , m_spinner( new WaitingWidget( tr( "Loading ..." ) ) )
-    , m_qmlWidget( new QQuickWidget )
+    , m_qmlWidget( new QQuickWidget( CalamaresUtils::qmlEngine(), nullptr ) )
+    , m_qmlContext( new QQmlContext( CalamaresUtils::qmlEngine()->rootContext(), this ) )
 {
-    CalamaresUtils::registerQmlModels();
-
     QVBoxLayout* layout = new QVBoxLayout( m_widget );
     layout->addWidget( m_spinner );
 
     m_qmlWidget->setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
     m_qmlWidget->setResizeMode( QQuickWidget::SizeRootObjectToView );
-    m_qmlWidget->engine()->addImportPath( CalamaresUtils::qmlModulesDir().absolutePath() );
 
     // QML Loading starts when the configuration for the module is set.
 }
@@ -172,7 +170,7 @@ QmlViewStep::loadComplete()
         // Don't do this again
         disconnect( m_qmlComponent, &QQmlComponent::statusChanged, this, &QmlViewStep::loadComplete );
 
-        QObject* o = m_qmlComponent->create();
+        QObject* o = m_qmlComponent->create( m_qmlContext );
         m_qmlObject = qobject_cast< QQuickItem* >( o );
         if ( !m_qmlObject )
         {
@@ -277,7 +275,7 @@ QmlViewStep::getConfig()
 void
 QmlViewStep::setContextProperty( const char* name, QObject* property )
 {
-    m_qmlWidget->engine()->rootContext()->setContextProperty( name, property );
+    m_qmlContext->setContextProperty( name, property );
 }
 
 }  // namespace Calamares
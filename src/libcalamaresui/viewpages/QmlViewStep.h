@@ -14,6 +14,7 @@
 #include "viewpages/ViewStep.h"
 
 class QQmlComponent;
+class QQmlContext;
 class QQuickItem;
 class QQuickWidget;
 class WaitingWidget;
@@ -110,6 +111,8 @@ private:
     QWidget* m_widget = nullptr;
     WaitingWidget* m_spinner = nullptr;
     QQuickWidget* m_qmlWidget = nullptr;
+    /// @brief Context for this step's QML, child of the shared engine's root context
+    QQmlContext* m_qmlContext = nullptr;
     QQmlComponent* m_qmlComponent = nullptr;
     QQuickItem* m_qmlObject = nullptr;
 };
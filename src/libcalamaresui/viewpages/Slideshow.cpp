@@ -17,7 +17,6 @@
 #ifdef WITH_QML
 #include "utils/Qml.h"
 #endif
-#include "utils/Retranslator.h"
 
 #include <QLabel>
 #include <QMutexLocker>
@@ -39,22 +38,14 @@ Slideshow::~Slideshow() {}
 #ifdef WITH_QML
 SlideshowQML::SlideshowQML( QWidget* parent )
     : Slideshow( parent )
-    , m_qmlShow( new QQuickWidget )
+    , m_qmlShow( new QQuickWidget( CalamaresUtils::qmlEngine(), nullptr ) )
     , m_qmlComponent( nullptr )
     , m_qmlObject( nullptr )
 {
     m_qmlShow->setObjectName( "qml" );
 
-    CalamaresUtils::registerQmlModels();
-
     m_qmlShow->setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
     m_qmlShow->setResizeMode( QQuickWidget::SizeRootObjectToView );
-    m_qmlShow->engine()->addImportPath( CalamaresUtils::qmlModulesDir().absolutePath() );
-
-    cDebug() << "QML import paths:" << Logger::DebugList( m_qmlShow->engine()->importPathList() );
-#if QT_VERSION >= QT_VERSION_CHECK( 5, 10, 0 )
-    CALAMARES_RETRANSLATE( if ( m_qmlShow ) { m_qmlShow->engine()->retranslate(); } );
-#endif
 
     if ( Branding::instance()->slideshowAPI() == 2 )
     {
@@ -48,6 +48,11 @@ ViewStep::onLeave()
 {
 }
 
+void
+ViewStep::onPrefetch()
+{
+}
+
 void
 ViewStep::next()
 {
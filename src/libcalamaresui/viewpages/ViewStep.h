@@ -147,6 +147,20 @@ public:
      */
     virtual void onLeave();
 
+    /**
+     * @brief onPrefetch called when this ViewStep is likely to be shown next
+     *
+     * While the user is on the step before this one, the ViewManager
+     * gives this step a chance to do expensive preparation -- building
+     * heavy widgets, starting background data-gathering -- so that
+     * onActivate() is fast. This may be called more than once, and
+     * may be called without the step ever being activated, so
+     * implementations should not do anything that is visible to the
+     * user or that depends on settings made in earlier steps.
+     * The default implementation does nothing.
+     */
+    virtual void onPrefetch();
+
     /**
      * @brief Jobs needed to run this viewstep
      *
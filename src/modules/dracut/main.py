@@ -13,7 +13,9 @@
 #
 
 import libcalamares
-from libcalamares.utils import target_env_call
+from libcalamares.utils import target_env_call, check_target_env_output
+import os
+import subprocess
 
 
 import gettext
@@ -27,13 +29,65 @@ def pretty_name():
     return _("Creating initramfs with dracut.")
 
 
-def run_dracut():
+def installed_kernels():
     """
-    Creates initramfs, even when initramfs already exists.
+    Returns the kernel versions installed in the target
+    (the directories in /lib/modules).
+    """
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    kernels = set()
+    for modules in ("lib/modules", "usr/lib/modules"):
+        path = os.path.join(root_mount_point, modules)
+        if os.path.isdir(path):
+            kernels.update(k for k in os.listdir(path) if os.path.isdir(os.path.join(path, k)))
+    return sorted(kernels)
 
-    :return:
+
+def dracut_supports_parallel():
+    try:
+        return "--parallel" in check_target_env_output(['dracut', '--help'])
+    except subprocess.CalledProcessError:
+        return False
+
+
+def is_clean(command):
+    """
+    Returns True if @p command already ran and nothing that goes into
+    the initramfs changed since (see libcalamares/utils/Initramfs.h).
     """
-    return target_env_call(['dracut', '-f'])
+    gs = libcalamares.globalstorage
+    return (gs.value("initramfsDirty") is False
+            and " ".join(command) in (gs.value("initramfsRebuilt") or []))
+
+
+def set_clean(command):
+    """
+    Records that @p command ran, so the initramfs is up-to-date for it.
+    """
+    gs = libcalamares.globalstorage
+    rebuilt = (gs.value("initramfsRebuilt") or []) if gs.value("initramfsDirty") is False else []
+    key = " ".join(command)
+    if key not in rebuilt:
+        rebuilt.append(key)
+    gs.insert("initramfsRebuilt", rebuilt)
+    gs.insert("initramfsDirty", False)
+
+
+def dracut_command():
+    """
+    Returns the command that creates initramfs, even when initramfs
+    already exists. With more than one kernel installed, builds them all,
+    in parallel if dracut supports that.
+    """
+    kernels = installed_kernels()
+    if len(kernels) == 1:
+        return ['dracut', '-f', '--kver', kernels[0]]
+    elif len(kernels) > 1:
+        command = ['dracut', '-f', '--regenerate-all']
+        if dracut_supports_parallel():
+            command.append('--parallel')
+        return command
+    return ['dracut', '-f']
 
 
 def run():
@@ -43,8 +97,15 @@ def run():
 
     :return:
     """
-    return_code = run_dracut()
+    command = dracut_command()
+    configuration = libcalamares.job.configuration or {}
+    if configuration.get("skipWhenClean", False) and is_clean(command):
+        libcalamares.utils.debug("initramfs is up-to-date, skipping dracut.")
+        return None
+
+    return_code = target_env_call(command)
 
     if return_code != 0:
         return ( _("Failed to run dracut on the target"),
                  _("The exit code was {}").format(return_code) )
+    set_clean(command)
@@ -18,6 +18,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include "utils/Initramfs.h"
 #include "utils/Logger.h"
 
 static const QLatin1String CONFIG_FILE( "/etc/dracut.conf.d/calamares-luks.conf" );
@@ -147,6 +148,7 @@ DracutLuksCfgJob::exec()
             outStream << QString( CONFIG_FILE_SWAPLINE ).arg( swapOuterUuid ).toLatin1();
         }
         cDebug() << "[DRACUTLUKSCFG]: Wrote config to" << realConfigFilePath;
+        CalamaresUtils::Initramfs::setDirty( QStringLiteral( "dracut LUKS configuration" ) );
     }
     else
     {
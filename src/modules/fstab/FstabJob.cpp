@@ -0,0 +1,152 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2014 Aurélien Gâteau <agateau@kde.org>
+ *   SPDX-FileCopyrightText: 2016 Teo Mrnjavac <teo@kde.org>
+ *   SPDX-FileCopyrightText: 2017 Alf Gaida <agaida@siduction.org>
+ *   SPDX-FileCopyrightText: 2019-2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "FstabJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "partition/Fstab.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+/// Swap files are small-ish
+static constexpr qint64 swapFileSize = 512 * 1024 * 1024;
+
+FstabJob::FstabJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+}
+
+FstabJob::~FstabJob() {}
+
+QString
+FstabJob::prettyName() const
+{
+    return tr( "Writing fstab." );
+}
+
+Calamares::JobResult
+FstabJob::exec()
+{
+    using namespace CalamaresUtils::Partition;
+
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    QVariantList partitions = gs->value( "partitions" ).toList();
+    const QString rootMountPoint = gs->value( "rootMountPoint" ).toString();
+
+    if ( partitions.isEmpty() )
+    {
+        cWarning() << "No *partitions* defined.";
+        return Calamares::JobResult::internalError(
+            tr( "Configuration Error" ),
+            tr( "No partitions are defined for <pre>%1</pre> to use." ).arg( "fstab" ),
+            Calamares::JobResult::InvalidConfiguration );
+    }
+    if ( rootMountPoint.isEmpty() )
+    {
+        cWarning() << "No *rootMountPoint* defined.";
+        return Calamares::JobResult::internalError(
+            tr( "Configuration Error" ),
+            tr( "No root mount point is given for <pre>%1</pre> to use." ).arg( "fstab" ),
+            Calamares::JobResult::InvalidConfiguration );
+    }
+    // The generator relies on there being (default) mount options
+    if ( m_mountOptions.isEmpty() )
+    {
+        return Calamares::JobResult::internalError(
+            tr( "Configuration Error" ),
+            tr( "No <pre>%1</pre> configuration is given for <pre>%2</pre> to use." ).arg( "mountOptions", "fstab" ),
+            Calamares::JobResult::InvalidConfiguration );
+    }
+
+    // This follows the GS settings from the partition module's Config object
+    const bool swapFile
+        = gs->value( "partitionChoices" ).toMap().value( "swap" ).toString() == QStringLiteral( "file" );
+    bool rootBtrfs = false;
+    for ( const auto& v : qAsConst( partitions ) )
+    {
+        const QVariantMap partition = v.toMap();
+        if ( CalamaresUtils::getString( partition, "mountPoint" ) == QStringLiteral( "/" ) )
+        {
+            rootBtrfs = CalamaresUtils::getString( partition, "fs" ).toLower() == QStringLiteral( "btrfs" );
+            break;
+        }
+    }
+    // btrfs swap files must be on a subvolume that is not snapshotted
+    const QString swapFilePath = rootBtrfs ? QStringLiteral( "/swap/swapfile" ) : QStringLiteral( "/swapfile" );
+    if ( swapFile )
+    {
+        // There's no formatted partition for it, so sneak in an entry
+        partitions.append( QVariantMap { { "fs", "swap" }, { "claimed", true }, { "device", swapFilePath } } );
+    }
+    emit progress( 0.1 );
+
+    const auto* system = CalamaresUtils::System::instance();
+    if ( swapFile )
+    {
+        emit progress( 0.2 );
+        const QString path = system->targetPath( swapFilePath );
+        system->createTargetParentDirs( swapFilePath );
+        const QString error = createSwapFile( path, swapFileSize, rootBtrfs );
+        if ( !error.isEmpty() )
+        {
+            cError() << error;
+            return Calamares::JobResult::error( tr( "Could not create swap file." ), error );
+        }
+        cDebug() << "Created swap file" << path;
+    }
+    emit progress( 0.5 );
+
+    FstabGenerator generator( m_mountOptions, m_ssdExtraMountOptions, m_crypttabOptions );
+    if ( !m_efiMountOptions.isEmpty() )
+    {
+        generator.setEfiMountOptions( gs->value( "efiSystemPartition" ).toString(), m_efiMountOptions );
+    }
+    const QString fstab
+        = fstabContents( generator.fstabEntries( partitions, gs->value( "btrfsSubvolumes" ).toList() ) );
+    const QString crypttab = crypttabContents( generator.crypttabEntries( partitions ) );
+
+    for ( const auto& [ path, contents ] : { qMakePair( QStringLiteral( "/etc/fstab" ), fstab ),
+                                            qMakePair( QStringLiteral( "/etc/crypttab" ), crypttab ) } )
+    {
+        if ( !system->createTargetFile( path, contents.toUtf8(), CalamaresUtils::System::WriteMode::Overwrite ) )
+        {
+            return Calamares::JobResult::error( tr( "Could not write <pre>%1</pre>." ).arg( path ),
+                                                tr( "The file could not be written in the target system." ) );
+        }
+    }
+
+    for ( const auto& v : qAsConst( partitions ) )
+    {
+        const QString mountPoint = CalamaresUtils::getString( v.toMap(), "mountPoint" );
+        if ( !mountPoint.isEmpty() && !system->createTargetDirs( mountPoint ) )
+        {
+            cWarning() << "Could not create mount point" << mountPoint;
+        }
+    }
+
+    emit progress( 1.0 );
+    return Calamares::JobResult::ok();
+}
+
+void
+FstabJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    bool ok = false;
+    m_mountOptions = CalamaresUtils::getSubMap( configurationMap, "mountOptions", ok );
+    m_ssdExtraMountOptions = CalamaresUtils::getSubMap( configurationMap, "ssdExtraMountOptions", ok );
+    m_efiMountOptions = CalamaresUtils::getString( configurationMap, "efiMountOptions" );
+    m_crypttabOptions = CalamaresUtils::getString( configurationMap, "crypttabOptions", QStringLiteral( "luks" ) );
+}
+
+CALAMARES_PLUGIN_FACTORY_DEFINITION( FstabJobFactory, registerPlugin< FstabJob >(); )
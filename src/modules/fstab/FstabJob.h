@@ -0,0 +1,47 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef FSTABJOB_H
+#define FSTABJOB_H
+
+#include "CppJob.h"
+#include "DllMacro.h"
+#include "utils/PluginFactory.h"
+
+#include <QObject>
+#include <QVariantMap>
+
+/** @brief Writes /etc/fstab and /etc/crypttab in the target system
+ *
+ * If the user chose a swap file, it is created as well.
+ */
+class PLUGINDLLEXPORT FstabJob : public Calamares::CppJob
+{
+    Q_OBJECT
+
+public:
+    explicit FstabJob( QObject* parent = nullptr );
+    ~FstabJob() override;
+
+    QString prettyName() const override;
+
+    Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+private:
+    QVariantMap m_mountOptions;
+    QVariantMap m_ssdExtraMountOptions;
+    QString m_efiMountOptions;
+    QString m_crypttabOptions;
+};
+
+CALAMARES_PLUGIN_FACTORY_DECLARATION( FstabJobFactory )
+
+#endif  // FSTABJOB_H
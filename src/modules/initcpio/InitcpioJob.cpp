@@ -10,6 +10,7 @@
 #include "InitcpioJob.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Initramfs.h"
 #include "utils/Logger.h"
 #include "utils/UMask.h"
 #include "utils/Variant.h"
@@ -64,9 +65,25 @@ InitcpioJob::exec()
     }
 
     cDebug() << "Updating initramfs with kernel" << m_kernel;
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "mkinitcpio", "-p", m_kernel }, QString(), QString() /* no timeout , 0 */ );
-    return r.explainProcess( "mkinitcpio", std::chrono::seconds( 10 ) /* fake timeout */ );
+    QList< QStringList > commands;
+    if ( m_kernel == QStringLiteral( "all" ) )
+    {
+        // One mkinitcpio per preset, so that they run in parallel
+        QDir presets( CalamaresUtils::System::instance()->targetPath( "/etc/mkinitcpio.d" ) );
+        for ( const auto& fi : presets.entryInfoList( { "*.preset" }, QDir::Files ) )
+        {
+            commands.append( { "mkinitcpio", "-p", fi.completeBaseName() } );
+        }
+        if ( commands.isEmpty() )
+        {
+            commands.append( { "mkinitcpio", "-P" } );
+        }
+    }
+    else
+    {
+        commands.append( { "mkinitcpio", "-p", m_kernel } );
+    }
+    return CalamaresUtils::Initramfs::rebuild( QStringLiteral( "mkinitcpio" ), commands, m_skipWhenClean );
 }
 
 void
@@ -97,6 +114,7 @@ InitcpioJob::setConfigurationMap( const QVariantMap& configurationMap )
     }
 
     m_unsafe = CalamaresUtils::getBool( configurationMap, "be_unsafe", false );
+    m_skipWhenClean = CalamaresUtils::getBool( configurationMap, "skipWhenClean", false );
 }
 
 CALAMARES_PLUGIN_FACTORY_DEFINITION( InitcpioJobFactory, registerPlugin< InitcpioJob >(); )
@@ -233,5 +233,6 @@ def run():
 
     hooks, modules, files = find_initcpio_features(partitions, root_mount_point)
     write_mkinitcpio_lines(hooks, modules, files, root_mount_point)
+    libcalamares.globalstorage.insert("initramfsDirty", True)
 
     return None
@@ -10,6 +10,7 @@
 #include "InitramfsJob.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Initramfs.h"
 #include "utils/Logger.h"
 #include "utils/UMask.h"
 #include "utils/Variant.h"
@@ -52,10 +53,19 @@ InitramfsJob::exec()
         }
     }
 
-    // And then do the ACTUAL work.
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "update-initramfs", "-k", m_kernel, "-c", "-t" }, QString(), QString() /* no timeout, 0 */ );
-    return r.explainProcess( "update-initramfs", std::chrono::seconds( 10 ) /* fake timeout */ );
+    // And then do the ACTUAL work, for each kernel in parallel.
+    const QStringList kernels = m_kernel == QStringLiteral( "all" ) ? CalamaresUtils::Initramfs::installedKernels()
+                                                                    : QStringList { m_kernel };
+    QList< QStringList > commands;
+    for ( const auto& k : kernels )
+    {
+        commands.append( { "update-initramfs", "-k", k, "-c", "-t" } );
+    }
+    if ( commands.isEmpty() )
+    {
+        commands.append( { "update-initramfs", "-k", m_kernel, "-c", "-t" } );
+    }
+    return CalamaresUtils::Initramfs::rebuild( QStringLiteral( "update-initramfs" ), commands, m_skipWhenClean );
 }
 
 
@@ -87,6 +97,7 @@ InitramfsJob::setConfigurationMap( const QVariantMap& configurationMap )
     }
 
     m_unsafe = CalamaresUtils::getBool( configurationMap, "be_unsafe", false );
+    m_skipWhenClean = CalamaresUtils::getBool( configurationMap, "skipWhenClean", false );
 }
 
 CALAMARES_PLUGIN_FACTORY_DEFINITION( InitramfsJobFactory, registerPlugin< InitramfsJob >(); )
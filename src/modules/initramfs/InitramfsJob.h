@@ -34,6 +34,7 @@ public:
 private:
     QString m_kernel;
     bool m_unsafe = false;
+    bool m_skipWhenClean = false;
 };
 
 CALAMARES_PLUGIN_FACTORY_DECLARATION( InitramfsJobFactory )
@@ -9,18 +9,23 @@
 
 #include "Tests.h"
 
+#include "InitramfsJob.h"
+
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Initramfs.h"
 #include "utils/Logger.h"
 #include "utils/Yaml.h"
 
 #include <QtTest/QtTest>
 
+#include <QDir>
 #include <QFileInfo>
 #include <QStringList>
+#include <QTemporaryDir>
 
 QTEST_GUILESS_MAIN( InitramfsTests )
 
@@ -72,3 +77,58 @@ InitramfsTests::testCreateTargetFile()
 
     QFile::remove( path );
 }
+
+void
+InitramfsTests::testInstalledKernels()
+{
+    QTemporaryDir root;
+    QVERIFY( root.isValid() );
+    Calamares::JobQueue::instance()->globalStorage()->insert( "rootMountPoint", root.path() );
+
+    QCOMPARE( CalamaresUtils::Initramfs::installedKernels(), QStringList() );
+
+    QDir d( root.path() );
+    QVERIFY( d.mkpath( "lib/modules/5.15.0-1" ) );
+    QVERIFY( d.mkpath( "usr/lib/modules/5.15.0-1" ) );
+    QVERIFY( d.mkpath( "usr/lib/modules/5.10.0-3" ) );
+    QCOMPARE( CalamaresUtils::Initramfs::installedKernels(), QStringList( { "5.10.0-3", "5.15.0-1" } ) );
+}
+
+void
+InitramfsTests::testSkipWhenClean()
+{
+    using namespace CalamaresUtils::Initramfs;
+    const QStringList kernel { "update-initramfs", "-k", "5.15.0-1", "-c", "-t" };
+    const QStringList other { "update-initramfs", "-k", "5.16.0-1", "-c", "-t" };
+
+    auto* gs = Calamares::JobQueue::instance()->globalStorage();
+    gs->remove( "initramfsDirty" );
+    gs->remove( "initramfsRebuilt" );
+    QVERIFY( isDirty( kernel ) );  // Unknown, so rebuild
+    setClean( kernel );
+    QVERIFY( !isDirty( kernel ) );
+    QVERIFY( isDirty( other ) );  // Rebuilding one kernel doesn't count for another
+    setClean( other );
+    QVERIFY( !isDirty( kernel ) );
+    QVERIFY( !isDirty( other ) );
+
+    // Would fail if it ran update-initramfs (in a chroot in /tmp)
+    gs->insert( "rootMountPoint", "/tmp" );
+    InitramfsJob job;
+    job.setConfigurationMap( QVariantMap { { "kernel", "5.15.0-1" }, { "skipWhenClean", true } } );
+    QVERIFY( job.exec() );
+
+    setDirty( QStringLiteral( "test" ) );
+    QVERIFY( isDirty( kernel ) );
+    QVERIFY( isDirty( other ) );
+
+    // A Python module marking it dirty also invalidates the earlier rebuilds
+    setClean( kernel );
+    gs->insert( "initramfsDirty", true );
+    setClean( other );
+    QVERIFY( isDirty( kernel ) );
+    QVERIFY( !isDirty( other ) );
+
+    gs->remove( "initramfsDirty" );
+    gs->remove( "initramfsRebuilt" );
+}
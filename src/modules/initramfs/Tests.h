@@ -25,6 +25,9 @@ private Q_SLOTS:
 
     // TODO: this doesn't actually test any of the functionality of this job
     void testCreateTargetFile();
+
+    void testInstalledKernels();
+    void testSkipWhenClean();
 };
 
 #endif
@@ -90,5 +90,6 @@ def run():
                 _("No root mount point is given for <pre>{!s}</pre> to use." ).format("initramfscfg"))
 
     copy_initramfs_hooks(partitions, root_mount_point)
+    libcalamares.globalstorage.insert("initramfsDirty", True)
 
     return None
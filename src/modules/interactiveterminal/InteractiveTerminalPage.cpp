@@ -47,12 +47,12 @@ InteractiveTerminalPage::errorKonsoleNotInstalled()
     mb.exec();
 }
 
-void
-InteractiveTerminalPage::onActivate()
+bool
+InteractiveTerminalPage::createTerminal()
 {
     if ( m_termHostWidget )
     {
-        return;
+        return true;
     }
     // For whatever reason, instead of simply linking against a library we
     // need to do a runtime query to KService just to get a sodding terminal
@@ -62,8 +62,7 @@ InteractiveTerminalPage::onActivate()
     {
         // And all of this hoping the Konsole application is installed. If not,
         // tough cookies.
-        errorKonsoleNotInstalled();
-        return;
+        return false;
     }
 
     // Create one instance of konsolepart.
@@ -71,8 +70,7 @@ InteractiveTerminalPage::onActivate()
     if ( !p )
     {
         // One more opportunity for the loading operation to fail.
-        errorKonsoleNotInstalled();
-        return;
+        return false;
     }
 
     // Cast the konsolepart to the TerminalInterface...
@@ -80,8 +78,8 @@ InteractiveTerminalPage::onActivate()
     if ( !t )
     {
         // This is why we can't have nice things.
-        errorKonsoleNotInstalled();
-        return;
+        delete p;
+        return false;
     }
 
     // Make the widget persist even if the KPart goes out of scope...
@@ -89,12 +87,36 @@ InteractiveTerminalPage::onActivate()
     // ... but kill the KPart if the widget goes out of scope.
     p->setAutoDeletePart( true );
 
+    m_terminal = t;
     m_termHostWidget = p->widget();
     m_layout->addWidget( m_termHostWidget );
     cDebug() << "Part widget ought to be" << m_termHostWidget->metaObject()->className();
+    return true;
+}
+
+void
+InteractiveTerminalPage::onPrefetch()
+{
+    // Failures are reported when the page is activated
+    (void)createTerminal();
+}
+
+void
+InteractiveTerminalPage::onActivate()
+{
+    if ( m_started )
+    {
+        return;
+    }
+    if ( !createTerminal() )
+    {
+        errorKonsoleNotInstalled();
+        return;
+    }
 
-    t->showShellInDir( QDir::home().path() );
-    t->sendInput( QString( "%1\n" ).arg( m_command ) );
+    m_started = true;
+    m_terminal->showShellInDir( QDir::home().path() );
+    m_terminal->sendInput( QString( "%1\n" ).arg( m_command ) );
 }
 
 
@@ -14,6 +14,7 @@
 
 class QLabel;
 class QVBoxLayout;
+class TerminalInterface;
 
 class InteractiveTerminalPage : public QWidget
 {
@@ -22,16 +23,22 @@ public:
     explicit InteractiveTerminalPage( QWidget* parent = nullptr );
 
     void onActivate();
+    /// @brief Loads the terminal part, without running anything in it
+    void onPrefetch();
 
     void setCommand( const QString& command );
 
 private:
     QVBoxLayout* m_layout;
     QWidget* m_termHostWidget;
+    TerminalInterface* m_terminal = nullptr;
+    bool m_started = false;  ///< Has the command been sent to the terminal?
     QString m_command;
     QLabel* m_headerLabel;
 
     void errorKonsoleNotInstalled();
+    /// @brief Creates the terminal part; returns @c false (quietly) on failure
+    bool createTerminal();
 };
 
 #endif  // INTERACTIVETERMINALPAGE_H
@@ -92,6 +92,12 @@ InteractiveTerminalViewStep::onActivate()
     m_widget->onActivate();
 }
 
+void
+InteractiveTerminalViewStep::onPrefetch()
+{
+    m_widget->onPrefetch();
+}
+
 
 void
 InteractiveTerminalViewStep::setConfigurationMap( const QVariantMap& configurationMap )
@@ -41,6 +41,7 @@ public:
     QList< Calamares::job_ptr > jobs() const override;
 
     void onActivate() override;
+    void onPrefetch() override;
 
 protected:
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
@@ -24,6 +24,7 @@
 #include <QApplication>
 #include <QProcess>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 /* Returns stringlist with suitable setxkbmap command-line arguments
  * to set the given @p model.
@@ -112,6 +113,20 @@ xkbmap_query_grp_option()
     return outputLine.mid( index, lastIndex - index );
 }
 
+/* Returns the group-switch option to use: the one currently set
+ * in X, or a default if none is set.
+ */
+static inline QString
+xkbmap_group_switcher()
+{
+    QString groupSwitcher = xkbmap_query_grp_option();
+    if ( groupSwitcher.isEmpty() )
+    {
+        groupSwitcher = "grp:alt_shift_toggle";
+    }
+    return groupSwitcher;
+}
+
 AdditionalLayoutInfo
 Config::getAdditionalLayoutInfo( const QString& layout )
 {
@@ -154,12 +169,14 @@ Config::Config( QObject* parent )
     , m_keyboardVariantsModel( new KeyboardVariantsModel( this ) )
 {
     m_setxkbmapTimer.setSingleShot( true );
+    connect( &m_setxkbmapWatcher, &QFutureWatcher< XkbApplied >::finished, this, &Config::xkbFinished );
 
     // Connect signals and slots
     connect( m_keyboardModelsModel, &KeyboardModelsModel::currentIndexChanged, [&]( int index ) {
         // Set Xorg keyboard model
         m_selectedModel = m_keyboardModelsModel->key( index );
-        QProcess::execute( "setxkbmap", xkbmap_model_args( m_selectedModel ) );
+        m_xkbModelPending = true;
+        xkbStart();
         emit prettyStatusChanged();
     } );
 
@@ -204,32 +221,86 @@ void
 Config::xkbApply()
 {
     m_additionalLayoutInfo = getAdditionalLayoutInfo( m_selectedLayout );
+    m_xkbLayoutPending = true;
+    m_setxkbmapTimer.disconnect( this );
+    xkbStart();
+}
 
-    if ( !m_additionalLayoutInfo.additionalLayout.isEmpty() )
+void
+Config::xkbStart()
+{
+    if ( m_setxkbmapWatcher.isRunning() || !( m_xkbModelPending || m_xkbLayoutPending ) )
     {
-        m_additionalLayoutInfo.groupSwitcher = xkbmap_query_grp_option();
+        // Either xkbFinished() will call this again, or there's nothing to do
+        return;
+    }
 
-        if ( m_additionalLayoutInfo.groupSwitcher.isEmpty() )
+    // The worker gets copies of the latest settings
+    const QString model = m_xkbModelPending ? m_selectedModel : QString();
+    const QString layout = m_xkbLayoutPending ? m_selectedLayout : QString();
+    const QString variant = m_selectedVariant;
+    const AdditionalLayoutInfo info = m_additionalLayoutInfo;
+    m_xkbModelPending = false;
+    m_xkbLayoutPending = false;
+
+    m_setxkbmapWatcher.setFuture( QtConcurrent::run( [ = ]() {
+        XkbApplied applied;
+        if ( !model.isEmpty() )
+        {
+            QProcess::execute( "setxkbmap", xkbmap_model_args( model ) );
+            cDebug() << "xkbmap model changed to: " << model;
+        }
+        if ( layout.isEmpty() )
         {
-            m_additionalLayoutInfo.groupSwitcher = "grp:alt_shift_toggle";
+            return applied;
         }
 
-        QProcess::execute( "setxkbmap",
-                           xkbmap_layout_args( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
-                                               { m_additionalLayoutInfo.additionalVariant, m_selectedVariant },
-                                               m_additionalLayoutInfo.groupSwitcher ) );
+        applied.layout = layout;
+        if ( !info.additionalLayout.isEmpty() )
+        {
+            applied.groupSwitcher = xkbmap_group_switcher();
+
+            QProcess::execute( "setxkbmap",
+                               xkbmap_layout_args( { info.additionalLayout, layout },
+                                                   { info.additionalVariant, variant },
+                                                   applied.groupSwitcher ) );
 
 
-        cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant << "(added "
-                 << m_additionalLayoutInfo.additionalLayout << "-" << m_additionalLayoutInfo.additionalVariant
-                 << " since current layout is not ASCII-capable)";
+            cDebug() << "xkbmap selection changed to: " << layout << '-' << variant << "(added "
+                     << info.additionalLayout << "-" << info.additionalVariant
+                     << " since current layout is not ASCII-capable)";
+        }
+        else
+        {
+            QProcess::execute( "setxkbmap", xkbmap_layout_args( layout, variant ) );
+            cDebug() << "xkbmap selection changed to: " << layout << '-' << variant;
+        }
+        return applied;
+    } ) );
+}
+
+void
+Config::xkbFinished()
+{
+    const auto applied = m_setxkbmapWatcher.result();
+    // The selection may have moved on while the worker was busy
+    if ( !applied.layout.isEmpty() && applied.layout == m_selectedLayout
+         && !m_additionalLayoutInfo.additionalLayout.isEmpty() )
+    {
+        m_additionalLayoutInfo.groupSwitcher = applied.groupSwitcher;
     }
-    else
+    xkbStart();
+}
+
+void
+Config::xkbWait()
+{
+    m_setxkbmapWatcher.waitForFinished();
+    if ( !m_additionalLayoutInfo.additionalLayout.isEmpty() && m_additionalLayoutInfo.groupSwitcher.isEmpty() )
     {
-        QProcess::execute( "setxkbmap", xkbmap_layout_args( m_selectedLayout, m_selectedVariant ) );
-        cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant;
+        // The worker hasn't reported back (or hasn't been started yet)
+        m_additionalLayoutInfo.groupSwitcher = xkbmap_group_switcher();
     }
-    m_setxkbmapTimer.disconnect( this );
 }
 
 
@@ -368,6 +439,7 @@ Config::createJobs()
 {
     QList< Calamares::job_ptr > list;
 
+    xkbWait();
     Calamares::Job* j = new SetKeyboardLayoutJob( m_selectedModel,
                                                   m_selectedLayout,
                                                   m_selectedVariant,
@@ -16,6 +16,7 @@
 #include "KeyboardLayoutModel.h"
 
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 #include <QMap>
 #include <QObject>
 #include <QTimer>
@@ -90,6 +91,27 @@ private:
     void xkbChanged( int index );
     void xkbApply();
 
+    /* The actual calls to setxkbmap happen in a worker thread, so
+     * that the UI doesn't stall on them. There is at most one
+     * worker running; changes made while it runs are coalesced into
+     * one pending request, which is started (with the then-latest
+     * settings) when the worker is done.
+     *
+     * xkbStart() starts a worker if something is pending,
+     * xkbFinished() is called when the worker is done.
+     */
+    void xkbStart();
+    void xkbFinished();
+    /// @brief Wait for any pending and running setxkbmap calls
+    void xkbWait();
+
+    /// @brief What the worker thread did
+    struct XkbApplied
+    {
+        QString layout;  ///< The layout that was applied (empty if only the model)
+        QString groupSwitcher;  ///< Group-switch option that was used
+    };
+
     KeyboardModelsModel* m_keyboardModelsModel;
     KeyboardLayoutModel* m_keyboardLayoutsModel;
     KeyboardVariantsModel* m_keyboardVariantsModel;
@@ -102,6 +124,9 @@ private:
     AdditionalLayoutInfo m_additionalLayoutInfo;
 
     QTimer m_setxkbmapTimer;
+    QFutureWatcher< XkbApplied > m_setxkbmapWatcher;
+    bool m_xkbModelPending = false;
+    bool m_xkbLayoutPending = false;
 
     // From configuration
     QString m_xOrgConfFileName;
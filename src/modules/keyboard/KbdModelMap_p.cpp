@@ -0,0 +1,99 @@
+/*   GENERATED FILE DO NOT EDIT
+*
+*  === This file is part of Calamares - <https://calamares.io> ===
+*
+* SPDX-FileCopyrightText: 2015 Systemd authors and contributors
+* SPDX-FileCopyrightText: 2018 Adriaan de Groot <groot@kde.org>
+* SPDX-License-Identifier: GPL-3.0-or-later
+*
+* This file is derived from kbd-model-map (from systemd-localed)
+* by kbd-model-map-extractor.py
+*
+*/
+
+// BEGIN Generated from kbd-model-map
+// *INDENT-OFF*
+// clang-format off
+
+struct KbdModelMapEntry
+{
+    const char* key;  ///< First X11 layout in xlayout, for sorting and lookup
+    const char* consoleLayout;
+    const char* xLayout;
+    const char* xModel;
+    const char* xVariant;  ///< Empty if the map says "-"
+};
+
+static constexpr int const kbd_model_map_size = 67;
+
+static const KbdModelMapEntry kbd_model_map_table[] = {
+{ "at", "de", "at", "pc105", "" },
+{ "be", "be-latin1", "be", "pc105", "" },
+{ "bg", "bg_pho-utf8", "bg,us", "pc105", ",phonetic" },
+{ "bg", "bg_bds-utf8", "bg,us", "pc105", "" },
+{ "br", "br-abnt2", "br", "abnt2", "" },
+{ "by", "by", "by,us", "pc105", "" },
+{ "ca", "cf", "ca", "pc105", "" },
+{ "ch", "sg", "ch", "pc105", "de_nodeadkeys" },
+{ "ch", "fr_CH", "ch", "pc105", "fr" },
+{ "ch", "sg-latin1", "ch", "pc105", "de_nodeadkeys" },
+{ "ch", "fr_CH-latin1", "ch", "pc105", "fr" },
+{ "cz", "cz-us-qwertz", "cz,us", "pc105", "" },
+{ "cz", "cz-lat2", "cz", "pc105", "qwerty" },
+{ "de", "de", "de", "pc105", "" },
+{ "de", "de-latin1", "de", "pc105", "" },
+{ "de", "de-latin1-nodeadkeys", "de", "pc105", "nodeadkeys" },
+{ "dk", "dk-latin1", "dk", "pc105", "" },
+{ "dk", "dk", "dk", "pc105", "" },
+{ "ee", "et", "ee", "pc105", "" },
+{ "es", "es", "es", "pc105", "" },
+{ "fi", "fi", "fi", "pc105", "" },
+{ "fr", "fr", "fr", "pc105", "" },
+{ "fr", "fr-latin1", "fr", "pc105", "" },
+{ "fr", "fr-pc", "fr", "pc105", "" },
+{ "fr", "fr-latin9", "fr", "pc105", "latin9" },
+{ "gb", "uk", "gb", "pc105", "" },
+{ "gr", "gr", "gr,us", "pc105", "" },
+{ "hr", "croat", "hr", "pc105", "" },
+{ "hu", "hu101", "hu", "pc105", "qwerty" },
+{ "hu", "hu", "hu", "pc105", "" },
+{ "ie", "ie", "ie", "pc105", "" },
+{ "il", "il", "il", "pc105", "" },
+{ "is", "is-latin1", "is", "pc105", "" },
+{ "it", "it2", "it", "pc105", "" },
+{ "it", "it", "it", "pc105", "" },
+{ "it", "it-ibm", "it", "pc105", "" },
+{ "jp", "jp106", "jp", "jp106", "" },
+{ "kh", "khmer", "kh,us", "pc105", "" },
+{ "kr", "ko", "kr", "pc105", "" },
+{ "kz", "kazakh", "kz,us", "pc105", "" },
+{ "latam", "la-latin1", "latam", "pc105", "" },
+{ "lt", "lt.baltic", "lt", "pc105", "" },
+{ "lt", "lt", "lt", "pc105", "" },
+{ "mk", "mk-utf", "mk,us", "pc105", "" },
+{ "nl", "nl", "nl", "pc105", "" },
+{ "no", "no", "no", "pc105", "" },
+{ "pl", "pl2", "pl", "pc105", "" },
+{ "pt", "pt-latin1", "pt", "pc105", "" },
+{ "ro", "ro-std", "ro", "pc105", "std" },
+{ "ro", "ro", "ro", "pc105", "" },
+{ "ro", "ro-std-cedilla", "ro", "pc105", "std_cedilla" },
+{ "ro", "ro-cedilla", "ro", "pc105", "cedilla" },
+{ "rs", "sr-latin", "rs", "pc105", "latin" },
+{ "rs", "sr-cy", "rs", "pc105", "" },
+{ "ru", "ru", "ru,us", "pc105", "" },
+{ "se", "sv-latin1", "se", "pc105", "" },
+{ "si", "slovene", "si", "pc105", "" },
+{ "sk", "sk-qwerty", "sk", "pc105", "" },
+{ "sk", "sk-qwertz", "sk", "pc105", "" },
+{ "tj", "tj_alt-UTF8", "tj", "pc105", "" },
+{ "tr", "trq", "tr", "pc105", "" },
+{ "tr", "trf", "tr", "pc105", "f" },
+{ "ua", "ua-utf", "ua,us", "pc105", "" },
+{ "us", "us", "us", "pc105+inet", "" },
+{ "us", "us-acentos", "us", "pc105", "intl" },
+{ "us", "dvorak", "us", "pc105", "dvorak" },
+{ "us", "dvorak", "us", "pc105", "dvorak-alt-intl" },
+};
+
+// END Generated from kbd-model-map
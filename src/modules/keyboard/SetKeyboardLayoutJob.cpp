@@ -29,6 +29,10 @@
 #include <QSettings>
 #include <QTextStream>
 
+#include <algorithm>
+
+#include "KbdModelMap_p.cpp"
+
 
 SetKeyboardLayoutJob::SetKeyboardLayoutJob( const QString& model,
                                             const QString& layout,
@@ -81,87 +85,74 @@ SetKeyboardLayoutJob::findConvertedKeymap( const QString& convertedKeymapPath )
 }
 
 
+namespace
+{
+/// @brief Compares table entries by key, for binary search
+struct KbdModelMapKeyLess
+{
+    bool operator()( const KbdModelMapEntry& e, const QByteArray& key ) const { return qstrcmp( e.key, key ) < 0; }
+    bool operator()( const QByteArray& key, const KbdModelMapEntry& e ) const { return qstrcmp( key, e.key ) < 0; }
+};
+}  // namespace
+
 STATICTEST QString
 findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
 {
-    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
+    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in table";
 
     int bestMatching = 0;
     QString name;
 
-    QFile file( ":/kbd-model-map" );
-    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cDebug() << Logger::SubEntry << "Could not read QRC";
-        return QString();
-    }
+    // Only entries whose first X11 layout is (the first of) our layout
+    // can match at all, and those are adjacent in the (sorted) table.
+    const QByteArray key = layout.section( ',', 0, 0 ).toLatin1();
+    const auto range = std::equal_range(
+        kbd_model_map_table, kbd_model_map_table + kbd_model_map_size, key, KbdModelMapKeyLess() );
 
-    QTextStream stream( &file );
-    while ( !stream.atEnd() )
+    for ( auto it = range.first; it != range.second; ++it )
     {
-        QString line = stream.readLine().trimmed();
-        if ( line.isEmpty() || line.startsWith( '#' ) )
-        {
-            continue;
-        }
-
-        QStringList mapping = line.split( '\t', SplitSkipEmptyParts );
-        if ( mapping.size() < 5 )
-        {
-            continue;
-        }
-
+        const QString xLayout = QString::fromLatin1( it->xLayout );
         int matching = 0;
 
         // Determine how well matching this entry is
         // We assume here that we have one X11 layout. If the UI changes to
         // allow more than one layout, this should change too.
-        if ( layout == mapping[ 1 ] )
+        if ( layout == xLayout )
         // If we got an exact match, this is best
         {
             matching = 10;
         }
         // Look for an entry whose first layout matches ours
-        else if ( mapping[ 1 ].startsWith( layout + ',' ) )
+        else if ( xLayout.startsWith( layout + ',' ) )
         {
             matching = 5;
         }
 
         if ( matching > 0 )
         {
-            if ( model.isEmpty() || model == mapping[ 2 ] )
+            if ( model.isEmpty() || model == QLatin1String( it->xModel ) )
             {
                 matching++;
             }
 
-            QString mappingVariant = mapping[ 3 ];
-            if ( mappingVariant == "-" )
-            {
-                mappingVariant = QString();
-            }
-            else if ( mappingVariant.startsWith( ',' ) )
-            {
-                mappingVariant.remove( 1, 0 );
-            }
-
-            if ( variant == mappingVariant )
+            if ( variant == QLatin1String( it->xVariant ) )
             {
                 matching++;
             }
 
-            // We ignore mapping[4], the xkb options, for now. If we ever
+            // We ignore the xkb options, for now. If we ever
             // allow setting options in the UI, we should match them here.
         }
 
         // The best matching entry so far, then let's save that
         if ( matching >= qMax( bestMatching, 1 ) )
         {
-            cDebug() << Logger::SubEntry << "Found legacy keymap" << mapping[ 0 ] << "with score" << matching;
+            cDebug() << Logger::SubEntry << "Found legacy keymap" << it->consoleLayout << "with score" << matching;
 
             if ( matching > bestMatching )
             {
                 bestMatching = matching;
-                name = mapping[ 0 ];
+                name = QString::fromLatin1( it->consoleLayout );
             }
         }
     }
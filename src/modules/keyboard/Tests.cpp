@@ -6,6 +6,8 @@
  *   Calamares is Free Software: see the License-Identifier above.
  *
  */
+#include "keyboardwidget/keyboardcodes.h"
+
 #include "utils/Logger.h"
 
 #include <QtTest/QtTest>
@@ -25,6 +27,10 @@ private Q_SLOTS:
 
     void testSimpleLayoutLookup_data();
     void testSimpleLayoutLookup();
+    void benchmarkLayoutLookup();
+
+    void testKeyCodes();
+    void benchmarkLayoutSwitch();
 };
 
 void
@@ -45,6 +51,10 @@ KeyboardLayoutTests::testSimpleLayoutLookup_data()
     QTest::newRow( "turkish default" ) << QString( "tr" ) << QString() << QString() << QString( "trq" );
     QTest::newRow( "turkish alt-q" ) << QString( "tr" ) << QString() << QString( "alt" ) << QString( "trq" );
     QTest::newRow( "turkish f" ) << QString( "tr" ) << QString() << QString( "f" ) << QString( "trf" );
+    QTest::newRow( "swiss" ) << QString( "ch" ) << QString() << QString( "fr" ) << QString( "fr_CH" );
+    QTest::newRow( "bulgarian" ) << QString( "bg" ) << QString() << QString( ",phonetic" ) << QString( "bg_pho-utf8" );
+    QTest::newRow( "multi" ) << QString( "mk,us" ) << QString() << QString() << QString( "mk-utf" );
+    QTest::newRow( "unknown" ) << QString( "xx" ) << QString() << QString() << QString();
 }
 
 
@@ -60,6 +70,68 @@ KeyboardLayoutTests::testSimpleLayoutLookup()
 }
 
 
+void
+KeyboardLayoutTests::benchmarkLayoutLookup()
+{
+    const QStringList layouts { "us", "tr", "ch", "de", "gb", "fr", "xx" };
+    QBENCHMARK
+    {
+        for ( const auto& layout : layouts )
+        {
+            findLegacyKeymap( layout, QString(), QString() );
+        }
+    }
+}
+
+void
+KeyboardLayoutTests::testKeyCodes()
+{
+    KeyboardCodes::CodeList codes;
+    QVERIFY( !KeyboardCodes::load( QString(), QString(), codes ) );
+    QVERIFY( codes.isEmpty() );
+
+    if ( !KeyboardCodes::load( "us", QString(), codes ) )
+    {
+        QSKIP( "Neither xkbcommon nor ckbcomp can produce keycodes" );
+    }
+    QVERIFY( codes.count() > 0x35 );
+    // Keycode 0x10 is the top-left letter, 0x02 the digit 1
+    QCOMPARE( codes.at( 0x10 - 1 ).plain, QStringLiteral( "q" ) );
+    QCOMPARE( codes.at( 0x10 - 1 ).shift, QStringLiteral( "Q" ) );
+    QCOMPARE( codes.at( 0x02 - 1 ).plain, QStringLiteral( "1" ) );
+    QCOMPARE( codes.at( 0x02 - 1 ).shift, QStringLiteral( "!" ) );
+
+    QVERIFY( KeyboardCodes::load( "fr", QString(), codes ) );
+    QCOMPARE( codes.at( 0x10 - 1 ).plain, QStringLiteral( "a" ) );
+
+    // Going back to an earlier layout gets the same symbols (from the cache)
+    QVERIFY( KeyboardCodes::load( "us", QString(), codes ) );
+    QCOMPARE( codes.at( 0x10 - 1 ).plain, QStringLiteral( "q" ) );
+}
+
+void
+KeyboardLayoutTests::benchmarkLayoutSwitch()
+{
+    // This is what the keyboard page does when a layout is selected:
+    // the preview loads the symbols for the new layout. After the
+    // first iteration, these all come from the cache.
+    KeyboardCodes::CodeList codes;
+    if ( !KeyboardCodes::load( "us", QString(), codes ) )
+    {
+        QSKIP( "Neither xkbcommon nor ckbcomp can produce keycodes" );
+    }
+
+    const QStringList layouts { "us", "de", "fr", "ru", "jp", "tr" };
+    QBENCHMARK
+    {
+        for ( const auto& layout : layouts )
+        {
+            KeyboardCodes::load( layout, QString(), codes );
+        }
+    }
+}
+
+
 QTEST_GUILESS_MAIN( KeyboardLayoutTests )
 
 #include "utils/moc-warnings.h"
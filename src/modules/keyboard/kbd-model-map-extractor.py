@@ -0,0 +1,82 @@
+#! /usr/bin/env python3
+#
+#  === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+"""
+Python3 script to turn kbd-model-map into a C++ lookup table.
+
+Run this in the keyboard module source directory, after editing
+kbd-model-map; it (over)writes KbdModelMap_p.cpp. The table is
+sorted by the first X11 layout of each entry (stable, so within
+a layout the order of the map file is preserved, which matters
+for the lookup) so that lookups can use a binary search.
+"""
+
+def scrape_file(file):
+    """
+    Returns a list of (consolelayout, xlayout, xmodel, xvariant) tuples,
+    in the order found in the file. Lines with fewer than five fields
+    are skipped, like the lookup code used to do.
+    """
+    entries = []
+    for line in file.readlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        fields = [f for f in line.split("\t") if f]
+        if len(fields) < 5:
+            continue
+        console, xlayout, xmodel, xvariant = fields[0:4]
+        if xvariant == "-":
+            xvariant = ""
+        entries.append((console, xlayout, xmodel, xvariant))
+    return entries
+
+
+cpp_header_comment = """/*   GENERATED FILE DO NOT EDIT
+*
+*  === This file is part of Calamares - <https://calamares.io> ===
+*
+* SPDX-FileCopyrightText: 2015 Systemd authors and contributors
+* SPDX-FileCopyrightText: 2018 Adriaan de Groot <groot@kde.org>
+* SPDX-License-Identifier: GPL-3.0-or-later
+*
+* This file is derived from kbd-model-map (from systemd-localed)
+* by kbd-model-map-extractor.py
+*
+*/
+
+// BEGIN Generated from kbd-model-map
+// *INDENT-OFF*
+// clang-format off
+"""
+
+cpp_struct = """
+struct KbdModelMapEntry
+{
+    const char* key;  ///< First X11 layout in xlayout, for sorting and lookup
+    const char* consoleLayout;
+    const char* xLayout;
+    const char* xModel;
+    const char* xVariant;  ///< Empty if the map says "-"
+};
+
+"""
+
+if __name__ == "__main__":
+    with open("kbd-model-map", "r") as f:
+        entries = scrape_file(f)
+    entries = sorted(entries, key=lambda e: e[1].split(",")[0])
+    with open("KbdModelMap_p.cpp", "w") as f:
+        f.write(cpp_header_comment)
+        f.write(cpp_struct)
+        f.write("static constexpr int const kbd_model_map_size = {!s};\n\n".format(len(entries)))
+        f.write("static const KbdModelMapEntry kbd_model_map_table[] = {\n")
+        for console, xlayout, xmodel, xvariant in entries:
+            f.write("""{{ "{!s}", "{!s}", "{!s}", "{!s}", "{!s}" }},\n""".format(
+                xlayout.split(",")[0], console, xlayout, xmodel, xvariant))
+        f.write("};\n\n")
+        f.write("// END Generated from kbd-model-map\n")
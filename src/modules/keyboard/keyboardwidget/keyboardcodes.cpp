@@ -0,0 +1,240 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2007 Free Software Foundation, Inc.
+ *   SPDX-FileCopyrightText: 2014 Teo Mrnjavac <teo@kde.org>
+ *   SPDX-FileCopyrightText: 2018 2021, Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Portions from the Manjaro Installation Framework
+ *   by Roland Singer <roland@manjaro.org>
+ *   Copyright (C) 2007 Free Software Foundation, Inc.
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "keyboardcodes.h"
+
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QCache>
+#include <QProcess>
+#include <QStringList>
+
+#ifdef HAVE_XKBCOMMON
+#include <xkbcommon/xkbcommon.h>
+#endif
+
+/// @brief Remove ctrl- and alt- symbols that are the same as the plain one
+static void
+simplifyCode( KeyboardCodes::Code& code )
+{
+    if ( code.ctrl == code.plain )
+    {
+        code.ctrl = QString();
+    }
+
+    if ( code.alt == code.plain )
+    {
+        code.alt = QString();
+    }
+}
+
+#ifdef HAVE_XKBCOMMON
+/* The preview only shows the main block of keys, which all have
+ * (kernel) keycodes below this one.
+ */
+static constexpr const int maxKeyCode = 0x7f;
+
+/// @brief Printable text of the symbol on @p key at shift-level @p level
+static QString
+levelText( xkb_keymap* keymap, xkb_keycode_t key, xkb_level_index_t level )
+{
+    const xkb_keysym_t* syms = nullptr;
+    if ( xkb_keymap_key_get_syms_by_level( keymap, key, 0, level, &syms ) < 1 )
+    {
+        return QString();
+    }
+
+    const char32_t ucs = xkb_keysym_to_utf32( syms[ 0 ] );
+    // Not a character, or a control character (e.g. Escape, Tab)
+    if ( ucs < 0x20 || ( 0x7f <= ucs && ucs < 0xa0 ) )
+    {
+        return QString();
+    }
+    return QString::fromUcs4( &ucs, 1 );
+}
+
+/** @brief Load codes by compiling the keymap in-process
+ *
+ * Returns @c false if xkbcommon can't compile the keymap.
+ */
+static bool
+loadXkbCommon( const QString& layout, const QString& variant, KeyboardCodes::CodeList& codes )
+{
+    // The context caches the include paths and parsed rules;
+    // it is intentionally kept for the lifetime of the process.
+    static xkb_context* context = xkb_context_new( XKB_CONTEXT_NO_FLAGS );
+    if ( !context )
+    {
+        return false;
+    }
+
+    const QByteArray layoutName = layout.toLatin1();
+    const QByteArray variantName = variant.toLatin1();
+    // Same model as the ckbcomp invocation, below
+    const xkb_rule_names names { "evdev",
+                                 "pc106",
+                                 layoutName.constData(),
+                                 variantName.isEmpty() ? nullptr : variantName.constData(),
+                                 nullptr };
+    xkb_keymap* keymap = xkb_keymap_new_from_names( context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS );
+    if ( !keymap )
+    {
+        return false;
+    }
+
+    codes.clear();
+    codes.reserve( maxKeyCode );
+    for ( int kernelCode = 1; kernelCode <= maxKeyCode; ++kernelCode )
+    {
+        // XKB keycodes are offset by 8 from the kernel keycodes
+        const xkb_keycode_t key = xkb_keycode_t( kernelCode + 8 );
+
+        // The levels are ordered as in ckbcomp's output
+        KeyboardCodes::Code code;
+        code.plain = levelText( keymap, key, 0 );
+        code.shift = levelText( keymap, key, 1 );
+        code.ctrl = levelText( keymap, key, 2 );
+        code.alt = levelText( keymap, key, 3 );
+        simplifyCode( code );
+
+        codes.append( code );
+    }
+
+    xkb_keymap_unref( keymap );
+    return true;
+}
+#endif
+
+static QString
+fromUnicodeString( const QString& raw )
+{
+    if ( raw.startsWith( "U+" ) )
+    {
+        return QChar( raw.mid( 2 ).toInt( nullptr, 16 ) );
+    }
+    else if ( raw.startsWith( "+U" ) )
+    {
+        return QChar( raw.mid( 3 ).toInt( nullptr, 16 ) );
+    }
+
+    return "";
+}
+
+/// @brief Load codes by running ckbcomp and parsing its output
+static bool
+loadCkbcomp( const QString& layout, const QString& variant, KeyboardCodes::CodeList& codes )
+{
+    QStringList param { "-model", "pc106", "-layout", layout, "-compact" };
+    if ( !variant.isEmpty() )
+    {
+        param << "-variant" << variant;
+    }
+
+
+    QProcess process;
+    process.setEnvironment( QStringList() << "LANG=C"
+                                          << "LC_MESSAGES=C" );
+    process.start( "ckbcomp", param );
+    if ( !process.waitForStarted() )
+    {
+        static bool need_warning = true;
+        if ( need_warning )
+        {
+            cWarning() << "ckbcomp not found , keyboard preview disabled";
+            need_warning = false;
+        }
+        return false;
+    }
+
+    if ( !process.waitForFinished() )
+    {
+        cWarning() << "ckbcomp failed, keyboard preview skipped for" << layout << variant;
+        return false;
+    }
+
+    // Clear codes
+    codes.clear();
+
+    const QStringList list = QString( process.readAll() ).split( "\n", SplitSkipEmptyParts );
+
+    for ( const QString& line : list )
+    {
+        if ( !line.startsWith( "keycode" ) || !line.contains( '=' ) )
+        {
+            continue;
+        }
+
+        QStringList split = line.split( '=' ).at( 1 ).trimmed().split( ' ' );
+        if ( split.size() < 4 )
+        {
+            continue;
+        }
+
+        KeyboardCodes::Code code;
+        code.plain = fromUnicodeString( split.at( 0 ) );
+        code.shift = fromUnicodeString( split.at( 1 ) );
+        code.ctrl = fromUnicodeString( split.at( 2 ) );
+        code.alt = fromUnicodeString( split.at( 3 ) );
+        simplifyCode( code );
+
+        codes.append( code );
+    }
+
+    return true;
+}
+
+/// @brief Loads codes without looking at the cache
+static bool
+loadUncached( const QString& layout, const QString& variant, KeyboardCodes::CodeList& codes )
+{
+#ifdef HAVE_XKBCOMMON
+    if ( loadXkbCommon( layout, variant, codes ) )
+    {
+        return true;
+    }
+    cDebug() << "Could not compile keymap for" << layout << variant << ", falling back to ckbcomp";
+#endif
+    return loadCkbcomp( layout, variant, codes );
+}
+
+bool
+KeyboardCodes::load( const QString& layout, const QString& variant, CodeList& codes )
+{
+    if ( layout.isEmpty() )
+    {
+        return false;
+    }
+
+    // Recently-used layouts are kept, so that going back and forth
+    // through the list of layouts doesn't load them again every time.
+    static QCache< QString, CodeList > cache( cacheSize );
+
+    const QString key = layout + '(' + variant + ')';
+    if ( const auto* cached = cache.object( key ) )
+    {
+        codes = *cached;
+        return true;
+    }
+
+    CodeList loaded;
+    if ( !loadUncached( layout, variant, loaded ) )
+    {
+        return false;
+    }
+    cache.insert( key, new CodeList( loaded ) );
+    codes = loaded;
+    return true;
+}
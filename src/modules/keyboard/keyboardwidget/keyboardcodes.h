@@ -0,0 +1,52 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2014 Teo Mrnjavac <teo@kde.org>
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef KEYBOARDCODES_H
+#define KEYBOARDCODES_H
+
+#include <QList>
+#include <QString>
+
+/** @brief Symbols on the keys of a keyboard, for the preview
+ *
+ * Which symbols are on the keys depends on the layout and variant.
+ * When libxkbcommon is available, the keymap is compiled in-process;
+ * otherwise `ckbcomp` is run to produce the table.
+ */
+class KeyboardCodes
+{
+public:
+    /// @brief Symbols on one key, for each shift-level
+    struct Code
+    {
+        QString plain, shift, ctrl, alt;
+    };
+    /** @brief Symbols for each key
+     *
+     * The list is indexed by (Linux kernel) keycode minus one.
+     */
+    using CodeList = QList< Code >;
+
+    /// @brief Number of layout-variant combinations that are kept
+    static constexpr const int cacheSize = 32;
+
+    /** @brief Loads the symbols for @p layout and @p variant into @p codes
+     *
+     * Returns @c false (and leaves @p codes unchanged) if the
+     * symbols cannot be determined.
+     *
+     * The most-recently used layout-variant combinations are cached,
+     * so loading one again is cheap. The cache is not thread-safe:
+     * only call this from the GUI thread.
+     */
+    static bool load( const QString& layout, const QString& variant, CodeList& codes );
+};
+
+#endif  // KEYBOARDCODES_H
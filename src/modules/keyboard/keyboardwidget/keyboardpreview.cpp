@@ -16,7 +16,6 @@
 #include "keyboardpreview.h"
 
 #include "utils/Logger.h"
-#include "utils/String.h"
 
 KeyBoardPreview::KeyBoardPreview( QWidget* parent )
     : QWidget( parent )
@@ -119,93 +118,7 @@ KeyBoardPreview::loadInfo()
 bool
 KeyBoardPreview::loadCodes()
 {
-    if ( layout.isEmpty() )
-    {
-        return false;
-    }
-
-    QStringList param { "-model", "pc106", "-layout", layout, "-compact" };
-    if ( !variant.isEmpty() )
-    {
-        param << "-variant" << variant;
-    }
-
-
-    QProcess process;
-    process.setEnvironment( QStringList() << "LANG=C"
-                                          << "LC_MESSAGES=C" );
-    process.start( "ckbcomp", param );
-    if ( !process.waitForStarted() )
-    {
-        static bool need_warning = true;
-        if ( need_warning )
-        {
-            cWarning() << "ckbcomp not found , keyboard preview disabled";
-            need_warning = false;
-        }
-        return false;
-    }
-
-    if ( !process.waitForFinished() )
-    {
-        cWarning() << "ckbcomp failed, keyboard preview skipped for" << layout << variant;
-        return false;
-    }
-
-    // Clear codes
-    codes.clear();
-
-    const QStringList list = QString( process.readAll() ).split( "\n", SplitSkipEmptyParts );
-
-    for ( const QString& line : list )
-    {
-        if ( !line.startsWith( "keycode" ) || !line.contains( '=' ) )
-        {
-            continue;
-        }
-
-        QStringList split = line.split( '=' ).at( 1 ).trimmed().split( ' ' );
-        if ( split.size() < 4 )
-        {
-            continue;
-        }
-
-        Code code;
-        code.plain = fromUnicodeString( split.at( 0 ) );
-        code.shift = fromUnicodeString( split.at( 1 ) );
-        code.ctrl = fromUnicodeString( split.at( 2 ) );
-        code.alt = fromUnicodeString( split.at( 3 ) );
-
-        if ( code.ctrl == code.plain )
-        {
-            code.ctrl = "";
-        }
-
-        if ( code.alt == code.plain )
-        {
-            code.alt = "";
-        }
-
-        codes.append( code );
-    }
-
-    return true;
-}
-
-
-QString
-KeyBoardPreview::fromUnicodeString( QString raw )
-{
-    if ( raw.startsWith( "U+" ) )
-    {
-        return QChar( raw.mid( 2 ).toInt( nullptr, 16 ) );
-    }
-    else if ( raw.startsWith( "+U" ) )
-    {
-        return QChar( raw.mid( 3 ).toInt( nullptr, 16 ) );
-    }
-
-    return "";
+    return KeyboardCodes::load( layout, variant, codes );
 }
 
 
@@ -15,13 +15,14 @@
 #ifndef KEYBOARDPREVIEW_H
 #define KEYBOARDPREVIEW_H
 
+#include "keyboardcodes.h"
+
 #include <QColor>
 #include <QFont>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
 #include <QPixmap>
-#include <QProcess>
 #include <QRectF>
 #include <QString>
 #include <QStringList>
@@ -51,15 +52,10 @@ private:
         QList< QList< int > > keys;
     };
 
-    struct Code
-    {
-        QString plain, shift, ctrl, alt;
-    };
-
     QString layout, variant;
     QFont lowerFont, upperFont;
     KB *kb, kbList[ 3 ];
-    QList< Code > codes;
+    KeyboardCodes::CodeList codes;
     int space, usable_width, key_w;
 
     void loadInfo();
@@ -68,7 +64,6 @@ private:
     QString shift_text( int index );
     QString ctrl_text( int index );
     QString alt_text( int index );
-    QString fromUnicodeString( QString raw );
 
 protected:
     void paintEvent( QPaintEvent* event ) override;
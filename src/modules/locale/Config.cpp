@@ -14,6 +14,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
+#include "geoip/Resolver.h"
 #include "locale/Global.h"
 #include "locale/Translation.h"
 #include "modulesystem/ModuleManager.h"
@@ -453,35 +454,17 @@ getStartingTimezone( const QVariantMap& configurationMap, CalamaresUtils::GeoIP:
     }
 }
 
-static inline void
-getGeoIP( const QVariantMap& configurationMap, std::unique_ptr< CalamaresUtils::GeoIP::Handler >& geoip )
-{
-    bool ok = false;
-    QVariantMap map = CalamaresUtils::getSubMap( configurationMap, "geoip", ok );
-    if ( ok )
-    {
-        QString url = CalamaresUtils::getString( map, "url" );
-        QString style = CalamaresUtils::getString( map, "style" );
-        QString selector = CalamaresUtils::getString( map, "selector" );
-
-        geoip = std::make_unique< CalamaresUtils::GeoIP::Handler >( style, url, selector );
-        if ( !geoip->isValid() )
-        {
-            cWarning() << "GeoIP Style" << style << "is not recognized.";
-        }
-    }
-}
-
 void
 Config::setConfigurationMap( const QVariantMap& configurationMap )
 {
     getLocaleGenLines( configurationMap, m_localeGenLines );
     getAdjustLiveTimezone( configurationMap, m_adjustLiveTimezone );
     getStartingTimezone( configurationMap, m_startingTimezone );
-    getGeoIP( configurationMap, m_geoip );
+    m_geoip = CalamaresUtils::GeoIP::Resolver::handlers( configurationMap.value( "geoip" ) );
 
 #ifndef BUILD_AS_TEST
-    if ( m_geoip && m_geoip->isValid() )
+    // The lookup may already be running, if it is configured in settings.conf
+    if ( !m_geoip.empty() || CalamaresUtils::GeoIP::Resolver::instance().isStarted() )
     {
         connect(
             Calamares::ModuleManager::instance(), &Calamares::ModuleManager::modulesLoaded, this, &Config::startGeoIP );
@@ -516,17 +499,22 @@ Config::finalizeGlobalStorage() const
 void
 Config::startGeoIP()
 {
-    if ( m_geoip && m_geoip->isValid() )
+    auto& resolver = CalamaresUtils::GeoIP::Resolver::instance();
+    if ( !resolver.isStarted() && !m_geoip.empty() )
     {
         auto& network = CalamaresUtils::Network::Manager::instance();
-        if ( network.hasInternet() || network.synchronousPing( m_geoip->url() ) )
+        if ( network.hasInternet() || network.synchronousPing( m_geoip.front().url() ) )
         {
-            using Watcher = QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair >;
-            m_geoipWatcher = std::make_unique< Watcher >();
-            m_geoipWatcher->setFuture( m_geoip->query() );
-            connect( m_geoipWatcher.get(), &Watcher::finished, this, &Config::completeGeoIP );
+            resolver.start( m_geoip );
         }
     }
+    if ( resolver.isStarted() )
+    {
+        using Watcher = QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair >;
+        m_geoipWatcher = std::make_unique< Watcher >();
+        connect( m_geoipWatcher.get(), &Watcher::finished, this, &Config::completeGeoIP );
+        m_geoipWatcher->setFuture( resolver.result() );
+    }
 }
 
 void
@@ -549,5 +537,5 @@ Config::completeGeoIP()
         cWarning() << "GeoIP result ignored because a location is already set.";
     }
     m_geoipWatcher.reset();
-    m_geoip.reset();
+    m_geoip.clear();
 }
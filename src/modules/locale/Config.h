@@ -21,6 +21,7 @@
 #include <QObject>
 
 #include <memory>
+#include <vector>
 
 class Config : public QObject
 {
@@ -173,12 +174,12 @@ private:
      */
     CalamaresUtils::GeoIP::RegionZonePair m_startingTimezone;
 
-    /** @brief Handler for GeoIP lookup (if configured)
+    /** @brief Handlers for GeoIP lookup (if configured)
      *
-     * The GeoIP lookup needs to be started at some suitable time,
-     * by explicitly calling *TODO*
+     * The GeoIP lookup is started once the modules are loaded,
+     * unless settings.conf has already started it.
      */
-    std::unique_ptr< CalamaresUtils::GeoIP::Handler > m_geoip;
+    std::vector< CalamaresUtils::GeoIP::Handler > m_geoip;
 
     // Implementation details for doing GeoIP lookup
     void startGeoIP();
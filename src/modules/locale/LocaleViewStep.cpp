@@ -56,7 +56,6 @@ LocaleViewStep::~LocaleViewStep()
 void
 LocaleViewStep::setUpPage()
 {
-    m_config->setCurrentLocation();
     if ( !m_actualWidget )
     {
         m_actualWidget = new LocalePage( m_config.get() );
@@ -130,7 +129,7 @@ void
 LocaleViewStep::onActivate()
 {
     m_config->setCurrentLocation();  // Finalize the location
-    if ( !m_actualWidget )
+    if ( !m_nextEnabled )
     {
         setUpPage();
     }
@@ -138,6 +137,19 @@ LocaleViewStep::onActivate()
 }
 
 
+void
+LocaleViewStep::onPrefetch()
+{
+    // The page (with the timezone map images) is the expensive part;
+    // the location is finalized in onActivate(), and the page follows it.
+    // Showing the page (and resizing the window for it) waits for onActivate() too.
+    if ( !m_actualWidget )
+    {
+        m_actualWidget = new LocalePage( m_config.get() );
+    }
+}
+
+
 void
 LocaleViewStep::onLeave()
 {
@@ -43,6 +43,7 @@ public:
     Calamares::JobList jobs() const override;
 
     void onActivate() override;
+    void onPrefetch() override;
     void onLeave() override;
 
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
@@ -37,6 +37,8 @@ private Q_SLOTS:
     void testTZImages();  // No overlaps in images
     void testTZLocations();  // No overlaps in locations
     void testSpecificLocations();
+    void testTZLabels();  // Label map matches the images
+    void benchmarkTZIndex();
 
     // Check the Config loading
     void testConfigInitialization();
@@ -178,6 +180,69 @@ LocaleTests::testTZImages()
     QCOMPARE( overlapcount, 0 );
 }
 
+void
+LocaleTests::testTZLabels()
+{
+    auto images = TimeZoneImageList::fromDirectory( SOURCE_DIR );
+    QCOMPARE( images.count(), images.zoneCount );
+    QVERIFY( !images.labels().isNull() );
+    QCOMPARE( images.labels().size(), images.imageSize );
+
+    // The shipped label map must say the same as looking
+    // through all the images (the old way of hit-testing).
+    QVector< QImage > zones;
+    for ( const auto& image : images )
+    {
+        zones.append( image.convertToFormat( QImage::Format_ARGB32 ) );
+    }
+    int claimed = 0;
+    for ( int y = 0; y < images.imageSize.height(); ++y )
+    {
+        for ( int x = 0; x < images.imageSize.width(); ++x )
+        {
+            const QPoint pos( x, y );
+            int expected = -1;
+            for ( int i = 0; i < zones.count(); ++i )
+            {
+                if ( zones.at( i ).pixel( pos ) != 0 )
+                {
+                    expected = i;
+                    break;
+                }
+            }
+            QCOMPARE( images.index( pos ), expected );
+            claimed += expected >= 0 ? 1 : 0;
+        }
+    }
+    QVERIFY( claimed > 0 );
+
+    // Out of bounds is unclaimed
+    QCOMPARE( images.index( QPoint( -1, 0 ) ), -1 );
+    QCOMPARE( images.index( QPoint( 0, images.imageSize.height() ) ), -1 );
+    QVERIFY( images.find( QPoint( images.imageSize.width(), 0 ) ).isNull() );
+}
+
+void
+LocaleTests::benchmarkTZIndex()
+{
+    const auto images = TimeZoneImageList::fromDirectory( SOURCE_DIR );
+    QCOMPARE( images.count(), images.zoneCount );
+
+    int found = 0;
+    QBENCHMARK
+    {
+        found = 0;
+        for ( int y = 0; y < images.imageSize.height(); y += 4 )
+        {
+            for ( int x = 0; x < images.imageSize.width(); x += 4 )
+            {
+                found += images.index( QPoint( x, y ) ) >= 0 ? 1 : 0;
+            }
+        }
+    }
+    QVERIFY( found > 0 );
+}
+
 bool
 operator<( const QPoint& l, const QPoint& r )
 {
@@ -24,6 +24,9 @@ static_assert( TimeZoneImageList::zoneCount == ( sizeof( zoneNames ) / sizeof( z
 
 #define ZONE_NAME QStringLiteral( "zone" )
 
+// Pixel value indicating that a spot is outside of a zone
+static constexpr const int RGB_TRANSPARENT = 0;
+
 static_assert( TimeZoneImageList::zoneCount == 37, "Incorrect number of zones" );
 
 TimeZoneImageList::TimeZoneImageList() {}
@@ -37,6 +40,7 @@ TimeZoneImageList::fromQRC()
         l.append( QImage( QStringLiteral( ":/images/timezone_" ) + zoneName + ".png" ) );
         l.last().setText( ZONE_NAME, zoneName );
     }
+    l.setLabels( QImage( QStringLiteral( ":/images/timezone_labels.png" ) ) );
 
     return l;
 }
@@ -57,10 +61,47 @@ TimeZoneImageList::fromDirectory( const QString& dirName )
         l.append( QImage( dir.filePath( QStringLiteral( "timezone_" ) + zoneName + ".png" ) ) );
         l.last().setText( ZONE_NAME, zoneName );
     }
+    l.setLabels( QImage( dir.filePath( QStringLiteral( "timezone_labels.png" ) ) ) );
 
     return l;
 }
 
+void
+TimeZoneImageList::setLabels( const QImage& labels )
+{
+    static_assert( zoneCount < noZone, "Zone indexes do not fit in the label map" );
+
+    if ( !labels.isNull() && labels.size() == imageSize )
+    {
+        m_labels = labels.convertToFormat( QImage::Format_Grayscale8 );
+        return;
+    }
+
+    cWarning() << "TimeZone label map is missing, computing it from the images.";
+    m_labels = QImage( imageSize, QImage::Format_Grayscale8 );
+    m_labels.fill( noZone );
+    for ( int i = 0; i < size(); ++i )
+    {
+        const QImage zone = at( i ).convertToFormat( QImage::Format_ARGB32 );
+        if ( zone.size() != imageSize )
+        {
+            continue;
+        }
+        for ( int y = 0; y < imageSize.height(); ++y )
+        {
+            const QRgb* zoneLine = reinterpret_cast< const QRgb* >( zone.constScanLine( y ) );
+            uchar* labelLine = m_labels.scanLine( y );
+            for ( int x = 0; x < imageSize.width(); ++x )
+            {
+                if ( labelLine[ x ] == noZone && zoneLine[ x ] != RGB_TRANSPARENT )
+                {
+                    labelLine[ x ] = uchar( i );
+                }
+            }
+        }
+    }
+}
+
 QPoint
 TimeZoneImageList::getLocationPosition( double longitude, double latitude )
 {
@@ -135,9 +176,6 @@ TimeZoneImageList::getLocationPosition( double longitude, double latitude )
     return QPoint( int( x ), int( y ) );
 }
 
-// Pixel value indicating that a spot is outside of a zone
-static constexpr const int RGB_TRANSPARENT = 0;
-
 int
 TimeZoneImageList::index( QPoint pos, int& count ) const
 {
@@ -175,17 +213,13 @@ TimeZoneImageList::index( QPoint pos, int& count ) const
 int
 TimeZoneImageList::index( QPoint pos ) const
 {
-    for ( int i = 0; i < size(); ++i )
+    if ( m_labels.isNull() || !m_labels.valid( pos ) )
     {
-        const QImage& zone = at( i );
-
-        // If not transparent set as current
-        if ( zone.pixel( pos ) != RGB_TRANSPARENT )
-        {
-            return i;
-        }
+        return -1;
     }
-    return -1;
+
+    const int label = m_labels.constScanLine( pos.y() )[ pos.x() ];
+    return ( label == noZone || label >= size() ) ? -1 : label;
 }
 
 QImage
@@ -19,6 +19,14 @@ using TimeZoneImage = QImage;
  *
  * There's one fixed list of timezone images that can be loaded
  * from the QRC, or from the source directory.
+ *
+ * Alongside the images, the list keeps a *label map*: a single
+ * 8-bit image of the same size where each pixel holds the index
+ * of the first zone image claiming that pixel. This makes
+ * hit-testing a single pixel lookup instead of a scan over all
+ * the images. The label map is generated from the images by
+ * `label-extractor.py` and shipped as `timezone_labels.png`;
+ * if it is missing or does not fit, it is computed at load time.
  */
 class TimeZoneImageList : public QList< TimeZoneImage >
 {
@@ -67,10 +75,25 @@ public:
      */
     QImage find( QPoint p ) const;
 
+    /// @brief The label map (see class description), may be null
+    const QImage& labels() const { return m_labels; }
+
     /// @brief The **expected** number of zones in the list.
     static constexpr const int zoneCount = 37;
     /// @brief The expected size of each zone image.
     static constexpr const QSize imageSize = QSize( 780, 340 );
+    /// @brief Value in the label map for pixels that no zone claims
+    static constexpr const uchar noZone = 255;
+
+private:
+    /** @brief Use @p labels as label map, or compute it from the images
+     *
+     * The label map is computed from the images if @p labels
+     * is null or has the wrong size.
+     */
+    void setLabels( const QImage& labels );
+
+    QImage m_labels;
 };
 
 #endif
@@ -0,0 +1,143 @@
+#! /usr/bin/env python3
+#
+#  === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+"""
+Python3 script to combine the timezone images into a label map.
+
+Run this in the locale module source directory, after changing
+any of the images/timezone_*.png files; it (over)writes
+images/timezone_labels.png . This script has no dependencies
+outside of the Python standard library.
+
+The label map is an 8-bit grayscale image the same size as the
+timezone images. Each pixel holds the index (in the list of zones,
+see zoneNames in TimeZoneImage.cpp) of the first timezone image
+that claims that pixel, or 255 if no image claims it. A pixel is
+claimed by an image if it is not fully zero (transparent black).
+"""
+
+import struct
+import sys
+import zlib
+
+# Must match zoneNames in TimeZoneImage.cpp
+zone_names = [
+    "0.0", "1.0", "2.0", "3.0", "3.5", "4.0", "4.5", "5.0", "5.5", "5.75", "6.0", "6.5", "7.0",
+    "8.0", "9.0", "9.5", "10.0", "10.5", "11.0", "12.0", "12.75", "13.0", "-1.0", "-2.0", "-3.0", "-3.5",
+    "-4.0", "-4.5", "-5.0", "-5.5", "-6.0", "-7.0", "-8.0", "-9.0", "-9.5", "-10.0", "-11.0" ]
+
+NO_ZONE = 255
+
+
+def read_chunks(data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("Not a PNG file")
+    offset = 8
+    while offset < len(data):
+        length, kind = struct.unpack(">I4s", data[offset:offset + 8])
+        yield kind, data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+
+
+def unfilter(raw, width, height, bpp):
+    """Undo the PNG scanline filters, returns a list of rows (bytearrays)."""
+    stride = width * bpp
+    rows = []
+    previous = bytearray(stride)
+    offset = 0
+    for _ in range(height):
+        filter_type = raw[offset]
+        line = bytearray(raw[offset + 1:offset + 1 + stride])
+        offset += 1 + stride
+        for i in range(stride):
+            left = line[i - bpp] if i >= bpp else 0
+            up = previous[i]
+            upleft = previous[i - bpp] if i >= bpp else 0
+            if filter_type == 1:
+                line[i] = (line[i] + left) & 0xff
+            elif filter_type == 2:
+                line[i] = (line[i] + up) & 0xff
+            elif filter_type == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xff
+            elif filter_type == 4:
+                p = left + up - upleft
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - upleft)
+                if pa <= pb and pa <= pc:
+                    predictor = left
+                elif pb <= pc:
+                    predictor = up
+                else:
+                    predictor = upleft
+                line[i] = (line[i] + predictor) & 0xff
+        rows.append(line)
+        previous = line
+    return rows
+
+
+def claimed_pixels(filename):
+    """
+    Returns (width, height, rows) where rows is a list of lists of
+    booleans, True where the image claims the pixel.
+    Handles only what the timezone images use: 8-bit RGBA and
+    8-bit palette (with optional transparency), non-interlaced.
+    """
+    with open(filename, "rb") as f:
+        data = f.read()
+    idat = b""
+    palette = []
+    alphas = b""
+    for kind, chunk in read_chunks(data):
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = [chunk[i:i + 3] for i in range(0, len(chunk), 3)]
+        elif kind == b"tRNS":
+            alphas = chunk
+        elif kind == b"IDAT":
+            idat += chunk
+    if depth != 8 or interlace != 0 or color_type not in (3, 6):
+        raise ValueError("Unsupported PNG format in {!s}".format(filename))
+
+    raw = zlib.decompress(idat)
+    if color_type == 6:
+        rows = unfilter(raw, width, height, 4)
+        return width, height, [[any(row[x * 4:x * 4 + 4]) for x in range(width)] for row in rows]
+    else:
+        # Palette: a pixel is claimed if the (A)RGB of its palette entry is non-zero
+        claims = []
+        for i, rgb in enumerate(palette):
+            alpha = alphas[i] if i < len(alphas) else 255
+            claims.append(bool(alpha) or any(rgb))
+        rows = unfilter(raw, width, height, 1)
+        return width, height, [[claims[v] for v in row] for row in rows]
+
+
+def write_grayscale_png(filename, width, height, rows):
+    def chunk(kind, payload):
+        return struct.pack(">I", len(payload)) + kind + payload + struct.pack(">I", zlib.crc32(kind + payload) & 0xffffffff)
+
+    raw = b"".join(b"\x00" + bytes(row) for row in rows)
+    with open(filename, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 0, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+if __name__ == "__main__":
+    labels = None
+    for index, name in enumerate(zone_names):
+        width, height, claims = claimed_pixels("images/timezone_{!s}.png".format(name))
+        if labels is None:
+            labels = [bytearray([NO_ZONE] * width) for _ in range(height)]
+        for y in range(height):
+            label_row = labels[y]
+            claim_row = claims[y]
+            for x in range(width):
+                if label_row[x] == NO_ZONE and claim_row[x]:
+                    label_row[x] = index
+    write_grayscale_png("images/timezone_labels.png", width, height, labels)
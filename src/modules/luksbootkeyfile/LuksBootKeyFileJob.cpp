@@ -9,6 +9,7 @@
 
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Entropy.h"
+#include "utils/Initramfs.h"
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
 #include "utils/UMask.h"
@@ -245,6 +246,8 @@ LuksBootKeyFileJob::exec()
                 tr( "Could not configure LUKS key file on partition %1." ).arg( d.device ) );
     }
 
+    // The keyfile goes into the initramfs
+    CalamaresUtils::Initramfs::setDirty( QStringLiteral( "LUKS keyfile" ) );
     return Calamares::JobResult::ok();
 }
 
@@ -140,6 +140,21 @@ MachineIdTests::testCopyFile()
         auto r2 = MachineId::copyFile( tempRoot.path(), tempISOdir.path() + '/' + sampleFile );
         QVERIFY( r2 );
     }
+
+    // Permissions are kept (the random seed is private)
+    const QString seed = tempISOdir.filePath( "random-seed" );
+    {
+        QFile f( seed );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( "0123456789abcdef" ), 16 );
+        QVERIFY( f.setPermissions( QFileDevice::ReadOwner | QFileDevice::WriteOwner ) );
+    }
+    auto r3 = MachineId::copyFile( tempRoot.path(), seed );
+    QVERIFY( r3 );
+    QFile copied( tempRoot.path() + seed );
+    QCOMPARE( copied.size(), 16 );
+    QVERIFY( copied.permissions() & QFileDevice::ReadOwner );
+    QVERIFY( !( copied.permissions() & ( QFileDevice::ReadGroup | QFileDevice::ReadOther ) ) );
 }
 
 void
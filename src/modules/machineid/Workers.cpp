@@ -14,6 +14,7 @@
 
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Entropy.h"
+#include "utils/FileCopy.h"
 #include "utils/Logger.h"
 
 #include <QFile>
@@ -66,13 +67,15 @@ copyFile( const QString& rootMountPoint, const QString& fileName )
             0 );
     }
 
-    QFile f( fileName );
-    if ( !f.exists() )
+    if ( !QFile::exists( fileName ) )
     {
         return Calamares::JobResult::error( QObject::tr( "File not found" ), fileName );
     }
-    if ( !f.copy( rootMountPoint + fileName ) )
+    // The random seed is only readable by root, keep it that way
+    const auto r = CalamaresUtils::copyFile( fileName, rootMountPoint + fileName, CalamaresUtils::PreserveAll );
+    if ( !r )
     {
+        cWarning() << r.errorString;
         return Calamares::JobResult::error( QObject::tr( "File not found" ), rootMountPoint + fileName );
     }
     return Calamares::JobResult::ok();
@@ -0,0 +1,165 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2014 Aurélien Gâteau <agateau@kde.org>
+ *   SPDX-FileCopyrightText: 2017 Alf Gaida <agaida@siduction.org>
+ *   SPDX-FileCopyrightText: 2019 Kevin Kofler <kevin.kofler@chello.at>
+ *   SPDX-FileCopyrightText: 2019-2020 Collabora Ltd
+ *   SPDX-FileCopyrightText: 2019-2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "MountJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "partition/Mount.h"
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+
+MountJob::MountJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+}
+
+MountJob::~MountJob() {}
+
+QString
+MountJob::prettyName() const
+{
+    return tr( "Mounting partitions." );
+}
+
+/** @brief The btrfs subvolumes to create for @p partitions
+ *
+ * Subvolumes for mount points that get a dedicated partition are
+ * left out. If there is no configuration, the layout from before
+ * configurability was introduced (/ and /home) is used.
+ */
+QVariantList
+MountJob::btrfsSubvolumes( const QVariantList& partitions ) const
+{
+    if ( !m_haveBtrfsSubvolumes )
+    {
+        cWarning() << "No configuration for btrfsSubvolumes";
+    }
+    QVariantList configured = m_btrfsSubvolumes;
+    if ( configured.isEmpty() )
+    {
+        configured = { QVariantMap { { "mountPoint", "/" }, { "subvolume", "/@" } },
+                       QVariantMap { { "mountPoint", "/home" }, { "subvolume", "/@home" } } };
+    }
+
+    QStringList partitionMounts;
+    for ( const auto& p : partitions )
+    {
+        const QString mountPoint = CalamaresUtils::getString( p.toMap(), "mountPoint" );
+        if ( !mountPoint.isEmpty() && mountPoint != QStringLiteral( "/" ) )
+        {
+            partitionMounts.append( mountPoint );
+        }
+    }
+
+    QVariantList subvolumes;
+    for ( const auto& s : qAsConst( configured ) )
+    {
+        if ( !partitionMounts.contains( CalamaresUtils::getString( s.toMap(), "mountPoint" ) ) )
+        {
+            subvolumes.append( s );
+        }
+    }
+
+    // If we have a swap **file**, give it a separate subvolume.
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    if ( gs->value( "partitionChoices" ).toMap().value( "swap" ).toString() == QStringLiteral( "file" ) )
+    {
+        subvolumes.append( QVariantMap { { "mountPoint", "/swap" }, { "subvolume", "/@swap" } } );
+    }
+    return subvolumes;
+}
+
+Calamares::JobResult
+MountJob::exec()
+{
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    const QVariantList partitions = gs->value( "partitions" ).toList();
+    if ( partitions.isEmpty() )
+    {
+        cWarning() << "No *partitions* defined.";
+        return Calamares::JobResult::internalError(
+            tr( "Configuration Error" ),
+            tr( "No partitions are defined for <pre>%1</pre> to use." ).arg( "mount" ),
+            Calamares::JobResult::InvalidConfiguration );
+    }
+
+    QTemporaryDir rootDir( QDir::tempPath() + QStringLiteral( "/calamares-root-XXXXXX" ) );
+    if ( !rootDir.isValid() )
+    {
+        return Calamares::JobResult::error( tr( "Could not create a directory to mount the target system in." ),
+                                            rootDir.errorString() );
+    }
+    rootDir.setAutoRemove( false );
+    const QString rootMountPoint = rootDir.path();
+
+    if ( m_extraMounts.isEmpty() && m_extraMountsEfi.isEmpty() )
+    {
+        cWarning() << "No extra mounts defined. Does mount.conf exist?";
+    }
+    QVariantList extraMounts = m_extraMounts;
+    if ( gs->value( "firmwareType" ).toString() == QStringLiteral( "efi" ) )
+    {
+        extraMounts.append( m_extraMountsEfi );
+    }
+
+    bool rootBtrfs = false;
+    for ( const auto& p : partitions )
+    {
+        const QVariantMap partition = p.toMap();
+        if ( CalamaresUtils::getString( partition, "mountPoint" ) == QStringLiteral( "/" ) )
+        {
+            rootBtrfs = CalamaresUtils::getString( partition, "fs" ).toLower() == QStringLiteral( "btrfs" );
+        }
+    }
+    const QVariantList subvolumes = rootBtrfs ? btrfsSubvolumes( partitions ) : QVariantList();
+
+    const CalamaresUtils::Partition::MountPlan plan( partitions + extraMounts, subvolumes );
+    QStringList failed;
+    const QString error = plan.execute( rootMountPoint, &failed );
+    if ( !error.isEmpty() )
+    {
+        cError() << error;
+        return Calamares::JobResult::error( tr( "Could not create btrfs subvolumes." ), error );
+    }
+    if ( !failed.isEmpty() )
+    {
+        // Not fatal, as before; later modules will complain if something is really missing
+        cWarning() << "Not mounted:" << failed;
+    }
+
+    // The fstab module needs the subvolumes that were created
+    if ( rootBtrfs )
+    {
+        gs->insert( "btrfsSubvolumes", subvolumes );
+    }
+    gs->insert( "rootMountPoint", rootMountPoint );
+    // Remember the extra mounts for the unpackfs module
+    gs->insert( "extraMounts", extraMounts );
+    return Calamares::JobResult::ok();
+}
+
+void
+MountJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    // Guard against missing keys (generally a sign that the config file is bad)
+    m_extraMounts = configurationMap.value( "extraMounts" ).toList();
+    m_extraMountsEfi = configurationMap.value( "extraMountsEfi" ).toList();
+    m_haveBtrfsSubvolumes = configurationMap.contains( "btrfsSubvolumes" );
+    m_btrfsSubvolumes = configurationMap.value( "btrfsSubvolumes" ).toList();
+}
+
+CALAMARES_PLUGIN_FACTORY_DEFINITION( MountJobFactory, registerPlugin< MountJob >(); )
@@ -0,0 +1,52 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef MOUNTJOB_H
+#define MOUNTJOB_H
+
+#include "CppJob.h"
+#include "DllMacro.h"
+#include "utils/PluginFactory.h"
+
+#include <QObject>
+#include <QVariantList>
+#include <QVariantMap>
+
+/** @brief Mounts the target system in a temporary directory
+ *
+ * The partitions from global storage are mounted, along with the
+ * configured extra mounts (e.g. /proc); the directory is stored
+ * in global storage as *rootMountPoint*.
+ */
+class PLUGINDLLEXPORT MountJob : public Calamares::CppJob
+{
+    Q_OBJECT
+
+public:
+    explicit MountJob( QObject* parent = nullptr );
+    ~MountJob() override;
+
+    QString prettyName() const override;
+
+    Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+private:
+    QVariantList btrfsSubvolumes( const QVariantList& partitions ) const;
+
+    QVariantList m_extraMounts;
+    QVariantList m_extraMountsEfi;
+    QVariantList m_btrfsSubvolumes;
+    bool m_haveBtrfsSubvolumes = false;
+};
+
+CALAMARES_PLUGIN_FACTORY_DECLARATION( MountJobFactory )
+
+#endif  // MOUNTJOB_H
@@ -13,6 +13,7 @@
 #include "Config.h"
 
 #include "LoaderQueue.h"
+#include "PackagePrefetch.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
@@ -27,6 +28,7 @@
 Config::Config( QObject* parent )
     : QObject( parent )
     , m_model( new PackageModel( this ) )
+    , m_prefetch( new PackagePrefetch( this ) )
 {
     CALAMARES_RETRANSLATE_SLOT( &Config::retranslate );
 }
@@ -133,6 +135,8 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
         m_titleLabel = new CalamaresUtils::Locale::TranslatedString( label, "title", className );
     }
 
+    m_prefetch->setConfigurationMap( CalamaresUtils::getSubMap( configurationMap, "prefetch", bogus ) );
+
     // Lastly, load the groups data
     const QString key = QStringLiteral( "groupsUrl" );
     const auto& groupsUrlVariant = configurationMap.value( key );
@@ -179,4 +183,7 @@ Config::finalizeGlobalStorage( const Calamares::ModuleSystem::InstanceKey& key )
 
     CalamaresUtils::Packages::setGSPackageAdditions(
         Calamares::JobQueue::instance()->globalStorage(), key, installPackages, tryInstallPackages );
+
+    // Start downloading now, rather than when the packages module runs
+    m_prefetch->start( PackagePrefetch::packageNames( installPackages + tryInstallPackages ) );
 }
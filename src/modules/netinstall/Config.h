@@ -23,6 +23,7 @@
 #include <memory>
 
 class LoaderQueue;
+class PackagePrefetch;
 
 class Config : public QObject
 {
@@ -94,6 +95,7 @@ private:
     CalamaresUtils::Locale::TranslatedString* m_titleLabel = nullptr;
     PackageModel* m_model = nullptr;
     LoaderQueue* m_queue = nullptr;
+    PackagePrefetch* m_prefetch = nullptr;
     Status m_status = Status::Ok;
     bool m_required = false;
 };
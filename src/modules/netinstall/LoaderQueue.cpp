@@ -12,12 +12,10 @@
 #include "LoaderQueue.h"
 
 #include "Config.h"
-#include "network/Manager.h"
 #include "utils/Logger.h"
 #include "utils/RAII.h"
 #include "utils/Yaml.h"
 
-#include <QNetworkReply>
 #include <QTimer>
 
 /** @brief Call fetchNext() on the queue if it can
@@ -129,24 +127,18 @@ LoaderQueue::fetch( const QUrl& url )
     using namespace CalamaresUtils::Network;
 
     cDebug() << "NetInstall loading groups from" << url;
-    QNetworkReply* reply = Manager::instance().asynchronousGet(
-        url,
-        RequestOptions( RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect, std::chrono::seconds( 30 ) ) );
 
-    if ( !reply )
-    {
-        cDebug() << Logger::SubEntry << "Request failed immediately.";
-        // If nobody sets a different status, this will remain
-        m_config->setStatus( Config::Status::FailedBadConfiguration );
-    }
-    else
-    {
-        // When the network request is done, **then** we might
-        // do the next item from the queue, so don't call fetchNext() now.
-        next.release();
-        m_reply = reply;
-        connect( reply, &QNetworkReply::finished, this, &LoaderQueue::dataArrived );
-    }
+    // When the network request is done, **then** we might
+    // do the next item from the queue, so don't call fetchNext() now.
+    next.release();
+    m_url = url;
+    m_watcher = new QFutureWatcher< Response >( this );
+    connect( m_watcher, &QFutureWatcherBase::finished, this, &LoaderQueue::dataArrived );
+    // Through the cache, so a restarted Calamares doesn't download the groups again
+    m_watcher->setFuture( Manager::instance().asynchronousRequest(
+        url,
+        RequestOptions(
+            RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect, std::chrono::seconds( 30 ), 2 ) ) );
 }
 
 void
@@ -154,30 +146,36 @@ LoaderQueue::dataArrived()
 {
     FetchNextUnless next( this );
 
-    if ( !m_reply || !m_reply->isFinished() )
+    if ( !m_watcher || !m_watcher->isFinished() )
     {
         cWarning() << "NetInstall data called too early.";
         m_config->setStatus( Config::Status::FailedInternalError );
         return;
     }
 
-    cDebug() << "NetInstall group data received" << m_reply->size() << "bytes from" << m_reply->url();
+    using CalamaresUtils::Network::RequestStatus;
+    using CalamaresUtils::Network::Response;
 
-    cqDeleter< QNetworkReply > d { m_reply };
+    cqDeleter< QFutureWatcher< Response > > d { m_watcher };
+    const Response response = m_watcher->result();
 
     // If m_required is *false* then we still say we're ready
     // even if the reply is corrupt or missing.
-    if ( m_reply->error() != QNetworkReply::NoError )
+    if ( !response.status )
     {
         cWarning() << "unable to fetch netinstall package lists.";
-        cDebug() << Logger::SubEntry << "Netinstall reply error: " << m_reply->error();
-        cDebug() << Logger::SubEntry << "Request for url: " << m_reply->url().toString()
-                 << " failed with: " << m_reply->errorString();
-        m_config->setStatus( Config::Status::FailedNetworkError );
+        cDebug() << Logger::SubEntry << "Request for url: " << m_url.toString() << " failed with: " << response.status
+                 << "HTTP status" << response.httpStatus;
+        // A request that can't even be made is a problem with the URL
+        m_config->setStatus( response.status.status == RequestStatus::Failed ? Config::Status::FailedBadConfiguration
+                                                                              : Config::Status::FailedNetworkError );
         return;
     }
 
-    QByteArray yamlData = m_reply->readAll();
+    cDebug() << "NetInstall group data received" << response.data.size() << "bytes from" << m_url
+             << ( response.fromCache ? "(cached)" : "" );
+
+    const QByteArray& yamlData = response.data;
     try
     {
         YAML::Node groups = YAML::Load( yamlData.constData() );
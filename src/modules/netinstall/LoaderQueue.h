@@ -12,12 +12,14 @@
 #ifndef NETINSTALL_LOADERQUEUE_H
 #define NETINSTALL_LOADERQUEUE_H
 
+#include "network/Manager.h"
+
+#include <QFutureWatcher>
 #include <QQueue>
 #include <QUrl>
 #include <QVariantList>
 
 class Config;
-class QNetworkReply;
 
 /** @brief Data about an entry in *groupsUrl*
  *
@@ -71,7 +73,8 @@ Q_SIGNALS:
 private:
     QQueue< SourceItem > m_queue;
     Config* m_config = nullptr;
-    QNetworkReply* m_reply = nullptr;
+    QUrl m_url;
+    QFutureWatcher< CalamaresUtils::Network::Response >* m_watcher = nullptr;
 };
 
 #endif
@@ -22,6 +22,8 @@ PackageModel::PackageModel( QObject* parent )
 PackageModel::~PackageModel()
 {
     delete m_rootItem;
+    // Hidden items are not children of any item in the tree
+    qDeleteAll( m_hiddenItems );
 }
 
 QModelIndex
@@ -178,6 +180,11 @@ PackageModel::getPackages() const
         return PackageTreeItem::List();
     }
 
+    if ( m_selectedValid && m_selectedSerial == m_rootItem->selectionSerial() )
+    {
+        return m_selectedPackages;
+    }
+
     auto items = getItemPackages( m_rootItem );
     for ( auto package : m_hiddenItems )
     {
@@ -186,6 +193,9 @@ PackageModel::getPackages() const
             items.append( getItemPackages( package ) );
         }
     }
+    m_selectedPackages = items;
+    m_selectedSerial = m_rootItem->selectionSerial();
+    m_selectedValid = true;
     return items;
 }
 
@@ -305,6 +315,10 @@ PackageModel::setupModelData( const QVariantList& l )
 {
     emit beginResetModel();
     delete m_rootItem;
+    qDeleteAll( m_hiddenItems );
+    m_hiddenItems.clear();
+    m_selectedPackages.clear();
+    m_selectedValid = false;
     m_rootItem = new PackageTreeItem();
     setupModelData( l, m_rootItem );
     emit endResetModel();
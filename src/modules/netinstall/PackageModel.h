@@ -54,6 +54,11 @@ public:
     int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
     int columnCount( const QModelIndex& parent = QModelIndex() ) const override;
 
+    /** @brief All the selected packages
+     *
+     * The list is cached, and re-computed only when the selection
+     * in the tree has changed since the last call.
+     */
     PackageTreeItem::List getPackages() const;
     PackageTreeItem::List getItemPackages( PackageTreeItem* item ) const;
 
@@ -64,6 +69,11 @@ private:
 
     PackageTreeItem* m_rootItem = nullptr;
     PackageTreeItem::List m_hiddenItems;
+
+    // Cache for getPackages(), valid while the serial matches the root's
+    mutable PackageTreeItem::List m_selectedPackages;
+    mutable quint64 m_selectedSerial = 0;
+    mutable bool m_selectedValid = false;
 };
 
 #endif  // PACKAGEMODEL_H
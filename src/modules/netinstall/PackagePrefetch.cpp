@@ -0,0 +1,177 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PackagePrefetch.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QDir>
+
+static const char PACKAGECACHE[] = "packageCache";
+
+PackagePrefetch::PackagePrefetch( QObject* parent )
+    : QObject( parent )
+{
+}
+
+PackagePrefetch::~PackagePrefetch()
+{
+    if ( m_process )
+    {
+        m_process->disconnect( this );
+        m_process->kill();
+        m_process->waitForFinished( 1000 );
+    }
+}
+
+void
+PackagePrefetch::setConfigurationMap( const QVariantMap& prefetch )
+{
+    m_command = CalamaresUtils::getStringList( prefetch, "command" );
+    m_cacheDirectory = CalamaresUtils::getString( prefetch, "cache", QStringLiteral( "/var/cache/calamares/packages" ) );
+    if ( isEnabled() )
+    {
+        cDebug() << "Netinstall packages are prefetched into" << m_cacheDirectory << "with" << m_command.first();
+    }
+}
+
+QStringList
+PackagePrefetch::command( const QStringList& packages ) const
+{
+    QStringList args;
+    for ( const auto& arg : m_command )
+    {
+        QString a( arg );
+        args << a.replace( QStringLiteral( "${CACHE}" ), m_cacheDirectory );
+    }
+    return args + packages;
+}
+
+QStringList
+PackagePrefetch::packageNames( const QVariantList& operations )
+{
+    QStringList names;
+    for ( const auto& op : operations )
+    {
+        if ( op.type() == QVariant::String )
+        {
+            names << op.toString();
+        }
+        else
+        {
+            const QString name = op.toMap().value( "package" ).toString();
+            if ( !name.isEmpty() )
+            {
+                names << name;
+            }
+        }
+    }
+    return names;
+}
+
+void
+PackagePrefetch::updateGlobalStorage( bool done, bool ok ) const
+{
+    auto* jobQueue = Calamares::JobQueue::instance();
+    Calamares::GlobalStorage* gs = jobQueue ? jobQueue->globalStorage() : nullptr;
+    if ( !gs )
+    {
+        return;
+    }
+    if ( m_packages.isEmpty() )
+    {
+        gs->remove( PACKAGECACHE );
+        return;
+    }
+    gs->insert( PACKAGECACHE,
+                QVariantMap { { "directory", m_cacheDirectory },
+                              { "packages", m_packages },
+                              { "done", done },
+                              { "ok", ok } } );
+}
+
+void
+PackagePrefetch::start( const QStringList& packages )
+{
+    if ( !isEnabled() || packages == m_packages )
+    {
+        return;
+    }
+
+    if ( m_process )
+    {
+        cDebug() << "Package selection changed, restarting prefetch.";
+        m_process->disconnect( this );
+        m_process->kill();
+        m_process->waitForFinished( 1000 );
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+
+    m_packages = packages;
+    if ( !packages.isEmpty() && !QDir().mkpath( m_cacheDirectory ) )
+    {
+        cWarning() << "Could not create package cache" << m_cacheDirectory;
+        m_packages.clear();
+    }
+    if ( m_packages.isEmpty() )
+    {
+        // Removes the key, there is nothing to wait for
+        updateGlobalStorage( true, true );
+        return;
+    }
+
+    const QStringList args = command( packages );
+    m_process = new QProcess( this );
+    m_process->setProgram( args.first() );
+    m_process->setArguments( args.mid( 1 ) );
+    m_process->setProcessChannelMode( QProcess::MergedChannels );
+    m_process->setStandardInputFile( QProcess::nullDevice() );
+    connect( m_process,
+             QOverload< int, QProcess::ExitStatus >::of( &QProcess::finished ),
+             this,
+             &PackagePrefetch::processFinished );
+    connect( m_process, &QProcess::errorOccurred, this, [this]( QProcess::ProcessError e ) {
+        if ( e == QProcess::FailedToStart )
+        {
+            processFinished( -1, QProcess::CrashExit );
+        }
+    } );
+
+    updateGlobalStorage( false, false );
+    cDebug() << "Prefetching" << packages.count() << "packages into" << m_cacheDirectory;
+    m_process->start();
+}
+
+void
+PackagePrefetch::processFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+    if ( !m_process )
+    {
+        return;
+    }
+    const bool ok = exitStatus == QProcess::NormalExit && exitCode == 0;
+    if ( ok )
+    {
+        cDebug() << "Prefetched" << m_packages.count() << "packages.";
+    }
+    else
+    {
+        // Not fatal: the packages module downloads whatever is missing
+        cWarning() << "Prefetching packages failed" << exitCode << m_process->errorString();
+        cDebug() << Logger::NoQuote << m_process->readAll();
+    }
+    m_process->deleteLater();
+    m_process = nullptr;
+    updateGlobalStorage( true, ok );
+    emit finished( ok );
+}
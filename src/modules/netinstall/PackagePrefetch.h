@@ -0,0 +1,75 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef NETINSTALL_PACKAGEPREFETCH_H
+#define NETINSTALL_PACKAGEPREFETCH_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QVariantMap>
+
+/** @brief Downloads selected packages in the background
+ *
+ * Once the user has picked packages, they can be downloaded into a
+ * cache directory on the host (live) system while the user is still
+ * busy with the rest of the installer, and while the exec phase
+ * unpacks the base system. The *packages* module then installs
+ * from that cache instead of downloading everything itself.
+ *
+ * Downloading is done by the distro's package manager in download-only
+ * mode, with a configured command. Global storage key *packageCache*
+ * tells the *packages* module where the cache is and whether the
+ * download is finished.
+ */
+class PackagePrefetch : public QObject
+{
+    Q_OBJECT
+
+public:
+    PackagePrefetch( QObject* parent = nullptr );
+    ~PackagePrefetch() override;
+
+    /** @brief Configure from the *prefetch* map in the module configuration
+     *
+     * Prefetching is enabled if there is a non-empty *command*.
+     */
+    void setConfigurationMap( const QVariantMap& prefetch );
+
+    bool isEnabled() const { return !m_command.isEmpty(); }
+    QString cacheDirectory() const { return m_cacheDirectory; }
+    /// @brief The command that prefetches @p packages (with the cache directory filled in)
+    QStringList command( const QStringList& packages ) const;
+
+    /** @brief Start downloading @p packages
+     *
+     * If a download is already running for a different set of packages,
+     * it is stopped and the download starts again (with the cache,
+     * downloads that have already completed won't be repeated).
+     * Starting again with the same packages does nothing.
+     */
+    void start( const QStringList& packages );
+
+    /// @brief The package names (no package-data maps) from an operations-list
+    static QStringList packageNames( const QVariantList& operations );
+
+Q_SIGNALS:
+    void finished( bool ok );
+
+private:
+    void processFinished( int exitCode, QProcess::ExitStatus exitStatus );
+    void updateGlobalStorage( bool done, bool ok ) const;
+
+    QStringList m_command;
+    QString m_cacheDirectory;
+    QStringList m_packages;
+    QProcess* m_process = nullptr;
+};
+
+#endif
@@ -94,7 +94,9 @@ PackageTreeItem::~PackageTreeItem()
 void
 PackageTreeItem::appendChild( PackageTreeItem* child )
 {
+    child->m_row = m_childItems.count();
     m_childItems.append( child );
+    countChild( child->isSelected(), 1 );
 }
 
 PackageTreeItem*
@@ -112,11 +114,7 @@ PackageTreeItem::childCount() const
 int
 PackageTreeItem::row() const
 {
-    if ( m_parentItem )
-    {
-        return m_parentItem->m_childItems.indexOf( const_cast< PackageTreeItem* >( this ) );
-    }
-    return 0;
+    return m_parentItem ? m_row : 0;
 }
 
 QVariant
@@ -177,75 +175,133 @@ PackageTreeItem::hiddenSelected() const
 
 
 void
-PackageTreeItem::setSelected( Qt::CheckState isSelected )
+PackageTreeItem::countChild( Qt::CheckState state, int delta )
 {
-    if ( parentItem() == nullptr )
+    switch ( state )
     {
-        // This is the root, it is always checked so don't change state
-        return;
+    case Qt::Checked:
+        m_checkedChildren += delta;
+        break;
+    case Qt::PartiallyChecked:
+        m_partialChildren += delta;
+        break;
+    case Qt::Unchecked:
+        break;
     }
+}
 
-    m_selected = isSelected;
-    setChildrenSelected( isSelected );
-
-    // Look for suitable parent item which may change checked-state
-    // when one of its children changes.
-    PackageTreeItem* currentItem = parentItem();
-    while ( ( currentItem != nullptr ) && ( currentItem->childCount() == 0 ) )
+void
+PackageTreeItem::changeState( Qt::CheckState isSelected )
+{
+    if ( m_selected == isSelected )
     {
-        currentItem = currentItem->parentItem();
+        return;
     }
-    if ( currentItem == nullptr )
+    // Only items that are actually in the parent's list of children
+    // are counted there; hidden items are not.
+    if ( m_parentItem && m_row >= 0 )
     {
-        // Reached the root .. don't bother
-        return;
+        m_parentItem->countChild( m_selected, -1 );
+        m_parentItem->countChild( isSelected, 1 );
     }
-
-    currentItem->updateSelected();
+    m_selected = isSelected;
 }
 
 void
-PackageTreeItem::updateSelected()
+PackageTreeItem::touchSelection()
 {
-    // Figure out checked-state based on the children
-    int childrenSelected = 0;
-    int childrenPartiallySelected = 0;
-    for ( int i = 0; i < childCount(); i++ )
+    PackageTreeItem* top = this;
+    while ( top->m_parentItem )
     {
-        if ( child( i )->isSelected() == Qt::Checked )
-        {
-            childrenSelected++;
-        }
-        if ( child( i )->isSelected() == Qt::PartiallyChecked )
-        {
-            childrenPartiallySelected++;
-        }
+        top = top->m_parentItem;
     }
-    if ( !childrenSelected && !childrenPartiallySelected )
+    top->m_selectionSerial++;
+}
+
+quint64
+PackageTreeItem::selectionSerial() const
+{
+    const PackageTreeItem* top = this;
+    while ( top->m_parentItem )
     {
-        setSelected( Qt::Unchecked );
+        top = top->m_parentItem;
     }
-    else if ( childrenSelected == childCount() )
+    return top->m_selectionSerial;
+}
+
+Qt::CheckState
+PackageTreeItem::childrenCheckState() const
+{
+    if ( !m_checkedChildren && !m_partialChildren )
     {
-        setSelected( Qt::Checked );
+        return Qt::Unchecked;
+    }
+    else if ( m_checkedChildren == childCount() )
+    {
+        return Qt::Checked;
     }
     else
     {
-        setSelected( Qt::PartiallyChecked );
+        return Qt::PartiallyChecked;
     }
 }
 
+void
+PackageTreeItem::setSelected( Qt::CheckState isSelected )
+{
+    if ( parentItem() == nullptr )
+    {
+        // This is the root, it is always checked so don't change state
+        return;
+    }
+
+    setChildrenSelected( isSelected );
+    changeState( isSelected );
+
+    // Walk up the tree, updating the state of each parent from its
+    // counters; stop as soon as a parent doesn't change, since
+    // nothing above it will change either. The root is never changed.
+    PackageTreeItem* currentItem = this;
+    while ( currentItem->m_row >= 0 )
+    {
+        PackageTreeItem* parent = currentItem->parentItem();
+        if ( !parent || !parent->parentItem() )
+        {
+            break;
+        }
+        const auto state = parent->childrenCheckState();
+        if ( state == parent->isSelected() )
+        {
+            break;
+        }
+        parent->changeState( state );
+        currentItem = parent;
+    }
+    touchSelection();
+}
+
+void
+PackageTreeItem::updateSelected()
+{
+    // Figure out checked-state based on the children
+    setSelected( childrenCheckState() );
+}
+
 
 void
 PackageTreeItem::setChildrenSelected( Qt::CheckState isSelected )
 {
     if ( isSelected != Qt::PartiallyChecked )
+    {
         // Children are never root; don't need to use setSelected on them.
         for ( auto child : m_childItems )
         {
             child->m_selected = isSelected;
             child->setChildrenSelected( isSelected );
         }
+        m_checkedChildren = isSelected == Qt::Checked ? m_childItems.count() : 0;
+        m_partialChildren = 0;
+    }
 }
 
 int
@@ -41,10 +41,22 @@ public:
     explicit PackageTreeItem();
     ~PackageTreeItem() override;
 
+    /** @brief Adds @p child as the last child of this item
+     *
+     * The child's selected state is accounted for in this item's
+     * child-state counters, but this item's own state is **not**
+     * changed: call updateSelected() once all the children are added.
+     */
     void appendChild( PackageTreeItem* child );
     PackageTreeItem* child( int row );
     int childCount() const;
     QVariant data( int column ) const override;
+    /** @brief Row of this item in its parent
+     *
+     * This is a stored index, not a search, so it is constant-time.
+     * Items that have a parent, but were not appended to it (e.g.
+     * hidden groups) return -1. Parentless items return 0.
+     */
     int row() const;
 
     PackageTreeItem* parentItem();
@@ -131,6 +143,15 @@ public:
      */
     void updateSelected();
 
+    /** @brief Serial number of the selection state of the tree
+     *
+     * Any change in selected-ness anywhere in the tree that this
+     * item belongs to, bumps the serial number of the top-most
+     * item (the root). Models can use this to cache information
+     * derived from the selection.
+     */
+    quint64 selectionSerial() const;
+
     // QStandardItem methods
     int type() const override;
 
@@ -145,8 +166,25 @@ public:
     bool operator!=( const PackageTreeItem& rhs ) const { return !( *this == rhs ); }
 
 private:
+    /// @brief Selected-state derived from the child-state counters
+    Qt::CheckState childrenCheckState() const;
+    /// @brief Sets state, keeping the parent's counters up-to-date
+    void changeState( Qt::CheckState isSelected );
+    /// @brief Add @p delta to the counter for @p state
+    void countChild( Qt::CheckState state, int delta );
+    /// @brief Bump the selection serial of the root
+    void touchSelection();
+
     PackageTreeItem* m_parentItem;
     List m_childItems;
+    int m_row = -1;  ///< Index in m_parentItem's children, or -1
+
+    // Number of children (direct children only) that are checked
+    // or partially checked; unchecked is the remainder.
+    int m_checkedChildren = 0;
+    int m_partialChildren = 0;
+    // Only meaningful for the root (top-most) item
+    quint64 m_selectionSerial = 0;
 
     // An entry can be a package, or a group.
     QString m_name;
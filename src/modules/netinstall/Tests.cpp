@@ -9,6 +9,7 @@
 
 #include "Config.h"
 #include "PackageModel.h"
+#include "PackagePrefetch.h"
 #include "PackageTreeItem.h"
 
 #include "utils/Logger.h"
@@ -18,6 +19,7 @@
 
 #include <KMacroExpander>
 
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 class ItemTests : public QObject
@@ -47,6 +49,12 @@ private Q_SLOTS:
 
     void testUrlFallback_data();
     void testUrlFallback();
+
+    void testLargeModel();
+    void benchmarkLoadLargeModel();
+    void benchmarkToggleLargeModel();
+
+    void testPrefetch();
 };
 
 ItemTests::ItemTests() {}
@@ -421,6 +429,193 @@ ItemTests::testUrlFallback()
 }
 
 
+/** @brief Synthetic netinstall data, @p groups groups of @p packages each
+ *
+ * Even-numbered groups are selected, odd-numbered ones are not.
+ * Each group has one subgroup with a handful of packages, too.
+ */
+static QVariantList
+largeGroupList( int groups, int packages )
+{
+    QVariantList groupList;
+    for ( int g = 0; g < groups; ++g )
+    {
+        QVariantList packageList;
+        for ( int p = 0; p < packages; ++p )
+        {
+            packageList.append( QStringLiteral( "package-%1-%2" ).arg( g ).arg( p ) );
+        }
+        QVariantList subPackageList;
+        for ( int p = 0; p < 4; ++p )
+        {
+            subPackageList.append( QStringLiteral( "subpackage-%1-%2" ).arg( g ).arg( p ) );
+        }
+
+        QVariantMap subgroup;
+        subgroup.insert( "name", QStringLiteral( "Subgroup %1" ).arg( g ) );
+        subgroup.insert( "description", QStringLiteral( "Subgroup" ) );
+        subgroup.insert( "selected", g % 2 == 0 );
+        subgroup.insert( "packages", subPackageList );
+
+        QVariantMap group;
+        group.insert( "name", QStringLiteral( "Group %1" ).arg( g ) );
+        group.insert( "description", QStringLiteral( "Group" ) );
+        group.insert( "selected", g % 2 == 0 );
+        group.insert( "packages", packageList );
+        group.insert( "subgroups", QVariantList { subgroup } );
+        groupList.append( group );
+    }
+    return groupList;
+}
+
+void
+ItemTests::testLargeModel()
+{
+    static constexpr const int groups = 20;
+    static constexpr const int packages = 1000;
+
+    PackageModel m( nullptr );
+    m.setupModelData( largeGroupList( groups, packages ) );
+
+    QCOMPARE( m.rowCount(), groups );
+    // Half the groups are selected, with all their packages
+    QCOMPARE( m.getPackages().count(), ( groups / 2 ) * ( packages + 4 ) );
+
+    // Rows are stored, check they match the actual position
+    for ( int g = 0; g < groups; ++g )
+    {
+        QModelIndex groupIndex = m.index( g, 0 );
+        QCOMPARE( m.rowCount( groupIndex ), packages + 1 );
+        for ( int p : { 0, 1, packages / 2, packages } )
+        {
+            QModelIndex packageIndex = m.index( p, 0, groupIndex );
+            QCOMPARE( m.parent( packageIndex ), groupIndex );
+            auto* item = static_cast< PackageTreeItem* >( packageIndex.internalPointer() );
+            QCOMPARE( item->row(), p );
+        }
+    }
+
+    // Un-check one package in a selected group, that makes it partial
+    QModelIndex group0 = m.index( 0, 0 );
+    QCOMPARE( m.data( group0, Qt::CheckStateRole ).toInt(), int( Qt::Checked ) );
+    QVERIFY( m.setData( m.index( 7, 0, group0 ), Qt::Unchecked, Qt::CheckStateRole ) );
+    QCOMPARE( m.data( group0, Qt::CheckStateRole ).toInt(), int( Qt::PartiallyChecked ) );
+    QCOMPARE( m.getPackages().count(), ( groups / 2 ) * ( packages + 4 ) - 1 );
+    // .. and checking it again restores the group
+    QVERIFY( m.setData( m.index( 7, 0, group0 ), Qt::Checked, Qt::CheckStateRole ) );
+    QCOMPARE( m.data( group0, Qt::CheckStateRole ).toInt(), int( Qt::Checked ) );
+
+    // Check one package in an unselected group, that makes it partial
+    QModelIndex group1 = m.index( 1, 0 );
+    QCOMPARE( m.data( group1, Qt::CheckStateRole ).toInt(), int( Qt::Unchecked ) );
+    QVERIFY( m.setData( m.index( 3, 0, group1 ), Qt::Checked, Qt::CheckStateRole ) );
+    QCOMPARE( m.data( group1, Qt::CheckStateRole ).toInt(), int( Qt::PartiallyChecked ) );
+    QCOMPARE( m.getPackages().count(), ( groups / 2 ) * ( packages + 4 ) + 1 );
+
+    // Selecting the subgroup's packages one-by-one checks the subgroup
+    QModelIndex subgroup1 = m.index( packages, 0, group1 );
+    QCOMPARE( m.data( subgroup1, Qt::CheckStateRole ).toInt(), int( Qt::Unchecked ) );
+    for ( int p = 0; p < 4; ++p )
+    {
+        QVERIFY( m.setData( m.index( p, 0, subgroup1 ), Qt::Checked, Qt::CheckStateRole ) );
+    }
+    QCOMPARE( m.data( subgroup1, Qt::CheckStateRole ).toInt(), int( Qt::Checked ) );
+    QCOMPARE( m.data( group1, Qt::CheckStateRole ).toInt(), int( Qt::PartiallyChecked ) );
+
+    // Un-checking the group un-checks everything in it
+    QVERIFY( m.setData( group1, Qt::Unchecked, Qt::CheckStateRole ) );
+    QCOMPARE( m.data( subgroup1, Qt::CheckStateRole ).toInt(), int( Qt::Unchecked ) );
+    QCOMPARE( m.getPackages().count(), ( groups / 2 ) * ( packages + 4 ) );
+}
+
+void
+ItemTests::benchmarkLoadLargeModel()
+{
+    const auto groupList = largeGroupList( 20, 1000 );
+    QBENCHMARK
+    {
+        PackageModel m( nullptr );
+        m.setupModelData( groupList );
+        QCOMPARE( m.rowCount(), 20 );
+    }
+}
+
+void
+ItemTests::benchmarkToggleLargeModel()
+{
+    PackageModel m( nullptr );
+    m.setupModelData( largeGroupList( 20, 1000 ) );
+
+    // Toggle every package in the first group off and back on,
+    // asking for the parent (the way views do) and the selection.
+    QModelIndex group0 = m.index( 0, 0 );
+    QBENCHMARK
+    {
+        for ( int p = 0; p < 1000; ++p )
+        {
+            QModelIndex packageIndex = m.index( p, 0, group0 );
+            m.setData( packageIndex, Qt::Unchecked, Qt::CheckStateRole );
+            QCOMPARE( m.parent( packageIndex ), group0 );
+        }
+        QCOMPARE( m.data( group0, Qt::CheckStateRole ).toInt(), int( Qt::PartiallyChecked ) );
+        for ( int p = 0; p < 1000; ++p )
+        {
+            m.setData( m.index( p, 0, group0 ), Qt::Checked, Qt::CheckStateRole );
+        }
+        QCOMPARE( m.data( group0, Qt::CheckStateRole ).toInt(), int( Qt::Checked ) );
+        QCOMPARE( m.getPackages().count(), 10 * 1004 );
+        QCOMPARE( m.getPackages().count(), 10 * 1004 );  // Cached
+    }
+}
+
+void
+ItemTests::testPrefetch()
+{
+    QTemporaryDir tempRoot( QDir::tempPath() + QStringLiteral( "/test-netinstall-XXXXXX" ) );
+    QVERIFY( tempRoot.isValid() );
+    const QString cache = tempRoot.filePath( "cache/pkg" );
+
+    const QVariantList operations { QStringLiteral( "vi" ),
+                                    QVariantMap { { "package", "wget" }, { "pre-script", "true" } },
+                                    QVariantMap { { "pre-script", "no package here" } },
+                                    QStringLiteral( "binutils" ) };
+    QCOMPARE( PackagePrefetch::packageNames( operations ), QStringList( { "vi", "wget", "binutils" } ) );
+
+    PackagePrefetch prefetch;
+    QVERIFY( !prefetch.isEnabled() );
+    prefetch.start( { "vi" } );  // Does nothing
+
+    // The "download" writes the package names to a file in the cache
+    prefetch.setConfigurationMap(
+        { { "cache", cache }, { "command", QStringList { "sh", "-c", "echo \"$@\" > ${CACHE}/list", "sh" } } } );
+    QVERIFY( prefetch.isEnabled() );
+    QCOMPARE( prefetch.cacheDirectory(), cache );
+    QCOMPARE( prefetch.command( { "vi" } ),
+              QStringList( { "sh", "-c", QStringLiteral( "echo \"$@\" > %1/list" ).arg( cache ), "sh", "vi" } ) );
+
+    QSignalSpy finished( &prefetch, &PackagePrefetch::finished );
+    prefetch.start( { "vi", "wget" } );
+    QVERIFY( finished.wait( 5000 ) );
+    QCOMPARE( finished.count(), 1 );
+    QCOMPARE( finished.first().first().toBool(), true );
+
+    QFile list( cache + QStringLiteral( "/list" ) );
+    QVERIFY( list.open( QIODevice::ReadOnly ) );
+    QCOMPARE( QString::fromUtf8( list.readAll() ).trimmed(), QStringLiteral( "vi wget" ) );
+
+    // Same selection again does not download again
+    prefetch.start( { "vi", "wget" } );
+    QVERIFY( !finished.wait( 200 ) );
+
+    // A failing download is reported, but that's all
+    prefetch.setConfigurationMap( { { "cache", cache }, { "command", QStringList { "false" } } } );
+    prefetch.start( { "vi" } );
+    QVERIFY( finished.wait( 5000 ) );
+    QCOMPARE( finished.count(), 2 );
+    QCOMPARE( finished.last().first().toBool(), false );
+}
+
+
 QTEST_GUILESS_MAIN( ItemTests )
 
 #include "utils/moc-warnings.h"
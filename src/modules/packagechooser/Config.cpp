@@ -10,20 +10,12 @@
 
 #include "Config.h"
 
-#ifdef HAVE_APPDATA
-#include "ItemAppData.h"
-#endif
-
-#ifdef HAVE_APPSTREAM
-#include "ItemAppStream.h"
-#include <AppStreamQt/pool.h>
-#include <memory>
-#endif
-
+#include "ItemLoader.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "packages/Globals.h"
+#include "utils/Dirs.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
@@ -177,63 +169,24 @@ Config::prettyStatus() const
     return tr( "Install option: <strong>%1</strong>" ).arg( m_packageChoice.value_or( tr( "None" ) ) );
 }
 
-static void
-fillModel( PackageListModel* model, const QVariantList& items )
+void
+Config::findDefaultItem( int first, int last )
 {
-    if ( items.isEmpty() )
+    if ( m_defaultItemId.isEmpty() || m_defaultModelIndex.isValid() )
     {
-        cWarning() << "No *items* for PackageChooser module.";
         return;
     }
-
-#ifdef HAVE_APPSTREAM
-    std::unique_ptr< AppStream::Pool > pool;
-    bool poolOk = false;
-#endif
-
-    cDebug() << "Loading PackageChooser model items from config";
-    int item_index = 0;
-    for ( const auto& item_it : items )
+    for ( int item_n = first; item_n <= last; ++item_n )
     {
-        ++item_index;
-        QVariantMap item_map = item_it.toMap();
-        if ( item_map.isEmpty() )
-        {
-            cWarning() << "PackageChooser entry" << item_index << "is not valid.";
-            continue;
-        }
+        QModelIndex item_idx = m_model->index( item_n, 0 );
+        QVariant item_id = m_model->data( item_idx, PackageListModel::IdRole );
 
-        if ( item_map.contains( "appdata" ) )
-        {
-#ifdef HAVE_XML
-            model->addPackage( fromAppData( item_map ) );
-#else
-            cWarning() << "Loading AppData XML is not supported.";
-#endif
-        }
-        else if ( item_map.contains( "appstream" ) )
-        {
-#ifdef HAVE_APPSTREAM
-            if ( !pool )
-            {
-                pool = std::make_unique< AppStream::Pool >();
-                pool->setLocale( QStringLiteral( "ALL" ) );
-                poolOk = pool->load();
-            }
-            if ( pool && poolOk )
-            {
-                model->addPackage( fromAppStream( *pool, item_map ) );
-            }
-#else
-            cWarning() << "Loading AppStream data is not supported.";
-#endif
-        }
-        else
+        if ( item_id.toString() == m_defaultItemId )
         {
-            model->addPackage( PackageItem( item_map ) );
+            m_defaultModelIndex = item_idx;
+            break;
         }
     }
-    cDebug() << Logger::SubEntry << "Loaded PackageChooser with" << model->packageCount() << "entries.";
 }
 
 void
@@ -251,23 +204,17 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
 
     if ( configurationMap.contains( "items" ) )
     {
-        fillModel( m_model, configurationMap.value( "items" ).toList() );
-
-        QString default_item_id = CalamaresUtils::getString( configurationMap, "default" );
-        if ( !default_item_id.isEmpty() )
-        {
-            for ( int item_n = 0; item_n < m_model->packageCount(); ++item_n )
-            {
-                QModelIndex item_idx = m_model->index( item_n, 0 );
-                QVariant item_id = m_model->data( item_idx, PackageListModel::IdRole );
-
-                if ( item_id.toString() == default_item_id )
-                {
-                    m_defaultModelIndex = item_idx;
-                    break;
-                }
-            }
-        }
+        // Items arrive in the model as they are loaded, so look for the default as they come in
+        m_defaultItemId = CalamaresUtils::getString( configurationMap, "default" );
+        connect( m_model, &QAbstractItemModel::rowsInserted, this, [ this ]( const QModelIndex&, int first, int last ) {
+            findDefaultItem( first, last );
+        } );
+
+        m_loader = new ItemLoader( m_model, this );
+        m_loader->setCacheFile( CalamaresUtils::appLogDir().absoluteFilePath(
+            QStringLiteral( "packagechooser-%1.cache" ).arg( m_defaultId.toString() ) ) );
+        connect( m_loader, &ItemLoader::finished, this, &Config::itemsLoaded );
+        m_loader->load( configurationMap.value( "items" ).toList() );
     }
     else
     {
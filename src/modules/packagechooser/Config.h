@@ -19,6 +19,8 @@
 #include <memory>
 #include <optional>
 
+class ItemLoader;
+
 enum class PackageChooserMode
 {
     Optional,  // zero or one
@@ -69,6 +71,11 @@ public:
 
     PackageChooserMode mode() const { return m_mode; }
     PackageListModel* model() const { return m_model; }
+    /** @brief The index of the *default* item
+     *
+     * Items are loaded in the background, so this may be invalid
+     * until itemsLoaded() is emitted.
+     */
     QModelIndex defaultSelectionIndex() const { return m_defaultModelIndex; }
 
     /** @brief Returns an "introductory package" which describes packagechooser
@@ -101,10 +108,16 @@ public:
 signals:
     void packageChoiceChanged( QString packageChoice );
     void prettyStatusChanged();
+    /// @brief All the items are loaded into the model
+    void itemsLoaded();
 
 private:
+    void findDefaultItem( int first, int last );
+
     PackageListModel* m_model = nullptr;
+    ItemLoader* m_loader = nullptr;
     QModelIndex m_defaultModelIndex;
+    QString m_defaultItemId;
 
     /// Selection mode for this module
     PackageChooserMode m_mode = PackageChooserMode::Optional;
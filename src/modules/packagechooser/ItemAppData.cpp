@@ -9,7 +9,7 @@
 
 /** @brief Loading items from AppData XML files.
  *
- * Only used if QtXML is found, implements PackageItem::fromAppData().
+ * Only used if QtXML is found, implements fromAppData() and mapFromAppData().
  */
 #include "PackageModel.h"
 
@@ -176,21 +176,21 @@ getNameAndSummary( const QDomNode& n )
     return m;
 }
 
-PackageItem
-fromAppData( const QVariantMap& item_map )
+QVariantMap
+mapFromAppData( const QVariantMap& item_map )
 {
     QString fileName = CalamaresUtils::getString( item_map, "appdata" );
     if ( fileName.isEmpty() )
     {
         cWarning() << "Can't load AppData without a suitable key.";
-        return PackageItem();
+        return QVariantMap();
     }
     cDebug() << "Loading AppData XML from" << fileName;
 
     QDomDocument doc = loadAppData( fileName );
     if ( doc.isNull() )
     {
-        return PackageItem();
+        return QVariantMap();
     }
 
     QDomElement componentNode = doc.documentElement();
@@ -204,7 +204,7 @@ fromAppData( const QVariantMap& item_map )
         }
         if ( id.isEmpty() )
         {
-            return PackageItem();
+            return QVariantMap();
         }
 
         // A "screenshot" entry in the Calamares config overrides AppData
@@ -218,8 +218,15 @@ fromAppData( const QVariantMap& item_map )
         map.insert( "id", id );
         map.insert( "screenshot", screenshotPath );
 
-        return PackageItem( map );
+        return map;
     }
 
-    return PackageItem();
+    return QVariantMap();
+}
+
+PackageItem
+fromAppData( const QVariantMap& item_map )
+{
+    const QVariantMap map = mapFromAppData( item_map );
+    return map.isEmpty() ? PackageItem() : PackageItem( map );
 }
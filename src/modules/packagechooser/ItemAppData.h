@@ -25,4 +25,15 @@
  */
 PackageItem fromAppData( const QVariantMap& map );
 
+/** @brief Loads an AppData XML file and returns the item map
+ *
+ * This is the configuration map for a PackageItem, like the items
+ * in packagechooser.conf: see fromAppData() for the keys in @p map.
+ * Returns an empty map if the AppData can't be loaded.
+ *
+ * This does not use QPixmap or other GUI classes, so it may be
+ * called from a worker thread.
+ */
+QVariantMap mapFromAppData( const QVariantMap& map );
+
 #endif
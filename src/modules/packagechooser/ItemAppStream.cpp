@@ -55,7 +55,7 @@ setScreenshot( QVariantMap& map, const AppStream::Screenshot& screenshot )
 }
 
 /// @brief Interpret an AppStream Component
-static PackageItem
+static QVariantMap
 fromComponent( AppStream::Component& component )
 {
     QVariantMap map;
@@ -106,17 +106,17 @@ fromComponent( AppStream::Component& component )
         }
     }
 
-    return PackageItem( map );
+    return map;
 }
 
-PackageItem
-fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
+QVariantMap
+mapFromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
 {
     QString appstreamId = CalamaresUtils::getString( item_map, "appstream" );
     if ( appstreamId.isEmpty() )
     {
         cWarning() << "Can't load AppStream without a suitable appstreamId.";
-        return PackageItem();
+        return QVariantMap();
     }
     cDebug() << "Loading AppStream data for" << appstreamId;
 
@@ -124,26 +124,30 @@ fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
     if ( itemList.count() < 1 )
     {
         cWarning() << "No AppStream data for" << appstreamId;
-        return PackageItem();
+        return QVariantMap();
     }
     if ( itemList.count() > 1 )
     {
         cDebug() << "Multiple AppStream data for" << appstreamId << "using first.";
     }
 
-    auto r = fromComponent( itemList.first() );
-    if ( r.isValid() )
+    auto map = fromComponent( itemList.first() );
+    QString id = CalamaresUtils::getString( item_map, "id" );
+    QString screenshotPath = CalamaresUtils::getString( item_map, "screenshot" );
+    if ( !id.isEmpty() )
     {
-        QString id = CalamaresUtils::getString( item_map, "id" );
-        QString screenshotPath = CalamaresUtils::getString( item_map, "screenshot" );
-        if ( !id.isEmpty() )
-        {
-            r.id = id;
-        }
-        if ( !screenshotPath.isEmpty() )
-        {
-            r.screenshot = screenshotPath;
-        }
+        map.insert( "id", id );
     }
-    return r;
+    if ( !screenshotPath.isEmpty() )
+    {
+        map.insert( "screenshot", screenshotPath );
+    }
+    return map;
+}
+
+PackageItem
+fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
+{
+    const QVariantMap map = mapFromAppStream( pool, item_map );
+    return map.isEmpty() ? PackageItem() : PackageItem( map );
 }
@@ -31,4 +31,15 @@ class Pool;
  */
 PackageItem fromAppStream( AppStream::Pool& pool, const QVariantMap& map );
 
+/** @brief Loads an item map from AppStream data.
+ *
+ * This is the configuration map for a PackageItem, like the items
+ * in packagechooser.conf: see fromAppStream() for the keys in @p map.
+ * Returns an empty map if there is no AppStream data for the item.
+ *
+ * The @p pool is not thread-safe: while this can be called from
+ * a worker thread, calls with the same pool must not overlap.
+ */
+QVariantMap mapFromAppStream( AppStream::Pool& pool, const QVariantMap& map );
+
 #endif
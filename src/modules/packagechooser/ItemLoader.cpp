@@ -0,0 +1,313 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ItemLoader.h"
+
+#ifdef HAVE_APPDATA
+#include "ItemAppData.h"
+#endif
+
+#ifdef HAVE_APPSTREAM
+#include "ItemAppStream.h"
+#include "locale/TranslationsModel.h"
+#include <AppStreamQt/pool.h>
+#include <QMutex>
+#include <QMutexLocker>
+#endif
+
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <functional>
+
+static constexpr quint32 cacheMagic = 0xca1a0050;
+
+#ifdef HAVE_APPSTREAM
+/** @brief The AppStream pool, loaded on first use
+ *
+ * The pool is not thread-safe, so AppStream items are loaded
+ * one after the other (but still in a worker thread).
+ */
+struct AppStreamData
+{
+    QMutex mutex;
+    std::unique_ptr< AppStream::Pool > pool;
+    bool ok = false;
+
+    QVariantMap load( const QVariantMap& item )
+    {
+        QMutexLocker lock( &mutex );
+        if ( !pool )
+        {
+            pool = std::make_unique< AppStream::Pool >();
+            pool->setLocale( QStringLiteral( "ALL" ) );
+            ok = pool->load();
+            if ( !ok )
+            {
+                cWarning() << "Could not load AppStream data.";
+            }
+        }
+        return ok ? mapFromAppStream( *pool, item ) : QVariantMap();
+    }
+};
+#endif
+
+/** @brief Identifies the data loaded for @p item
+ *
+ * If the data comes from a file, pass the @p fileName so that
+ * a changed file gives a different key.
+ */
+static QString
+cacheKey( const QVariantMap& item, const QString& fileName = QString() )
+{
+    QByteArray data;
+    QDataStream s( &data, QIODevice::WriteOnly );
+    s.setVersion( QDataStream::Qt_5_9 );
+    s << item;
+    if ( !fileName.isEmpty() )
+    {
+        QFileInfo fi( fileName );
+        s << fi.lastModified().toMSecsSinceEpoch() << fi.size();
+    }
+    return QString::fromLatin1( QCryptographicHash::hash( data, QCryptographicHash::Sha1 ).toHex() );
+}
+
+struct ItemLoader::Private
+{
+    PackageListModel* model;
+    QString cacheFile;
+    QThreadPool pool;
+#ifdef HAVE_APPSTREAM
+    std::shared_ptr< AppStreamData > appstream;
+#endif
+
+    /// Loaded item maps, in configuration order; an empty map is an item that failed
+    QVector< QVariantMap > maps;
+    QVector< bool > done;
+    /// Cache keys for the items that are worth caching (others are empty)
+    QStringList keys;
+    int added = 0;  ///< Items before this one are in the model
+    int pending = 0;  ///< Items still loading in the background
+    bool cacheChanged = false;
+
+    QHash< QString, QVariantMap > readCache() const;
+    void writeCache() const;
+};
+
+QHash< QString, QVariantMap >
+ItemLoader::Private::readCache() const
+{
+    QHash< QString, QVariantMap > cache;
+    QFile f( cacheFile );
+    if ( cacheFile.isEmpty() || !f.open( QIODevice::ReadOnly ) )
+    {
+        return cache;
+    }
+
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    quint32 magic = 0;
+    s >> magic;
+    if ( magic != cacheMagic )
+    {
+        return cache;
+    }
+    s >> cache;
+    if ( s.status() != QDataStream::Ok )
+    {
+        cWarning() << "Ignoring damaged packagechooser cache" << cacheFile;
+        cache.clear();
+    }
+    return cache;
+}
+
+void
+ItemLoader::Private::writeCache() const
+{
+    // Only the current items are kept, which drops stale entries
+    QHash< QString, QVariantMap > cache;
+    for ( int i = 0; i < maps.count(); ++i )
+    {
+        if ( !keys[ i ].isEmpty() && !maps[ i ].isEmpty() )
+        {
+            cache.insert( keys[ i ], maps[ i ] );
+        }
+    }
+
+    QSaveFile f( cacheFile );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        cWarning() << "Could not write packagechooser cache" << cacheFile;
+        return;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    s << cacheMagic << cache;
+    if ( s.status() != QDataStream::Ok || !f.commit() )
+    {
+        cWarning() << "Could not write packagechooser cache" << cacheFile;
+    }
+}
+
+ItemLoader::ItemLoader( PackageListModel* model, QObject* parent )
+    : QObject( parent )
+    , d( std::make_unique< Private >() )
+{
+    d->model = model;
+}
+
+ItemLoader::~ItemLoader()
+{
+    d->pool.waitForDone();
+}
+
+void
+ItemLoader::setCacheFile( const QString& fileName )
+{
+    d->cacheFile = fileName;
+}
+
+bool
+ItemLoader::isFinished() const
+{
+    return d->pending == 0 && d->added == d->maps.count();
+}
+
+void
+ItemLoader::waitForFinished()
+{
+    if ( !isFinished() )
+    {
+        QEventLoop loop;
+        connect( this, &ItemLoader::finished, &loop, &QEventLoop::quit );
+        loop.exec();
+    }
+}
+
+void
+ItemLoader::load( const QVariantList& items )
+{
+    if ( items.isEmpty() )
+    {
+        cWarning() << "No *items* for PackageChooser module.";
+    }
+
+    const auto cache = d->readCache();
+    d->maps.resize( items.count() );
+    d->done.fill( false, items.count() );
+    d->keys.clear();
+
+    cDebug() << "Loading PackageChooser model items from config";
+    for ( int i = 0; i < items.count(); ++i )
+    {
+        d->keys.append( QString() );
+        const QVariantMap item_map = items[ i ].toMap();
+        std::function< QVariantMap() > loader;
+        if ( item_map.isEmpty() )
+        {
+            cWarning() << "PackageChooser entry" << ( i + 1 ) << "is not valid.";
+        }
+        else if ( item_map.contains( "appdata" ) )
+        {
+#ifdef HAVE_APPDATA
+            d->keys[ i ] = cacheKey( item_map, CalamaresUtils::getString( item_map, "appdata" ) );
+            loader = [ item_map ]() { return mapFromAppData( item_map ); };
+#else
+            cWarning() << "Loading AppData XML is not supported.";
+#endif
+        }
+        else if ( item_map.contains( "appstream" ) )
+        {
+#ifdef HAVE_APPSTREAM
+            if ( !d->appstream )
+            {
+                d->appstream = std::make_shared< AppStreamData >();
+                // Make sure this is created in the GUI thread, not in a worker
+                CalamaresUtils::Locale::availableTranslations();
+            }
+            d->keys[ i ] = cacheKey( item_map );
+            auto appstream = d->appstream;
+            loader = [ appstream, item_map ]() { return appstream->load( item_map ); };
+#else
+            cWarning() << "Loading AppStream data is not supported.";
+#endif
+        }
+        else
+        {
+            d->maps[ i ] = item_map;
+        }
+
+        auto it = d->keys[ i ].isEmpty() ? cache.constEnd() : cache.constFind( d->keys[ i ] );
+        if ( it != cache.constEnd() )
+        {
+            d->maps[ i ] = it.value();
+        }
+        else if ( loader )
+        {
+            d->cacheChanged = true;
+            ++d->pending;
+            auto* watcher = new QFutureWatcher< QVariantMap >( this );
+            connect( watcher, &QFutureWatcherBase::finished, this, [ this, i, watcher ]() {
+                watcher->deleteLater();
+                complete( i, watcher->result() );
+            } );
+            watcher->setFuture( QtConcurrent::run( &d->pool, loader ) );
+            continue;
+        }
+        d->done[ i ] = true;
+    }
+
+    addReady();
+}
+
+void
+ItemLoader::complete( int index, const QVariantMap& map )
+{
+    d->maps[ index ] = map;
+    d->done[ index ] = true;
+    --d->pending;
+    addReady();
+}
+
+void
+ItemLoader::addReady()
+{
+    while ( d->added < d->maps.count() && d->done[ d->added ] )
+    {
+        const auto& map = d->maps[ d->added ];
+        if ( !map.isEmpty() )
+        {
+            d->model->addPackage( PackageItem( map ) );
+        }
+        ++d->added;
+    }
+
+    if ( isFinished() )
+    {
+        if ( d->cacheChanged && !d->cacheFile.isEmpty() )
+        {
+            d->writeCache();
+            d->cacheChanged = false;
+        }
+        cDebug() << Logger::SubEntry << "Loaded PackageChooser with" << d->model->packageCount() << "entries.";
+        emit finished();
+    }
+}
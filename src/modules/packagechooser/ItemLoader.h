@@ -0,0 +1,64 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PACKAGECHOOSER_ITEMLOADER_H
+#define PACKAGECHOOSER_ITEMLOADER_H
+
+#include "PackageModel.h"
+
+#include <QObject>
+#include <QVariantList>
+
+#include <memory>
+
+/** @brief Loads the items of a packagechooser into a model
+ *
+ * Items from AppData files or AppStream data take a while to load,
+ * so they are loaded concurrently in worker threads. Items are added
+ * to the model in configuration order, as soon as they (and the items
+ * before them) are loaded.
+ *
+ * The loaded item data is kept in a cache file (if one is set) and
+ * re-used on the next run, as long as the item configuration and the
+ * AppData file are unchanged. AppStream data is assumed not to change.
+ */
+class ItemLoader : public QObject
+{
+    Q_OBJECT
+public:
+    ItemLoader( PackageListModel* model, QObject* parent = nullptr );
+    ~ItemLoader() override;
+
+    /// @brief Keep item data in @p fileName; empty (the default) means no cache
+    void setCacheFile( const QString& fileName );
+
+    /** @brief Starts loading the @p items into the model
+     *
+     * Each item is a map, as in packagechooser.conf. Items that need
+     * no loading are added to the model right away. Emits finished()
+     * once all the items have been added (possibly from this call).
+     */
+    void load( const QVariantList& items );
+
+    bool isFinished() const;
+    /// @brief Waits (with a local event loop) until finished
+    void waitForFinished();
+
+signals:
+    void finished();
+
+private:
+    void complete( int index, const QVariantMap& map );
+    void addReady();
+
+    struct Private;
+    std::unique_ptr< Private > d;
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include "ui_page_package.h"
 
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 
@@ -128,6 +129,14 @@ PackageChooserPage::setModel( QAbstractItemModel* model )
              &QItemSelectionModel::selectionChanged,
              this,
              &PackageChooserPage::updateLabels );
+    // Screenshots are loaded when they are first asked for, and arrive later
+    connect( model, &QAbstractItemModel::dataChanged, this, [ this ]( const QModelIndex& from, const QModelIndex& to ) {
+        const QModelIndex current = ui->products->selectionModel()->currentIndex();
+        if ( current.isValid() && from.row() <= current.row() && current.row() <= to.row() )
+        {
+            currentChanged( current );
+        }
+    } );
 }
 
 void
@@ -172,5 +181,7 @@ PackageChooserPage::setIntroduction( const PackageItem& item )
 {
     m_introduction.name = item.name;
     m_introduction.description = item.description;
-    m_introduction.screenshot = item.screenshot;
+    m_introduction.screenshot = ( item.screenshot.isNull() && !item.screenshotPath.isEmpty() )
+        ? ImageRegistry::instance()->pixmap( item.screenshotPath, QSize() )
+        : item.screenshot;
 }
@@ -32,6 +32,7 @@ PackageChooserViewStep::PackageChooserViewStep( QObject* parent )
     , m_stepName( nullptr )
 {
     emit nextStatusChanged( false );
+    connect( m_config, &Config::itemsLoaded, this, &PackageChooserViewStep::itemsLoaded );
 }
 
 
@@ -168,3 +169,19 @@ PackageChooserViewStep::hookupModel()
     m_widget->setModel( m_config->model() );
     m_widget->setIntroduction( m_config->introductionPackage() );
 }
+
+void
+PackageChooserViewStep::itemsLoaded()
+{
+    if ( !m_widget )
+    {
+        return;
+    }
+    // The none-package (which is the introduction), or the default, may have been slow to load
+    m_widget->setIntroduction( m_config->introductionPackage() );
+    if ( !m_widget->hasSelection() )
+    {
+        m_widget->setSelection( m_config->defaultSelectionIndex() );
+    }
+    m_widget->updateLabels();
+}
@@ -47,6 +47,7 @@ public:
 
 private:
     void hookupModel();
+    void itemsLoaded();
 
     Config* m_config;
     PackageChooserPage* m_widget;
@@ -9,9 +9,13 @@
 
 #include "PackageModel.h"
 
+#include "network/Manager.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
+#include <QFutureWatcher>
+
 PackageItem::PackageItem() {}
 
 PackageItem::PackageItem( const QString& a_id, const QString& a_name, const QString& a_description )
@@ -24,11 +28,11 @@ PackageItem::PackageItem( const QString& a_id, const QString& a_name, const QStr
 PackageItem::PackageItem( const QString& a_id,
                           const QString& a_name,
                           const QString& a_description,
-                          const QString& screenshotPath )
+                          const QString& a_screenshotPath )
     : id( a_id )
     , name( a_name )
     , description( a_description )
-    , screenshot( screenshotPath )
+    , screenshotPath( a_screenshotPath )
 {
 }
 
@@ -36,7 +40,7 @@ PackageItem::PackageItem::PackageItem( const QVariantMap& item_map )
     : id( CalamaresUtils::getString( item_map, "id" ) )
     , name( CalamaresUtils::Locale::TranslatedString( item_map, "name" ) )
     , description( CalamaresUtils::Locale::TranslatedString( item_map, "description" ) )
-    , screenshot( CalamaresUtils::getString( item_map, "screenshot" ) )
+    , screenshotPath( CalamaresUtils::getString( item_map, "screenshot" ) )
     , packageNames( CalamaresUtils::getStringList( item_map, "packages" ) )
 {
     if ( name.isEmpty() && id.isEmpty() )
@@ -136,7 +140,27 @@ PackageListModel::data( const QModelIndex& index, int role ) const
     }
     else if ( role == ScreenshotRole )
     {
-        return m_packages[ row ].screenshot;
+        const auto& package = m_packages[ row ];
+        if ( !package.screenshot.isNull() || package.screenshotPath.isEmpty() )
+        {
+            return package.screenshot;
+        }
+        // The model itself doesn't change, but it does tell views about the screenshot
+        auto* self = const_cast< PackageListModel* >( this );
+        const QString scheme = QUrl( package.screenshotPath ).scheme();
+        if ( scheme == QStringLiteral( "http" ) || scheme == QStringLiteral( "https" ) )
+        {
+            self->fetchScreenshot( row );
+            return QPixmap();
+        }
+        return ImageRegistry::instance()->pixmapAsync(
+            package.screenshotPath, QSize(), CalamaresUtils::Original, self, [ self, row ]( const QPixmap& pixmap ) {
+                // A failed load isn't cached, so asking again would just fail again
+                if ( !pixmap.isNull() )
+                {
+                    emit self->dataChanged( self->index( row ), self->index( row ), { ScreenshotRole } );
+                }
+            } );
     }
     else if ( role == IdRole )
     {
@@ -145,3 +169,35 @@ PackageListModel::data( const QModelIndex& index, int role ) const
 
     return QVariant();
 }
+
+void
+PackageListModel::fetchScreenshot( int row )
+{
+    if ( m_requestedScreenshots.contains( row ) )
+    {
+        return;
+    }
+    // Only once, also if it fails: asking again would just fail again
+    m_requestedScreenshots.insert( row );
+
+    using namespace CalamaresUtils::Network;
+    auto* watcher = new QFutureWatcher< Response >( this );
+    connect( watcher, &QFutureWatcherBase::finished, this, [ this, watcher, row ]() {
+        watcher->deleteLater();
+        const Response response = watcher->result();
+        QPixmap pixmap;
+        if ( response.status && pixmap.loadFromData( response.data ) )
+        {
+            m_packages[ row ].screenshot = pixmap;
+            emit dataChanged( index( row ), index( row ), { ScreenshotRole } );
+        }
+        else
+        {
+            cWarning() << "Could not download screenshot" << m_packages[ row ].screenshotPath;
+        }
+    } );
+    watcher->setFuture( Manager::instance().asynchronousRequest(
+        QUrl( m_packages[ row ].screenshotPath ),
+        RequestOptions(
+            RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect, std::chrono::seconds( 30 ), 2 ) ) );
+}
@@ -16,6 +16,7 @@
 #include <QAbstractListModel>
 #include <QObject>
 #include <QPixmap>
+#include <QSet>
 #include <QVector>
 
 
@@ -24,7 +25,14 @@ struct PackageItem
     QString id;
     CalamaresUtils::Locale::TranslatedString name;
     CalamaresUtils::Locale::TranslatedString description;
+    /// @brief A screenshot that is set directly (e.g. for the introduction)
     QPixmap screenshot;
+    /** @brief Where the screenshot is, if not set directly
+     *
+     * The screenshot is only loaded when it is needed, see
+     * PackageListModel::ScreenshotRole.
+     */
+    QString screenshotPath;
     QStringList packageNames;
 
     /// @brief Create blank PackageItem
@@ -38,9 +46,9 @@ struct PackageItem
 
     /** @brief Creates a PackageItem from given strings.
      *
-     * Set all the text members and load the screenshot from the given
-     * @p screenshotPath, which may be a QRC path (:/path/in/qrc) or
-     * a filesystem path, whatever QPixmap understands.
+     * Set all the text members and the @p screenshotPath, which may
+     * be a QRC path (:/path/in/qrc) or a filesystem path, whatever
+     * QImage understands.
      */
     PackageItem( const QString& id, const QString& name, const QString& description, const QString& screenshotPath );
 
@@ -111,6 +119,15 @@ public:
      */
     QStringList getInstallPackagesForNames( const QStringList& ids ) const;
 
+    /** @brief Roles for data()
+     *
+     * The ScreenshotRole is a QPixmap. For items with a *screenshotPath*,
+     * the first request returns a null pixmap and starts loading the
+     * screenshot in the background; dataChanged() is emitted when
+     * it is loaded. That way, only the screenshots that are
+     * actually shown are loaded. Screenshots with an http(s) URL
+     * (e.g. from AppStream) are downloaded through the network Manager.
+     */
     enum Roles : int
     {
         NameRole = Qt::DisplayRole,
@@ -120,7 +137,12 @@ public:
     };
 
 private:
+    /// @brief Downloads the (remote) screenshot of the package in @p row
+    void fetchScreenshot( int row );
+
     PackageList m_packages;
+    /// Rows whose screenshot has been requested from the network
+    QSet< int > m_requestedScreenshots;
 };
 
 #endif
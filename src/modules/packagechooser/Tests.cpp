@@ -15,10 +15,12 @@
 #ifdef HAVE_APPSTREAM
 #include "ItemAppStream.h"
 #endif
+#include "ItemLoader.h"
 #include "PackageModel.h"
 
 #include "utils/Logger.h"
 
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 QTEST_MAIN( PackageChooserTests )
@@ -39,8 +41,9 @@ PackageChooserTests::testBogus()
     QVERIFY( true );
 }
 
-void
-PackageChooserTests::testAppData()
+/// @brief Finds the Calamares AppData file, which is in the top-level source directory
+static QString
+findAppData()
 {
     // Path from the build-dir and from the running-the-test varies,
     // for in-source build, for build/, and for tests-in-build/,
@@ -50,16 +53,22 @@ PackageChooserTests::testAppData()
     {
         if ( QFile::exists( prefix + appdataName ) )
         {
-            appdataName = prefix + appdataName;
-            break;
+            return prefix + appdataName;
         }
     }
+    return appdataName;
+}
+
+void
+PackageChooserTests::testAppData()
+{
+    const QString appdataName = findAppData();
     QVERIFY( QFile::exists( appdataName ) );
 
     QVariantMap m;
     m.insert( "appdata", appdataName );
 
-#ifdef HAVE_XML
+#ifdef HAVE_APPDATA
     PackageItem p1 = fromAppData( m );
     QVERIFY( p1.isValid() );
     QCOMPARE( p1.id, QStringLiteral( "io.calamares.calamares.desktop" ) );
@@ -71,6 +80,7 @@ PackageChooserTests::testAppData()
     QCOMPARE( p1.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
     QVERIFY( p1.screenshot.isNull() );
+    QVERIFY( p1.screenshotPath.isEmpty() );
 
     m.insert( "id", "calamares" );
     m.insert( "screenshot", ":/images/calamares.png" );
@@ -79,6 +89,94 @@ PackageChooserTests::testAppData()
     QCOMPARE( p2.id, QStringLiteral( "calamares" ) );
     QCOMPARE( p2.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
-    QVERIFY( !p2.screenshot.isNull() );
+    QCOMPARE( p2.screenshotPath, QStringLiteral( ":/images/calamares.png" ) );
+#endif
+}
+
+void
+PackageChooserTests::testLoader()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString cacheFile = dir.filePath( "packagechooser.cache" );
+
+    QVariantList items;
+    items.append( QVariantMap { { "id", "" }, { "name", "No package" } } );
+#ifdef HAVE_APPDATA
+    items.append( QVariantMap { { "appdata", findAppData() }, { "id", "calamares" } } );
+    items.append( QVariantMap { { "appdata", dir.filePath( "missing.appdata.xml" ) } } );
+#endif
+    items.append( QVariantMap() );
+    items.append( QVariantMap { { "id", "kate" }, { "name", "Kate" }, { "screenshot", ":/images/kate.png" } } );
+
+#ifdef HAVE_APPDATA
+    const QStringList expected { QString(), QStringLiteral( "calamares" ), QStringLiteral( "kate" ) };
+#else
+    const QStringList expected { QString(), QStringLiteral( "kate" ) };
 #endif
+    for ( int run = 0; run < 2; ++run )
+    {
+        // The second run uses the cache
+        PackageListModel model( nullptr );
+        ItemLoader loader( &model );
+        loader.setCacheFile( cacheFile );
+        QSignalSpy finished( &loader, &ItemLoader::finished );
+        loader.load( items );
+        loader.waitForFinished();
+        QVERIFY( loader.isFinished() );
+        QCOMPARE( finished.count(), 1 );
+
+        // Items that fail are left out, and the others keep their order
+        QCOMPARE( model.packageCount(), expected.count() );
+        for ( int i = 0; i < expected.count(); ++i )
+        {
+            QCOMPARE( model.packageData( i ).id, expected[ i ] );
+        }
+#ifdef HAVE_APPDATA
+        QCOMPARE( model.packageData( 1 ).name.get(), QStringLiteral( "Calamares" ) );
+        QVERIFY( QFile::exists( cacheFile ) );
+#endif
+    }
+
+    {
+        // Nothing to load in the background, so it's done right away
+        PackageListModel model( nullptr );
+        ItemLoader loader( &model );
+        loader.load( QVariantList { items.first() } );
+        QVERIFY( loader.isFinished() );
+        QCOMPARE( model.packageCount(), 1 );
+    }
+}
+
+void
+PackageChooserTests::testScreenshot()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    QImage image( 64, 48, QImage::Format_RGB32 );
+    image.fill( Qt::darkGreen );
+    const QString screenshot = dir.filePath( "screenshot.png" );
+    QVERIFY( image.save( screenshot ) );
+
+    PackageListModel model( nullptr );
+    model.addPackage( PackageItem( "kate", "Kate", "An editor", screenshot ) );
+    model.addPackage( PackageItem( "vi", "Vi", "Another editor", dir.filePath( "missing.png" ) ) );
+    model.addPackage( PackageItem( "ed", "Ed", "The editor" ) );
+    QCOMPARE( model.packageData( 0 ).screenshotPath, screenshot );
+    QVERIFY( model.packageData( 0 ).screenshot.isNull() );
+
+    // The screenshot is loaded when it is asked for
+    qRegisterMetaType< QVector< int > >();
+    QSignalSpy changed( &model, &QAbstractItemModel::dataChanged );
+    const auto index = model.index( 0 );
+    QVERIFY( model.data( index, PackageListModel::ScreenshotRole ).value< QPixmap >().isNull() );
+    QTRY_COMPARE( changed.count(), 1 );
+    QCOMPARE( changed.first().at( 0 ).toModelIndex(), index );
+    QCOMPARE( model.data( index, PackageListModel::ScreenshotRole ).value< QPixmap >().size(), QSize( 64, 48 ) );
+
+    // A screenshot that can't be loaded doesn't change anything
+    QVERIFY( model.data( model.index( 1 ), PackageListModel::ScreenshotRole ).value< QPixmap >().isNull() );
+    QVERIFY( model.data( model.index( 2 ), PackageListModel::ScreenshotRole ).value< QPixmap >().isNull() );
+    QTest::qWait( 100 );
+    QCOMPARE( changed.count(), 1 );
 }
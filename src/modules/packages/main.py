@@ -15,8 +15,10 @@
 #
 
 import abc
+import os
 from string import Template
 import subprocess
+import time
 
 import libcalamares
 from libcalamares.utils import check_target_env_call, target_env_call
@@ -34,6 +36,7 @@ _n = _translation.ngettext
 total_packages = 0  # For the entire job
 completed_packages = 0  # Done so far for this job
 group_packages = 0  # One group of packages from an -install or -remove entry
+group_completed_packages = 0  # Done so far for the current group
 
 INSTALL = object()
 REMOVE = object()
@@ -46,6 +49,39 @@ def _change_mode(mode):
     libcalamares.job.setprogress(completed_packages * 1.0 / total_packages)
 
 
+def _packages_done(count):
+    """
+    Records that @p count more packages of the current group are done,
+    and updates the job's progress accordingly.
+    """
+    global group_completed_packages
+    group_completed_packages += count
+    libcalamares.job.setprogress((completed_packages + group_completed_packages) * 1.0 / total_packages)
+
+
+def _group_package_list(package_list):
+    """
+    Splits @p package_list into runs of plain package names and
+    single package-data entries (which have scripts that must run
+    around that one package). The order of the packages is kept,
+    so that scripts see the same system as when all packages are
+    handled one-by-one.
+
+    @param package_list: list[str|dict]
+    @return: list[list[str]|dict]
+    """
+    groups = []
+    for package in package_list:
+        if isinstance(package, str):
+            if groups and isinstance(groups[-1], list):
+                groups[-1].append(package)
+            else:
+                groups.append([package])
+        else:
+            groups.append(package)
+    return groups
+
+
 def pretty_name():
     return _("Install packages.")
 
@@ -81,15 +117,22 @@ class PackageManager(metaclass=abc.ABCMeta):
 
     Subclasses are collected below to populate the list of possible
     backends.
+
+    A subclass may set the class property `cache_directory` to the
+    directory (in the target system) where the package manager looks
+    for already-downloaded packages; see `mount_package_cache()`.
     """
     backend = None
+    cache_directory = None
 
     @abc.abstractmethod
     def install(self, pkgs, from_local=False):
         """
         Install a list of packages (named) into the system.
-        Although this handles lists, in practice it is called
-        with one package at a time.
+        This is called with as many packages at a time as
+        possible, which should be done in one transaction.
+        If any of the packages can't be installed, this should
+        raise CalledProcessError.
 
         @param pkgs: list[str]
             list of package names
@@ -160,17 +203,20 @@ class PackageManager(metaclass=abc.ABCMeta):
         This operation is called for "critical" packages,
         which are expected to succeed, or fail, all together.
         However, if there are packages with pre- or post-scripts,
-        then packages are installed one-by-one instead.
+        then those packages are installed one-by-one, and the
+        plain package names between them in groups.
 
         NOTE: package managers may reimplement this method
         NOTE: exceptions are expected to leave this method, to indicate
               failure of the installation.
         """
-        if all([isinstance(x, str) for x in package_list]):
-            self.install(package_list, from_local=from_local)
-        else:
-            for package in package_list:
-                self.install_package(package, from_local=from_local)
+        for group in _group_package_list(package_list):
+            if isinstance(group, list):
+                self.install(group, from_local=from_local)
+                _packages_done(len(group))
+            else:
+                self.install_package(group, from_local=from_local)
+                _packages_done(1)
 
     def operation_try_install(self, package_list):
         """
@@ -180,19 +226,27 @@ class PackageManager(metaclass=abc.ABCMeta):
 
         This operation is called for "non-critical" packages,
         which can succeed or fail without affecting the overall installation.
-        Packages are installed one-by-one to support package managers
-        that do not have a "install as much as you can" mode.
+        Package managers generally do not have a "install as much as you can"
+        mode, so unless *try_in_batches* is false, plain package names
+        are installed in one transaction first; if that fails, the
+        packages are split in halves that are tried separately, until
+        the failing packages are found. Otherwise, packages are installed
+        one-by-one so a single failing package won't stop all of them.
 
         NOTE: package managers may reimplement this method
         NOTE: no package-installation exceptions should be raised
         """
-        # we make a separate package manager call for each package so a
-        # single failing package won't stop all of them
-        for package in package_list:
-            try:
-                self.install_package(package)
-            except subprocess.CalledProcessError:
-                libcalamares.utils.warning("Could not install package %s" % package)
+        batched = libcalamares.job.configuration.get("try_in_batches", True)
+        for group in _group_package_list(package_list):
+            if isinstance(group, list) and batched:
+                self._try_batch(self.install, group, "install")
+            else:
+                for package in group if isinstance(group, list) else [group]:
+                    try:
+                        self.install_package(package)
+                    except subprocess.CalledProcessError:
+                        libcalamares.utils.warning("Could not install package %s" % package)
+                    _packages_done(1)
 
     def operation_remove(self, package_list):
         """
@@ -203,30 +257,70 @@ class PackageManager(metaclass=abc.ABCMeta):
         This operation is called for "critical" packages, which are
         expected to succeed or fail all together.
         However, if there are packages with pre- or post-scripts,
-        then packages are removed one-by-one instead.
+        then those packages are removed one-by-one, and the plain
+        package names between them in groups.
 
         NOTE: package managers may reimplement this method
         NOTE: exceptions should be raised to indicate failure
         """
-        if all([isinstance(x, str) for x in package_list]):
-            self.remove(package_list)
-        else:
-            for package in package_list:
-                self.remove_package(package)
+        for group in _group_package_list(package_list):
+            if isinstance(group, list):
+                self.remove(group)
+                _packages_done(len(group))
+            else:
+                self.remove_package(group)
+                _packages_done(1)
 
     def operation_try_remove(self, package_list):
         """
         Same relation as try_install has to install, except it removes
-        packages instead. Packages are removed one-by-one.
+        packages instead. Packages are removed in batches, or one-by-one.
 
         NOTE: package managers may reimplement this method
         NOTE: no package-installation exceptions should be raised
         """
-        for package in package_list:
-            try:
-                self.remove_package(package)
-            except subprocess.CalledProcessError:
-                libcalamares.utils.warning("Could not remove package %s" % package)
+        batched = libcalamares.job.configuration.get("try_in_batches", True)
+        for group in _group_package_list(package_list):
+            if isinstance(group, list) and batched:
+                self._try_batch(self.remove, group, "remove")
+            else:
+                for package in group if isinstance(group, list) else [group]:
+                    try:
+                        self.remove_package(package)
+                    except subprocess.CalledProcessError:
+                        libcalamares.utils.warning("Could not remove package %s" % package)
+                    _packages_done(1)
+
+    def _try_batch(self, operation, pkgs, verb):
+        """
+        Applies @p operation (install or remove) to all of @p pkgs
+        in one package-manager call. If that fails, bisects the list:
+        each half is tried separately (and split further if it fails
+        again) until the packages that fail on their own are found.
+        Those are logged and skipped; everything else is done.
+
+        A single failing package among N costs about 2 log2(N) extra
+        package-manager calls, instead of N-1 when going one-by-one.
+
+        @param operation: callable taking list[str]
+        @param pkgs: list[str]
+        @param verb: str
+            "install" or "remove", for logging
+        @return: list[str]
+            the packages that failed
+        """
+        try:
+            operation(pkgs)
+        except subprocess.CalledProcessError:
+            if len(pkgs) == 1:
+                libcalamares.utils.warning("Could not {!s} package {!s}".format(verb, pkgs[0]))
+                _packages_done(1)
+                return pkgs
+            libcalamares.utils.debug("Could not {!s} {!s} packages at once, splitting.".format(verb, len(pkgs)))
+            middle = len(pkgs) // 2
+            return self._try_batch(operation, pkgs[:middle], verb) + self._try_batch(operation, pkgs[middle:], verb)
+        _packages_done(len(pkgs))
+        return []
 
 ### PACKAGE MANAGER IMPLEMENTATIONS
 #
@@ -238,12 +332,10 @@ class PMApk(PackageManager):
     backend = "apk"
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "add", pkg])
+        check_target_env_call(["apk", "add"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "del", pkg])
+        check_target_env_call(["apk", "del"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["apk", "update"])
@@ -254,6 +346,7 @@ class PMApk(PackageManager):
 
 class PMApt(PackageManager):
     backend = "apt"
+    cache_directory = "/var/cache/apt/archives"
 
     def install(self, pkgs, from_local=False):
         check_target_env_call(["apt-get", "-q", "-y", "install"] + pkgs)
@@ -353,12 +446,10 @@ class PMPackageKit(PackageManager):
     backend = "packagekit"
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "install", pkg])
+        check_target_env_call(["pkcon", "-py", "install"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "remove", pkg])
+        check_target_env_call(["pkcon", "-py", "remove"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["pkcon", "refresh"])
@@ -369,6 +460,7 @@ class PMPackageKit(PackageManager):
 
 class PMPacman(PackageManager):
     backend = "pacman"
+    cache_directory = "/var/cache/pacman/pkg"
 
     def install(self, pkgs, from_local=False):
         if from_local:
@@ -391,6 +483,7 @@ class PMPacman(PackageManager):
 
 class PMPamac(PackageManager):
     backend = "pamac"
+    cache_directory = "/var/cache/pacman/pkg"
 
     def del_db_lock(self, lock="/var/lib/pacman/db.lck"):
         # In case some error or crash, the database will be locked,
@@ -557,6 +650,116 @@ def subst_locale(plist):
     return ret
 
 
+def wait_for_prefetch():
+    """
+    If the netinstall module is downloading packages in the background
+    (global storage key *packageCache*), wait for it to finish, for at
+    most *prefetch_timeout* seconds.
+
+    @return: str|None
+        The cache directory (on the host), or None if there is none.
+    """
+    timeout = libcalamares.job.configuration.get("prefetch_timeout", 1800)
+    deadline = time.monotonic() + timeout
+    cache = libcalamares.globalstorage.value("packageCache")
+    while cache and not cache.get("done", False):
+        if time.monotonic() > deadline:
+            libcalamares.utils.warning("Package prefetch did not finish in {!s} seconds.".format(timeout))
+            break
+        time.sleep(1)
+        cache = libcalamares.globalstorage.value("packageCache")
+    if not cache:
+        return None
+
+    directory = cache.get("directory")
+    libcalamares.utils.debug("Package cache {!s} (prefetch finished={!s} ok={!s})".format(
+        directory, cache.get("done", False), cache.get("ok", False)))
+    # Even an incomplete cache is useful
+    if directory and os.path.isdir(directory):
+        return directory
+    return None
+
+
+def mount_package_cache(pkgman):
+    """
+    Makes prefetched packages (see wait_for_prefetch()) available to the
+    package manager in the target system, by bind-mounting the cache
+    directory over the directory where the package manager looks for
+    downloaded packages. That is *cache_directory* from the configuration,
+    or the backend's default.
+
+    @return: str|None
+        The mount point, which must be unmounted afterwards, or None.
+    """
+    target_cache = libcalamares.job.configuration.get("cache_directory", pkgman.cache_directory)
+    if not target_cache:
+        return None
+    host_cache = wait_for_prefetch()
+    if not host_cache:
+        return None
+
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    mount_point = os.path.join(root_mount_point, target_cache.lstrip("/"))
+    if libcalamares.utils.mount(host_cache, mount_point, "", "--bind") != 0:
+        libcalamares.utils.warning("Could not use package cache {!s}".format(host_cache))
+        return None
+    libcalamares.utils.debug("Installing packages from cache {!s}".format(host_cache))
+    return mount_point
+
+
+# Package-manager hooks that rebuild the initramfs, as pairs of
+# (override, hook) paths in the target. A symlink to /dev/null
+# in the override location disables the hook, see alpm-hooks(5)
+# and kernel-install(8).
+INITRAMFS_HOOKS = [
+    ("/etc/pacman.d/hooks/90-mkinitcpio-install.hook", "/usr/share/libalpm/hooks/90-mkinitcpio-install.hook"),
+    ("/etc/kernel/install.d/50-dracut.install", "/usr/lib/kernel/install.d/50-dracut.install"),
+    ]
+# initramfs-tools triggers obey update_initramfs=no in here
+UPDATE_INITRAMFS_CONF = "/etc/initramfs-tools/update-initramfs.conf"
+
+
+def defer_initramfs():
+    """
+    Stops the package manager from rebuilding the initramfs while
+    packages are installed, and marks the initramfs as needing
+    a rebuild (by the initcpio, initramfs or dracut module later).
+
+    @return: function
+        Call this to undo the changes.
+    """
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    masked = []
+    for override, hook in INITRAMFS_HOOKS:
+        override_path = os.path.join(root_mount_point, override.lstrip("/"))
+        if os.path.lexists(os.path.join(root_mount_point, hook.lstrip("/"))) and not os.path.lexists(override_path):
+            try:
+                os.makedirs(os.path.dirname(override_path), exist_ok=True)
+                os.symlink("/dev/null", override_path)
+                masked.append(override_path)
+            except OSError as e:
+                libcalamares.utils.warning("Could not disable initramfs hook {!s}: {!s}".format(hook, e))
+
+    conf_path = os.path.join(root_mount_point, UPDATE_INITRAMFS_CONF.lstrip("/"))
+    conf = None
+    if os.path.isfile(conf_path):
+        with open(conf_path, "r") as f:
+            conf = f.read()
+        lines = [l for l in conf.splitlines() if not l.startswith("update_initramfs=")]
+        with open(conf_path, "w") as f:
+            f.write("\n".join(lines + ["update_initramfs=no"]) + "\n")
+
+    libcalamares.globalstorage.insert("initramfsDirty", True)
+
+    def restore():
+        for path in masked:
+            os.unlink(path)
+        if conf is not None:
+            with open(conf_path, "w") as f:
+                f.write(conf)
+    return restore
+
+
 def run_operations(pkgman, entry):
     """
     Call package manager with suitable parameters for the given
@@ -572,11 +775,12 @@ def run_operations(pkgman, entry):
         names (strings) or package information dictionaries with pre-
         and post-scripts.
     """
-    global group_packages, completed_packages, mode_packages
+    global group_packages, completed_packages, group_completed_packages, mode_packages
 
     for key in entry.keys():
         package_list = subst_locale(entry[key])
         group_packages = len(package_list)
+        group_completed_packages = 0
         if key == "install":
             _change_mode(INSTALL)
             pkgman.operation_install(package_list)
@@ -597,10 +801,12 @@ def run_operations(pkgman, entry):
         else:
             libcalamares.utils.warning("Unknown package-operation key {!s}".format(key))
         completed_packages += len(package_list)
+        group_completed_packages = 0
         libcalamares.job.setprogress(completed_packages * 1.0 / total_packages)
         libcalamares.utils.debug("Pretty name: {!s}, setting progress..".format(pretty_name()))
 
     group_packages = 0
+    group_completed_packages = 0
     _change_mode(None)
 
 
@@ -666,18 +872,28 @@ def run():
         # Avoids potential divide-by-zero in progress reporting
         return None
 
-    for entry in operations:
-        group_packages = 0
-        libcalamares.utils.debug(pretty_name())
-        try:
-            run_operations(pkgman, entry)
-        except subprocess.CalledProcessError as e:
-            libcalamares.utils.warning(str(e))
-            libcalamares.utils.debug("stdout:" + str(e.stdout))
-            libcalamares.utils.debug("stderr:" + str(e.stderr))
-            return (_("Package Manager error"),
-                    _("The package manager could not make changes to the installed system. The command <pre>{!s}</pre> returned error code {!s}.")
-                    .format(e.cmd, e.returncode))
+    cache_mount_point = mount_package_cache(pkgman)
+    restore_initramfs = None
+    if libcalamares.job.configuration.get("defer_initramfs", False):
+        restore_initramfs = defer_initramfs()
+    try:
+        for entry in operations:
+            group_packages = 0
+            libcalamares.utils.debug(pretty_name())
+            try:
+                run_operations(pkgman, entry)
+            except subprocess.CalledProcessError as e:
+                libcalamares.utils.warning(str(e))
+                libcalamares.utils.debug("stdout:" + str(e.stdout))
+                libcalamares.utils.debug("stderr:" + str(e.stderr))
+                return (_("Package Manager error"),
+                        _("The package manager could not make changes to the installed system. The command <pre>{!s}</pre> returned error code {!s}.")
+                        .format(e.cmd, e.returncode))
+    finally:
+        if restore_initramfs:
+            restore_initramfs()
+        if cache_mount_point:
+            subprocess.call(["umount", cache_mount_point])
 
     mode_packages = None
 
@@ -57,6 +57,8 @@ class PlymouthController:
             if (("plymouth_theme" in libcalamares.job.configuration) and
                (libcalamares.job.configuration["plymouth_theme"] is not None)):
                 self.setTheme()
+                # The theme is part of the initramfs
+                libcalamares.globalstorage.insert("initramfsDirty", True)
         return None
 
 
@@ -12,14 +12,12 @@
 #include "JobQueue.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/CommandList.h"
+#include "utils/FileCopy.h"
 #include "utils/Logger.h"
 #include "utils/Permissions.h"
-#include "utils/Units.h"
 
 #include <QFile>
 
-using namespace CalamaresUtils::Units;
-
 QString
 targetPrefix()
 {
@@ -82,32 +80,16 @@ PreserveFiles::prettyName() const
 static bool
 copy_file( const QString& source, const QString& dest )
 {
-    QFile sourcef( source );
-    if ( !sourcef.open( QFile::ReadOnly ) )
-    {
-        cWarning() << "Could not read" << source;
-        return false;
-    }
-
-    QFile destf( dest );
-    if ( !destf.open( QFile::WriteOnly ) )
+    // The files belong to the target system now: keep permissions
+    // and timestamps, but not the owners (which are from the host)
+    // or security labels.
+    const auto r = CalamaresUtils::copyFile(
+        source, dest, CalamaresUtils::PreserveMode | CalamaresUtils::PreserveTimestamps );
+    if ( !r )
     {
-        sourcef.close();
-        cWarning() << "Could not open" << destf.fileName() << "for writing; could not copy" << source;
-        return false;
+        cWarning() << r.errorString;
     }
-
-    QByteArray b;
-    do
-    {
-        b = sourcef.read( 1_MiB );
-        destf.write( b );
-    } while ( b.count() > 0 );
-
-    sourcef.close();
-    destf.close();
-
-    return true;
+    return r.ok();
 }
 
 Calamares::JobResult
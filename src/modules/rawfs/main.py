@@ -14,7 +14,6 @@ import os
 import stat
 import subprocess
 from time import gmtime, strftime, sleep
-from math import gcd
 
 import gettext
 _ = gettext.translation("calamares-python",
@@ -25,12 +24,6 @@ _ = gettext.translation("calamares-python",
 def pretty_name():
     return _("Installing data.")
 
-def lcm(a, b):
-    """
-    Computes the Least Common Multiple of 2 numbers
-    """
-    return a * b / gcd(a, b)
-
 def get_device_size(device):
     """
     Returns a filesystem's total size and block size in bytes.
@@ -69,6 +62,9 @@ def get_device_size(device):
 class RawFSLowSpaceError(Exception):
     pass
 
+class RawFSCopyError(Exception):
+    pass
+
 class RawFSItem:
     __slots__ = ['source', 'destination', 'filesystem', 'resize']
 
@@ -84,8 +80,6 @@ class RawFSItem:
             The number of items in the filesystems list
             (used for progress reporting)
         """
-        count = 0
-
         libcalamares.utils.debug("Copying {} to {}".format(self.source, self.destination))
         if libcalamares.job.configuration.get("bogus", False):
             return
@@ -97,23 +91,14 @@ class RawFSItem:
             raise RawFSLowSpaceError
             return
 
-        # Compute transfer block size (100x the LCM of the block sizes seems a good fit)
-        blksize = int(100 * lcm(srcblksize, destblksize))
-
-        # Execute copy
-        src = open(self.source, "rb")
-        dest = open(self.destination, "wb")
-        buffer = src.read(blksize)
-        while len(buffer) > 0:
-            dest.write(buffer)
-            count += len(buffer)
-            # Compute job progress
-            progress = ((count / srcsize) + (current)) / total
-            libcalamares.job.setprogress(progress)
-            # Read next data block
-            buffer = src.read(blksize)
-        src.close()
-        dest.close()
+        # Execute copy; this skips holes in sparse images and
+        # reports progress as it goes.
+        verify = libcalamares.job.configuration.get("verify", False)
+        try:
+            libcalamares.job.raw_copy(self.source, self.destination,
+                                      current / total, (current + 1) / total, verify)
+        except OSError as e:
+            raise RawFSCopyError(str(e))
 
         if self.resize:
             if "ext" in self.filesystem:
@@ -177,6 +162,9 @@ def run():
         except RawFSLowSpaceError:
             return ("Not enough free space",
                 "{} partition is too small to copy {} on it".format(item.destination, item.source))
+        except RawFSCopyError as e:
+            return (_("Could not copy data."),
+                _("Copying {!s} to {!s} failed: {!s}").format(item.source, item.destination, e))
         update_global_storage(item, partitions)
 
     return None
@@ -13,6 +13,7 @@
 #
 
 import libcalamares
+import os
 
 
 import gettext
@@ -26,24 +27,241 @@ def pretty_name():
     return _("Configure systemd services")
 
 
-def systemctl(targets, command, suffix):
+# Where systemd looks for unit files, in order of preference
+# (relative to the root of the target system).
+UNIT_PATHS = ["etc/systemd/system",
+              "usr/local/lib/systemd/system",
+              "usr/lib/systemd/system",
+              "lib/systemd/system",
+              ]
+# Where enablement symlinks and masks go
+CONFIG_PATH = "etc/systemd/system"
+
+
+class OfflineUnits:
+    """
+    Enables, disables and masks systemd units by creating and removing
+    the symlinks in the target system directly, like `systemctl --root`
+    does. This avoids starting systemctl in the chroot for each unit.
+
+    Only the common cases are handled: each method returns False
+    if it cannot handle the unit (e.g. the unit file is a symlink
+    or uses specifiers in its [Install] section), and then
+    systemctl should be used instead.
+    """
+    def __init__(self, root):
+        self.root = root
+        self.config_dir = os.path.join(root, CONFIG_PATH)
+
+    def find(self, name):
+        """
+        Returns the path of the unit file for unit @p name (as seen
+        from inside the target) and the unit file's name, or None.
+        An instance (e.g. getty@tty1.service) uses its template file.
+        """
+        candidates = [name]
+        if "@" in name and not name.split("@", 1)[1].startswith("."):
+            candidates.append(name[:name.index("@") + 1] + name[name.rindex("."):])
+        for filename in candidates:
+            for d in UNIT_PATHS:
+                full = os.path.join(self.root, d, filename)
+                if os.path.islink(full):
+                    # Aliases, masks, linked units: leave those to systemctl
+                    return None
+                if os.path.isfile(full):
+                    return "/" + d + "/" + filename, filename
+        return None
+
+    def install_section(self, name):
+        """
+        Returns a dict with the settings from the [Install] section
+        of the unit file of @p name, each a list of names.
+        Returns None if the file can't be read, or uses specifiers.
+        """
+        found = self.find(name)
+        if found is None:
+            return None
+        install = {}
+        section = None
+        try:
+            with open(os.path.join(self.root, found[0].lstrip("/")), "r") as f:
+                lines = f.read().replace("\\\n", " ").splitlines()
+        except (OSError, UnicodeDecodeError):
+            return None
+        for line in lines:
+            line = line.strip()
+            if not line or line[0] in "#;":
+                continue
+            if line.startswith("["):
+                section = line
+                continue
+            if section != "[Install]" or "=" not in line:
+                continue
+            key, value = [x.strip() for x in line.split("=", 1)]
+            if "%" in value:
+                return None
+            if value:
+                install.setdefault(key, []).extend(value.split())
+            else:
+                # Empty assignment resets the list
+                install[key] = []
+        return install
+
+    def _symlink(self, target, link):
+        if os.path.islink(link):
+            return os.readlink(link) == target
+        if os.path.lexists(link):
+            return False
+        os.makedirs(os.path.dirname(link), exist_ok=True)
+        os.symlink(target, link)
+        return True
+
+    def enable(self, name, seen=None):
+        seen = set() if seen is None else seen
+        if name in seen:
+            return True
+        seen.add(name)
+
+        found = self.find(name)
+        install = self.install_section(name)
+        if found is None or install is None:
+            return False
+        unit_path, filename = found
+
+        link_name = name
+        if name == filename and "@." in filename:
+            # A template is enabled with its default instance
+            default = install.get("DefaultInstance", [])
+            if not default:
+                return False
+            link_name = filename.replace("@.", "@{}.".format(default[-1]), 1)
+
+        links = []
+        for key, suffix in (("WantedBy", ".wants"), ("RequiredBy", ".requires")):
+            for unit in install.get(key, []):
+                links.append(os.path.join(self.config_dir, unit + suffix, link_name))
+        for alias in install.get("Alias", []):
+            links.append(os.path.join(self.config_dir, alias))
+        if not links and not install.get("Also"):
+            libcalamares.utils.warning("Unit {!s} has no installation config, not enabled.".format(name))
+            return True
+
+        try:
+            for link in links:
+                if not self._symlink(unit_path, link):
+                    return False
+        except OSError as e:
+            libcalamares.utils.warning("Cannot enable {!s} offline: {!s}".format(name, e))
+            return False
+        return all(self.enable(also, seen) for also in install.get("Also", []))
+
+    def disable(self, name, seen=None):
+        seen = set() if seen is None else seen
+        if name in seen:
+            return True
+        seen.add(name)
+
+        found = self.find(name)
+        install = self.install_section(name)
+        if found is None or install is None:
+            return False
+        filename = found[1]
+        instance = name != filename
+
+        # Remove the symlinks to the unit file: aliases, and those in .wants/.requires
+        try:
+            for dirpath, dirnames, filenames in os.walk(self.config_dir):
+                dirnames[:] = [d for d in dirnames if d.endswith((".wants", ".requires"))]
+                for link_name in filenames:
+                    if instance and link_name != name:
+                        continue
+                    link = os.path.join(dirpath, link_name)
+                    if os.path.islink(link) and os.path.basename(os.readlink(link)) == filename:
+                        os.unlink(link)
+        except OSError as e:
+            libcalamares.utils.warning("Cannot disable {!s} offline: {!s}".format(name, e))
+            return False
+        return all(self.disable(also, seen) for also in install.get("Also", []))
+
+    def mask(self, name):
+        try:
+            return self._symlink("/dev/null", os.path.join(self.config_dir, name))
+        except OSError as e:
+            libcalamares.utils.warning("Cannot mask {!s} offline: {!s}".format(name, e))
+            return False
+
+    def change(self, command, name):
+        if command == "enable":
+            return self.enable(name)
+        elif command == "disable":
+            return self.disable(name)
+        elif command == "mask":
+            return self.mask(name)
+        return False
+
+
+def systemctl_failure(command, suffix, name, ec):
+    """
+    Returns a failure message for a mandatory @p name that could not
+    be changed with systemctl @p command (which returned @p ec).
+    """
+    title = _("Cannot modify service")
+    diagnostic = _("<code>systemctl {arg!s}</code> call in chroot returned error code {num!s}.").format(arg=command, num=ec)
+
+    if command == "enable" and suffix == ".service":
+        description = _("Cannot enable systemd service <code>{name!s}</code>.")
+    elif command == "enable" and suffix == ".target":
+        description = _("Cannot enable systemd target <code>{name!s}</code>.")
+    elif command == "disable" and suffix == ".service":
+        description = _("Cannot enable systemd service <code>{name!s}</code>.")
+    elif command == "disable" and suffix == ".target":
+        description = _("Cannot disable systemd target <code>{name!s}</code>.")
+    elif command == "mask":
+        description = _("Cannot mask systemd unit <code>{name!s}</code>.")
+    else:
+        description = _("Unknown systemd commands <code>{command!s}</code> and <code>{suffix!s}</code> for unit {name!s}.")
+
+    return (title,
+            description.format(name=name, command=command, suffix=suffix) + " " + diagnostic
+            )
+
+
+def systemctl(targets, command, suffix, offline=None):
     """
     For each entry in @p targets, run "systemctl <command> <thing>",
     where <thing> is the entry's name plus the given @p suffix.
     (No dot is added between name and suffix; suffix may be empty)
 
+    If @p offline is given (an OfflineUnits), the changes are made
+    by that where possible. The remaining entries are passed
+    to a single systemctl invocation; only if that fails is
+    systemctl run for each entry separately, to find out which
+    one failed.
+
     Returns a failure message, or None if this was successful.
     Services that are not mandatory have their failures suppressed
     silently.
     """
+    units = []
     for svc in targets:
         if isinstance(svc, str):
-            name = svc
-            mandatory = False
+            units.append((svc, False))
         else:
-            name = svc["name"]
-            mandatory = svc.get("mandatory", False)
+            units.append((svc["name"], svc.get("mandatory", False)))
+
+    if offline is not None:
+        units = [u for u in units if not offline.change(command, u[0] + suffix)]
+    if not units:
+        return None
+
+    if len(units) > 1:
+        ec = libcalamares.utils.target_env_call(
+            ['systemctl', command] + ["{}{}".format(name, suffix) for name, _mandatory in units]
+            )
+        if ec == 0:
+            return None
 
+    for name, mandatory in units:
         ec = libcalamares.utils.target_env_call(
             ['systemctl', command, "{}{}".format(name, suffix)]
             )
@@ -56,25 +274,7 @@ def systemctl(targets, command, suffix):
                 "systemctl {} call in chroot returned error code {}".format(command, ec)
                 )
             if mandatory:
-                title = _("Cannot modify service")
-                diagnostic = _("<code>systemctl {arg!s}</code> call in chroot returned error code {num!s}.").format(arg=command, num=ec)
-
-                if command == "enable" and suffix == ".service":
-                    description = _("Cannot enable systemd service <code>{name!s}</code>.")
-                elif command == "enable" and suffix == ".target":
-                    description = _("Cannot enable systemd target <code>{name!s}</code>.")
-                elif command == "disable" and suffix == ".service":
-                    description = _("Cannot enable systemd service <code>{name!s}</code>.")
-                elif command == "disable" and suffix == ".target":
-                    description = _("Cannot disable systemd target <code>{name!s}</code>.")
-                elif command == "mask":
-                    description = _("Cannot mask systemd unit <code>{name!s}</code>.")
-                else:
-                    description = _("Unknown systemd commands <code>{command!s}</code> and <code>{suffix!s}</code> for unit {name!s}.")
-
-                return (title,
-                        description.format(name=name, command=command, suffix=suffix) + " " + diagnostic
-                        )
+                return systemctl_failure(command, suffix, name, ec)
     return None
 
 
@@ -88,24 +288,28 @@ def run():
     # here will work in a chroot; in fact, they are the only systemctl commands
     # that support that, see:
     # http://0pointer.de/blog/projects/changing-roots.html
+    offline = None
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    if cfg.get("offline", True) and root_mount_point:
+        offline = OfflineUnits(root_mount_point)
 
-    r = systemctl(cfg.get("services", []), "enable", ".service")
+    r = systemctl(cfg.get("services", []), "enable", ".service", offline)
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("targets", []), "enable", ".target")
+    r = systemctl(cfg.get("targets", []), "enable", ".target", offline)
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("disable", []), "disable", ".service")
+    r = systemctl(cfg.get("disable", []), "disable", ".service", offline)
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("disable-targets", []), "disable", ".target")
+    r = systemctl(cfg.get("disable-targets", []), "disable", ".target", offline)
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("mask", []), "mask", "")
+    r = systemctl(cfg.get("mask", []), "mask", "", offline)
     if r is not None:
         return r
 
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+#   SPDX-License-Identifier: GPL-3.0-or-later
+#
+#   Calamares is Free Software: see the License-Identifier above.
+#
+"""
+Creates (with *setup*) or checks (with *check*) a fake target system
+for the services-systemd tests, in the directory given as second argument.
+"""
+
+import os
+import shutil
+import sys
+
+UNIT_DIR = "usr/lib/systemd/system"
+CONFIG_DIR = "etc/systemd/system"
+
+SERVICE = """[Unit]
+Description=Unit {name} for testing
+
+[Service]
+ExecStart=/bin/true
+
+[Install]
+"""
+UNITS = {
+    "enabled.service": "WantedBy=multi-user.target\nAlias=alias.service\n",
+    "disabled.service": "WantedBy=multi-user.target\n",
+    "masked.service": "WantedBy=multi-user.target\n",
+    }
+
+
+def unit_path(name):
+    return "/" + UNIT_DIR + "/" + name
+
+
+def setup(root):
+    shutil.rmtree(root, ignore_errors=True)
+    os.makedirs(os.path.join(root, UNIT_DIR))
+    for name, install in UNITS.items():
+        with open(os.path.join(root, UNIT_DIR, name), "w") as f:
+            f.write(SERVICE.format(name=name) + install)
+    # Enabled already, so that the test can disable it
+    wants = os.path.join(root, CONFIG_DIR, "multi-user.target.wants")
+    os.makedirs(wants)
+    os.symlink(unit_path("disabled.service"), os.path.join(wants, "disabled.service"))
+    return 0
+
+
+def check(root):
+    config = os.path.join(root, CONFIG_DIR)
+    expected = {
+        "multi-user.target.wants/enabled.service": unit_path("enabled.service"),
+        "alias.service": unit_path("enabled.service"),
+        "masked.service": "/dev/null",
+        }
+    failures = 0
+    for link, target in expected.items():
+        path = os.path.join(config, link)
+        if not os.path.islink(path) or os.readlink(path) != target:
+            print("Expected symlink {!s} -> {!s}".format(link, target))
+            failures += 1
+    for link in ("multi-user.target.wants/disabled.service", "multi-user.target.wants/masked.service"):
+        if os.path.lexists(os.path.join(config, link)):
+            print("Unexpected {!s}".format(link))
+            failures += 1
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3 or sys.argv[1] not in ("setup", "check"):
+        print("Usage: fake-root.py setup|check <root>")
+        sys.exit(1)
+    sys.exit(setup(sys.argv[2]) if sys.argv[1] == "setup" else check(sys.argv[2]))
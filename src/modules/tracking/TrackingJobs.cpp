@@ -115,10 +115,12 @@ TrackingInstallJob::exec()
     using CalamaresUtils::Network::RequestOptions;
     using CalamaresUtils::Network::RequestStatus;
 
+    // A ping is never cached; try once more if the network hiccups
     auto result = Manager::instance().synchronousPing(
         QUrl( m_url ),
         RequestOptions( RequestOptions::FollowRedirect | RequestOptions::FakeUserAgent,
-                        RequestOptions::milliseconds( 5000 ) ) );
+                        RequestOptions::milliseconds( 5000 ),
+                        1 ) );
     if ( result.status == RequestStatus::Timeout )
     {
         cWarning() << "install-tracking request timed out.";
@@ -0,0 +1,863 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "AccountDatabase.h"
+
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+
+static const char* const accountFileNames[] = { "/etc/passwd", "/etc/shadow", "/etc/group",
+                                                "/etc/gshadow", "/etc/subuid", "/etc/subgid" };
+
+/// @brief Index of the line for @p name in @p lines, or -1
+static int
+findEntry( const QStringList& lines, const QString& name )
+{
+    const QString prefix = name + ':';
+    for ( int i = 0; i < lines.count(); ++i )
+    {
+        if ( lines.at( i ).startsWith( prefix ) )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief The ids (third field) used in @p lines, as in passwd and group
+static std::set< int >
+usedIds( const QStringList& lines )
+{
+    std::set< int > ids;
+    for ( const auto& line : lines )
+    {
+        bool ok = false;
+        int id = line.section( ':', 2, 2 ).toInt( &ok );
+        if ( ok )
+        {
+            ids.insert( id );
+        }
+    }
+    return ids;
+}
+
+/** @brief Picks an id from [ @p min, @p max ] that is not in @p used
+ *
+ * Like the shadow tools, use one more than the highest used id in the
+ * range, unless that is out of range, then the lowest free one.
+ * For @p countDown, use the highest free id in the range instead.
+ */
+static int
+freeId( const std::set< int >& used, int min, int max, bool countDown )
+{
+    if ( countDown )
+    {
+        for ( int id = max; id >= min; --id )
+        {
+            if ( !used.count( id ) )
+            {
+                return id;
+            }
+        }
+        return -1;
+    }
+
+    auto it = used.upper_bound( max );
+    if ( it == used.begin() || *std::prev( it ) < min )
+    {
+        return min;
+    }
+    const int highest = *std::prev( it );
+    if ( highest < max )
+    {
+        return highest + 1;
+    }
+    for ( int id = min; id <= max; ++id )
+    {
+        if ( !used.count( id ) )
+        {
+            return id;
+        }
+    }
+    return -1;
+}
+
+/// @brief Does @p s fit in a field of an account file?
+static bool
+isValidField( const QString& s )
+{
+    return !s.contains( ':' ) && !s.contains( '\n' );
+}
+
+static QString
+errorString()
+{
+    return QString::fromLocal8Bit( strerror( errno ) );
+}
+
+AccountDatabase::AccountDatabase() {}
+
+QString
+AccountDatabase::targetPath( const QString& path ) const
+{
+    return QDir::cleanPath( m_root + '/' + path );
+}
+
+QString
+AccountDatabase::path( File f ) const
+{
+    return targetPath( QString::fromLatin1( accountFileNames[ static_cast< int >( f ) ] ) );
+}
+
+bool
+AccountDatabase::nssUsesFiles() const
+{
+    QFile nsswitch( targetPath( QStringLiteral( "/etc/nsswitch.conf" ) ) );
+    if ( !nsswitch.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        // No configuration, the C library uses files
+        return true;
+    }
+
+    static const QStringList databases { "passwd:", "group:", "shadow:", "gshadow:" };
+    static const QStringList editableSources { "files", "compat", "systemd" };
+    const QRegularExpression whitespace( "\\s+" );
+    while ( !nsswitch.atEnd() )
+    {
+        const QString line = QString::fromUtf8( nsswitch.readLine() ).section( '#', 0, 0 ).trimmed();
+        QStringList words = line.split( whitespace, SplitSkipEmptyParts );
+        if ( words.isEmpty() || !databases.contains( words.first() ) )
+        {
+            continue;
+        }
+        words.removeFirst();
+        bool inAction = false;
+        for ( const auto& w : words )
+        {
+            // Skip [STATUS=ACTION] items, which may contain spaces
+            if ( inAction || w.startsWith( '[' ) )
+            {
+                inAction = !w.endsWith( ']' );
+                continue;
+            }
+            if ( !editableSources.contains( w ) )
+            {
+                cDebug() << "NSS source" << w << "for" << line.section( ':', 0, 0 ) << "is not editable.";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void
+AccountDatabase::loadSettings()
+{
+    m_settings = Settings();
+    bool sysGidMaxSet = false;
+
+    QFile loginDefs( targetPath( QStringLiteral( "/etc/login.defs" ) ) );
+    if ( loginDefs.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        const QRegularExpression whitespace( "\\s+" );
+        int umask = 022;
+        int homeMode = -1;
+        while ( !loginDefs.atEnd() )
+        {
+            const QString line = QString::fromUtf8( loginDefs.readLine() ).trimmed();
+            if ( line.isEmpty() || line.startsWith( '#' ) )
+            {
+                continue;
+            }
+            const QString key = line.section( whitespace, 0, 0 );
+            const QString value = line.section( whitespace, 1, 1 );
+            bool ok = false;
+            const qlonglong number = value.toLongLong( &ok, 0 );
+
+            // clang-format off
+            if ( key == "UID_MIN" && ok ) { m_settings.uidMin = int( number ); }
+            else if ( key == "UID_MAX" && ok ) { m_settings.uidMax = int( number ); }
+            else if ( key == "GID_MIN" && ok ) { m_settings.gidMin = int( number ); }
+            else if ( key == "GID_MAX" && ok ) { m_settings.gidMax = int( number ); }
+            else if ( key == "SYS_GID_MIN" && ok ) { m_settings.sysGidMin = int( number ); }
+            else if ( key == "SYS_GID_MAX" && ok ) { m_settings.sysGidMax = int( number ); sysGidMaxSet = true; }
+            else if ( key == "SUB_UID_MIN" && ok ) { m_settings.subUidMin = number; }
+            else if ( key == "SUB_UID_MAX" && ok ) { m_settings.subUidMax = number; }
+            else if ( key == "SUB_UID_COUNT" && ok ) { m_settings.subUidCount = number; }
+            else if ( key == "SUB_GID_MIN" && ok ) { m_settings.subGidMin = number; }
+            else if ( key == "SUB_GID_MAX" && ok ) { m_settings.subGidMax = number; }
+            else if ( key == "SUB_GID_COUNT" && ok ) { m_settings.subGidCount = number; }
+            else if ( key == "PASS_MIN_DAYS" && ok ) { m_settings.passMinDays = value; }
+            else if ( key == "PASS_MAX_DAYS" && ok ) { m_settings.passMaxDays = value; }
+            else if ( key == "PASS_WARN_AGE" && ok ) { m_settings.passWarnAge = value; }
+            // These are octal even without a leading 0
+            else if ( key == "UMASK" ) { umask = value.toInt( &ok, 8 ); if ( !ok ) { umask = 022; } }
+            else if ( key == "HOME_MODE" ) { homeMode = value.toInt( &ok, 8 ); if ( !ok ) { homeMode = -1; } }
+            // clang-format on
+        }
+        m_settings.homeMode = homeMode >= 0 ? homeMode : ( 0777 & ~umask );
+    }
+    if ( !sysGidMaxSet )
+    {
+        m_settings.sysGidMax = m_settings.gidMin - 1;
+    }
+
+    QFile useraddDefaults( targetPath( QStringLiteral( "/etc/default/useradd" ) ) );
+    if ( useraddDefaults.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        while ( !useraddDefaults.atEnd() )
+        {
+            const QString line = QString::fromUtf8( useraddDefaults.readLine() ).trimmed();
+            const QString key = line.section( '=', 0, 0 ).trimmed();
+            const QString value = line.section( '=', 1 ).trimmed();
+            if ( key == "SHELL" )
+            {
+                m_settings.shell = value;
+            }
+            else if ( key == "SKEL" && !value.isEmpty() )
+            {
+                m_settings.skel = value;
+            }
+            else if ( key == "HOME" && !value.isEmpty() )
+            {
+                m_settings.homeBase = value;
+            }
+        }
+    }
+}
+
+bool
+AccountDatabase::load( const QString& rootMountPoint )
+{
+    if ( m_loaded && rootMountPoint == m_root )
+    {
+        return m_usable;
+    }
+
+    m_root = rootMountPoint;
+    m_loaded = true;
+    m_usable = false;
+    m_files = {};
+
+#ifdef __FreeBSD__
+    cDebug() << "Account files are not edited in-process on FreeBSD.";
+    return false;
+#endif
+
+    if ( !nssUsesFiles() )
+    {
+        return false;
+    }
+
+    for ( int i = 0; i < int( m_files.size() ); ++i )
+    {
+        const File f = static_cast< File >( i );
+        QFile accountFile( path( f ) );
+        if ( !accountFile.exists() )
+        {
+            continue;
+        }
+        if ( !accountFile.open( QIODevice::ReadOnly ) )
+        {
+            cWarning() << "Cannot read" << accountFile.fileName();
+            return false;
+        }
+        AccountFile& a = file( f );
+        a.lines = QString::fromUtf8( accountFile.readAll() ).split( '\n' );
+        if ( !a.lines.isEmpty() && a.lines.last().isEmpty() )
+        {
+            a.lines.removeLast();
+        }
+        a.exists = true;
+    }
+
+    if ( !file( File::Passwd ).exists || !file( File::Shadow ).exists || !file( File::Group ).exists )
+    {
+        cDebug() << "Target system has no shadow password files in" << m_root;
+        return false;
+    }
+    // NIS entries in the files (for compat lookups) are not something we want to touch
+    for ( File f : { File::Passwd, File::Group } )
+    {
+        const auto& lines = file( f ).lines;
+        if ( std::any_of( lines.cbegin(), lines.cend(), []( const QString& line ) {
+                 return line.startsWith( '+' ) || line.startsWith( '-' );
+             } ) )
+        {
+            cDebug() << "Account files in" << m_root << "contain NIS entries.";
+            return false;
+        }
+    }
+
+    loadSettings();
+    m_usable = true;
+    return true;
+}
+
+bool
+AccountDatabase::isModified() const
+{
+    return std::any_of( m_files.cbegin(), m_files.cend(), []( const AccountFile& f ) { return f.modified; } );
+}
+
+bool
+AccountDatabase::hasUser( const QString& login ) const
+{
+    return findEntry( file( File::Passwd ).lines, login ) >= 0;
+}
+
+bool
+AccountDatabase::hasGroup( const QString& name ) const
+{
+    return findEntry( file( File::Group ).lines, name ) >= 0;
+}
+
+QStringList
+AccountDatabase::groups() const
+{
+    QStringList names;
+    for ( const auto& line : file( File::Group ).lines )
+    {
+        const QString name = line.section( ':', 0, 0 );
+        if ( !name.isEmpty() && !name.startsWith( '#' ) && line.contains( ':' ) )
+        {
+            names.append( name );
+        }
+    }
+    return names;
+}
+
+int
+AccountDatabase::userId( const QString& login ) const
+{
+    const auto& lines = file( File::Passwd ).lines;
+    const int index = findEntry( lines, login );
+    bool ok = false;
+    const int id = index < 0 ? -1 : lines.at( index ).section( ':', 2, 2 ).toInt( &ok );
+    return ok ? id : -1;
+}
+
+int
+AccountDatabase::groupId( const QString& name ) const
+{
+    const auto& lines = file( File::Group ).lines;
+    const int index = findEntry( lines, name );
+    bool ok = false;
+    const int id = index < 0 ? -1 : lines.at( index ).section( ':', 2, 2 ).toInt( &ok );
+    return ok ? id : -1;
+}
+
+int
+AccountDatabase::freeUserId() const
+{
+    return freeId( usedIds( file( File::Passwd ).lines ), m_settings.uidMin, m_settings.uidMax, false );
+}
+
+int
+AccountDatabase::freeGroupId( bool isSystemGroup, int preferred ) const
+{
+    const auto used = usedIds( file( File::Group ).lines );
+    if ( preferred >= 0 && !used.count( preferred ) )
+    {
+        return preferred;
+    }
+    return isSystemGroup ? freeId( used, m_settings.sysGidMin, m_settings.sysGidMax, true )
+                         : freeId( used, m_settings.gidMin, m_settings.gidMax, false );
+}
+
+bool
+AccountDatabase::addGroup( const QString& name, bool isSystemGroup )
+{
+    if ( !m_usable || name.isEmpty() || !isValidField( name ) || hasGroup( name ) )
+    {
+        return false;
+    }
+    const int gid = freeGroupId( isSystemGroup );
+    if ( gid < 0 )
+    {
+        cWarning() << "No free group id for" << name;
+        return false;
+    }
+
+    AccountFile& group = file( File::Group );
+    group.lines.append( QStringLiteral( "%1:x:%2:" ).arg( name ).arg( gid ) );
+    group.modified = true;
+
+    AccountFile& gshadow = file( File::GShadow );
+    if ( gshadow.exists )
+    {
+        gshadow.lines.append( name + QStringLiteral( ":!::" ) );
+        gshadow.modified = true;
+    }
+    return true;
+}
+
+void
+AccountDatabase::addSubordinateIds( File f, const QString& login, qlonglong min, qlonglong max, qlonglong count )
+{
+    AccountFile& sub = file( f );
+    if ( !sub.exists || count <= 0 || findEntry( sub.lines, login ) >= 0 )
+    {
+        return;
+    }
+
+    // Start after the last range that is already handed out
+    qlonglong start = min;
+    for ( const auto& line : sub.lines )
+    {
+        bool startOk = false;
+        bool countOk = false;
+        const qlonglong rangeStart = line.section( ':', 1, 1 ).toLongLong( &startOk );
+        const qlonglong rangeCount = line.section( ':', 2, 2 ).toLongLong( &countOk );
+        if ( startOk && countOk )
+        {
+            start = std::max( start, rangeStart + rangeCount );
+        }
+    }
+    if ( start + count - 1 > max )
+    {
+        cWarning() << "No free subordinate ids for" << login << "in" << path( f );
+        return;
+    }
+    sub.lines.append( QStringLiteral( "%1:%2:%3" ).arg( login ).arg( start ).arg( count ) );
+    sub.modified = true;
+}
+
+bool
+AccountDatabase::addUser( const QString& login, const QString& fullName, const QString& shell )
+{
+    if ( !m_usable || login.isEmpty() || !isValidField( login ) || !isValidField( fullName )
+         || !isValidField( shell ) )
+    {
+        return false;
+    }
+    if ( hasUser( login ) || hasGroup( login ) )
+    {
+        cWarning() << "User or group" << login << "already exists.";
+        return false;
+    }
+
+    const int uid = freeUserId();
+    const int gid = freeGroupId( false, uid );
+    if ( uid < 0 || gid < 0 )
+    {
+        cWarning() << "No free user or group id for" << login;
+        return false;
+    }
+
+    const QString home = QDir::cleanPath( m_settings.homeBase + '/' + login );
+    AccountFile& passwd = file( File::Passwd );
+    passwd.lines.append( QStringList { login,
+                                       QStringLiteral( "x" ),
+                                       QString::number( uid ),
+                                       QString::number( gid ),
+                                       fullName,
+                                       home,
+                                       shell.isEmpty() ? m_settings.shell : shell }
+                             .join( ':' ) );
+    passwd.modified = true;
+
+    const qint64 today = QDateTime::currentSecsSinceEpoch() / ( 24 * 60 * 60 );
+    AccountFile& shadow = file( File::Shadow );
+    shadow.lines.append( QStringList { login,
+                                       QStringLiteral( "!" ),
+                                       QString::number( today ),
+                                       m_settings.passMinDays,
+                                       m_settings.passMaxDays,
+                                       m_settings.passWarnAge,
+                                       QString(),
+                                       QString(),
+                                       QString() }
+                             .join( ':' ) );
+    shadow.modified = true;
+
+    AccountFile& group = file( File::Group );
+    group.lines.append( QStringLiteral( "%1:x:%2:" ).arg( login ).arg( gid ) );
+    group.modified = true;
+    AccountFile& gshadow = file( File::GShadow );
+    if ( gshadow.exists )
+    {
+        gshadow.lines.append( login + QStringLiteral( ":!::" ) );
+        gshadow.modified = true;
+    }
+
+    addSubordinateIds( File::SubUid, login, m_settings.subUidMin, m_settings.subUidMax, m_settings.subUidCount );
+    addSubordinateIds( File::SubGid, login, m_settings.subGidMin, m_settings.subGidMax, m_settings.subGidCount );
+    return true;
+}
+
+/// @brief Adds @p login to the comma-separated list in field @p field of the @p name line
+static void
+addMember( QStringList& lines, const QString& name, int field, const QString& login )
+{
+    const int index = findEntry( lines, name );
+    if ( index < 0 )
+    {
+        return;
+    }
+    QStringList fields = lines.at( index ).split( ':' );
+    while ( fields.count() <= field )
+    {
+        fields.append( QString() );
+    }
+    QStringList members = fields.at( field ).split( ',', SplitSkipEmptyParts );
+    if ( !members.contains( login ) )
+    {
+        members.append( login );
+        fields[ field ] = members.join( ',' );
+        lines[ index ] = fields.join( ':' );
+    }
+}
+
+bool
+AccountDatabase::addUserToGroups( const QString& login, const QStringList& groups )
+{
+    if ( !m_usable || !hasUser( login ) )
+    {
+        return false;
+    }
+    for ( const auto& g : groups )
+    {
+        if ( !hasGroup( g ) )
+        {
+            cWarning() << "Cannot add" << login << "to non-existent group" << g;
+            return false;
+        }
+    }
+
+    AccountFile& group = file( File::Group );
+    AccountFile& gshadow = file( File::GShadow );
+    for ( const auto& g : groups )
+    {
+        addMember( group.lines, g, 3, login );
+        if ( gshadow.exists )
+        {
+            addMember( gshadow.lines, g, 3, login );
+        }
+    }
+    group.modified = true;
+    gshadow.modified = gshadow.exists;
+    return true;
+}
+
+bool
+AccountDatabase::setPassword( const QString& login, const QString& encrypted )
+{
+    AccountFile& shadow = file( File::Shadow );
+    const int index = findEntry( shadow.lines, login );
+    if ( !m_usable || index < 0 || !isValidField( encrypted ) )
+    {
+        return false;
+    }
+
+    QStringList fields = shadow.lines.at( index ).split( ':' );
+    if ( fields.count() < 2 )
+    {
+        return false;
+    }
+    fields[ 1 ] = encrypted;
+    shadow.lines[ index ] = fields.join( ':' );
+    shadow.modified = true;
+    return true;
+}
+
+bool
+AccountDatabase::lockPassword( const QString& login )
+{
+    // passwd -d empties the password, then -l prefixes a !
+    return setPassword( login, QStringLiteral( "!" ) );
+}
+
+/// @brief Sets ownership of @p dir and everything in it (like `chown -R`)
+static bool
+chownTree( const QString& dir, uid_t uid, gid_t gid, QString& error )
+{
+    if ( lchown( QFile::encodeName( dir ).constData(), uid, gid ) )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( dir, errorString() );
+        return false;
+    }
+    QDirIterator it( dir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                     QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        const QString path = it.next();
+        if ( lchown( QFile::encodeName( path ).constData(), uid, gid ) )
+        {
+            error = QStringLiteral( "%1: %2" ).arg( path, errorString() );
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Copies the tree at @p from to @p to, owned by @p uid and @p gid
+ *
+ * Directories, regular files and symlinks are copied, with their
+ * permissions. Other kinds of files are skipped.
+ */
+static bool
+copyTree( const QString& from, const QString& to, uid_t uid, gid_t gid, QString& error )
+{
+    const QDir source( from );
+    QDirIterator it( from, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                     QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        const QString sourcePath = it.next();
+        const QString targetPath = to + '/' + source.relativeFilePath( sourcePath );
+        const QByteArray sourceName = QFile::encodeName( sourcePath );
+        const QByteArray targetName = QFile::encodeName( targetPath );
+
+        struct stat st;
+        if ( lstat( sourceName.constData(), &st ) )
+        {
+            error = QStringLiteral( "%1: %2" ).arg( sourcePath, errorString() );
+            return false;
+        }
+        if ( S_ISDIR( st.st_mode ) )
+        {
+            if ( mkdir( targetName.constData(), st.st_mode & 07777 ) && errno != EEXIST )
+            {
+                error = QStringLiteral( "%1: %2" ).arg( targetPath, errorString() );
+                return false;
+            }
+        }
+        else if ( S_ISLNK( st.st_mode ) )
+        {
+            QByteArray link( int( st.st_size ) + 1, '\0' );
+            const ssize_t length = readlink( sourceName.constData(), link.data(), size_t( link.size() ) );
+            if ( length < 0 || symlink( link.left( int( length ) ).constData(), targetName.constData() ) )
+            {
+                error = QStringLiteral( "%1: %2" ).arg( targetPath, errorString() );
+                return false;
+            }
+        }
+        else if ( S_ISREG( st.st_mode ) )
+        {
+            if ( !QFile::copy( sourcePath, targetPath ) )
+            {
+                error = QStringLiteral( "Cannot copy %1" ).arg( sourcePath );
+                return false;
+            }
+        }
+        else
+        {
+            continue;
+        }
+        if ( lchown( targetName.constData(), uid, gid )
+             || ( !S_ISLNK( st.st_mode ) && chmod( targetName.constData(), st.st_mode & 07777 ) ) )
+        {
+            error = QStringLiteral( "%1: %2" ).arg( targetPath, errorString() );
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+AccountDatabase::createHome( const QString& login, QString& error ) const
+{
+    const auto& lines = file( File::Passwd ).lines;
+    const int index = findEntry( lines, login );
+    if ( !m_usable || index < 0 )
+    {
+        error = QStringLiteral( "No user %1" ).arg( login );
+        return false;
+    }
+    const QStringList fields = lines.at( index ).split( ':' );
+    const uid_t uid = fields.value( 2 ).toUInt();
+    const gid_t gid = fields.value( 3 ).toUInt();
+    const QString home = targetPath( fields.value( 5 ) );
+    if ( fields.value( 5 ).isEmpty() )
+    {
+        error = QStringLiteral( "User %1 has no home directory" ).arg( login );
+        return false;
+    }
+
+    if ( QFileInfo::exists( home ) )
+    {
+        // Like useradd -m, don't copy the skeleton over an existing home
+        return chownTree( home, uid, gid, error );
+    }
+
+    const QByteArray homeName = QFile::encodeName( home );
+    if ( !QDir().mkpath( QFileInfo( home ).absolutePath() )
+         || mkdir( homeName.constData(), mode_t( m_settings.homeMode ) )
+         || chmod( homeName.constData(), mode_t( m_settings.homeMode ) ) || lchown( homeName.constData(), uid, gid ) )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( home, errorString() );
+        return false;
+    }
+    const QString skel = targetPath( m_settings.skel );
+    return QFileInfo( skel ).isDir() ? copyTree( skel, home, uid, gid, error ) : true;
+}
+
+/// @brief Writes @p contents to a new file @p path with the mode and owner of @p original
+static bool
+writeLike( const QString& original, const QString& path, const QByteArray& contents, QString& error )
+{
+    const QByteArray originalName = QFile::encodeName( original );
+    const QByteArray name = QFile::encodeName( path );
+    struct stat st;
+    if ( stat( originalName.constData(), &st ) )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( original, errorString() );
+        return false;
+    }
+
+    unlink( name.constData() );
+    int fd = open( name.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+    if ( fd < 0 )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( path, errorString() );
+        return false;
+    }
+
+    bool ok = fchown( fd, st.st_uid, st.st_gid ) == 0 && fchmod( fd, st.st_mode & 07777 ) == 0;
+    const char* data = contents.constData();
+    qint64 remaining = contents.size();
+    while ( ok && remaining > 0 )
+    {
+        const ssize_t written = write( fd, data, size_t( remaining ) );
+        if ( written < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        ok = written > 0;
+        data += written;
+        remaining -= written;
+    }
+    ok = ok && fsync( fd ) == 0;
+    if ( !ok )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( path, errorString() );
+    }
+    ok = ( close( fd ) == 0 ) && ok;
+    if ( !ok )
+    {
+        unlink( name.constData() );
+    }
+    return ok;
+}
+
+bool
+AccountDatabase::commit( QString& error )
+{
+    if ( !m_usable )
+    {
+        error = QStringLiteral( "Account files of %1 cannot be edited." ).arg( m_root );
+        return false;
+    }
+    if ( !isModified() )
+    {
+        return true;
+    }
+
+    // Same lock as lckpwdf(), in the target system
+    const QByteArray lockName = QFile::encodeName( targetPath( QStringLiteral( "/etc/.pwd.lock" ) ) );
+    int lockFd = open( lockName.constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600 );
+    if ( lockFd < 0 )
+    {
+        error = QStringLiteral( "%1: %2" ).arg( QFile::decodeName( lockName ), errorString() );
+        return false;
+    }
+    struct flock lock;
+    memset( &lock, 0, sizeof( lock ) );
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    int attempts = 150;  // 15 seconds, like lckpwdf()
+    while ( fcntl( lockFd, F_SETLK, &lock ) )
+    {
+        if ( ( errno != EAGAIN && errno != EACCES && errno != EINTR ) || --attempts <= 0 )
+        {
+            error = QStringLiteral( "Cannot lock the account files: %1" ).arg( errorString() );
+            close( lockFd );
+            return false;
+        }
+        QThread::msleep( 100 );
+    }
+
+    // Write all the new files, and only then replace the old ones
+    QList< int > written;
+    bool ok = true;
+    for ( int i = 0; ok && i < int( m_files.size() ); ++i )
+    {
+        const AccountFile& f = m_files[ i ];
+        if ( !f.modified )
+        {
+            continue;
+        }
+        const QString original = path( static_cast< File >( i ) );
+        ok = writeLike( original, original + '+', ( f.lines.join( '\n' ) + '\n' ).toUtf8(), error );
+        if ( ok )
+        {
+            written.append( i );
+        }
+    }
+    QList< int > replaced;
+    for ( int i : written )
+    {
+        const QString original = path( static_cast< File >( i ) );
+        const QByteArray originalName = QFile::encodeName( original );
+        const QByteArray newName = QFile::encodeName( original + '+' );
+        if ( !ok )
+        {
+            unlink( newName.constData() );
+            continue;
+        }
+
+        // Keep a backup, like the shadow tools do; it is also what a failed commit restores
+        const QByteArray backupName = QFile::encodeName( original + '-' );
+        unlink( backupName.constData() );
+        if ( link( originalName.constData(), backupName.constData() )
+             || rename( newName.constData(), originalName.constData() ) )
+        {
+            error = QStringLiteral( "%1: %2" ).arg( original, errorString() );
+            ok = false;
+            unlink( newName.constData() );
+            continue;
+        }
+        replaced.append( i );
+    }
+    for ( int i : replaced )
+    {
+        if ( ok )
+        {
+            m_files[ i ].modified = false;
+            continue;
+        }
+        // Put back the files that were already replaced, so they stay consistent with each other
+        const QString original = path( static_cast< File >( i ) );
+        if ( rename( QFile::encodeName( original + '-' ).constData(), QFile::encodeName( original ).constData() ) )
+        {
+            cError() << "Could not restore" << original << "from its backup" << errorString();
+        }
+    }
+
+    close( lockFd );  // Releases the lock
+    return ok;
+}
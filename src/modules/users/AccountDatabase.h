@@ -0,0 +1,177 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2021 Adriaan de Groot <groot@kde.org>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/**@file In-process editing of the account files of the target system
+ *
+ * Creating users and groups and setting passwords is traditionally
+ * done by running `useradd`, `groupadd`, `usermod` and `passwd` in
+ * the target system, each of them a process in a chroot. When the
+ * target system keeps its accounts in plain files (which is the case
+ * for freshly-installed systems nearly everywhere), the users module
+ * edits those files directly instead, collecting all the changes
+ * and writing them back in one go.
+ */
+
+#ifndef USERS_ACCOUNTDATABASE_H
+#define USERS_ACCOUNTDATABASE_H
+
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <memory>
+
+/** @brief The account files of a target system
+ *
+ * Reads `/etc/passwd`, `/etc/shadow`, `/etc/group` and `/etc/gshadow`
+ * (and `/etc/subuid` and `/etc/subgid`, if they exist) relative to
+ * a root directory. Changes are made in memory, and written back by
+ * commit(), which takes the same lock that `lckpwdf()` does and
+ * replaces each changed file atomically, keeping a backup `file-`
+ * just like the shadow tools do.
+ *
+ * The database is only usable if NSS in the target system looks up
+ * accounts in files; if it uses LDAP, SSSD, NIS or anything else
+ * that we can't edit, load() returns @c false and the tools should
+ * be used instead. On FreeBSD (which has its own password database
+ * format) it is never usable.
+ *
+ * Allocation of user and group ids follows what the shadow tools do,
+ * with the settings from the target's `/etc/login.defs`.
+ */
+class AccountDatabase
+{
+public:
+    AccountDatabase();
+
+    /** @brief Load the account files from @p rootMountPoint
+     *
+     * Returns @c true if the files could be read and can be edited
+     * in-process. Loading again for the same root directory does
+     * nothing and returns the same result as before.
+     */
+    bool load( const QString& rootMountPoint );
+    /// @brief Was load() successful?
+    bool isUsable() const { return m_usable; }
+    /// @brief Are there changes that have not been committed yet?
+    bool isModified() const;
+
+    bool hasUser( const QString& login ) const;
+    bool hasGroup( const QString& name ) const;
+    /// @brief Names of all the groups (from `/etc/group`)
+    QStringList groups() const;
+    /// @brief The user id of @p login, or -1 if there is no such user
+    int userId( const QString& login ) const;
+    /// @brief The group id of @p name, or -1 if there is no such group
+    int groupId( const QString& name ) const;
+
+    /** @brief Add group @p name (like `groupadd`)
+     *
+     * System groups get an id from the system range, counting down.
+     * Returns @c false if the group exists already or no id is free.
+     */
+    bool addGroup( const QString& name, bool isSystemGroup );
+    /** @brief Add user @p login (like `useradd -U`)
+     *
+     * This also adds a user-private group named @p login.
+     * The password is locked, use setPassword() to change that.
+     * An empty @p shell uses the default shell from `/etc/default/useradd`.
+     * The home directory is not created, see createHome().
+     */
+    bool addUser( const QString& login, const QString& fullName, const QString& shell );
+    /// @brief Add @p login to each of the @p groups (like `usermod -aG`)
+    bool addUserToGroups( const QString& login, const QStringList& groups );
+    /// @brief Set the (already encrypted) password for @p login (like `usermod -p`)
+    bool setPassword( const QString& login, const QString& encrypted );
+    /// @brief Remove and lock the password for @p login (like `passwd -dl`)
+    bool lockPassword( const QString& login );
+
+    /** @brief Create the home directory for @p login (like `useradd -m`)
+     *
+     * The home directory is populated from the skeleton directory
+     * (`/etc/skel` unless configured otherwise) and everything is
+     * owned by the user and their primary group. If the home directory
+     * exists already, nothing is copied, but ownership of everything
+     * in it is still set to the user. Returns @c false on failure,
+     * with a message in @p error.
+     */
+    bool createHome( const QString& login, QString& error ) const;
+
+    /** @brief Write the changes back to the files
+     *
+     * All of the changed files are written to temporary files first,
+     * and only if that succeeds for all of them, are they renamed
+     * over the originals (keeping a backup with a `-` suffix). If one
+     * of the renames fails, the files already renamed are restored from
+     * their backups. Returns @c false on failure, with a message
+     * in @p error; the original files are unchanged in that case.
+     */
+    bool commit( QString& error );
+
+private:
+    /// @brief Which account file (index into m_files)
+    enum class File
+    {
+        Passwd,
+        Shadow,
+        Group,
+        GShadow,
+        SubUid,
+        SubGid
+    };
+    struct AccountFile
+    {
+        QStringList lines;
+        bool exists = false;
+        bool modified = false;
+    };
+    struct Settings
+    {
+        int uidMin = 1000;
+        int uidMax = 60000;
+        int gidMin = 1000;
+        int gidMax = 60000;
+        int sysGidMin = 101;
+        int sysGidMax = 999;
+        int homeMode = 0755;
+        qlonglong subUidMin = 100000;
+        qlonglong subUidMax = 600100000;
+        qlonglong subUidCount = 65536;
+        qlonglong subGidMin = 100000;
+        qlonglong subGidMax = 600100000;
+        qlonglong subGidCount = 65536;
+        QString passMinDays;
+        QString passMaxDays;
+        QString passWarnAge;
+        QString shell;
+        QString skel = QStringLiteral( "/etc/skel" );
+        QString homeBase = QStringLiteral( "/home" );
+    };
+
+    AccountFile& file( File f ) { return m_files[ static_cast< int >( f ) ]; }
+    const AccountFile& file( File f ) const { return m_files[ static_cast< int >( f ) ]; }
+    QString path( File f ) const;
+    QString targetPath( const QString& path ) const;
+
+    bool nssUsesFiles() const;
+    void loadSettings();
+    int freeUserId() const;
+    int freeGroupId( bool isSystemGroup, int preferred = -1 ) const;
+    void addSubordinateIds( File f, const QString& login, qlonglong min, qlonglong max, qlonglong count );
+
+    QString m_root;
+    bool m_loaded = false;
+    bool m_usable = false;
+    Settings m_settings;
+    std::array< AccountFile, 6 > m_files;
+};
+
+using AccountDatabasePtr = std::shared_ptr< AccountDatabase >;
+
+#endif
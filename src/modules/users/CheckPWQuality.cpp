@@ -26,15 +26,22 @@
 
 PasswordCheck::PasswordCheck()
     : m_weight( 0 )
-    , m_message()
-    , m_accept( []( const QString& ) { return true; } )
+    , m_cost( Cost::Cheap )
+    , m_check( []( const QString& ) { return QString(); } )
 {
 }
 
 PasswordCheck::PasswordCheck( MessageFunc m, AcceptFunc a, Weight weight )
     : m_weight( weight )
-    , m_message( m )
-    , m_accept( a )
+    , m_cost( Cost::Cheap )
+    , m_check( [m, a]( const QString& s ) { return a( s ) ? QString() : m(); } )
+{
+}
+
+PasswordCheck::PasswordCheck( CheckFunc check, Weight weight, Cost cost )
+    : m_weight( weight )
+    , m_cost( cost )
+    , m_check( check )
 {
 }
 
@@ -96,12 +103,24 @@ mungeString( void* p )
  * Class that acts as a RAII placeholder for pwquality_settings_t pointers.
  * Gets a new pointer and ensures it is deleted only once; provides
  * convenience functions for setting options and checking passwords.
+ *
+ * The settings are set up once, when the configuration is read, and
+ * then shared by all the checks. Checking does not modify the holder,
+ * so checks may run in parallel (in background threads).
  */
 class PWSettingsHolder
 {
 public:
     static constexpr int arbitrary_minimum_strength = 40;
 
+    /// @brief The outcome of a single check()
+    struct Result
+    {
+        int rv = 0;  ///< Return value from libpwquality
+        QString errorString;  ///< Textual error from libpwquality
+        int errorCount = 0;  ///< Count (used in %n) error from libpwquality
+    };
+
     PWSettingsHolder()
         : m_settings( pwquality_default_settings() )
     {
@@ -114,28 +133,24 @@ public:
 
     /** @brief Checks the given password @p pwd against the current configuration
      *
-     * Resets m_errorString and m_errorCount and then sets them appropriately
-     * so that explanation() can be called afterwards. Sets m_rv as well.
+     * The result can be passed to explanation() afterwards.
      */
-
-    int check( const QString& pwd )
+    Result check( const QString& pwd ) const
     {
+        Result r;
         void* auxerror = nullptr;
-        m_rv = pwquality_check( m_settings, pwd.toUtf8().constData(), nullptr, nullptr, &auxerror );
+        r.rv = pwquality_check( m_settings, pwd.toUtf8().constData(), nullptr, nullptr, &auxerror );
 
         // Positive return values could be ignored; some negative ones
         // place extra information in auxerror, which is a void* and
         // which needs interpretation to long- or string-values.
-        m_errorCount = 0;
-        m_errorString = QString();
-
-        switch ( m_rv )
+        switch ( r.rv )
         {
         case PWQ_ERROR_CRACKLIB_CHECK:
             if ( auxerror )
             {
                 /* Here the string comes from cracklib, don't free? */
-                m_errorString = mungeString( auxerror );
+                r.errorString = mungeString( auxerror );
             }
             break;
         case PWQ_ERROR_MEM_ALLOC:
@@ -145,7 +160,7 @@ public:
         case PWQ_ERROR_NON_STR_SETTING:
             if ( auxerror )
             {
-                m_errorString = mungeString( auxerror );
+                r.errorString = mungeString( auxerror );
                 free( auxerror );
             }
             break;
@@ -160,41 +175,41 @@ public:
         case PWQ_ERROR_MAX_SEQUENCE:
             if ( auxerror )
             {
-                m_errorCount = mungeLong( auxerror );
+                r.errorCount = mungeLong( auxerror );
             }
             break;
         default:
             break;
         }
 
-        return m_rv;
+        return r;
     }
 
-    /** @brief Explain the results of the last call to check()
+    /** @brief Explain the results @p r of a call to check()
      *
      * This is roughly the same as the function pwquality_strerror,
      * only with QStrings instead, and using the Qt translation scheme.
      * It is used under the terms of the GNU GPL v3 or later, as
      * allowed by the libpwquality license (LICENSES/GPLv2+-libpwquality)
      */
-    QString explanation()
+    static QString explanation( const Result& r )
     {
-        if ( m_rv >= arbitrary_minimum_strength )
+        if ( r.rv >= arbitrary_minimum_strength )
         {
             return QString();
         }
-        if ( m_rv >= 0 )
+        if ( r.rv >= 0 )
         {
             return QCoreApplication::translate( "PWQ", "Password is too weak" );
         }
 
-        switch ( m_rv )
+        switch ( r.rv )
         {
         case PWQ_ERROR_MEM_ALLOC:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
                 return QCoreApplication::translate( "PWQ", "Memory allocation error when setting '%1'" )
-                    .arg( m_errorString );
+                    .arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "Memory allocation error" );
         case PWQ_ERROR_SAME_PASSWORD:
@@ -213,75 +228,75 @@ public:
         case PWQ_ERROR_BAD_WORDS:
             return QCoreApplication::translate( "PWQ", "The password contains forbidden words in some form" );
         case PWQ_ERROR_MIN_DIGITS:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains fewer than %n digits", nullptr, m_errorCount );
+                    "PWQ", "The password contains fewer than %n digits", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password contains too few digits" );
         case PWQ_ERROR_MIN_UPPERS:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains fewer than %n uppercase letters", nullptr, m_errorCount );
+                    "PWQ", "The password contains fewer than %n uppercase letters", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password contains too few uppercase letters" );
         case PWQ_ERROR_MIN_LOWERS:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains fewer than %n lowercase letters", nullptr, m_errorCount );
+                    "PWQ", "The password contains fewer than %n lowercase letters", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password contains too few lowercase letters" );
         case PWQ_ERROR_MIN_OTHERS:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains fewer than %n non-alphanumeric characters", nullptr, m_errorCount );
+                    "PWQ", "The password contains fewer than %n non-alphanumeric characters", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password contains too few non-alphanumeric characters" );
         case PWQ_ERROR_MIN_LENGTH:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password is shorter than %n characters", nullptr, m_errorCount );
+                    "PWQ", "The password is shorter than %n characters", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password is too short" );
         case PWQ_ERROR_ROTATED:
             return QCoreApplication::translate( "PWQ", "The password is a rotated version of the previous one" );
         case PWQ_ERROR_MIN_CLASSES:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains fewer than %n character classes", nullptr, m_errorCount );
+                    "PWQ", "The password contains fewer than %n character classes", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password does not contain enough character classes" );
         case PWQ_ERROR_MAX_CONSECUTIVE:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
-                    "PWQ", "The password contains more than %n same characters consecutively", nullptr, m_errorCount );
+                    "PWQ", "The password contains more than %n same characters consecutively", nullptr, r.errorCount );
             }
             return QCoreApplication::translate( "PWQ", "The password contains too many same characters consecutively" );
         case PWQ_ERROR_MAX_CLASS_REPEAT:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
                     "PWQ",
                     "The password contains more than %n characters of the same class consecutively",
                     nullptr,
-                    m_errorCount );
+                    r.errorCount );
             }
             return QCoreApplication::translate(
                 "PWQ", "The password contains too many characters of the same class consecutively" );
         case PWQ_ERROR_MAX_SEQUENCE:
-            if ( m_errorCount )
+            if ( r.errorCount )
             {
                 return QCoreApplication::translate(
                     "PWQ",
                     "The password contains monotonic sequence longer than %n characters",
                     nullptr,
-                    m_errorCount );
+                    r.errorCount );
             }
             return QCoreApplication::translate( "PWQ",
                                                 "The password contains too long of a monotonic character sequence" );
@@ -293,34 +308,34 @@ public:
             return QCoreApplication::translate( "PWQ",
                                                 "Password generation failed - required entropy too low for settings" );
         case PWQ_ERROR_CRACKLIB_CHECK:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
                 return QCoreApplication::translate( "PWQ", "The password fails the dictionary check - %1" )
-                    .arg( m_errorString );
+                    .arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "The password fails the dictionary check" );
         case PWQ_ERROR_UNKNOWN_SETTING:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
-                return QCoreApplication::translate( "PWQ", "Unknown setting - %1" ).arg( m_errorString );
+                return QCoreApplication::translate( "PWQ", "Unknown setting - %1" ).arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "Unknown setting" );
         case PWQ_ERROR_INTEGER:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
-                return QCoreApplication::translate( "PWQ", "Bad integer value of setting - %1" ).arg( m_errorString );
+                return QCoreApplication::translate( "PWQ", "Bad integer value of setting - %1" ).arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "Bad integer value" );
         case PWQ_ERROR_NON_INT_SETTING:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
-                return QCoreApplication::translate( "PWQ", "Setting %1 is not of integer type" ).arg( m_errorString );
+                return QCoreApplication::translate( "PWQ", "Setting %1 is not of integer type" ).arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "Setting is not of integer type" );
         case PWQ_ERROR_NON_STR_SETTING:
-            if ( !m_errorString.isEmpty() )
+            if ( !r.errorString.isEmpty() )
             {
-                return QCoreApplication::translate( "PWQ", "Setting %1 is not of string type" ).arg( m_errorString );
+                return QCoreApplication::translate( "PWQ", "Setting %1 is not of string type" ).arg( r.errorString );
             }
             return QCoreApplication::translate( "PWQ", "Setting is not of string type" );
         case PWQ_ERROR_CFGFILE_OPEN:
@@ -335,10 +350,6 @@ public:
     }
 
 private:
-    QString m_errorString;  ///< Textual error from last call to check()
-    int m_errorCount = 0;  ///< Count (used in %n) error from last call to check()
-    int m_rv = 0;  ///< Return value from libpwquality
-
     pwquality_settings_t* m_settings = nullptr;
 };
 
@@ -378,21 +389,22 @@ DEFINE_CHECK_FUNC( libpwquality )
     /* Something actually added? */
     if ( requirement_count )
     {
-        checks.push_back( PasswordCheck( [settings]() { return settings->explanation(); },
-                                         [settings]( const QString& s ) {
-                                             int r = settings->check( s );
-                                             if ( r < 0 )
-                                             {
-                                                 cWarning() << "libpwquality error" << r
-                                                            << pwquality_strerror( nullptr, 256, r, nullptr );
-                                             }
-                                             else if ( r < settings->arbitrary_minimum_strength )
-                                             {
-                                                 cDebug() << "Password strength" << r << "too low";
-                                             }
-                                             return r >= settings->arbitrary_minimum_strength;
-                                         },
-                                         PasswordCheck::Weight( 100 ) ) );
+        // The dictionary lookup is what makes this expensive
+        checks.push_back( PasswordCheck(
+            [settings]( const QString& s ) {
+                const auto r = settings->check( s );
+                if ( r.rv < 0 )
+                {
+                    cWarning() << "libpwquality error" << r.rv << pwquality_strerror( nullptr, 256, r.rv, nullptr );
+                }
+                else if ( r.rv < settings->arbitrary_minimum_strength )
+                {
+                    cDebug() << "Password strength" << r.rv << "too low";
+                }
+                return PWSettingsHolder::explanation( r );
+            },
+            PasswordCheck::Weight( 100 ),
+            PasswordCheck::Cost::Expensive ) );
     }
 }
 #endif
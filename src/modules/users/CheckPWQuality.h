@@ -28,9 +28,23 @@ public:
     /** Return true if the string is acceptable. */
     using AcceptFunc = std::function< bool( const QString& ) >;
     using MessageFunc = std::function< QString() >;
+    /** Return an empty string if acceptable, a message otherwise. */
+    using CheckFunc = std::function< QString( const QString& ) >;
 
     using Weight = size_t;
 
+    /** @brief How expensive is a check?
+     *
+     * Cheap checks are run whenever the password changes, expensive
+     * ones (e.g. dictionary lookups) are run in the background,
+     * only once the user stops typing.
+     */
+    enum class Cost
+    {
+        Cheap,
+        Expensive
+    };
+
     /** @brief Generate a @p message if @p filter returns true
      *
      * When @p filter returns true on the proposed password, the
@@ -40,6 +54,12 @@ public:
      * @p weight is used to order the checks (low-weight goes first).
      */
     PasswordCheck( MessageFunc message, AcceptFunc filter, Weight weight = 1000 );
+    /** @brief Run @p check, which returns a message if the password is not accepted
+     *
+     * The @p check must be thread-safe if @p cost is Cost::Expensive,
+     * since it is run in a background thread.
+     */
+    PasswordCheck( CheckFunc check, Weight weight, Cost cost );
     /** @brief Null check, always accepts, no message */
     PasswordCheck();
 
@@ -48,15 +68,16 @@ public:
         *  according to this filter. Returns a message describing
         *  what is wrong if not.
         */
-    QString filter( const QString& s ) const { return m_accept( s ) ? QString() : m_message(); }
+    QString filter( const QString& s ) const { return m_check( s ); }
 
     Weight weight() const { return m_weight; }
+    bool isExpensive() const { return m_cost == Cost::Expensive; }
     bool operator<( const PasswordCheck& other ) const { return weight() < other.weight(); }
 
 private:
     Weight m_weight;
-    MessageFunc m_message;
-    AcceptFunc m_accept;
+    Cost m_cost;
+    CheckFunc m_check;
 };
 
 using PasswordCheckList = QVector< PasswordCheck >;
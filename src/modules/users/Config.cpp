@@ -9,6 +9,7 @@
 
 #include "Config.h"
 
+#include "AccountDatabase.h"
 #include "CreateUserJob.h"
 #include "MiscJobs.h"
 #include "SetHostNameJob.h"
@@ -25,6 +26,7 @@
 #include <QMetaProperty>
 #include <QRegExp>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 #ifdef HAVE_ICU
 #include <unicode/translit.h>
@@ -105,9 +107,26 @@ Config::Config( QObject* parent )
     connect( this, &Config::rootPasswordStatusChanged, this, &Config::checkReady );
     connect( this, &Config::reuseUserPasswordForRootChanged, this, &Config::checkReady );
     connect( this, &Config::requireStrongPasswordsChanged, this, &Config::checkReady );
+
+    // Expensive password checks wait until typing stops
+    m_passwordCheckTimer = new QTimer( this );
+    m_passwordCheckTimer->setSingleShot( true );
+    m_passwordCheckTimer->setInterval( 250 );
+    connect( m_passwordCheckTimer, &QTimer::timeout, this, &Config::checkPasswords );
+    m_passwordCheckWatcher = new QFutureWatcher< QHash< QString, QString > >( this );
+    connect( m_passwordCheckWatcher,
+             &QFutureWatcher< QHash< QString, QString > >::finished,
+             this,
+             &Config::passwordChecksFinished );
 }
 
-Config::~Config() {}
+Config::~Config()
+{
+    if ( m_passwordCheckCancelled )
+    {
+        *m_passwordCheckCancelled = true;
+    }
+}
 
 void
 Config::setUserShell( const QString& shell )
@@ -501,6 +520,7 @@ Config::setUserPassword( const QString& s )
     if ( s != m_userPassword )
     {
         m_userPassword = s;
+        checkPasswordsLater();
         const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary );
         emit userPasswordStatusChanged( p.first, p.second );
         emit userPasswordChanged( s );
@@ -525,6 +545,11 @@ Config::setUserPasswordSecondary( const QString& s )
  * the secondary fields -- checks them for validity and returns
  * a pair of <validity, message>.
  *
+ * Expensive checks are not run here: their results come from
+ * the background checks, and until those are done, the password
+ * is not valid yet (or weak, if weak passwords are allowed).
+ * The empty password is never checked in the background; it is
+ * rejected early (e.g. by libpwquality), so it is checked here.
  */
 Config::PasswordStatus
 Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
@@ -537,7 +562,22 @@ Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
     bool failureIsFatal = requireStrongPasswords();
     for ( const auto& pc : m_passwordChecks )
     {
-        QString message = pc.filter( pw1 );
+        QString message;
+        if ( pc.isExpensive() && !pw1.isEmpty() )
+        {
+            // The result is for all the expensive checks together
+            const auto it = m_passwordCheckResults.constFind( pw1 );
+            if ( it == m_passwordCheckResults.constEnd() )
+            {
+                return qMakePair( failureIsFatal ? PasswordValidity::Invalid : PasswordValidity::Weak,
+                                  tr( "Checking password quality..." ) );
+            }
+            message = it.value();
+        }
+        else
+        {
+            message = pc.filter( pw1 );
+        }
 
         if ( !message.isEmpty() )
         {
@@ -548,6 +588,121 @@ Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
     return qMakePair( PasswordValidity::Valid, tr( "OK!" ) );
 }
 
+/** @brief Runs the expensive checks from @p checks on each of the @p passwords
+ *
+ * For each password, the result is the message from the first check
+ * that fails, or empty if they all pass. This runs in a background
+ * thread; when @p cancelled is set, it stops early.
+ */
+static QHash< QString, QString >
+runExpensivePasswordChecks( const PasswordCheckList& checks,
+                            const QStringList& passwords,
+                            std::shared_ptr< std::atomic_bool > cancelled )
+{
+    QHash< QString, QString > results;
+    for ( const auto& pw : passwords )
+    {
+        QString message;
+        for ( const auto& pc : checks )
+        {
+            if ( *cancelled )
+            {
+                return results;
+            }
+            if ( pc.isExpensive() && message.isEmpty() )
+            {
+                message = pc.filter( pw );
+            }
+        }
+        results.insert( pw, message );
+    }
+    return results;
+}
+
+void
+Config::checkPasswordsLater()
+{
+    if ( std::any_of( m_passwordChecks.cbegin(), m_passwordChecks.cend(), []( const PasswordCheck& pc ) {
+             return pc.isExpensive();
+         } ) )
+    {
+        // Anything already running is for an older password
+        if ( m_passwordCheckCancelled )
+        {
+            *m_passwordCheckCancelled = true;
+        }
+        m_passwordCheckTimer->start();
+    }
+}
+
+void
+Config::checkPasswords()
+{
+    if ( m_passwordCheckWatcher->isRunning() )
+    {
+        // Cancelled already, try again when it's done
+        return;
+    }
+
+    QStringList passwords;
+    for ( const auto& pw : { m_userPassword, m_rootPassword } )
+    {
+        if ( !pw.isEmpty() && !m_passwordCheckResults.contains( pw ) && !passwords.contains( pw ) )
+        {
+            passwords.append( pw );
+        }
+    }
+    if ( passwords.isEmpty() )
+    {
+        return;
+    }
+
+    m_passwordCheckCancelled = std::make_shared< std::atomic_bool >( false );
+    m_passwordCheckWatcher->setFuture(
+        QtConcurrent::run( runExpensivePasswordChecks, m_passwordChecks, passwords, m_passwordCheckCancelled ) );
+}
+
+void
+Config::passwordChecksFinished()
+{
+    const auto results = m_passwordCheckWatcher->result();
+    for ( auto it = results.cbegin(); it != results.cend(); ++it )
+    {
+        m_passwordCheckResults.insert( it.key(), it.value() );
+    }
+    // Only keep the results that might still be useful: the new ones, and those for the current passwords
+    if ( m_passwordCheckResults.count() > 32 )
+    {
+        for ( auto it = m_passwordCheckResults.begin(); it != m_passwordCheckResults.end(); )
+        {
+            if ( results.contains( it.key() ) || it.key() == m_userPassword || it.key() == rootPassword() )
+            {
+                ++it;
+            }
+            else
+            {
+                it = m_passwordCheckResults.erase( it );
+            }
+        }
+    }
+
+    if ( results.contains( m_userPassword ) )
+    {
+        const auto p = userPasswordStatus();
+        emit userPasswordStatusChanged( p.first, p.second );
+    }
+    if ( results.contains( rootPassword() ) )
+    {
+        const auto p = rootPasswordStatus();
+        emit rootPasswordStatusChanged( p.first, p.second );
+    }
+
+    // Something changed while checking: check the new passwords
+    if ( m_passwordCheckCancelled && *m_passwordCheckCancelled && !m_passwordCheckTimer->isActive() )
+    {
+        checkPasswords();
+    }
+}
 
 Config::PasswordStatus
 Config::userPasswordStatus() const
@@ -576,6 +731,7 @@ Config::setRootPassword( const QString& s )
     if ( writeRootPassword() && s != m_rootPassword )
     {
         m_rootPassword = s;
+        checkPasswordsLater();
         const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary );
         emit rootPasswordStatusChanged( p.first, p.second );
         emit rootPasswordChanged( s );
@@ -734,6 +890,50 @@ setConfigurationDefaultGroups( const QVariantMap& map, QList< GroupDescription >
     }
 }
 
+UserDescription
+UserDescription::fromMap( const QVariantMap& map )
+{
+    UserDescription u;
+    u.loginName = CalamaresUtils::getString( map, "name" );
+    u.fullName = CalamaresUtils::getString( map, "fullName" );
+    u.password = CalamaresUtils::getString( map, "password" );
+    u.encryptedPassword = CalamaresUtils::getString( map, "encryptedPassword" );
+    u.shell = CalamaresUtils::getString( map, "shell" );
+    u.useDefaultGroups = !map.contains( "groups" );
+    u.groups = CalamaresUtils::getStringList( map, "groups" );
+    u.createHome = CalamaresUtils::getBool( map, "createHome", true );
+    if ( !u.loginName.isEmpty() && !u.isValid() )
+    {
+        cWarning() << "The *encryptedPassword* of user" << u.loginName << "is not a valid password hash.";
+    }
+    return u;
+}
+
+STATICTEST void
+setConfigurationAdditionalUsers( const QVariantMap& map, QList< UserDescription >& additionalUsers )
+{
+    additionalUsers.clear();
+
+    QStringList seen;
+    for ( const auto& v : map.value( "additionalUsers" ).toList() )
+    {
+        const auto u = UserDescription::fromMap( v.toMap() );
+        if ( !u.isValid() )
+        {
+            cWarning() << "Ignoring invalid *additionalUsers* entry" << u.loginName;
+        }
+        else if ( seen.contains( u.loginName ) )
+        {
+            cWarning() << "Ignoring duplicate *additionalUsers* entry" << u.loginName;
+        }
+        else
+        {
+            seen.append( u.loginName );
+            additionalUsers.append( u );
+        }
+    }
+}
+
 STATICTEST HostNameActions
 getHostNameActions( const QVariantMap& configurationMap )
 {
@@ -844,6 +1044,7 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
     m_hostNameActions = getHostNameActions( configurationMap );
 
     setConfigurationDefaultGroups( configurationMap, m_defaultGroups );
+    setConfigurationAdditionalUsers( configurationMap, m_additionalUsers );
 
     // Renaming of Autologin -> AutoLogin in 4ffa79d4cf also affected
     // configuration keys, which was not intended. Accept both.
@@ -901,6 +1102,8 @@ Config::createJobs() const
     }
 
     Calamares::Job* j;
+    // Shared by the account jobs, written by WriteAccountsJob
+    AccountDatabasePtr accounts = std::make_shared< AccountDatabase >();
 
     if ( !m_sudoersGroup.isEmpty() )
     {
@@ -908,16 +1111,22 @@ Config::createJobs() const
         jobs.append( Calamares::job_ptr( j ) );
     }
 
-    j = new SetupGroupsJob( this );
+    j = new SetupGroupsJob( this, accounts );
+    jobs.append( Calamares::job_ptr( j ) );
+
+    j = new CreateUserJob( this, accounts );
+    jobs.append( Calamares::job_ptr( j ) );
+
+    j = new CreateUsersJob( this, accounts );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new CreateUserJob( this );
+    j = new SetPasswordJob( loginName(), userPassword(), accounts );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new SetPasswordJob( loginName(), userPassword() );
+    j = new SetPasswordJob( "root", rootPassword(), accounts );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new SetPasswordJob( "root", rootPassword() );
+    j = new WriteAccountsJob( accounts );
     jobs.append( Calamares::job_ptr( j ) );
 
     j = new SetHostNameJob( hostName(), hostNameActions() );
@@ -16,10 +16,17 @@
 #include "modulesystem/Config.h"
 #include "utils/NamedEnum.h"
 
+#include <QFutureWatcher>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QVariantMap>
 
+#include <atomic>
+#include <memory>
+
+class QTimer;
+
 enum HostNameAction
 {
     None = 0x0,
@@ -85,6 +92,42 @@ private:
     bool m_isSystem = false;
 };
 
+/** @brief Settings for an additional, preconfigured, user
+ *
+ * Besides the user entered in the UI, the configuration (or
+ * Global Storage) can list any number of additional users to
+ * create; this is used for images that need lots of accounts.
+ */
+struct UserDescription
+{
+    QString loginName;
+    QString fullName;
+    /// Plain-text password; empty (and no encryptedPassword) locks the account
+    QString password;
+    /// Already-encrypted password, as for `usermod -p`; takes precedence
+    QString encryptedPassword;
+    /// Empty for the configured userShell
+    QString shell;
+    QStringList groups;
+    bool useDefaultGroups = true;
+    bool createHome = true;
+
+    /// @brief A name, and (if set) an encrypted password that fits in /etc/shadow
+    bool isValid() const
+    {
+        return !loginName.isEmpty() && !encryptedPassword.contains( ':' ) && !encryptedPassword.contains( '\n' );
+    }
+
+    /** @brief Reads a single user from @p map
+     *
+     * Keys are *name*, *fullName*, *password*, *encryptedPassword*,
+     * *shell*, *groups* and *createHome*. Without a *groups* key,
+     * the user gets the *defaultGroups*. An *encryptedPassword* that
+     * contains a colon or newline makes the user invalid.
+     */
+    static UserDescription fromMap( const QVariantMap& map );
+};
+
 
 class PLUGINDLLEXPORT Config : public Calamares::ModuleSystem::Config
 {
@@ -215,6 +258,8 @@ public:
     bool requireStrongPasswords() const { return m_requireStrongPasswords; }
 
     const QList< GroupDescription >& defaultGroups() const { return m_defaultGroups; }
+    /// Additional users from the configuration (see UserDescription)
+    const QList< UserDescription >& additionalUsers() const { return m_additionalUsers; }
     /** @brief the names of all the groups for the current user
      *
      * Takes into account defaultGroups and autoLogin behavior.
@@ -303,7 +348,13 @@ private:
     PasswordStatus passwordStatus( const QString&, const QString& ) const;
     void checkReady();
 
+    /// @brief Runs the expensive password checks once typing stops
+    void checkPasswordsLater();
+    void checkPasswords();
+    void passwordChecksFinished();
+
     QList< GroupDescription > m_defaultGroups;
+    QList< UserDescription > m_additionalUsers;
     QString m_userShell;
     QString m_autoLoginGroup;
     QString m_sudoersGroup;
@@ -331,6 +382,16 @@ private:
 
     HostNameActions m_hostNameActions;
     PasswordCheckList m_passwordChecks;
+    /** @brief Results of the expensive checks, by password
+     *
+     * The expensive checks (see PasswordCheck::Cost) run in a background
+     * thread, a little while after the password was last changed; until
+     * a result is available here, a password is not (yet) valid.
+     */
+    QHash< QString, QString > m_passwordCheckResults;
+    QTimer* m_passwordCheckTimer = nullptr;
+    QFutureWatcher< QHash< QString, QString > >* m_passwordCheckWatcher = nullptr;
+    std::shared_ptr< std::atomic_bool > m_passwordCheckCancelled;
 };
 
 #endif
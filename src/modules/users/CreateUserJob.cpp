@@ -8,6 +8,7 @@
 #include "CreateUserJob.h"
 
 #include "Config.h"
+#include "SetPasswordJob.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
@@ -15,17 +16,20 @@
 #include "utils/Logger.h"
 #include "utils/Permissions.h"
 
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 #include <QTextStream>
+#include <QtConcurrent/QtConcurrent>
 
 
-CreateUserJob::CreateUserJob( const Config* config )
+CreateUserJob::CreateUserJob( const Config* config, const AccountDatabasePtr& accounts )
     : Calamares::Job()
     , m_config( config )
+    , m_accounts( accounts )
 {
 }
 
@@ -51,22 +55,24 @@ CreateUserJob::prettyStatusMessage() const
 }
 
 static Calamares::JobResult
-createUser( const QString& loginName, const QString& fullName, const QString& shell )
+createUser( const QString& loginName, const QString& fullName, const QString& shell, bool createHome = true )
 {
     QStringList useraddCommand;
 #ifdef __FreeBSD__
     useraddCommand << "pw"
                    << "useradd"
-                   << "-n" << loginName << "-m"
-                   << "-c" << fullName;
+                   << "-n" << loginName;
+    if ( createHome )
+    {
+        useraddCommand << "-m";
+    }
+    useraddCommand << "-c" << fullName;
     if ( !shell.isEmpty() )
     {
         useraddCommand << "-s" << shell;
     }
 #else
-    useraddCommand << "useradd"
-                   << "-m"
-                   << "-U";
+    useraddCommand << "useradd" << ( createHome ? "-m" : "-M" ) << "-U";
     if ( !shell.isEmpty() )
     {
         useraddCommand << "-s" << shell;
@@ -107,6 +113,90 @@ setUserGroups( const QString& loginName, const QStringList& groups )
 }
 
 
+/** @brief Creates the @p groups that don't exist yet in the target system
+ *
+ * This is the equivalent, with the tools in the target, of what the
+ * in-process path does with the account database.
+ */
+static Calamares::JobResult
+createMissingGroups( const QStringList& groups )
+{
+    for ( const auto& g : groups )
+    {
+        if ( CalamaresUtils::System::instance()->targetEnvCall( { "getent", "group", g } ) == 0 )
+        {
+            continue;
+        }
+#ifdef __FreeBSD__
+        const QStringList groupaddCommand { "pw", "groupadd", "-n", g };
+#else
+        const QStringList groupaddCommand { "groupadd", g };
+#endif
+        if ( CalamaresUtils::System::instance()->targetEnvCall( groupaddCommand ) )
+        {
+            cError() << "groupadd failed for" << g;
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot create group %1." ).arg( g ) );
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+/** @brief Moves the dotfiles in @p home to a new directory @p backupDirName
+ *
+ * This is `mv -f .* backup`, without needing a shell for the glob.
+ */
+static void
+backupDotfiles( const QDir& home, const QString& backupDirName )
+{
+    if ( !home.mkdir( backupDirName ) )
+    {
+        cWarning() << "Could not create" << backupDirName << "in" << home.absolutePath();
+        return;
+    }
+    const auto entries = home.entryList( QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot );
+    for ( const auto& name : entries )
+    {
+        if ( !name.startsWith( '.' ) )
+        {
+            continue;
+        }
+        const QString target = backupDirName + '/' + name;
+        if ( !home.rename( name, target ) )
+        {
+            cWarning() << "Could not move" << name << "to" << target;
+        }
+    }
+}
+
+/// @brief Creates the user from @p config in @p accounts, and the home directory
+static Calamares::JobResult
+createUserInProcess( AccountDatabase& accounts, const Config* config )
+{
+    const QString loginName = config->loginName();
+    if ( !accounts.addUser( loginName, config->fullName(), config->userShell() ) )
+    {
+        return Calamares::JobResult::error( QCoreApplication::translate( "CreateUserJob", "Cannot create user %1." )
+                                                .arg( loginName ) );
+    }
+    if ( !accounts.addUserToGroups( loginName, config->groupsForThisUser() ) )
+    {
+        return Calamares::JobResult::error(
+            QCoreApplication::translate( "CreateUserJob", "Cannot add user %1 to groups: %2." )
+                .arg( loginName, config->groupsForThisUser().join( ',' ) ) );
+    }
+    QString error;
+    if ( !accounts.createHome( loginName, error ) )
+    {
+        cError() << "Could not create home directory" << error;
+        return Calamares::JobResult::error(
+            QCoreApplication::translate( "CreateUserJob", "Cannot create home directory for user %1." )
+                .arg( loginName ),
+            error );
+    }
+    return Calamares::JobResult::ok();
+}
+
 Calamares::JobResult
 CreateUserJob::exec()
 {
@@ -130,16 +220,19 @@ CreateUserJob::exec()
         if ( existingHome.exists() )
         {
             QString backupDirName = "dotfiles_backup_" + QDateTime::currentDateTime().toString( "yyyy-MM-dd_HH-mm-ss" );
-            existingHome.mkdir( backupDirName );
-
-            // We need the extra `sh -c` here to ensure that we can expand the shell globs
-            CalamaresUtils::System::instance()->targetEnvCall(
-                { "sh", "-c", "mv -f " + shellFriendlyHome + "/.* " + shellFriendlyHome + "/" + backupDirName } );
+            backupDotfiles( existingHome, backupDirName );
         }
     }
 
     cDebug() << "[CREATEUSER]: creating user";
 
+    if ( m_accounts && m_accounts->load( destDir.absolutePath() ) )
+    {
+        m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
+        emit progress( 0.5 );
+        return createUserInProcess( *m_accounts, m_config );
+    }
+
     m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
     emit progress( 0.5 );
     auto useraddResult = createUser( m_config->loginName(), m_config->fullName(), m_config->userShell() );
@@ -169,3 +262,206 @@ CreateUserJob::exec()
 
     return Calamares::JobResult::ok();
 }
+
+
+CreateUsersJob::CreateUsersJob( const Config* config, const AccountDatabasePtr& accounts )
+    : Calamares::Job()
+    , m_config( config )
+    , m_accounts( accounts )
+{
+}
+
+
+QString
+CreateUsersJob::prettyName() const
+{
+    return tr( "Create additional users" );
+}
+
+
+QString
+CreateUsersJob::prettyStatusMessage() const
+{
+    return m_status.isEmpty() ? tr( "Creating additional users" ) : m_status;
+}
+
+/** @brief The additional users from @p config and from Global Storage
+ *
+ * Users with the same login name as the main user, or another
+ * additional user, are skipped. Users with no explicit groups
+ * get the default groups.
+ */
+static QList< UserDescription >
+additionalUsers( const Config* config, const Calamares::GlobalStorage* gs )
+{
+    QList< UserDescription > users = config->additionalUsers();
+    for ( const auto& v : gs->value( "additionalUsers" ).toList() )
+    {
+        users.append( UserDescription::fromMap( v.toMap() ) );
+    }
+
+    QStringList defaultGroups;
+    for ( const auto& g : config->defaultGroups() )
+    {
+        defaultGroups.append( g.name() );
+    }
+
+    QStringList seen { config->loginName() };
+    QList< UserDescription > validUsers;
+    validUsers.reserve( users.count() );
+    for ( auto& u : users )
+    {
+        if ( !u.isValid() || seen.contains( u.loginName ) )
+        {
+            cWarning() << "Skipping additional user" << u.loginName;
+            continue;
+        }
+        seen.append( u.loginName );
+        if ( u.useDefaultGroups )
+        {
+            u.groups = defaultGroups;
+        }
+        if ( u.shell.isEmpty() )
+        {
+            u.shell = config->userShell();
+        }
+        validUsers.append( u );
+    }
+    return validUsers;
+}
+
+/// @brief Creates all the @p users in @p accounts, with @p passwords (as for usermod -p)
+static Calamares::JobResult
+createUsersInProcess( AccountDatabase& accounts,
+                      const QList< UserDescription >& users,
+                      const QStringList& passwords )
+{
+    for ( int i = 0; i < users.count(); ++i )
+    {
+        const auto& u = users.at( i );
+        if ( !accounts.addUser( u.loginName, u.fullName, u.shell ) )
+        {
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot create user %1." ).arg( u.loginName ) );
+        }
+        // Like the *defaultGroups*, groups that don't exist are created
+        for ( const auto& g : u.groups )
+        {
+            if ( !accounts.hasGroup( g ) && !accounts.addGroup( g, false ) )
+            {
+                return Calamares::JobResult::error(
+                    QCoreApplication::translate( "CreateUserJob", "Cannot create group %1." ).arg( g ) );
+            }
+        }
+        if ( !accounts.addUserToGroups( u.loginName, u.groups ) )
+        {
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot add user %1 to groups: %2." )
+                    .arg( u.loginName, u.groups.join( ',' ) ) );
+        }
+        if ( !passwords.at( i ).isEmpty() && !accounts.setPassword( u.loginName, passwords.at( i ) ) )
+        {
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot set password for user %1." ).arg( u.loginName ) );
+        }
+    }
+
+    // Homes are independent of each other
+    auto createHome = [&accounts]( const UserDescription& u ) {
+        QString error;
+        if ( u.createHome && !accounts.createHome( u.loginName, error ) )
+        {
+            return QStringLiteral( "%1: %2" ).arg( u.loginName, error );
+        }
+        return QString();
+    };
+    const QStringList errors = QtConcurrent::blockingMapped< QStringList >( users, createHome );
+    for ( const auto& e : errors )
+    {
+        if ( !e.isEmpty() )
+        {
+            cError() << "Could not create home directory" << e;
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot create home directories." ), e );
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+/// @brief Creates all the @p users with the tools in the target system
+static Calamares::JobResult
+createUsersWithTools( const QList< UserDescription >& users, const QStringList& passwords )
+{
+    for ( int i = 0; i < users.count(); ++i )
+    {
+        const auto& u = users.at( i );
+        auto r = createUser( u.loginName, u.fullName, u.shell, u.createHome );
+        if ( !r )
+        {
+            return r;
+        }
+        if ( !u.groups.isEmpty() )
+        {
+            // Like the *defaultGroups*, groups that don't exist are created
+            r = createMissingGroups( u.groups );
+            if ( !r )
+            {
+                return r;
+            }
+            r = setUserGroups( u.loginName, u.groups );
+            if ( !r )
+            {
+                return r;
+            }
+        }
+        const QString& encrypted = passwords.at( i );
+        if ( !encrypted.isEmpty()
+             && CalamaresUtils::System::instance()->targetEnvCall( { "usermod", "-p", encrypted, u.loginName } ) )
+        {
+            return Calamares::JobResult::error(
+                QCoreApplication::translate( "CreateUserJob", "Cannot set password for user %1." ).arg( u.loginName ) );
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+Calamares::JobResult
+CreateUsersJob::exec()
+{
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    const QString rootMountPoint = gs->value( "rootMountPoint" ).toString();
+    const auto users = additionalUsers( m_config, gs );
+    if ( users.isEmpty() )
+    {
+        return Calamares::JobResult::ok();
+    }
+    cDebug() << "[CREATEUSERS]: creating" << users.count() << "additional users";
+
+    // Encrypting passwords is by far the most expensive part
+    m_status = tr( "Encrypting passwords" );
+    emit progress( 0.1 );
+    auto encrypt = []( const UserDescription& u ) -> QString {
+        if ( !u.encryptedPassword.isEmpty() )
+        {
+            return u.encryptedPassword;
+        }
+        return u.password.isEmpty() ? QString() : SetPasswordJob::encrypt( u.password );
+    };
+    const QStringList passwords = QtConcurrent::blockingMapped< QStringList >( users, encrypt );
+    for ( int i = 0; i < users.count(); ++i )
+    {
+        if ( passwords.at( i ).isEmpty() && !users.at( i ).password.isEmpty() )
+        {
+            return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( users.at( i ).loginName ),
+                                                tr( "The password could not be encrypted." ) );
+        }
+    }
+
+    m_status = tr( "Creating additional users" );
+    emit progress( 0.5 );
+    if ( m_accounts && m_accounts->load( rootMountPoint ) )
+    {
+        return createUsersInProcess( *m_accounts, users, passwords );
+    }
+    return createUsersWithTools( users, passwords );
+}
@@ -10,6 +10,8 @@
 #ifndef CREATEUSERJOB_H
 #define CREATEUSERJOB_H
 
+#include "AccountDatabase.h"
+
 #include "Job.h"
 
 class Config;
@@ -18,7 +20,13 @@ class CreateUserJob : public Calamares::Job
 {
     Q_OBJECT
 public:
-    CreateUserJob( const Config* config );
+    /** @brief Creates the user configured in @p config
+     *
+     * If @p accounts is given and can be used for the target system,
+     * the user is added there (and written later by WriteAccountsJob),
+     * otherwise `useradd` and `usermod` are run in the target system.
+     */
+    CreateUserJob( const Config* config, const AccountDatabasePtr& accounts = AccountDatabasePtr() );
     QString prettyName() const override;
     QString prettyDescription() const override;
     QString prettyStatusMessage() const override;
@@ -26,6 +34,31 @@ public:
 
 private:
     const Config* m_config;
+    AccountDatabasePtr m_accounts;
+    QString m_status;
+};
+
+/** @brief Creates the additional users from the configuration
+ *
+ * The additional users come from the *additionalUsers* setting in
+ * the configuration file and from the Global Storage key of the same
+ * name (which other modules can fill). Passwords are encrypted in
+ * parallel. If @p accounts can be used for the target system, all of
+ * the users are added there (and written in one go by WriteAccountsJob),
+ * otherwise the tools are run for each user.
+ */
+class CreateUsersJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    CreateUsersJob( const Config* config, const AccountDatabasePtr& accounts = AccountDatabasePtr() );
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+private:
+    const Config* m_config;
+    AccountDatabasePtr m_accounts;
     QString m_status;
 };
 
@@ -107,11 +107,15 @@ groupsInTargetSystem()
  * go through the @p wantedGroups and create each of them. Groups that
  * fail, or which should have already been there, are added to
  * @p missingGroups by name.
+ *
+ * If @p accounts is not null, the groups are added there, otherwise
+ * `groupadd` is run in the target system.
  */
 static bool
 ensureGroupsExistInTarget( const QList< GroupDescription >& wantedGroups,
                            const QStringList& availableGroups,
-                           QStringList& missingGroups )
+                           QStringList& missingGroups,
+                           AccountDatabase* accounts )
 {
     int failureCount = 0;
 
@@ -126,6 +130,16 @@ ensureGroupsExistInTarget( const QList< GroupDescription >& wantedGroups,
                 continue;
             }
 
+            if ( accounts )
+            {
+                if ( !accounts->addGroup( group.name(), group.isSystemGroup() ) )
+                {
+                    failureCount++;
+                    missingGroups.append( group.name() + QChar( '*' ) );
+                }
+                continue;
+            }
+
             QStringList cmd;
 #ifdef __FreeBSD__
             if ( group.isSystemGroup() )
@@ -155,8 +169,9 @@ ensureGroupsExistInTarget( const QList< GroupDescription >& wantedGroups,
     return failureCount == 0;
 }
 
-SetupGroupsJob::SetupGroupsJob( const Config* config )
+SetupGroupsJob::SetupGroupsJob( const Config* config, const AccountDatabasePtr& accounts )
     : m_config( config )
+    , m_accounts( accounts )
 {
 }
 
@@ -169,11 +184,18 @@ SetupGroupsJob::prettyName() const
 Calamares::JobResult
 SetupGroupsJob::exec()
 {
+    AccountDatabase* accounts = nullptr;
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    if ( m_accounts && gs && m_accounts->load( gs->value( "rootMountPoint" ).toString() ) )
+    {
+        accounts = m_accounts.get();
+    }
+
     const auto& defaultGroups = m_config->defaultGroups();
-    QStringList availableGroups = groupsInTargetSystem();
+    QStringList availableGroups = accounts ? accounts->groups() : groupsInTargetSystem();
     QStringList missingGroups;
 
-    if ( !ensureGroupsExistInTarget( defaultGroups, availableGroups, missingGroups ) )
+    if ( !ensureGroupsExistInTarget( defaultGroups, availableGroups, missingGroups, accounts ) )
     {
         return Calamares::JobResult::error( tr( "Could not create groups in target system" ) );
     }
@@ -188,8 +210,39 @@ SetupGroupsJob::exec()
     {
         const QString autoLoginGroup = m_config->autoLoginGroup();
         (void)ensureGroupsExistInTarget(
-            QList< GroupDescription >() << GroupDescription( autoLoginGroup ), availableGroups, missingGroups );
+            QList< GroupDescription >() << GroupDescription( autoLoginGroup ),
+            availableGroups,
+            missingGroups,
+            accounts );
     }
 
     return Calamares::JobResult::ok();
 }
+
+WriteAccountsJob::WriteAccountsJob( const AccountDatabasePtr& accounts )
+    : m_accounts( accounts )
+{
+}
+
+QString
+WriteAccountsJob::prettyName() const
+{
+    return tr( "Writing user accounts." );
+}
+
+Calamares::JobResult
+WriteAccountsJob::exec()
+{
+    if ( !m_accounts || !m_accounts->isUsable() || !m_accounts->isModified() )
+    {
+        // The tools have already done the work, or there is nothing to do
+        return Calamares::JobResult::ok();
+    }
+
+    QString error;
+    if ( !m_accounts->commit( error ) )
+    {
+        return Calamares::JobResult::error( tr( "Could not write user accounts in target system" ), error );
+    }
+    return Calamares::JobResult::ok();
+}
@@ -17,6 +17,8 @@
 #ifndef USERS_MISCJOBS_H
 #define USERS_MISCJOBS_H
 
+#include "AccountDatabase.h"
+
 #include "Job.h"
 
 class Config;
@@ -38,12 +40,32 @@ class SetupGroupsJob : public Calamares::Job
     Q_OBJECT
 
 public:
-    SetupGroupsJob( const Config* config );
+    SetupGroupsJob( const Config* config, const AccountDatabasePtr& accounts = AccountDatabasePtr() );
     QString prettyName() const override;
     Calamares::JobResult exec() override;
 
 public:
     const Config* m_config;
+    AccountDatabasePtr m_accounts;
+};
+
+/** @brief Writes the account files changed by the other jobs
+ *
+ * The groups, user and password jobs make their changes to a
+ * shared AccountDatabase (if the target system allows that);
+ * this job writes all of them to the target system at once.
+ */
+class WriteAccountsJob : public Calamares::Job
+{
+    Q_OBJECT
+
+public:
+    WriteAccountsJob( const AccountDatabasePtr& accounts );
+    QString prettyName() const override;
+    Calamares::JobResult exec() override;
+
+public:
+    AccountDatabasePtr m_accounts;
 };
 
 #endif
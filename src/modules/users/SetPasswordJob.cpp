@@ -18,6 +18,7 @@
 
 #include <QDir>
 
+#include <memory>
 #include <random>
 
 #ifndef NO_CRYPT_H
@@ -26,10 +27,13 @@
 #include <unistd.h>
 
 
-SetPasswordJob::SetPasswordJob( const QString& userName, const QString& newPassword )
+SetPasswordJob::SetPasswordJob( const QString& userName,
+                                const QString& newPassword,
+                                const AccountDatabasePtr& accounts )
     : Calamares::Job()
     , m_userName( userName )
     , m_newPassword( newPassword )
+    , m_accounts( accounts )
 {
 }
 
@@ -72,6 +76,17 @@ SetPasswordJob::make_salt( int length )
     return salt_string;
 }
 
+QString
+SetPasswordJob::encrypt( const QString& password )
+{
+    // crypt() uses static storage, crypt_r() doesn't; the state is large
+    // enough that it shouldn't be on the stack.
+    auto data = std::make_unique< struct crypt_data >();
+    const char* encrypted = crypt_r( password.toUtf8().constData(), make_salt( 16 ).toUtf8().constData(), data.get() );
+    // Failure is either nullptr or a string starting with *, depending on the implementation
+    return ( encrypted && encrypted[ 0 ] != '*' ) ? QString::fromLatin1( encrypted ) : QString();
+}
+
 Calamares::JobResult
 SetPasswordJob::exec()
 {
@@ -81,8 +96,16 @@ SetPasswordJob::exec()
         return Calamares::JobResult::error( tr( "Bad destination system path." ),
                                             tr( "rootMountPoint is %1" ).arg( destDir.absolutePath() ) );
 
+    const bool inProcess = m_accounts && m_accounts->load( destDir.absolutePath() );
+
     if ( m_userName == "root" && m_newPassword.isEmpty() )  //special case for disabling root account
     {
+        if ( inProcess )
+        {
+            return m_accounts->lockPassword( m_userName )
+                ? Calamares::JobResult::ok()
+                : Calamares::JobResult::error( tr( "Cannot disable root account." ) );
+        }
         int ec = CalamaresUtils::System::instance()->targetEnvCall( { "passwd", "-dl", m_userName } );
         if ( ec )
             return Calamares::JobResult::error( tr( "Cannot disable root account." ),
@@ -90,7 +113,22 @@ SetPasswordJob::exec()
         return Calamares::JobResult::ok();
     }
 
-    QString encrypted = QString::fromLatin1( crypt( m_newPassword.toUtf8(), make_salt( 16 ).toUtf8() ) );
+    QString encrypted = encrypt( m_newPassword );
+    if ( encrypted.isEmpty() )
+    {
+        return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( m_userName ),
+                                            tr( "The password could not be encrypted." ) );
+    }
+
+    if ( inProcess )
+    {
+        if ( !m_accounts->setPassword( m_userName, encrypted ) )
+        {
+            return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( m_userName ),
+                                                tr( "There is no user %1 in the target system." ).arg( m_userName ) );
+        }
+        return Calamares::JobResult::ok();
+    }
 
     int ec = CalamaresUtils::System::instance()->targetEnvCall( { "usermod", "-p", encrypted, m_userName } );
     if ( ec )
@@ -11,6 +11,8 @@
 #ifndef SETPASSWORDJOB_H
 #define SETPASSWORDJOB_H
 
+#include "AccountDatabase.h"
+
 #include "Job.h"
 
 
@@ -18,16 +20,30 @@ class SetPasswordJob : public Calamares::Job
 {
     Q_OBJECT
 public:
-    SetPasswordJob( const QString& userName, const QString& newPassword );
+    /** @brief Sets the password of @p userName
+     *
+     * If @p accounts is given and can be used for the target system,
+     * the password is set there (and written later by WriteAccountsJob),
+     * otherwise `usermod` is run in the target system.
+     */
+    SetPasswordJob( const QString& userName,
+                    const QString& newPassword,
+                    const AccountDatabasePtr& accounts = AccountDatabasePtr() );
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
 
     static QString make_salt( int length );
+    /** @brief Encrypts @p password (SHA512, with a new salt)
+     *
+     * This is thread-safe, so passwords can be encrypted in parallel.
+     */
+    static QString encrypt( const QString& password );
 
 private:
     QString m_userName;
     QString m_newPassword;
+    AccountDatabasePtr m_accounts;
 };
 
 #endif /* SETPASSWORDJOB_H */
@@ -7,6 +7,7 @@
  *
  */
 
+#include "AccountDatabase.h"
 #include "Config.h"
 #include "CreateUserJob.h"
 #include "MiscJobs.h"
@@ -14,11 +15,17 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "utils/Logger.h"
+#include "utils/String.h"
 #include "utils/Yaml.h"
 
 #include <QDir>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
+#include <algorithm>
+
+#include <unistd.h>
+
 // Implementation details
 extern QStringList groupsInTargetSystem();  // CreateUserJob
 
@@ -37,6 +44,13 @@ private Q_SLOTS:
 
     void testSudoGroup();
     void testJobCreation();
+
+    void testAccountDatabase();
+    void testAccountDatabaseNSS();
+    void testAccountDatabaseRollback();
+
+    void testCreateUsers();
+    void benchmarkCreateUsers();
 };
 
 GroupTests::GroupTests() {}
@@ -147,14 +161,16 @@ GroupTests::testSudoGroup()
  * - A sudo job is created only when the sudoers group is set;
  * - Groups job
  * - User job
+ * - Additional users job
  * - Password job
  * - Root password job
+ * - Write-accounts job
  * - Hostname job are always created.
  */
 void
 GroupTests::testJobCreation()
 {
-    const int expectedJobs = 5;
+    const int expectedJobs = 7;
     Config c;
     QVERIFY( !c.isReady() );
 
@@ -171,6 +187,306 @@ GroupTests::testJobCreation()
     QCOMPARE( c.createJobs().count(), expectedJobs + 1 );
 }
 
+/// @brief Writes @p contents to @p path (relative to @p root), or fails
+static bool
+writeFile( const QDir& root, const QString& path, const QByteArray& contents )
+{
+    QFile f( root.filePath( path ) );
+    return root.mkpath( QFileInfo( f ).absolutePath() ) && f.open( QIODevice::WriteOnly )
+        && f.write( contents ) == contents.size();
+}
+
+static QStringList
+readLines( const QDir& root, const QString& path )
+{
+    QFile f( root.filePath( path ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return QStringList();
+    }
+    return QString::fromUtf8( f.readAll() ).split( '\n', SplitSkipEmptyParts );
+}
+
+/// @brief A tiny target system with just the account files
+static bool
+makeAccountFiles( const QDir& root )
+{
+    return writeFile( root,
+                      "etc/passwd",
+                      "root:x:0:0:root:/root:/bin/bash\n"
+                      "existing:x:1000:1000:Existing User:/home/existing:/bin/sh\n" )
+        && writeFile( root, "etc/shadow", "root:*:19000:0:99999:7:::\nexisting:!:19000:0:99999:7:::\n" )
+        && writeFile( root, "etc/group", "root:x:0:\nwheel:x:998:\nexisting:x:1000:\n" )
+        && writeFile( root, "etc/gshadow", "root:*::\nwheel:!::\nexisting:!::\n" )
+        && writeFile( root, "etc/subuid", "existing:100000:65536\n" )
+        && writeFile( root,
+                      "etc/login.defs",
+                      "# Comment\nUID_MIN 1000\nUID_MAX 60000\nGID_MIN 1000\nGID_MAX 60000\n"
+                      "SYS_GID_MAX 999\nPASS_MAX_DAYS 99999\nPASS_WARN_AGE 7\n" )
+        && writeFile( root, "etc/default/useradd", "SHELL=/bin/zsh\n" );
+}
+
+void
+GroupTests::testAccountDatabase()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+    QVERIFY( makeAccountFiles( root ) );
+
+    AccountDatabase accounts;
+    QVERIFY( accounts.load( root.absolutePath() ) );
+    QVERIFY( accounts.isUsable() );
+    QVERIFY( !accounts.isModified() );
+    QCOMPARE( accounts.groups(), QStringList( { "root", "wheel", "existing" } ) );
+    QCOMPARE( accounts.userId( "existing" ), 1000 );
+    QCOMPARE( accounts.groupId( "wheel" ), 998 );
+
+    // System groups count down, from below the existing one
+    QVERIFY( accounts.addGroup( "audio", true ) );
+    QCOMPARE( accounts.groupId( "audio" ), 999 );
+    QVERIFY( accounts.addGroup( "video", true ) );
+    QCOMPARE( accounts.groupId( "video" ), 997 );
+    QVERIFY( !accounts.addGroup( "wheel", true ) );  // Exists already
+    QVERIFY( !accounts.addGroup( "a:b", false ) );
+
+    QVERIFY( accounts.addUser( "goodj", "Goodluck Jonathan", QString() ) );
+    QVERIFY( !accounts.addUser( "goodj", "Goodluck Jonathan", QString() ) );
+    QVERIFY( !accounts.addUser( "colon", "Full: Name", QString() ) );
+    QCOMPARE( accounts.userId( "goodj" ), 1001 );
+    QCOMPARE( accounts.groupId( "goodj" ), 1001 );
+    QVERIFY( accounts.addUserToGroups( "goodj", { "wheel", "audio" } ) );
+    QVERIFY( !accounts.addUserToGroups( "goodj", { "nonexistent" } ) );
+    QVERIFY( accounts.setPassword( "goodj", "$6$salt$hash" ) );
+    QVERIFY( accounts.lockPassword( "root" ) );
+    QVERIFY( !accounts.setPassword( "nobody", "x" ) );
+    QVERIFY( accounts.isModified() );
+
+    // Nothing written yet
+    QCOMPARE( readLines( root, "etc/passwd" ).count(), 2 );
+
+    QString error;
+    QVERIFY( accounts.commit( error ) );
+    QVERIFY( error.isEmpty() );
+    QVERIFY( !accounts.isModified() );
+
+    const auto passwd = readLines( root, "etc/passwd" );
+    QCOMPARE( passwd.count(), 3 );
+    QCOMPARE( passwd.last(), QStringLiteral( "goodj:x:1001:1001:Goodluck Jonathan:/home/goodj:/bin/zsh" ) );
+    const auto shadow = readLines( root, "etc/shadow" );
+    QCOMPARE( shadow.count(), 3 );
+    QCOMPARE( shadow.first(), QStringLiteral( "root:!:19000:0:99999:7:::" ) );
+    QVERIFY( shadow.last().startsWith( "goodj:$6$salt$hash:" ) );
+    QVERIFY( shadow.last().endsWith( ":99999:7:::" ) );
+    const auto group = readLines( root, "etc/group" );
+    QVERIFY( group.contains( "wheel:x:998:goodj" ) );
+    QVERIFY( group.contains( "audio:x:999:goodj" ) );
+    QVERIFY( group.contains( "video:x:997:" ) );
+    QVERIFY( group.contains( "goodj:x:1001:" ) );
+    const auto gshadow = readLines( root, "etc/gshadow" );
+    QVERIFY( gshadow.contains( "wheel:!::goodj" ) );
+    QVERIFY( gshadow.contains( "goodj:!::" ) );
+    QCOMPARE( readLines( root, "etc/subuid" ).last(), QStringLiteral( "goodj:165536:65536" ) );
+    QVERIFY( !QFile::exists( root.filePath( "etc/subgid" ) ) );  // Not created if it wasn't there
+
+    // Backups of the originals, and no leftovers
+    QCOMPARE( readLines( root, "etc/passwd-" ).count(), 2 );
+    QVERIFY( !QFile::exists( root.filePath( "etc/passwd+" ) ) );
+
+    // The database keeps working after a commit
+    QVERIFY( accounts.addGroup( "later", false ) );
+    QCOMPARE( accounts.groupId( "later" ), 1002 );
+    QVERIFY( accounts.commit( error ) );
+    QVERIFY( readLines( root, "etc/group" ).contains( "later:x:1002:" ) );
+
+    if ( geteuid() != 0 )
+    {
+        QSKIP( "Home directory ownership can only be set as root" );
+    }
+    QVERIFY( writeFile( root, "etc/skel/.profile", "# Profile\n" ) );
+    QVERIFY( accounts.createHome( "goodj", error ) );
+    QFileInfo profile( root.filePath( "home/goodj/.profile" ) );
+    QVERIFY( profile.exists() );
+    QCOMPARE( profile.ownerId(), 1001u );
+    QCOMPARE( profile.groupId(), 1001u );
+}
+
+void
+GroupTests::testAccountDatabaseNSS()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+    QVERIFY( makeAccountFiles( root ) );
+
+    {
+        QVERIFY( writeFile( root,
+                            "etc/nsswitch.conf",
+                            "passwd: files systemd\ngroup: compat [NOTFOUND=return] files\nhosts: dns\n" ) );
+        AccountDatabase accounts;
+        QVERIFY( accounts.load( root.absolutePath() ) );
+    }
+    {
+        QVERIFY( writeFile( root, "etc/nsswitch.conf", "passwd: files ldap\ngroup: files\n" ) );
+        AccountDatabase accounts;
+        QVERIFY( !accounts.load( root.absolutePath() ) );
+        QVERIFY( !accounts.addGroup( "audio", true ) );
+        QString error;
+        QVERIFY( !accounts.commit( error ) );
+        QVERIFY( !error.isEmpty() );
+    }
+    {
+        QVERIFY( QFile::remove( root.filePath( "etc/nsswitch.conf" ) ) );
+        QVERIFY( writeFile( root, "etc/group", "root:x:0:\n+:::\n" ) );
+        AccountDatabase accounts;
+        QVERIFY( !accounts.load( root.absolutePath() ) );
+    }
+    {
+        QVERIFY( QFile::remove( root.filePath( "etc/shadow" ) ) );
+        AccountDatabase accounts;
+        QVERIFY( !accounts.load( root.absolutePath() ) );
+    }
+}
+
+void
+GroupTests::testAccountDatabaseRollback()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+    QVERIFY( makeAccountFiles( root ) );
+    const auto passwd = readLines( root, "etc/passwd" );
+    const auto shadow = readLines( root, "etc/shadow" );
+    const auto group = readLines( root, "etc/group" );
+
+    AccountDatabase accounts;
+    QVERIFY( accounts.load( root.absolutePath() ) );
+    QVERIFY( accounts.addUser( "goodj", "Goodluck Jonathan", QString() ) );
+
+    // The backup of /etc/shadow can't be made, after /etc/passwd was replaced
+    QVERIFY( root.mkpath( "etc/shadow-/blocked" ) );
+    QString error;
+    QVERIFY( !accounts.commit( error ) );
+    QVERIFY( error.contains( "shadow" ) );
+    QVERIFY( accounts.isModified() );
+    QCOMPARE( readLines( root, "etc/passwd" ), passwd );
+    QCOMPARE( readLines( root, "etc/shadow" ), shadow );
+    QCOMPARE( readLines( root, "etc/group" ), group );
+    for ( const char* leftover : { "etc/passwd+", "etc/shadow+", "etc/group+", "etc/gshadow+" } )
+    {
+        QVERIFY2( !QFile::exists( root.filePath( leftover ) ), leftover );
+    }
+
+    // Once the problem is gone, the same changes can be committed
+    QVERIFY( QDir( root.filePath( "etc/shadow-" ) ).removeRecursively() );
+    QVERIFY( accounts.commit( error ) );
+    QVERIFY( !accounts.isModified() );
+    QCOMPARE( readLines( root, "etc/passwd" ).count(), passwd.count() + 1 );
+    QCOMPARE( readLines( root, "etc/shadow" ).count(), shadow.count() + 1 );
+}
+
+void
+GroupTests::testCreateUsers()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+    QVERIFY( makeAccountFiles( root ) );
+
+    QVariantList users;
+    users.append( QVariantMap { { "name", "lab01" }, { "password", "secret" }, { "createHome", false } } );
+    users.append( QVariantMap {
+        { "name", "lab02" }, { "groups", QStringList { "wheel", "lab" } }, { "createHome", false } } );
+    users.append( QVariantMap { { "name", "goodj" } } );  // Same as the main user, skipped
+
+    Config c;
+    c.setConfigurationMap( QVariantMap { { "defaultGroups", QStringList { "wheel" } }, { "additionalUsers", users } } );
+    c.setLoginName( QStringLiteral( "goodj" ) );
+    QCOMPARE( c.additionalUsers().count(), 3 );
+
+    auto* gs = Calamares::JobQueue::instance()->globalStorage();
+    gs->insert( "rootMountPoint", root.absolutePath() );
+    gs->insert( "additionalUsers",
+                QVariantList { QVariantMap { { "name", "fromgs" }, { "encryptedPassword", "$6$salt$hash" },
+                                             { "createHome", false } } } );
+
+    auto accounts = std::make_shared< AccountDatabase >();
+    CreateUsersJob j( &c, accounts );
+    QVERIFY( j.exec() );
+    WriteAccountsJob w( accounts );
+    QVERIFY( w.exec() );
+
+    gs->insert( "rootMountPoint", "/" );
+    gs->remove( "additionalUsers" );
+
+    const auto passwd = readLines( root, "etc/passwd" );
+    QCOMPARE( passwd.count(), 5 );
+    QVERIFY( passwd.contains( "lab01:x:1001:1001::/home/lab01:/bin/bash" ) );
+    QVERIFY( passwd.contains( "lab02:x:1002:1002::/home/lab02:/bin/bash" ) );
+    QVERIFY( passwd.contains( "fromgs:x:1003:1004::/home/fromgs:/bin/bash" ) );  // 1003 is lab
+    const auto group = readLines( root, "etc/group" );
+    QVERIFY( group.contains( "wheel:x:998:lab01,lab02" ) );
+    QVERIFY( group.contains( "lab:x:1003:lab02" ) );  // Created, after lab02's group
+    const auto shadow = readLines( root, "etc/shadow" );
+    QVERIFY( std::any_of(
+        shadow.cbegin(), shadow.cend(), []( const QString& l ) { return l.startsWith( "lab01:$6$" ); } ) );
+    QVERIFY( std::any_of(
+        shadow.cbegin(), shadow.cend(), []( const QString& l ) { return l.startsWith( "lab02:!:" ); } ) );
+    QVERIFY( std::any_of(
+        shadow.cbegin(), shadow.cend(), []( const QString& l ) { return l.startsWith( "fromgs:$6$salt$hash:" ); } ) );
+    QVERIFY( !QFile::exists( root.filePath( "home/lab01" ) ) );
+
+    // A group that can't be created is an error, not a user in fewer groups
+    Config bad;
+    bad.setConfigurationMap( QVariantMap { { "additionalUsers",
+                                             QVariantList { QVariantMap { { "name", "lab03" },
+                                                                          { "groups", QStringList { "bad:group" } },
+                                                                          { "createHome", false } } } } } );
+    bad.setLoginName( QStringLiteral( "goodj" ) );
+    gs->insert( "rootMountPoint", root.absolutePath() );
+    CreateUsersJob badJob( &bad, std::make_shared< AccountDatabase >() );
+    QVERIFY( !badJob.exec() );
+    gs->insert( "rootMountPoint", "/" );
+}
+
+void
+GroupTests::benchmarkCreateUsers()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+
+    QVariantList users;
+    for ( int i = 0; i < 1000; ++i )
+    {
+        users.append( QVariantMap { { "name", QStringLiteral( "lab%1" ).arg( i, 4, 10, QChar( '0' ) ) },
+                                    { "fullName", QStringLiteral( "Lab user %1" ).arg( i ) },
+                                    { "password", QStringLiteral( "password%1" ).arg( i ) },
+                                    { "createHome", false } } );
+    }
+    Config c;
+    c.setConfigurationMap( QVariantMap { { "defaultGroups", QStringList { "wheel" } }, { "additionalUsers", users } } );
+    c.setLoginName( QStringLiteral( "goodj" ) );
+    QCOMPARE( c.additionalUsers().count(), 1000 );
+
+    auto* gs = Calamares::JobQueue::instance()->globalStorage();
+    gs->insert( "rootMountPoint", root.absolutePath() );
+    QBENCHMARK
+    {
+        QVERIFY( makeAccountFiles( root ) );
+        auto accounts = std::make_shared< AccountDatabase >();
+        CreateUsersJob j( &c, accounts );
+        QVERIFY( j.exec() );
+        WriteAccountsJob w( accounts );
+        QVERIFY( w.exec() );
+    }
+    gs->insert( "rootMountPoint", "/" );
+
+    QCOMPARE( readLines( root, "etc/passwd" ).count(), 1002 );
+    QCOMPARE( readLines( root, "etc/passwd" ).last(),
+              QStringLiteral( "lab0999:x:2000:2000:Lab user 999:/home/lab0999:/bin/bash" ) );
+}
+
 
 QTEST_GUILESS_MAIN( GroupTests )
 
@@ -21,6 +21,7 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testSalt();
+    void testEncrypt();
 };
 
 PasswordTests::PasswordTests() {}
@@ -48,6 +49,17 @@ PasswordTests::testSalt()
     qDebug() << "Obtained salt" << s;
 }
 
+void
+PasswordTests::testEncrypt()
+{
+    const QString e0 = SetPasswordJob::encrypt( QStringLiteral( "secret" ) );
+    const QString e1 = SetPasswordJob::encrypt( QStringLiteral( "secret" ) );
+    QVERIFY( e0.startsWith( "$6$" ) );
+    QCOMPARE( e0.count( '$' ), 3 );
+    QVERIFY( e0.length() > 4 + 16 + 80 );  // Salt, and the SHA512 hash in base64
+    QVERIFY( e0 != e1 );  // Different salt each time
+}
+
 QTEST_GUILESS_MAIN( PasswordTests )
 
 #include "utils/moc-warnings.h"
@@ -17,6 +17,7 @@
 
 // Implementation details
 extern void setConfigurationDefaultGroups( const QVariantMap& map, QList< GroupDescription >& defaultGroups );
+extern void setConfigurationAdditionalUsers( const QVariantMap& map, QList< UserDescription >& additionalUsers );
 extern HostNameActions getHostNameActions( const QVariantMap& configurationMap );
 extern bool addPasswordCheck( const QString& key, const QVariant& value, PasswordCheckList& passwordChecks );
 
@@ -40,10 +41,14 @@ private Q_SLOTS:
     void testDefaultGroupsYAML_data();
     void testDefaultGroupsYAML();
 
+    void testAdditionalUsers();
+
     void testHostActions_data();
     void testHostActions();
     void testPasswordChecks();
     void testUserPassword();
+    void testPasswordLatency();
+    void testPasswordCacheEviction();
 
     void testAutoLogin_data();
     void testAutoLogin();
@@ -216,6 +221,47 @@ UserTests::testDefaultGroupsYAML()
 }
 
 
+void
+UserTests::testAdditionalUsers()
+{
+    const QByteArray yaml = "additionalUsers:\n"
+                            "    - name: lab01\n"
+                            "      fullName: Lab 1\n"
+                            "      password: secret\n"
+                            "      groups: [ audio ]\n"
+                            "    - name: kiosk\n"
+                            "      encryptedPassword: \"$6$x$y\"\n"
+                            "      createHome: false\n"
+                            "    - fullName: Nameless\n"
+                            "    - name: lab01\n"
+                            "    - name: broken\n"
+                            "      encryptedPassword: \"$6$x:y\"\n";
+    const auto map = CalamaresUtils::yamlMapToVariant( YAML::Load( yaml.constData() ) );
+
+    QList< UserDescription > users;
+    setConfigurationAdditionalUsers( map, users );
+    QCOMPARE( users.count(), 2 );  // No name, duplicate and broken password hash are skipped
+
+    const auto& lab = users.at( 0 );
+    QCOMPARE( lab.loginName, QStringLiteral( "lab01" ) );
+    QCOMPARE( lab.fullName, QStringLiteral( "Lab 1" ) );
+    QCOMPARE( lab.password, QStringLiteral( "secret" ) );
+    QVERIFY( lab.encryptedPassword.isEmpty() );
+    QCOMPARE( lab.groups, QStringList { "audio" } );
+    QVERIFY( !lab.useDefaultGroups );
+    QVERIFY( lab.createHome );
+
+    const auto& kiosk = users.at( 1 );
+    QCOMPARE( kiosk.loginName, QStringLiteral( "kiosk" ) );
+    QVERIFY( kiosk.password.isEmpty() );
+    QCOMPARE( kiosk.encryptedPassword, QStringLiteral( "$6$x$y" ) );
+    QVERIFY( kiosk.useDefaultGroups );
+    QVERIFY( !kiosk.createHome );
+
+    setConfigurationAdditionalUsers( QVariantMap(), users );
+    QVERIFY( users.isEmpty() );
+}
+
 void
 UserTests::testHostActions_data()
 {
@@ -342,6 +388,116 @@ UserTests::testUserPassword()
     }
 }
 
+/** @brief Typing a password doesn't wait for libpwquality
+ *
+ * Each keystroke only runs the cheap checks; the dictionary check
+ * runs in the background once typing stops. This logs the time
+ * spent per keystroke and the time until the final result.
+ */
+void
+UserTests::testPasswordLatency()
+{
+#ifdef HAVE_LIBPWQUALITY
+    Config c;
+    QVariantMap m;
+    m.insert( "defaultGroups", QStringList { "wheel" } );
+    m.insert( "passwordRequirements",
+              QVariantMap { { "nonempty", true }, { "libpwquality", QStringList { "minlen=8" } } } );
+    c.setConfigurationMap( m );
+
+    const QString pending( "Checking password quality..." );  // Untranslated in tests
+    const QString password( "Tr0ub4dor&3-correct-horse" );
+    QElapsedTimer timer;
+    qint64 slowestKeystroke = 0;
+    timer.start();
+    for ( int i = 1; i <= password.length(); ++i )
+    {
+        QElapsedTimer keystroke;
+        keystroke.start();
+        c.setUserPassword( password.left( i ) );
+        c.setUserPasswordSecondary( password.left( i ) );
+        slowestKeystroke = std::max( slowestKeystroke, keystroke.nsecsElapsed() );
+    }
+    const qint64 typing = timer.elapsed();
+    // Not checked yet, since we were typing
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Invalid ) );
+    QCOMPARE( c.userPasswordMessage(), pending );
+
+    QTRY_VERIFY_WITH_TIMEOUT( c.userPasswordMessage() != pending, 5000 );
+    cDebug() << "Password of" << password.length() << "characters typed in" << typing << "ms,"
+             << "slowest keystroke" << ( slowestKeystroke / 1000 ) << "us,"
+             << "result after" << timer.elapsed() << "ms";
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Valid ) );
+
+    // A dictionary word is found out, too
+    timer.restart();
+    c.setUserPassword( "password" );
+    c.setUserPasswordSecondary( "password" );
+    QTRY_VERIFY_WITH_TIMEOUT( c.userPasswordMessage() != pending, 5000 );
+    cDebug() << "Weak password result after" << timer.elapsed() << "ms";
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Invalid ) );
+
+    // Going back to an earlier password uses the earlier result
+    c.setUserPassword( password );
+    c.setUserPasswordSecondary( password );
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Valid ) );
+
+    // When weak passwords are allowed, a pending check doesn't block
+    c.setRequireStrongPasswords( false );
+    c.setUserPassword( "not-checked-yet" );
+    c.setUserPasswordSecondary( "not-checked-yet" );
+    QCOMPARE( c.userPasswordMessage(), pending );
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Weak ) );
+    c.setRequireStrongPasswords( true );
+
+    // The empty password is never checked in the background
+    c.setUserPassword( QString() );
+    c.setUserPasswordSecondary( QString() );
+    QVERIFY( c.userPasswordMessage() != pending );
+    QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Invalid ) );
+#else
+    QSKIP( "No libpwquality, no expensive password checks" );
+#endif
+}
+
+/** @brief The cache of expensive check results keeps the current passwords
+ *
+ * Checking more passwords than fit in the cache must not drop the
+ * result for a password that is still in use (here, the root password).
+ */
+void
+UserTests::testPasswordCacheEviction()
+{
+#ifdef HAVE_LIBPWQUALITY
+    Config c;
+    QVariantMap m;
+    m.insert( "defaultGroups", QStringList { "wheel" } );
+    m.insert( "setRootPassword", true );
+    m.insert( "doReusePassword", false );
+    m.insert( "passwordRequirements",
+              QVariantMap { { "nonempty", true }, { "libpwquality", QStringList { "minlen=8" } } } );
+    c.setConfigurationMap( m );
+
+    const QString pending( "Checking password quality..." );  // Untranslated in tests
+    c.setRootPassword( QStringLiteral( "root-Tr0ub4dor&3" ) );
+    c.setRootPasswordSecondary( QStringLiteral( "root-Tr0ub4dor&3" ) );
+    QTRY_VERIFY_WITH_TIMEOUT( c.rootPasswordMessage() != pending, 5000 );
+    const QString rootMessage = c.rootPasswordMessage();
+
+    for ( int i = 0; i < 40; ++i )
+    {
+        const QString password = QStringLiteral( "user-%1-correct-horse" ).arg( i );
+        c.setUserPassword( password );
+        c.setUserPasswordSecondary( password );
+        QTRY_VERIFY_WITH_TIMEOUT( c.userPasswordMessage() != pending, 5000 );
+    }
+    // Still cached, so known right away
+    QCOMPARE( c.rootPasswordMessage(), rootMessage );
+#else
+    QSKIP( "No libpwquality, no expensive password checks" );
+#endif
+}
+
 void
 UserTests::testAutoLogin_data()
 {